@@ -0,0 +1,232 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//
+// Created by root on 10/18/26.
+//
+
+#include "bench_util.h"
+
+#include "falcon/operator/phe/phe_key_context.h"
+#include "falcon/operator/phe/share_combine.h"
+#include "falcon/utils/thread_pool.h"
+
+#include <memory>
+#include <numeric>
+#include <vector>
+
+/**
+ * the state of an operator benchmark: the keys of state.range(0) bits and
+ * the crypto pool of state.range(1) threads
+ */
+static const BenchKeys &setup(benchmark::State &state) {
+  crypto_thread_pool_init((int)state.range(1));
+  return bench_keys((int)state.range(0));
+}
+
+static void BM_Encrypt(benchmark::State &state) {
+  const BenchKeys &keys = setup(state);
+  std::vector<std::vector<double>> mat(1,
+                                       std::vector<double>(BENCH_VECTOR_SIZE));
+  std::iota(mat[0].begin(), mat[0].end(), -BENCH_VECTOR_SIZE / 2.0);
+  auto **res = new EncodedNumber *[1];
+  res[0] = new EncodedNumber[BENCH_VECTOR_SIZE];
+  for (auto _ : state) {
+    // the slots hold the ciphertexts of the previous iteration
+    for (int i = 0; i < BENCH_VECTOR_SIZE; i++) {
+      res[0][i].setter_type(Plaintext);
+    }
+    djcs_t_aux_double_mat_encryption(keys.pk, keys.hr, res, 1,
+                                     BENCH_VECTOR_SIZE, mat,
+                                     PHE_FIXED_POINT_PRECISION);
+  }
+  state.SetItemsProcessed(state.iterations() * BENCH_VECTOR_SIZE);
+  delete[] res[0];
+  delete[] res;
+}
+BENCHMARK(BM_Encrypt)->Apply(bench_phe_args);
+
+static void BM_PartialDecrypt(benchmark::State &state) {
+  const BenchKeys &keys = setup(state);
+  PheKeyContext ctx(keys.pk, keys.au[0]);
+  auto *ciphers = new EncodedNumber[BENCH_VECTOR_SIZE];
+  auto *res = new EncodedNumber[BENCH_VECTOR_SIZE];
+  bench_random_ciphers(keys, ciphers, BENCH_VECTOR_SIZE);
+  for (auto _ : state) {
+    djcs_t_aux_partial_decrypt_batch(ctx, res, ciphers, BENCH_VECTOR_SIZE);
+  }
+  state.SetItemsProcessed(state.iterations() * BENCH_VECTOR_SIZE);
+  delete[] ciphers;
+  delete[] res;
+}
+BENCHMARK(BM_PartialDecrypt)->Apply(bench_phe_args);
+
+static void BM_ShareCombine(benchmark::State &state) {
+  const BenchKeys &keys = setup(state);
+  std::vector<int> party_ids(BENCH_PARTY_NUM);
+  std::iota(party_ids.begin(), party_ids.end(), 0);
+  ShareCombineContext ctx(std::make_shared<PheKeyContext>(keys.pk, keys.au[0]),
+                          party_ids);
+  auto *ciphers = new EncodedNumber[BENCH_VECTOR_SIZE];
+  auto *res = new EncodedNumber[BENCH_VECTOR_SIZE];
+  bench_random_ciphers(keys, ciphers, BENCH_VECTOR_SIZE);
+  // the shares of all the parties, shares[i][j] from party j
+  auto **shares = new EncodedNumber *[BENCH_VECTOR_SIZE];
+  for (int i = 0; i < BENCH_VECTOR_SIZE; i++) {
+    shares[i] = new EncodedNumber[BENCH_PARTY_NUM];
+  }
+  for (int j = 0; j < BENCH_PARTY_NUM; j++) {
+    djcs_t_aux_partial_decrypt_batch(keys.pk, keys.au[j], res, ciphers,
+                                     BENCH_VECTOR_SIZE);
+    for (int i = 0; i < BENCH_VECTOR_SIZE; i++) {
+      shares[i][j] = res[i];
+    }
+  }
+  for (auto _ : state) {
+    djcs_t_aux_share_combine_batch(ctx, res, shares, BENCH_VECTOR_SIZE);
+  }
+  state.SetItemsProcessed(state.iterations() * BENCH_VECTOR_SIZE);
+  for (int i = 0; i < BENCH_VECTOR_SIZE; i++) {
+    delete[] shares[i];
+  }
+  delete[] shares;
+  delete[] ciphers;
+  delete[] res;
+}
+BENCHMARK(BM_ShareCombine)->Apply(bench_phe_args);
+
+static void BM_EeAdd(benchmark::State &state) {
+  const BenchKeys &keys = setup(state);
+  auto *ciphers1 = new EncodedNumber[BENCH_VECTOR_SIZE];
+  auto *ciphers2 = new EncodedNumber[BENCH_VECTOR_SIZE];
+  auto *res = new EncodedNumber[BENCH_VECTOR_SIZE];
+  bench_random_ciphers(keys, ciphers1, BENCH_VECTOR_SIZE);
+  bench_random_ciphers(keys, ciphers2, BENCH_VECTOR_SIZE);
+  for (auto _ : state) {
+    djcs_t_aux_vec_ele_wise_ee_add(keys.pk, res, ciphers1, ciphers2,
+                                   BENCH_VECTOR_SIZE);
+  }
+  state.SetItemsProcessed(state.iterations() * BENCH_VECTOR_SIZE);
+  delete[] ciphers1;
+  delete[] ciphers2;
+  delete[] res;
+}
+BENCHMARK(BM_EeAdd)->Apply(bench_phe_args);
+
+static void BM_EpMul(benchmark::State &state) {
+  const BenchKeys &keys = setup(state);
+  auto *ciphers = new EncodedNumber[BENCH_VECTOR_SIZE];
+  auto *plains = new EncodedNumber[BENCH_VECTOR_SIZE];
+  auto *res = new EncodedNumber[BENCH_VECTOR_SIZE];
+  bench_random_ciphers(keys, ciphers, BENCH_VECTOR_SIZE);
+  bench_random_plains(keys.pk, plains, BENCH_VECTOR_SIZE);
+  for (auto _ : state) {
+    djcs_t_aux_vec_ele_wise_ep_mul(keys.pk, res, ciphers, plains,
+                                   BENCH_VECTOR_SIZE);
+  }
+  state.SetItemsProcessed(state.iterations() * BENCH_VECTOR_SIZE);
+  delete[] ciphers;
+  delete[] plains;
+  delete[] res;
+}
+BENCHMARK(BM_EpMul)->Apply(bench_phe_args);
+
+static void BM_InnerProduct(benchmark::State &state) {
+  const BenchKeys &keys = setup(state);
+  auto *ciphers = new EncodedNumber[BENCH_VECTOR_SIZE];
+  auto *plains = new EncodedNumber[BENCH_VECTOR_SIZE];
+  EncodedNumber res;
+  bench_random_ciphers(keys, ciphers, BENCH_VECTOR_SIZE);
+  bench_random_plains(keys.pk, plains, BENCH_VECTOR_SIZE);
+  for (auto _ : state) {
+    djcs_t_aux_inner_product(keys.pk, keys.hr, res, ciphers, plains,
+                             BENCH_VECTOR_SIZE);
+  }
+  state.SetItemsProcessed(state.iterations() * BENCH_VECTOR_SIZE);
+  delete[] ciphers;
+  delete[] plains;
+}
+BENCHMARK(BM_InnerProduct)->Apply(bench_phe_args);
+
+/** allocate a matrix of random plaintexts */
+static EncodedNumber **random_plain_mat(djcs_t_public_key *pk, int row_size,
+                                        int column_size) {
+  auto **mat = new EncodedNumber *[row_size];
+  for (int i = 0; i < row_size; i++) {
+    mat[i] = new EncodedNumber[column_size];
+    bench_random_plains(pk, mat[i], column_size);
+  }
+  return mat;
+}
+
+/** free a matrix */
+static void free_mat(EncodedNumber **mat, int row_size) {
+  for (int i = 0; i < row_size; i++) {
+    delete[] mat[i];
+  }
+  delete[] mat;
+}
+
+static void BM_VecMat(benchmark::State &state) {
+  const BenchKeys &keys = setup(state);
+  // a batch of samples times the encrypted weights, as in the linear models
+  int row_size = BENCH_VECTOR_SIZE, column_size = BENCH_MATRIX_SIZE;
+  auto *ciphers = new EncodedNumber[column_size];
+  auto *res = new EncodedNumber[row_size];
+  bench_random_ciphers(keys, ciphers, column_size);
+  EncodedNumber **plains = random_plain_mat(keys.pk, row_size, column_size);
+  for (auto _ : state) {
+    djcs_t_aux_vec_mat_ep_mult(keys.pk, keys.hr, res, ciphers, plains,
+                               row_size, column_size);
+  }
+  state.SetItemsProcessed(state.iterations() * row_size * column_size);
+  free_mat(plains, row_size);
+  delete[] ciphers;
+  delete[] res;
+}
+BENCHMARK(BM_VecMat)->Apply(bench_phe_args);
+
+static void BM_MatMat(benchmark::State &state) {
+  const BenchKeys &keys = setup(state);
+  int size = BENCH_MATRIX_SIZE;
+  auto **cipher_mat = new EncodedNumber *[size];
+  for (int i = 0; i < size; i++) {
+    cipher_mat[i] = new EncodedNumber[size];
+    bench_random_ciphers(keys, cipher_mat[i], size);
+  }
+  EncodedNumber **plain_mat = random_plain_mat(keys.pk, size, size);
+  auto **res = new EncodedNumber *[size];
+  for (int i = 0; i < size; i++) {
+    res[i] = new EncodedNumber[size];
+  }
+  for (auto _ : state) {
+    djcs_t_aux_mat_mat_ep_mult(keys.pk, keys.hr, res, cipher_mat, plain_mat,
+                               size, size, size, size);
+  }
+  state.SetItemsProcessed(state.iterations() * size * size * size);
+  free_mat(cipher_mat, size);
+  free_mat(plain_mat, size);
+  free_mat(res, size);
+}
+BENCHMARK(BM_MatMat)->Apply(bench_phe_args);
@@ -0,0 +1,90 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//
+// Created by root on 10/18/26.
+//
+
+#include "bench_util.h"
+
+#include "falcon/utils/pb_converter/common_converter.h"
+
+#include <string>
+#include <vector>
+
+static void BM_Encode(benchmark::State &state) {
+  const BenchKeys &keys = bench_keys((int)state.range(0));
+  auto *plains = new EncodedNumber[BENCH_VECTOR_SIZE];
+  for (auto _ : state) {
+    bench_random_plains(keys.pk, plains, BENCH_VECTOR_SIZE);
+  }
+  state.SetItemsProcessed(state.iterations() * BENCH_VECTOR_SIZE);
+  delete[] plains;
+}
+BENCHMARK(BM_Encode)->Apply(bench_key_args);
+
+static void BM_Decode(benchmark::State &state) {
+  const BenchKeys &keys = bench_keys((int)state.range(0));
+  auto *plains = new EncodedNumber[BENCH_VECTOR_SIZE];
+  bench_random_plains(keys.pk, plains, BENCH_VECTOR_SIZE);
+  std::vector<double> values(BENCH_VECTOR_SIZE);
+  for (auto _ : state) {
+    for (int i = 0; i < BENCH_VECTOR_SIZE; i++) {
+      plains[i].decode(values[i]);
+    }
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * BENCH_VECTOR_SIZE);
+  delete[] plains;
+}
+BENCHMARK(BM_Decode)->Apply(bench_key_args);
+
+static void BM_Serialize(benchmark::State &state) {
+  const BenchKeys &keys = bench_keys((int)state.range(0));
+  auto *ciphers = new EncodedNumber[BENCH_VECTOR_SIZE];
+  bench_random_ciphers(keys, ciphers, BENCH_VECTOR_SIZE);
+  std::string message;
+  for (auto _ : state) {
+    serialize_encoded_number_array(ciphers, BENCH_VECTOR_SIZE, message);
+  }
+  state.SetItemsProcessed(state.iterations() * BENCH_VECTOR_SIZE);
+  state.SetBytesProcessed(state.iterations() * (int64_t)message.size());
+  delete[] ciphers;
+}
+BENCHMARK(BM_Serialize)->Apply(bench_key_args);
+
+static void BM_Deserialize(benchmark::State &state) {
+  const BenchKeys &keys = bench_keys((int)state.range(0));
+  auto *ciphers = new EncodedNumber[BENCH_VECTOR_SIZE];
+  bench_random_ciphers(keys, ciphers, BENCH_VECTOR_SIZE);
+  std::string message;
+  serialize_encoded_number_array(ciphers, BENCH_VECTOR_SIZE, message);
+  for (auto _ : state) {
+    deserialize_encoded_number_array(ciphers, BENCH_VECTOR_SIZE, message);
+  }
+  state.SetItemsProcessed(state.iterations() * BENCH_VECTOR_SIZE);
+  state.SetBytesProcessed(state.iterations() * (int64_t)message.size());
+  delete[] ciphers;
+}
+BENCHMARK(BM_Deserialize)->Apply(bench_key_args);
@@ -0,0 +1,114 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//
+// Created by root on 10/18/26.
+//
+
+#include "bench_util.h"
+
+#include "falcon/utils/thread_pool.h"
+
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <random>
+
+static const std::vector<int> BENCH_KEY_SIZES = {512, 1024, 2048, 3072};
+
+const BenchKeys &bench_keys(int key_size) {
+  static std::map<int, BenchKeys> keys;
+  static std::mutex keys_mutex;
+  std::lock_guard<std::mutex> lock(keys_mutex);
+  auto it = keys.find(key_size);
+  if (it != keys.end()) {
+    return it->second;
+  }
+  BenchKeys k;
+  k.hr = hcs_init_random();
+  k.pk = djcs_t_init_public_key();
+  djcs_t_private_key *vk = djcs_t_init_private_key();
+  djcs_t_generate_key_pair(k.pk, vk, k.hr, 1, key_size, BENCH_PARTY_NUM,
+                           BENCH_PARTY_NUM);
+  mpz_t *coeff = djcs_t_init_polynomial(vk, k.hr);
+  k.au = (djcs_t_auth_server **)malloc(BENCH_PARTY_NUM *
+                                       sizeof(djcs_t_auth_server *));
+  mpz_t si;
+  mpz_init(si);
+  for (int i = 0; i < BENCH_PARTY_NUM; i++) {
+    djcs_t_compute_polynomial(vk, coeff, si, i);
+    k.au[i] = djcs_t_init_auth_server();
+    djcs_t_set_auth_server(k.au[i], si, i);
+  }
+  mpz_clear(si);
+  djcs_t_free_polynomial(vk, coeff);
+  djcs_t_free_private_key(vk);
+  return keys.emplace(key_size, k).first->second;
+}
+
+void bench_random_plains(djcs_t_public_key *pk, EncodedNumber *plains,
+                         int size) {
+  // a fixed seed, so that the runs compared to a baseline use the same inputs
+  std::mt19937 engine(size);
+  std::uniform_real_distribution<double> dist(-100.0, 100.0);
+  for (int i = 0; i < size; i++) {
+    plains[i].set_double(pk->n[0], dist(engine), PHE_FIXED_POINT_PRECISION);
+    plains[i].setter_type(Plaintext);
+  }
+}
+
+void bench_random_ciphers(const BenchKeys &keys, EncodedNumber *ciphers,
+                          int size) {
+  bench_random_plains(keys.pk, ciphers, size);
+  for (int i = 0; i < size; i++) {
+    djcs_t_aux_encrypt(keys.pk, keys.hr, ciphers[i], ciphers[i]);
+  }
+}
+
+void bench_phe_args(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"key_size", "threads"});
+  std::vector<int> thread_nums;
+  int cpu_num = available_cpu_num();
+  for (int threads = 1; threads < cpu_num; threads *= 2) {
+    thread_nums.push_back(threads);
+  }
+  thread_nums.push_back(cpu_num);
+  for (int key_size : BENCH_KEY_SIZES) {
+    for (int threads : thread_nums) {
+      b->Args({key_size, threads});
+    }
+  }
+  // the operators run on the crypto pool, the main thread cpu time is not
+  // representative
+  b->UseRealTime();
+  b->Unit(benchmark::kMillisecond);
+}
+
+void bench_key_args(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"key_size"});
+  for (int key_size : BENCH_KEY_SIZES) {
+    b->Args({key_size});
+  }
+  b->Unit(benchmark::kMicrosecond);
+}
@@ -0,0 +1,74 @@
+//
+// Created by root on 10/18/26.
+//
+
+#ifndef FALCON_BENCH_FALCON_BENCH_UTIL_H_
+#define FALCON_BENCH_FALCON_BENCH_UTIL_H_
+
+#include "falcon/operator/phe/djcs_t_aux.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+// the number of elements of the benchmarked vectors
+#define BENCH_VECTOR_SIZE 256
+// the row and column size of the benchmarked matrices
+#define BENCH_MATRIX_SIZE 32
+// the number of parties holding a key share
+#define BENCH_PARTY_NUM 3
+
+/**
+ * The djcs_t keys of a key size, generated once per process since the key
+ * generation dominates the short benchmarks
+ */
+struct BenchKeys {
+  djcs_t_public_key *pk;
+  djcs_t_auth_server **au;
+  hcs_random *hr;
+};
+
+/**
+ * get the keys of a key size, generated on first use
+ *
+ * @param key_size: the bit length of n
+ * @return the keys, kept until the process exits
+ */
+const BenchKeys &bench_keys(int key_size);
+
+/**
+ * encode random fixed point values in [-100, 100)
+ *
+ * @param pk: public key
+ * @param plains: the encoded values
+ * @param size: the number of values
+ */
+void bench_random_plains(djcs_t_public_key *pk, EncodedNumber *plains,
+                         int size);
+
+/**
+ * encrypt random fixed point values in [-100, 100)
+ *
+ * @param keys: the keys
+ * @param ciphers: the ciphertexts
+ * @param size: the number of values
+ */
+void bench_random_ciphers(const BenchKeys &keys, EncodedNumber *ciphers,
+                          int size);
+
+/**
+ * add the key size and crypto pool thread arguments, the thread counts are
+ * the powers of two up to the available cpus
+ *
+ * @param b: the benchmark
+ */
+void bench_phe_args(benchmark::internal::Benchmark *b);
+
+/**
+ * add the key size arguments, for the single thread benchmarks
+ *
+ * @param b: the benchmark
+ */
+void bench_key_args(benchmark::internal::Benchmark *b);
+
+#endif // FALCON_BENCH_FALCON_BENCH_UTIL_H_
@@ -91,19 +91,13 @@ void retrieve_prediction_result(
  * spdz computation with thread,
  * the spdz_logistic_function_computation will do the 1/(1+e^(wx)) operation
  *
- * @param party_num: number of parties
- * @param party_id: current party id
- * @param mpc_port_bases: port bases of the spdz parties
- * @param mpc_player_path: player data path of the spdz parties
- * @param party_host_names: spdz parties host names (ips)
+ * @param spdz_session: the party's spdz session
  * @param batch_aggregation_shares: the batch shares
  * @param cur_batch_size: size of current batch
  * @param batch_loss_shares: promise structure of the loss shares
  */
 void spdz_logistic_function_computation(
-    int party_num, int party_id, std::vector<int> mpc_port_bases,
-    const std::string &mpc_player_path,
-    std::vector<std::string> party_host_names,
+    std::shared_ptr<SpdzSession> spdz_session,
     std::vector<double> batch_aggregation_shares, int cur_batch_size,
     falcon::SpdzLogRegCompType comp_type,
     std::promise<std::vector<double>> *batch_loss_shares);
@@ -9,6 +9,7 @@
 #include <falcon/algorithm/vertical/nn/layer.h>
 #include <falcon/common.h>
 #include <falcon/party/party.h>
+#include <functional>
 #include <future>
 #include <iostream>
 #include <numeric>
@@ -111,13 +112,16 @@ public:
    * @param layer_activation_shares: return the activation shares of each layer
    * @param layer_deriv_activation_shares: return the derivative activation
    * shares of each layer
+   * @param overlap: if given, called once while spdz computes the activation
+   * of the output layer, e.g., to prepare the next batch
    */
-  void forward_computation(const Party &party, int cur_batch_size,
-                           const std::vector<int> &local_weight_sizes,
-                           EncodedNumber **encoded_batch_samples,
-                           EncodedNumber **predicted_labels,
-                           TripleDVec &layer_activation_shares,
-                           TripleDVec &layer_deriv_activation_shares) const;
+  void forward_computation(
+      const Party &party, int cur_batch_size,
+      const std::vector<int> &local_weight_sizes,
+      EncodedNumber **encoded_batch_samples, EncodedNumber **predicted_labels,
+      TripleDVec &layer_activation_shares,
+      TripleDVec &layer_deriv_activation_shares,
+      const std::function<void()> &overlap = nullptr) const;
 
   /**
    * parse the resulted shares received from spdz program in forward_computation
@@ -159,10 +163,7 @@ public:
 /**
  * compute spdz function for mlp builder
  *
- * @param party_num: the number of parties
- * @param party_id: the party's id
- * @param mpc_tree_port_base: the port base to connect to mpc program
- * @param party_host_names: the ip addresses of parties
+ * @param spdz_session: the party's spdz session
  * @param public_value_size: the number of public values
  * @param public_values: the public values to be sent
  * @param private_value_size: the number of private values
@@ -170,9 +171,7 @@ public:
  * @param mlp_comp_type: the computation type
  * @param res: the result returned from mpc program
  */
-void spdz_mlp_computation(int party_num, int party_id,
-                          std::vector<int> mpc_port_bases,
-                          std::vector<std::string> party_host_names,
+void spdz_mlp_computation(std::shared_ptr<SpdzSession> spdz_session,
                           int public_value_size,
                           const std::vector<int> &public_values,
                           int private_value_size,
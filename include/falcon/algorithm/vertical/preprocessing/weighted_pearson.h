@@ -28,7 +28,7 @@
  * @param cipher_value: cipher to be converted
  * @param result: converted result
  */
-void convert_cipher_to_negative(djcs_t_public_key *phe_pub_key,
+void convert_cipher_to_negative(const djcs_t_public_key *phe_pub_key,
                                 const EncodedNumber &cipher_value,
                                 EncodedNumber &result);
 
@@ -134,10 +134,7 @@ std::vector<double> compute_wpcc(const Party &party,
  * the spdz_lime_computation will do the sqrt(dist), kernel
  * exponential, and pearson coefficient operation
  *
- * @param party_num: the participating party number
- * @param party_id: the participating party id
- * @param mpc_port_bases: the mpc ports
- * @param party_host_names: the mpc hosts
+ * @param spdz_session: the party's spdz session
  * @param public_value_size: public value size
  * @param public_values: public value known to all parties
  * @param private_value_size: private value size
@@ -146,9 +143,7 @@ std::vector<double> compute_wpcc(const Party &party,
  * @param lime_comp_type: which function in MPC is executed
  * @param res: res, in form of share
  */
-void spdz_lime_computation(int party_num, int party_id,
-                           std::vector<int> mpc_port_bases,
-                           std::vector<std::string> party_host_names,
+void spdz_lime_computation(std::shared_ptr<SpdzSession> spdz_session,
                            int public_value_size,
                            const std::vector<int> &public_values,
                            int private_value_size,
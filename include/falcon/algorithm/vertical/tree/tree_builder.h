@@ -14,6 +14,7 @@
 #include <falcon/party/party.h>
 
 #include <future>
+#include <memory>
 #include <string>
 #include <thread>
 #include <vector>
@@ -48,6 +49,33 @@ struct DecisionTreeParams {
   double dp_budget;
 };
 
+/**
+ * The encrypted statistics of the local splits of a tree node, computed by
+ * each party before they are gathered by find_best_split
+ */
+struct LocalSplitStatistics {
+  // the number of local splits
+  int split_num;
+  // the left and right branch statistics of each split, 2 * class_num each
+  EncodedNumber **statistics;
+  // the left and right branch sample numbers of each split
+  EncodedNumber *left_sample_nums;
+  EncodedNumber *right_sample_nums;
+
+  /**
+   * allocate the statistics of the local splits
+   *
+   * @param split_num: the number of local splits
+   * @param class_num: the number of classes
+   */
+  LocalSplitStatistics(int split_num, int class_num);
+
+  ~LocalSplitStatistics();
+
+  LocalSplitStatistics(const LocalSplitStatistics &) = delete;
+  LocalSplitStatistics &operator=(const LocalSplitStatistics &) = delete;
+};
+
 class DecisionTreeBuilder : public ModelBuilder {
 
 public:
@@ -201,6 +229,19 @@ public:
   bool check_pruning_conditions(Party &party, int node_index,
                                 EncodedNumber *sample_mask_iv);
 
+  /**
+   * start checking the pruning conditions of this node, the spdz part of the
+   * check runs in the background
+   * @param party: initialized party object
+   * @param node_index: the index of tree node to be check
+   * @param sample_mask_iv: the encrypted mask indicator vector
+   * @return the future of the spdz result, whose first value is 1 if the
+   *   pruning condition is satisfied
+   */
+  std::future<std::vector<double>>
+  check_pruning_conditions_async(Party &party, int node_index,
+                                 EncodedNumber *sample_mask_iv);
+
   /**
    * calculate the impurity of the root node
    * @param party: initialized party object
@@ -233,12 +274,35 @@ public:
    * @param party_split_nums: the returned vector of each party's split numbers
    * @param use_sample_weights: whether use sample weights (for LIME)
    * @param sss_sample_weights: the encrypted weights (for LIME)
+   * @param local_statistics: the local split statistics of the node if they
+   *   are computed beforehand, e.g., while the pruning check is pending,
+   *   otherwise they are computed here
    */
   std::vector<double> find_best_split(
       const Party &party, int node_index,
       std::vector<int> available_feature_ids, EncodedNumber *sample_mask_iv,
       EncodedNumber *encrypted_labels, std::vector<int> &party_split_nums,
       bool use_sample_weights = false,
+      const std::vector<double> &sss_sample_weights = std::vector<double>(),
+      LocalSplitStatistics *local_statistics = nullptr);
+
+  /**
+   * compute the encrypted statistics of the local splits of a node
+   *
+   * @param party: initialized party object
+   * @param node_index: the index of tree node to be computed
+   * @param available_feature_ids: the available features of the current node
+   * @param sample_mask_iv: the encrypted mask iv of the samples
+   * @param encrypted_labels: the encrypted labels of the training data
+   * @param use_sample_weights: whether use sample weights (for LIME)
+   * @param sss_sample_weights: the encrypted weights (for LIME)
+   * @return the local split statistics
+   */
+  std::unique_ptr<LocalSplitStatistics> compute_local_split_statistics(
+      const Party &party, int node_index,
+      const std::vector<int> &available_feature_ids,
+      EncodedNumber *sample_mask_iv, EncodedNumber *encrypted_labels,
+      bool use_sample_weights = false,
       const std::vector<double> &sss_sample_weights = std::vector<double>());
 
   /**
@@ -457,10 +521,7 @@ public:
 
 /**
  * compute spdz function for tree builder
- * @param party_num: the number of parties
- * @param party_id: the party's id
- * @param mpc_tree_port_base: the port base to connect to mpc program
- * @param party_host_names: the ip addresses of parties
+ * @param spdz_session: the party's spdz session
  * @param public_value_size: the number of public values
  * @param public_values: the public values to be sent
  * @param private_value_size: the number of private values
@@ -468,9 +529,7 @@ public:
  * @param tree_comp_type: the computation type
  * @param res: the result returned from mpc program
  */
-void spdz_tree_computation(int party_num, int party_id,
-                           std::vector<int> mpc_tree_port_bases,
-                           std::vector<std::string> party_host_names,
+void spdz_tree_computation(std::shared_ptr<SpdzSession> spdz_session,
                            int public_value_size,
                            const std::vector<int> &public_values,
                            int private_value_size,
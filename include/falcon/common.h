@@ -118,6 +118,41 @@ enum AlgorithmName {
 enum DatasetType { TRAIN, TEST, VALIDATE };
 
 #define NUM_OMP_THREADS 6
+// precomputed encryption randomness pool owned by each party
+#define PHE_RANDOM_POOL_CAPACITY 4096
+#define PHE_RANDOM_POOL_WATERMARK 1024
+#define PHE_RANDOM_POOL_THREADS 2
+// window bits of the multi-exponentiation, 0 selects it from the input sizes
+#define PHE_MULTI_EXP_WINDOW 0
+// ciphers raised to at least this many plaintexts use fixed-base tables
+#define PHE_FIXED_BASE_THRESHOLD 64
+#define PHE_FIXED_BASE_MAX_WINDOW 6
+// thread-local caches of gmp limb blocks, in power of two size classes from
+// 16 bytes to 2^PHE_GMP_ARENA_MAX_BLOCK_BITS bytes
+#define PHE_GMP_ARENA_MAX_BLOCK_BITS 16
+#define PHE_GMP_ARENA_CLASS_CAPACITY 256
+// thread-local temporaries of the phe operators
+#define PHE_SCRATCH_SIZE 6
+// multi-buffer modexp kernels, used when the cpu supports them, in groups of
+// PHE_MONT_KERNEL_LANES exponentiations, smaller groups are left to gmp
+#define PHE_MONT_KERNEL_ENABLED true
+#define PHE_MONT_KERNEL_LANES 8
+#define PHE_MONT_KERNEL_MIN_LANES 3
+#define PHE_MONT_KERNEL_MAX_WINDOW 6
+// the parallel encryptions draw randomness per chunk of this many elements,
+// so that the deterministic mode does not depend on the number of threads
+#define PHE_RANDOM_STREAM_GRAIN 16
+// large encoded number arrays are streamed in messages of this many
+// elements, with at most PHE_STREAM_QUEUE_CHUNKS of them queued for sending
+#define PHE_STREAM_CHUNK_SIZE 256
+#define PHE_STREAM_QUEUE_CHUNKS 4
+// the queued bytes per direction of a party channel before the sender or
+// the receiving thread waits
+#define PARTY_CHANNEL_MAX_PENDING_BYTES (256L << 20)
+// the topology of the reductions of ciphertext arrays among the parties:
+// star on the root, binary tree rooted at the root, or ring reduce-scatter
+// followed by all-gather
+enum ReduceTopology { STAR_TOPOLOGY, TREE_TOPOLOGY, RING_TOPOLOGY };
 #define PARALLELISM_ENABLED true
 } // namespace falcon
 
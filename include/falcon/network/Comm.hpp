@@ -129,8 +129,18 @@ public:
 	* Will block until all bytes are read.
 	*/
 	virtual size_t read(byte* buffer, int sizeToRead, int peer = -1, int protocol = -1) = 0;
+	/**
+	* Shut the connection down in both directions, so that a blocked read
+	* fails and a later write fails.
+	*/
+	virtual void shutdown() = 0;
 	virtual void write(string s) { write((const byte *)s.c_str(), s.size()); };
 	virtual void writeWithSize(const byte* data, int size);
+	/**
+	* Write @param header followed by @param data as one sized message,
+	* without copying them into one buffer.
+	*/
+	virtual void writeWithSize(const byte* header, int headerSize, const byte* data, int size);
 	virtual int readSize();
 	virtual size_t readWithSizeIntoVector(vector<byte> & targetVector);
 	virtual void writeWithSize(string s) { writeWithSize((const byte*)s.c_str(), s.size()); };
@@ -156,6 +166,9 @@ public:
 	};
 	int join(int sleepBetweenAttempts = 500, int timeout = 5000, bool first = true) override;
     size_t write(const byte* data, int size, int peer = -1, int protocol = -1) override;
+    using CommParty::writeWithSize;
+    void writeWithSize(const byte* header, int headerSize, const byte* data, int size) override;
+    void shutdown() override;
 	size_t read(byte* data, int sizeToRead, int peer = -1, int protocol = -1) override {
 	    bytesIn += sizeToRead;
 		return boost::asio::read(socketForRead(), boost::asio::buffer(data, sizeToRead));
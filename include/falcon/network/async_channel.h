@@ -0,0 +1,142 @@
+//
+// Created by root on 10/18/26.
+//
+
+#ifndef FALCON_INCLUDE_FALCON_NETWORK_ASYNC_CHANNEL_H_
+#define FALCON_INCLUDE_FALCON_NETWORK_ASYNC_CHANNEL_H_
+
+#include "falcon/network/Comm.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * The tag of a message on an AsyncChannel. The messages of a tag are
+ * delivered in their sending order, while the messages of different tags
+ * may be received in any order, so that the phases, tree nodes and
+ * mini-batches of a protocol can be interleaved on the same channel. The
+ * default tag is used by the untagged messages of Party
+ */
+struct MessageTag {
+  // the protocol phase, e.g., a training stage
+  int phase;
+  // the node id, e.g., a tree node or a layer
+  int node;
+  // the batch id, e.g., a mini-batch iteration
+  int batch;
+
+  MessageTag() : phase(-1), node(-1), batch(-1) {}
+  MessageTag(int phase, int node, int batch)
+      : phase(phase), node(node), batch(batch) {}
+
+  bool operator<(const MessageTag &other) const {
+    if (phase != other.phase) {
+      return phase < other.phase;
+    }
+    if (node != other.node) {
+      return node < other.node;
+    }
+    return batch < other.batch;
+  }
+};
+
+/**
+ * A full-duplex asynchronous channel to one peer on top of a connected
+ * blocking CommParty.
+ *
+ * A sending thread writes the queued messages in order, and a receiving
+ * thread reads the incoming messages and dispatches them by tag to the
+ * pending receives or to a mailbox, so that a party receives from a peer
+ * while it is sending to others. Each message is written as one sized
+ * frame of its tag followed by its payload. Both directions apply
+ * backpressure: send blocks while the queued messages exceed
+ * max_pending_bytes, and the receiving thread stops reading, leaving the
+ * data in the socket, while the undelivered messages exceed it and no
+ * receive is pending. The channel owns the CommParty from its construction:
+ * it must not be read or written directly anymore.
+ */
+class AsyncChannel {
+public:
+  /**
+   * start the sending and receiving threads on a connected channel
+   *
+   * @param channel: the connected channel to the peer
+   * @param max_pending_bytes: the queued bytes per direction before the
+   *   backpressure applies
+   */
+  AsyncChannel(std::shared_ptr<CommParty> channel, long max_pending_bytes);
+
+  /**
+   * flush the queued messages, then shut the connection down and join the
+   * receiving thread
+   */
+  ~AsyncChannel();
+
+  AsyncChannel(const AsyncChannel &) = delete;
+  AsyncChannel &operator=(const AsyncChannel &) = delete;
+
+  /**
+   * queue a message, blocks while the queue is full
+   *
+   * @param tag: the message tag
+   * @param message: the message payload, moved into the queue
+   * @return a future that is ready when the message is written, with an
+   *   exception if the write fails
+   */
+  std::future<void> send(const MessageTag &tag, std::string message);
+
+  /**
+   * receive the next message of a tag
+   *
+   * @param tag: the message tag
+   * @return a future of the message payload, with an exception if the
+   *   connection fails before the message arrives
+   */
+  std::future<std::string> recv(const MessageTag &tag);
+
+private:
+  struct OutMessage {
+    // the frame header, followed by the payload without a copy
+    int header[3];
+    std::string payload;
+    std::promise<void> written;
+  };
+
+  // the state shared with the threads
+  struct State {
+    std::shared_ptr<CommParty> channel;
+    long max_pending_bytes;
+    std::mutex mutex;
+    std::condition_variable send_cv;
+    std::condition_variable recv_cv;
+    std::deque<OutMessage> out_queue;
+    long out_bytes = 0;
+    bool closed = false;
+    // the messages received before their recv, and the recv waiting for
+    // their messages, by tag
+    std::map<MessageTag, std::deque<std::string>> mailbox;
+    std::map<MessageTag, std::deque<std::promise<std::string>>> waiting;
+    long mailbox_bytes = 0;
+    int waiting_num = 0;
+    // set when the connection fails
+    std::exception_ptr error;
+  };
+
+  /** the loop of the sending thread */
+  static void send_loop(std::shared_ptr<State> state);
+
+  /** the loop of the receiving thread */
+  static void recv_loop(std::shared_ptr<State> state);
+
+  std::shared_ptr<State> state;
+  std::thread sender;
+  std::thread receiver;
+};
+
+#endif // FALCON_INCLUDE_FALCON_NETWORK_ASYNC_CHANNEL_H_
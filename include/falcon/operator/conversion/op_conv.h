@@ -10,6 +10,21 @@
 #include <falcon/operator/phe/fixed_point_encoder.h>
 #include <falcon/party/party.h>
 
+/**
+ * set whether collaborative_decrypt shards the share combination with the
+ * star topology, all the parties must use the same mode. If sharded, each
+ * party combines the decryption shares of one index range and the decrypted
+ * ranges are all-gathered, instead of the request party combining all the
+ * shares, so that large decryptions (e.g., the predictions of a forest on a
+ * test set) are combined by all the parties. Not sharded by default
+ *
+ * @param sharded: whether to shard the share combination
+ */
+void sharded_decrypt_init(bool sharded);
+
+/** get whether collaborative_decrypt shards the share combination */
+bool sharded_decrypt();
+
 /**
  * parties jointly decrypt a ciphertext vector,
  * assume that the parties have already have the same src_ciphers.
@@ -26,6 +41,25 @@ void collaborative_decrypt(const Party &party, EncodedNumber *src_ciphers,
                            EncodedNumber *dest_plains, int size,
                            int req_party_id);
 
+/**
+ * parties jointly decrypt a ciphertext vector as collaborative_decrypt, but
+ * pack encoder.getter_slot_num() ciphertexts into one before decryption, so
+ * that fewer ciphertexts are partially decrypted, sent and combined. The
+ * ciphertexts must have the same exponent and values fitting the slots.
+ *
+ * @param party: the participating party
+ * @param encoder: the packed encoder of the party's public key
+ * @param src_ciphers: ciphertext vector to be decrypted
+ * @param dest_plains: decrypted plaintext vector
+ * @param size: size of the vector
+ * @param req_party_id: party that initiate decryption
+ */
+void packed_collaborative_decrypt(const Party &party,
+                                  const PackedEncoder &encoder,
+                                  EncodedNumber *src_ciphers,
+                                  EncodedNumber *dest_plains, int size,
+                                  int req_party_id);
+
 /**
  * convert 1-dimension ciphertext vector to secret shares securely, each party
  * will have a share Algorithm 1: Conversion to secretly shared value in paper
@@ -37,10 +71,14 @@ void collaborative_decrypt(const Party &party, EncodedNumber *src_ciphers,
  * @param size: size of the vector
  * @param req_party_id: party that initiate decryption
  * @param phe_precision: fixed point precision when encoding
+ * @param packing_value_bits: the bit length bound of the decoded |x|, if
+ *   positive and the ciphertexts have the same exponent, the masked values
+ *   are packed before decryption
  */
 void ciphers_to_secret_shares(const Party &party, EncodedNumber *src_ciphers,
                               std::vector<double> &secret_shares, int size,
-                              int req_party_id, int phe_precision);
+                              int req_party_id, int phe_precision,
+                              int packing_value_bits = 0);
 
 /**
  * convert 2-dimension ciphertext matrix to 2-dimensional secret shares
@@ -0,0 +1,214 @@
+//
+// Created by root on 10/18/26.
+//
+
+#ifndef FALCON_INCLUDE_FALCON_OPERATOR_MPC_SPDZ_SESSION_H_
+#define FALCON_INCLUDE_FALCON_OPERATOR_MPC_SPDZ_SESSION_H_
+
+#include <falcon/operator/mpc/spdz_connector.h>
+
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * The client connections of a party to the spdz parties, shared by all the
+ * spdz computations of the party.
+ *
+ * The ssl context is created once, and the connections are opened by the
+ * first computation, with the ssl handshakes and the gfp field setup. In a
+ * persistent session, the connections stay open and the next computations
+ * are sent on the same sockets, one after another, so that a computation
+ * costs its messages only. Otherwise, the connections are closed after each
+ * computation and reopened by the next one, for the mpc programs that
+ * accept a new client connection per computation. A SpdzComputation holds
+ * the session for one computation.
+ */
+class SpdzSession {
+public:
+  /**
+   * create a session, the connections are opened by the first computation
+   *
+   * @param party_num: number of parties for spdz computations
+   * @param party_id: current party id
+   * @param port_bases: ports of the spdz programs
+   * @param host_names: ip addresses of the spdz parties
+   * @param persistent: whether to keep the connections between computations
+   */
+  SpdzSession(int party_num, int party_id, std::vector<int> port_bases,
+              std::vector<std::string> host_names, bool persistent);
+
+  /** close the connections */
+  virtual ~SpdzSession();
+
+  SpdzSession(const SpdzSession &) = delete;
+  SpdzSession &operator=(const SpdzSession &) = delete;
+
+  /** get the number of spdz parties */
+  int getter_party_num() const { return party_num; }
+
+  /** get the current party id */
+  int getter_party_id() const { return party_id; }
+
+  /**
+   * register an asynchronous computation, so that the computations of the
+   * session run in the order they are started, as the spdz parties serve
+   * the computations of all the clients in the same order
+   *
+   * @param end: a future that is ready at the end of the computation
+   * @return the end of the previously registered computation, or an invalid
+   *   future if there is none
+   */
+  std::shared_future<void> enqueue(std::shared_future<void> end);
+
+  /**
+   * mark the last computation as failed, so that the next computation
+   * reconnects, as the messages of the failed one may be left on the
+   * sockets
+   */
+  void mark_failed();
+
+protected:
+  /** open the connections to the spdz parties and set up the gfp field */
+  virtual void connect();
+
+  /** close the connections */
+  virtual void disconnect();
+
+  /**
+   * close the connections if they are open, a derived session calls it in
+   * its destructor
+   */
+  void close();
+
+private:
+  friend class SpdzComputation;
+
+  int party_num;
+  int party_id;
+  std::vector<int> port_bases;
+  std::vector<std::string> host_names;
+  bool persistent;
+  // created with the first connections
+  std::unique_ptr<ssl_ctx> ctx;
+  ssl_service io_service;
+  std::vector<int> plain_sockets;
+  std::vector<ssl_socket *> sockets;
+  bool connected;
+  // set when a computation fails, until the next one reconnects
+  bool failed;
+  // held by the running computation
+  std::mutex mutex;
+  // the end of the last registered computation
+  std::shared_future<void> last_end;
+  std::mutex queue_mutex;
+};
+
+/**
+ * A spdz computation on a session: the session is locked and connected for
+ * the lifetime of the object, and the connections are closed at its end if
+ * the session is not persistent. If the previous computation failed, the
+ * connections are reopened first
+ */
+class SpdzComputation {
+public:
+  /**
+   * wait for the previous computations of the session and connect it
+   *
+   * @param session: the spdz session of the party
+   */
+  explicit SpdzComputation(SpdzSession &session);
+
+  /** release the session */
+  ~SpdzComputation();
+
+  SpdzComputation(const SpdzComputation &) = delete;
+  SpdzComputation &operator=(const SpdzComputation &) = delete;
+
+  /** get the ssl sockets of the spdz parties */
+  std::vector<ssl_socket *> &sockets() { return session.sockets; }
+
+private:
+  SpdzSession &session;
+  std::unique_lock<std::mutex> lock;
+};
+
+/**
+ * set whether the spdz sessions created next are persistent, should be
+ * called before the network is initialized, e.g., from the main function.
+ * The mpc programs must then serve the successive computations of a client
+ * on its connection. Not persistent by default
+ *
+ * @param persistent: whether to keep the connections between computations
+ */
+void spdz_session_persistent_init(bool persistent);
+
+/** get whether the spdz sessions created next are persistent */
+bool spdz_session_persistent();
+
+/**
+ * run a spdz computation after the previously started one, see
+ * spdz_computation_async
+ *
+ * @param previous: the end of the previously started computation
+ * @param end: set at the end of this computation
+ * @param computation: the spdz computation function
+ * @param spdz_session: the party's spdz session
+ * @param args: the arguments of the computation before its result promise
+ * @return the result of the computation
+ */
+template <class Computation, class... Args>
+std::vector<double>
+spdz_computation_run(std::shared_future<void> previous,
+                     std::shared_ptr<std::promise<void>> end,
+                     Computation computation,
+                     std::shared_ptr<SpdzSession> spdz_session, Args... args) {
+  if (previous.valid()) {
+    previous.wait();
+  }
+  // required by spdz connector and mpc computation
+  bigint::init_thread();
+  std::promise<std::vector<double>> promise_values;
+  std::future<std::vector<double>> future_values = promise_values.get_future();
+  try {
+    computation(spdz_session, args..., &promise_values);
+  } catch (...) {
+    spdz_session->mark_failed();
+    end->set_value();
+    throw;
+  }
+  end->set_value();
+  return future_values.get();
+}
+
+/**
+ * start a spdz computation in the background and return the future of its
+ * result, so that the caller does independent work, e.g., the phe
+ * computations of the next step, while the spdz parties compute. The
+ * computations of a session run one after another in the order they are
+ * started, so all the parties must start them in the same order. The
+ * future waits for the computation when it is destroyed
+ *
+ * @param computation: the spdz computation function, that takes the session,
+ *   args and a promise of the result
+ * @param spdz_session: the party's spdz session
+ * @param args: the arguments of the computation before its result promise,
+ *   copied for the background thread
+ * @return the future of the result of the computation
+ */
+template <class Computation, class... Args>
+std::future<std::vector<double>>
+spdz_computation_async(Computation computation,
+                       std::shared_ptr<SpdzSession> spdz_session,
+                       Args... args) {
+  auto end = std::make_shared<std::promise<void>>();
+  std::shared_future<void> previous =
+      spdz_session->enqueue(end->get_future().share());
+  return std::async(std::launch::async,
+                    spdz_computation_run<Computation, Args...>, previous, end,
+                    computation, spdz_session, args...);
+}
+
+#endif // FALCON_INCLUDE_FALCON_OPERATOR_MPC_SPDZ_SESSION_H_
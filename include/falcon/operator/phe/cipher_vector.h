@@ -0,0 +1,230 @@
+//
+// Created by root on 10/18/26.
+//
+
+#ifndef FALCON_INCLUDE_FALCON_OPERATOR_PHE_CIPHER_VECTOR_H_
+#define FALCON_INCLUDE_FALCON_OPERATOR_PHE_CIPHER_VECTOR_H_
+
+#include "falcon/operator/phe/fixed_point_encoder.h"
+
+#include <memory>
+#include <vector>
+
+/**
+ * The moduli shared by all the ciphertext containers of one public key:
+ * the plaintext modulus n, the ciphertext modulus n^{s+1}, and the number
+ * of limbs of a ciphertext in [0, n^{s+1}).
+ */
+struct CipherModulus {
+  /**
+   * copy the moduli of a public key
+   *
+   * @param pk: public key
+   */
+  explicit CipherModulus(const djcs_t_public_key *pk);
+
+  ~CipherModulus();
+
+  CipherModulus(const CipherModulus &) = delete;
+  CipherModulus &operator=(const CipherModulus &) = delete;
+
+  mpz_t n;
+  mpz_t cipher_modulus;
+  int limb_num;
+};
+
+/**
+ * A vector of ciphertexts of the same public key and the same exponent.
+ * Unlike EncodedNumber[], which stores n, the value, the exponent and the
+ * type per element in separately allocated mpz_t, the ciphertexts are fixed
+ * width limbs in one contiguous buffer, the moduli are shared by reference
+ * and the exponent is kept once per vector.
+ */
+class CipherVector {
+public:
+  CipherVector();
+
+  /**
+   * create a vector of size ciphertexts, all set to 0
+   *
+   * @param modulus: the shared moduli
+   * @param size: the vector size
+   * @param exponent: the exponent of the ciphertexts
+   */
+  CipherVector(std::shared_ptr<const CipherModulus> modulus, int size,
+               int exponent);
+
+  /**
+   * create a vector from an array of ciphertexts with the same exponent
+   *
+   * @param modulus: the shared moduli
+   * @param ciphers: the ciphertexts
+   * @param size: the array size
+   */
+  CipherVector(std::shared_ptr<const CipherModulus> modulus,
+               const EncodedNumber *ciphers, int size);
+
+  CipherVector(const CipherVector &) = default;
+  CipherVector &operator=(const CipherVector &) = default;
+  CipherVector(CipherVector &&other) noexcept;
+  CipherVector &operator=(CipherVector &&other) noexcept;
+
+  /**
+   * get the value of a ciphertext
+   *
+   * @param index: the element index
+   * @param value: the ciphertext value
+   */
+  void getter_value(int index, mpz_t value) const;
+
+  /**
+   * set the value of a ciphertext
+   *
+   * @param index: the element index
+   * @param value: the ciphertext value in [0, n^{s+1})
+   */
+  void setter_value(int index, const mpz_t value);
+
+  /**
+   * get a read-only view of a ciphertext, without copy. The view must not be
+   * modified or cleared, and is invalidated when the vector is changed
+   *
+   * @param index: the element index
+   * @param tmp: the mpz_t struct that holds the view
+   * @return the view as mpz_srcptr
+   */
+  mpz_srcptr view(int index, mpz_t tmp) const;
+
+  /**
+   * get a ciphertext as an encoded number
+   *
+   * @param index: the element index
+   * @param res: the encoded ciphertext
+   */
+  void getter_encoded_number(int index, EncodedNumber &res) const;
+
+  /**
+   * set a ciphertext from an encoded number of the same exponent
+   *
+   * @param index: the element index
+   * @param cipher: the encoded ciphertext
+   */
+  void setter_encoded_number(int index, const EncodedNumber &cipher);
+
+  /**
+   * convert to an array of encoded ciphertexts, for the functions that take
+   * EncodedNumber arrays
+   *
+   * @param res: the array, of at least size elements
+   */
+  void to_encoded_numbers(EncodedNumber *res) const;
+
+  /** get the vector size */
+  int getter_size() const { return size; }
+
+  /** get the exponent of the ciphertexts */
+  int getter_exponent() const { return exponent; }
+
+  /** set the exponent of the ciphertexts, the values are not changed */
+  void setter_exponent(int exp) { exponent = exp; }
+
+  /** get the shared moduli */
+  std::shared_ptr<const CipherModulus> getter_modulus() const {
+    return modulus;
+  }
+
+private:
+  std::shared_ptr<const CipherModulus> modulus;
+  int size;
+  int exponent;
+  // size * modulus->limb_num limbs, the least significant limb first
+  std::vector<mp_limb_t> limbs;
+};
+
+/**
+ * A row-major matrix of ciphertexts of the same public key and the same
+ * exponent, stored as one CipherVector, e.g., the encrypted label indicator
+ * vectors of the tree model (class_num * sample_num).
+ */
+class CipherMatrix {
+public:
+  CipherMatrix();
+
+  /**
+   * create a matrix of ciphertexts, all set to 0
+   *
+   * @param modulus: the shared moduli
+   * @param row_size: the number of rows
+   * @param column_size: the number of columns
+   * @param exponent: the exponent of the ciphertexts
+   */
+  CipherMatrix(std::shared_ptr<const CipherModulus> modulus, int row_size,
+               int column_size, int exponent);
+
+  /**
+   * create a matrix from a row-major array of ciphertexts
+   *
+   * @param modulus: the shared moduli
+   * @param ciphers: the ciphertexts, row_size * column_size elements
+   * @param row_size: the number of rows
+   * @param column_size: the number of columns
+   */
+  CipherMatrix(std::shared_ptr<const CipherModulus> modulus,
+               const EncodedNumber *ciphers, int row_size, int column_size);
+
+  CipherMatrix(const CipherMatrix &) = default;
+  CipherMatrix &operator=(const CipherMatrix &) = default;
+  CipherMatrix(CipherMatrix &&other) noexcept;
+  CipherMatrix &operator=(CipherMatrix &&other) noexcept;
+
+  /** get the value of the ciphertext at (i, j) */
+  void getter_value(int i, int j, mpz_t value) const;
+
+  /** set the value of the ciphertext at (i, j) */
+  void setter_value(int i, int j, const mpz_t value);
+
+  /** get a read-only view of the ciphertext at (i, j), see CipherVector */
+  mpz_srcptr view(int i, int j, mpz_t tmp) const;
+
+  /**
+   * copy a row into a vector
+   *
+   * @param i: the row index
+   * @param res: the row vector
+   */
+  void getter_row(int i, CipherVector &res) const;
+
+  /**
+   * set a row from a vector of the same exponent
+   *
+   * @param i: the row index
+   * @param row: the row vector of column_size elements
+   */
+  void setter_row(int i, const CipherVector &row);
+
+  /**
+   * convert to a row-major array of encoded ciphertexts
+   *
+   * @param res: the array, of at least row_size * column_size elements
+   */
+  void to_encoded_numbers(EncodedNumber *res) const;
+
+  /** get the number of rows */
+  int getter_row_size() const { return row_size; }
+
+  /** get the number of columns */
+  int getter_column_size() const { return column_size; }
+
+  /** get the exponent of the ciphertexts */
+  int getter_exponent() const { return data.getter_exponent(); }
+
+  /** get the underlying row-major vector */
+  const CipherVector &getter_data() const { return data; }
+
+private:
+  int row_size;
+  int column_size;
+  CipherVector data;
+};
+
+#endif // FALCON_INCLUDE_FALCON_OPERATOR_PHE_CIPHER_VECTOR_H_
@@ -5,7 +5,13 @@
 #ifndef FALCON_SRC_OPERATOR_PHE_DJCS_T_AUX_H_
 #define FALCON_SRC_OPERATOR_PHE_DJCS_T_AUX_H_
 
+#include "falcon/operator/phe/cipher_vector.h"
+#include "falcon/operator/phe/encrypted_weight_table.h"
 #include "falcon/operator/phe/fixed_point_encoder.h"
+#include "falcon/operator/phe/packed_encoder.h"
+#include "falcon/operator/phe/phe_key_context.h"
+#include "falcon/operator/phe/phe_random_pool.h"
+#include "falcon/operator/phe/share_combine.h"
 #include "gmp.h"    // gmp is included implicitly
 #include "libhcs.h" // master header includes everything
 #include <vector>
@@ -22,7 +28,20 @@
  * @param res: ciphertext EncodedNumber
  * @param plain: plaintext EncodedNumber
  */
-void djcs_t_aux_encrypt(djcs_t_public_key *pk, hcs_random *hr,
+void djcs_t_aux_encrypt(const djcs_t_public_key *pk, hcs_random *hr,
+                        EncodedNumber &res, const EncodedNumber &plain);
+
+/**
+ * encrypt a plaintext EncodedNumber with precomputed randomness,
+ * the online cost is g^m (a multiplication when g = n + 1) and
+ * one modular multiplication
+ *
+ * @param pk: public key
+ * @param pool: precomputed randomness pool of the same public key
+ * @param res: ciphertext EncodedNumber
+ * @param plain: plaintext EncodedNumber
+ */
+void djcs_t_aux_encrypt(const djcs_t_public_key *pk, PheRandomPool *pool,
                         EncodedNumber &res, const EncodedNumber &plain);
 
 /**
@@ -33,8 +52,8 @@ void djcs_t_aux_encrypt(djcs_t_public_key *pk, hcs_random *hr,
  * @param res: partially decrypted EncodedNumber
  * @param cipher: ciphertext EncodedNumber
  */
-void djcs_t_aux_partial_decrypt(djcs_t_public_key *pk, djcs_t_auth_server *au,
-                                EncodedNumber &res,
+void djcs_t_aux_partial_decrypt(const djcs_t_public_key *pk,
+                                djcs_t_auth_server *au, EncodedNumber &res,
                                 const EncodedNumber &cipher);
 
 /**
@@ -45,7 +64,7 @@ void djcs_t_aux_partial_decrypt(djcs_t_public_key *pk, djcs_t_auth_server *au,
  * @param shares: partially decrypted EncodedNumbers
  * @param size: size of the shares vector
  */
-void djcs_t_aux_share_combine(djcs_t_public_key *pk, EncodedNumber &res,
+void djcs_t_aux_share_combine(const djcs_t_public_key *pk, EncodedNumber &res,
                               EncodedNumber *shares, int size);
 
 /**
@@ -57,7 +76,7 @@ void djcs_t_aux_share_combine(djcs_t_public_key *pk, EncodedNumber &res,
  * @param cipher1: first ciphertext EncodedNumber
  * @param cipher2: second ciphertext EncodedNumber
  */
-void djcs_t_aux_ee_add(djcs_t_public_key *pk, EncodedNumber &res,
+void djcs_t_aux_ee_add(const djcs_t_public_key *pk, EncodedNumber &res,
                        const EncodedNumber &cipher1,
                        const EncodedNumber &cipher2);
 
@@ -69,22 +88,26 @@ void djcs_t_aux_ee_add(djcs_t_public_key *pk, EncodedNumber &res,
  * @param size: size of the vector
  * @param cipher_vector: the vector to be aggregated
  */
-void djcs_t_aux_ee_add_a_vector(djcs_t_public_key *pk, hcs_random *hr,
+void djcs_t_aux_ee_add_a_vector(const djcs_t_public_key *pk, hcs_random *hr,
                                 EncodedNumber &res, int size,
                                 EncodedNumber *cipher_vector);
 
 /**
  * homomorphic addition of two ciphers and return an EncodedNumber
  * both cipher have un-identical exponents,
- * increase one cipher's exponent to match
+ * the cipher with the lower precision is scaled to the other one on the fly,
+ * the inputs are not modified. Scaling a trivial encrypted zero (value 1)
+ * is free, so accumulators that start from it take the precision of the
+ * first term without a modexp
  *
  * @param pk: public key
  * @param res: summation ciphertext
  * @param cipher1: first ciphertext EncodedNumber
  * @param cipher2: second ciphertext EncodedNumber
  */
-void djcs_t_aux_ee_add_ext(djcs_t_public_key *pk, EncodedNumber &res,
-                           EncodedNumber cipher1, EncodedNumber cipher2);
+void djcs_t_aux_ee_add_ext(const djcs_t_public_key *pk, EncodedNumber &res,
+                           const EncodedNumber &cipher1,
+                           const EncodedNumber &cipher2);
 
 /**
  * homomorphic multiplication of a cipher and a plain
@@ -95,9 +118,39 @@ void djcs_t_aux_ee_add_ext(djcs_t_public_key *pk, EncodedNumber &res,
  * @param cipher: ciphertext EncodedNumber
  * @param plain: plaintext EncodedNumber
  */
-void djcs_t_aux_ep_mul(djcs_t_public_key *pk, EncodedNumber &res,
+void djcs_t_aux_ep_mul(const djcs_t_public_key *pk, EncodedNumber &res,
                        const EncodedNumber &cipher, const EncodedNumber &plain);
 
+/**
+ * homomorphic multiplication of a cipher and a plain, with the result
+ * brought to at least target_precision: the scaling is folded into the
+ * plaintext (c^{m * B^k}), so that no extra exponentiation is needed to
+ * align the product with the terms it is added to afterwards
+ *
+ * @param pk: public key
+ * @param res: multiplication ciphertext
+ * @param cipher: ciphertext EncodedNumber
+ * @param plain: plaintext EncodedNumber
+ * @param target_precision: the minimum precision of the product
+ */
+void djcs_t_aux_ep_mul_ext(const djcs_t_public_key *pk, EncodedNumber &res,
+                           const EncodedNumber &cipher,
+                           const EncodedNumber &plain, int target_precision);
+
+/**
+ * signed homomorphic multiplication of a cipher and a plain, the plain is
+ * mapped to (-n/2, n/2], and a negative plain inverts the cipher once and
+ * exponentiates by |plain| instead of by an integer close to n
+ *
+ * @param pk: public key
+ * @param res: multiplication ciphertext
+ * @param cipher: ciphertext EncodedNumber
+ * @param plain: plaintext EncodedNumber
+ */
+void djcs_t_aux_signed_ep_mul(const djcs_t_public_key *pk, EncodedNumber &res,
+                              const EncodedNumber &cipher,
+                              const EncodedNumber &plain);
+
 /**
  * this function increases the precision of a ciphertext,
  * target_precision should be greater tha precision(exponent) of cipher
@@ -108,7 +161,7 @@ void djcs_t_aux_ep_mul(djcs_t_public_key *pk, EncodedNumber &res,
  * @param target_precision: the precision to be reached
  * @param cipher: ciphertext EncodedNumber
  */
-void djcs_t_aux_increase_prec(djcs_t_public_key *pk, EncodedNumber &res,
+void djcs_t_aux_increase_prec(const djcs_t_public_key *pk, EncodedNumber &res,
                               int target_precision, EncodedNumber cipher);
 
 /***********************************************************/
@@ -126,7 +179,7 @@ void djcs_t_aux_increase_prec(djcs_t_public_key *pk, EncodedNumber &res,
  * @param phe_precision: the precision to be used
  */
 void djcs_t_aux_double_vec_encryption(
-    djcs_t_public_key *pk, hcs_random *hr, EncodedNumber *res, int size,
+    const djcs_t_public_key *pk, hcs_random *hr, EncodedNumber *res, int size,
     const std::vector<double> &vec,
     int phe_precision = PHE_FIXED_POINT_PRECISION);
 
@@ -141,9 +194,96 @@ void djcs_t_aux_double_vec_encryption(
  * @param phe_precision: the precision to be used
  */
 void djcs_t_aux_int_vec_encryption(
-    djcs_t_public_key *pk, hcs_random *hr, EncodedNumber *res, int size,
+    const djcs_t_public_key *pk, hcs_random *hr, EncodedNumber *res, int size,
     const std::vector<int> &vec, int phe_precision = PHE_FIXED_POINT_PRECISION);
 
+/**
+ * homomorphic subtraction of two ciphers, i.e., cipher1 * cipher2^{-1}
+ * both cipher have same exponent
+ *
+ * @param pk: public key
+ * @param res: the resulted cipher
+ * @param cipher1: the cipher to subtract from
+ * @param cipher2: the subtracted cipher
+ */
+void djcs_t_aux_ee_sub(const djcs_t_public_key *pk, EncodedNumber &res,
+                       const EncodedNumber &cipher1,
+                       const EncodedNumber &cipher2);
+
+/**
+ * partially decrypt a ciphertext vector, the exponent 2 * delta * s_i is
+ * computed once, and the elements are processed in parallel
+ *
+ * @param pk: public key
+ * @param au: the auth server (secret key share) of this party
+ * @param res: partially decrypted EncodedNumbers
+ * @param ciphers: the ciphertext vector
+ * @param size: the size of the ciphertext vector
+ */
+void djcs_t_aux_partial_decrypt_batch(const djcs_t_public_key *pk,
+                                      djcs_t_auth_server *au,
+                                      EncodedNumber *res,
+                                      EncodedNumber *ciphers, int size);
+
+/**
+ * partially decrypt a ciphertext vector with the decryption exponent and
+ * the Montgomery constants precomputed in the key context
+ *
+ * @param ctx: the phe key context of this party
+ * @param res: partially decrypted EncodedNumbers
+ * @param ciphers: the ciphertext vector
+ * @param size: the size of the ciphertext vector
+ */
+void djcs_t_aux_partial_decrypt_batch(const PheKeyContext &ctx,
+                                      EncodedNumber *res,
+                                      EncodedNumber *ciphers, int size);
+
+/**
+ * combine the partially decrypted EncodedNumbers of a ciphertext vector
+ * with the precomputed constants of the context, the elements are processed
+ * in parallel without per element allocation
+ *
+ * @param ctx: share combination constants of the key and party set
+ * @param res: decrypted EncodedNumbers
+ * @param shares: shares[i] holds the shares of the i-th ciphertext, in the
+ *  order of the party set of ctx
+ * @param size: the number of ciphertexts
+ */
+void djcs_t_aux_share_combine_batch(const ShareCombineContext &ctx,
+                                    EncodedNumber *res, EncodedNumber **shares,
+                                    int size);
+
+/**
+ * partially decrypt a ciphertext vector into shares raised to the
+ * coefficient of the party, c^{2 * delta * s_i * 2 * lambda_i}, in one
+ * exponentiation. The decryption is then the product of the weighted shares
+ * of all the parties, which are ciphertext typed so that they are
+ * multiplied by djcs_t_aux_ee_add in any order, e.g., along a reduction tree
+ *
+ * @param ctx: the phe key context of this party
+ * @param combiner: share combination constants of the key and party set
+ * @param index: the index of this party in the party set of combiner
+ * @param res: the weighted shares
+ * @param ciphers: the ciphertext vector
+ * @param size: the size of the ciphertext vector
+ */
+void djcs_t_aux_weighted_partial_decrypt_batch(
+    const PheKeyContext &ctx, const ShareCombineContext &combiner, int index,
+    EncodedNumber *res, EncodedNumber *ciphers, int size);
+
+/**
+ * decrypt the products of the weighted shares of all the parties
+ *
+ * @param ctx: share combination constants of the key and party set
+ * @param res: decrypted EncodedNumbers, can be the same as products
+ * @param products: the products of the weighted shares
+ * @param size: the number of ciphertexts
+ */
+void djcs_t_aux_weighted_share_combine_batch(const ShareCombineContext &ctx,
+                                             EncodedNumber *res,
+                                             EncodedNumber *products,
+                                             int size);
+
 /**
  * homomorphic aggregate a cipher vector and return the result
  *
@@ -152,7 +292,7 @@ void djcs_t_aux_int_vec_encryption(
  * @param ciphers: a vector of ciphertext EncodedNumber
  * @param size: the size of the ciphers vector
  */
-void djcs_t_aux_vec_aggregate(djcs_t_public_key *pk, EncodedNumber &res,
+void djcs_t_aux_vec_aggregate(const djcs_t_public_key *pk, EncodedNumber &res,
                               EncodedNumber *ciphers, int size);
 
 /**
@@ -165,8 +305,8 @@ void djcs_t_aux_vec_aggregate(djcs_t_public_key *pk, EncodedNumber &res,
  * @param ciphers2: the cipher vector 2
  * @param size: the size of the two cipher vectors
  */
-void djcs_t_aux_vec_ele_wise_ee_add(djcs_t_public_key *pk, EncodedNumber *res,
-                                    EncodedNumber *ciphers1,
+void djcs_t_aux_vec_ele_wise_ee_add(const djcs_t_public_key *pk,
+                                    EncodedNumber *res, EncodedNumber *ciphers1,
                                     EncodedNumber *ciphers2, int size);
 
 /**
@@ -180,14 +320,69 @@ void djcs_t_aux_vec_ele_wise_ee_add(djcs_t_public_key *pk, EncodedNumber *res,
  * @param ciphers2: the cipher vector 2
  * @param size: the size of the two cipher vectors
  */
-void djcs_t_aux_vec_ele_wise_ee_add_ext(djcs_t_public_key *pk,
+void djcs_t_aux_vec_ele_wise_ee_add_ext(const djcs_t_public_key *pk,
                                         EncodedNumber *res,
                                         EncodedNumber *ciphers1,
                                         EncodedNumber *ciphers2, int size);
 
+/**
+ * element-wise homomorphic ciphertext subtraction
+ * both cipher have same exponent
+ *
+ * @param pk: public key
+ * @param res: the resulted cipher vector
+ * @param ciphers1: the cipher vector to subtract from
+ * @param ciphers2: the subtracted cipher vector
+ * @param size: the size of the two cipher vectors
+ */
+void djcs_t_aux_vec_ele_wise_ee_sub(const djcs_t_public_key *pk,
+                                    EncodedNumber *res, EncodedNumber *ciphers1,
+                                    EncodedNumber *ciphers2, int size);
+
+/**
+ * masked select of a cipher vector by a 0/1 bit vector, replaces the
+ * element-wise multiplication with plaintext 0 or 1:
+ * on 1 the cipher is copied (re-randomized if required), on 0 an encrypted
+ * zero with the same exponent is emitted (fresh if re-randomized, otherwise
+ * the trivial ciphertext 1). res can be the same array as ciphers
+ *
+ * @param pk: public key
+ * @param pool: randomness pool, only used when rerandomize is true
+ * @param res: the selected cipher vector
+ * @param ciphers: the cipher vector
+ * @param bits: the 0/1 bit vector
+ * @param size: vector size
+ * @param rerandomize: whether the output is re-randomized
+ */
+void djcs_t_aux_masked_select(const djcs_t_public_key *pk, PheRandomPool *pool,
+                              EncodedNumber *res, EncodedNumber *ciphers,
+                              const std::vector<int> &bits, int size,
+                              bool rerandomize = true);
+
+/**
+ * re-randomize a cipher vector by multiplying each cipher with a fresh
+ * encryption of zero from the pool. The homomorphic products below start
+ * from the trivial encryption of zero, so their results must be
+ * re-randomized before they are sent to another party, otherwise the
+ * receiver can test guesses of the plaintext operand.
+ * res can be the same array as ciphers
+ *
+ * @param pk: public key
+ * @param pool: randomness pool
+ * @param res: the re-randomized cipher vector
+ * @param ciphers: the cipher vector
+ * @param size: vector size
+ */
+void djcs_t_aux_vec_rerandomize(const djcs_t_public_key *pk,
+                                PheRandomPool *pool, EncodedNumber *res,
+                                EncodedNumber *ciphers, int size);
+
 /**
  * homomorphic inner product of a cipher vector and a plain vector, return an
  * EncodedNumber e,g. {a1, a2, a3 } * {[b1], [b2], [b3]} = [a1b1+a2b3+a3b3]
+ * it is computed by djcs_t_aux_signed_inner_product (multi-exponentiation)
+ * the result is not re-randomized, it only carries the randomness of ciphers,
+ * see djcs_t_aux_vec_rerandomize
  *
  * @param pk: public key
  * @param hr: random variable
@@ -196,7 +391,7 @@ void djcs_t_aux_vec_ele_wise_ee_add_ext(djcs_t_public_key *pk,
  * @param plains: a vector of plaintext EncodedNumber
  * @param size: vector size
  */
-void djcs_t_aux_inner_product(djcs_t_public_key *pk, hcs_random *hr,
+void djcs_t_aux_inner_product(const djcs_t_public_key *pk, hcs_random *hr,
                               EncodedNumber &res, EncodedNumber *ciphers,
                               EncodedNumber *plains, int size);
 
@@ -211,10 +406,41 @@ void djcs_t_aux_inner_product(djcs_t_public_key *pk, hcs_random *hr,
  * @param plains: a vector of plaintext EncodedNumber
  * @param size: vector size
  */
-void djcs_t_aux_vec_ele_wise_ep_mul(djcs_t_public_key *pk, EncodedNumber *res,
-                                    EncodedNumber *ciphers,
+void djcs_t_aux_vec_ele_wise_ep_mul(const djcs_t_public_key *pk,
+                                    EncodedNumber *res, EncodedNumber *ciphers,
                                     EncodedNumber *plains, int size);
 
+/**
+ * element-wise signed ciphertext plaintext multiplication,
+ * see djcs_t_aux_signed_ep_mul
+ *
+ * @param pk: public key
+ * @param res: resulted ciphertext vector
+ * @param ciphers: a vector of ciphertext EncodedNumber
+ * @param plains: a vector of plaintext EncodedNumber
+ * @param size: vector size
+ */
+void djcs_t_aux_vec_ele_wise_signed_ep_mul(const djcs_t_public_key *pk,
+                                           EncodedNumber *res,
+                                           EncodedNumber *ciphers,
+                                           EncodedNumber *plains, int size);
+
+/**
+ * signed homomorphic inner product of a cipher vector and a plain vector,
+ * the positive and the negative terms are each computed by one
+ * multi-exponentiation (see multi_exp.h), and the negative product is
+ * inverted once, so each term only exponentiates by |plain|
+ *
+ * @param pk: public key
+ * @param res: inner product ciphertext EncodedNumber
+ * @param ciphers: a vector of ciphertext EncodedNumber
+ * @param plains: a vector of plaintext EncodedNumber
+ * @param size: vector size
+ */
+void djcs_t_aux_signed_inner_product(const djcs_t_public_key *pk,
+                                     EncodedNumber &res, EncodedNumber *ciphers,
+                                     EncodedNumber *plains, int size);
+
 /**
  * this function increases the precision of each element of a ciphertext vector,
  * for computing homomorphic addition when the precision does not match
@@ -225,19 +451,20 @@ void djcs_t_aux_vec_ele_wise_ep_mul(djcs_t_public_key *pk, EncodedNumber *res,
  * @param ciphers: the ciphertext vector
  * @param size: the size of the ciphertext vector
  */
-void djcs_t_aux_increase_prec_vec(djcs_t_public_key *pk, EncodedNumber *res,
-                                  int target_precision, EncodedNumber *ciphers,
-                                  int size);
+void djcs_t_aux_increase_prec_vec(const djcs_t_public_key *pk,
+                                  EncodedNumber *res, int target_precision,
+                                  EncodedNumber *ciphers, int size);
 
 /***********************************************************/
 /***************** matrix related operations ***************/
 /***********************************************************/
 
 /**
- * encrypt a double matrix based on pk and phe precision
+ * encrypt a double matrix based on pk and phe precision, the rows are
+ * encrypted in parallel with the per-thread random streams
  *
  * @param pk: public key
- * @param hr: djcs_t random
+ * @param hr: djcs_t random, not used, see phe_random_stream
  * @param res: resulted ciphertext matrix
  * @param row_size: the row size of the matrix
  * @param column_size: the column size of the matrix
@@ -245,8 +472,8 @@ void djcs_t_aux_increase_prec_vec(djcs_t_public_key *pk, EncodedNumber *res,
  * @param phe_precision: the precision to be used
  */
 void djcs_t_aux_double_mat_encryption(
-    djcs_t_public_key *pk, hcs_random *hr, EncodedNumber **res, int row_size,
-    int column_size, const std::vector<std::vector<double>> &mat,
+    const djcs_t_public_key *pk, hcs_random *hr, EncodedNumber **res,
+    int row_size, int column_size, const std::vector<std::vector<double>> &mat,
     int phe_precision = PHE_FIXED_POINT_PRECISION);
 
 /**
@@ -259,7 +486,7 @@ void djcs_t_aux_double_mat_encryption(
  * @param row_size: the number of rows in the matrix
  * @param column_size: the number of columns in the matrix
  */
-void djcs_t_aux_matrix_ele_wise_ee_add(djcs_t_public_key *pk,
+void djcs_t_aux_matrix_ele_wise_ee_add(const djcs_t_public_key *pk,
                                        EncodedNumber **res,
                                        EncodedNumber **cipher_mat1,
                                        EncodedNumber **cipher_mat2,
@@ -277,7 +504,7 @@ void djcs_t_aux_matrix_ele_wise_ee_add(djcs_t_public_key *pk,
  * @param row_size: the number of rows in the matrix
  * @param column_size: the number of columns in the matrix
  */
-void djcs_t_aux_matrix_ele_wise_ee_add_ext(djcs_t_public_key *pk,
+void djcs_t_aux_matrix_ele_wise_ee_add_ext(const djcs_t_public_key *pk,
                                            EncodedNumber **res,
                                            EncodedNumber **cipher_mat1,
                                            EncodedNumber **cipher_mat2,
@@ -286,6 +513,9 @@ void djcs_t_aux_matrix_ele_wise_ee_add_ext(djcs_t_public_key *pk,
 /**
  * MatMul: homomorphic multiplication between a cipher vector and a plain
  * matrix, the result is a cipher vector size of cipher == column size of plain
+ * when row_size >= PHE_FIXED_BASE_THRESHOLD, the ciphers are exponentiated
+ * by fixed-base tables (see EncryptedWeightTable)
+ * the results are not re-randomized, see djcs_t_aux_vec_rerandomize
  * @param pk: public key
  * @param hr: random variable
  * @param res: multiplication results with row_size [ae1+be2, ce1+de2]
@@ -294,15 +524,51 @@ void djcs_t_aux_matrix_ele_wise_ee_add_ext(djcs_t_public_key *pk,
  * @param row_size: number of plaintext rows
  * @param column_size: number of plaintext columns, equal to cipher size
  */
-void djcs_t_aux_vec_mat_ep_mult(djcs_t_public_key *pk, hcs_random *hr,
+void djcs_t_aux_vec_mat_ep_mult(const djcs_t_public_key *pk, hcs_random *hr,
                                 EncodedNumber *res, EncodedNumber *ciphers,
                                 EncodedNumber **plains, int row_size,
                                 int column_size);
 
+/**
+ * MatMul with the fixed-base tables of the cipher vector, which can be
+ * built once and reused by several plain matrices
+ *
+ * @param pk: public key
+ * @param table: the fixed-base tables of the cipher vector
+ * @param res: multiplication results with row_size
+ * @param plains: plain matrix
+ * @param row_size: number of plaintext rows
+ * @param column_size: number of plaintext columns, equal to table size
+ */
+void djcs_t_aux_vec_mat_ep_mult(const djcs_t_public_key *pk,
+                                const EncryptedWeightTable &table,
+                                EncodedNumber *res, EncodedNumber **plains,
+                                int row_size, int column_size);
+
+/**
+ * signed version of djcs_t_aux_vec_mat_ep_mult, each row is computed by
+ * djcs_t_aux_signed_inner_product
+ *
+ * @param pk: public key
+ * @param res: multiplication results with row_size
+ * @param ciphers: cipher vector
+ * @param plains: plain matrix
+ * @param row_size: number of plaintext rows
+ * @param column_size: number of plaintext columns, equal to cipher size
+ */
+void djcs_t_aux_vec_mat_signed_ep_mult(const djcs_t_public_key *pk,
+                                       EncodedNumber *res,
+                                       EncodedNumber *ciphers,
+                                       EncodedNumber **plains, int row_size,
+                                       int column_size);
+
 /**
  * the homomorphic multiplication between a plaintext matrix and a ciphertext
  * matrix, the result is a cipher matrix need to ensure plain_column_size =
  * cipher_row_size e,g. plainText (M*N) * cipherText (N*K) = Res (M*K)
+ * when M >= PHE_FIXED_BASE_THRESHOLD, the cipher columns are exponentiated
+ * by fixed-base tables (see EncryptedWeightTable)
+ * the results are not re-randomized, see djcs_t_aux_vec_rerandomize
  *
  * @param pk: public key
  * @param hr: random variable
@@ -314,7 +580,7 @@ void djcs_t_aux_vec_mat_ep_mult(djcs_t_public_key *pk, hcs_random *hr,
  * @param plain_row_size: the number of rows of plaintext matrix
  * @param plain_column_size: the number of columns of plaintext matrix
  */
-void djcs_t_aux_mat_mat_ep_mult(djcs_t_public_key *pk, hcs_random *hr,
+void djcs_t_aux_mat_mat_ep_mult(const djcs_t_public_key *pk, hcs_random *hr,
                                 EncodedNumber **res, EncodedNumber **cipher_mat,
                                 EncodedNumber **plain_mat, int cipher_row_size,
                                 int cipher_column_size, int plain_row_size,
@@ -333,10 +599,14 @@ void djcs_t_aux_mat_mat_ep_mult(djcs_t_public_key *pk, hcs_random *hr,
  * @param plain_row_size: the number of rows of plaintext matrix
  * @param plain_column_size: the number of columns of plaintext matrix
  */
-void djcs_t_aux_ele_wise_mat_mat_ep_mult(
-    djcs_t_public_key *pk, EncodedNumber **res, EncodedNumber **cipher_mat,
-    EncodedNumber **plain_mat, int cipher_row_size, int cipher_column_size,
-    int plain_row_size, int plain_column_size);
+void djcs_t_aux_ele_wise_mat_mat_ep_mult(const djcs_t_public_key *pk,
+                                         EncodedNumber **res,
+                                         EncodedNumber **cipher_mat,
+                                         EncodedNumber **plain_mat,
+                                         int cipher_row_size,
+                                         int cipher_column_size,
+                                         int plain_row_size,
+                                         int plain_column_size);
 
 /**
  * this function increases the precision of a ciphertext matrix,
@@ -349,18 +619,88 @@ void djcs_t_aux_ele_wise_mat_mat_ep_mult(
  * @param row_size: the number of rows in the matrix
  * @param column_size: the number of columns in the matrix
  */
-void djcs_t_aux_increase_prec_mat(djcs_t_public_key *pk, EncodedNumber **res,
-                                  int target_precision,
+void djcs_t_aux_increase_prec_mat(const djcs_t_public_key *pk,
+                                  EncodedNumber **res, int target_precision,
                                   EncodedNumber **cipher_mat, int row_size,
                                   int column_size);
 
+/**
+ * element-wise homomorphic addition of two cipher vectors with the same
+ * exponent, res can be the same vector as ciphers1 or ciphers2
+ *
+ * @param pk: public key
+ * @param res: the summation cipher vector
+ * @param ciphers1: the first cipher vector
+ * @param ciphers2: the second cipher vector
+ */
+void djcs_t_aux_vec_ele_wise_ee_add(const djcs_t_public_key *pk,
+                                    CipherVector &res,
+                                    const CipherVector &ciphers1,
+                                    const CipherVector &ciphers2);
+
+/**
+ * homomorphic aggregate a cipher vector
+ *
+ * @param pk: public key
+ * @param res: aggregated ciphertext
+ * @param ciphers: the cipher vector
+ */
+void djcs_t_aux_vec_aggregate(const djcs_t_public_key *pk, EncodedNumber &res,
+                              const CipherVector &ciphers);
+
+/**
+ * homomorphic inner product of a cipher vector and a signed plain vector,
+ * see djcs_t_aux_signed_inner_product
+ *
+ * @param pk: public key
+ * @param res: inner product ciphertext EncodedNumber
+ * @param ciphers: the cipher vector
+ * @param plains: a vector of plaintext EncodedNumber, of the cipher vector size
+ */
+void djcs_t_aux_signed_inner_product(const djcs_t_public_key *pk,
+                                     EncodedNumber &res,
+                                     const CipherVector &ciphers,
+                                     EncodedNumber *plains);
+
+/**
+ * masked select of a cipher vector by a 0/1 bit vector, see the
+ * EncodedNumber version. res can be the same vector as ciphers
+ *
+ * @param pk: public key
+ * @param pool: randomness pool, only used when rerandomize is true
+ * @param res: the selected cipher vector
+ * @param ciphers: the cipher vector
+ * @param bits: the 0/1 bit vector
+ * @param rerandomize: whether the output is re-randomized
+ */
+void djcs_t_aux_masked_select(const djcs_t_public_key *pk, PheRandomPool *pool,
+                              CipherVector &res, const CipherVector &ciphers,
+                              const std::vector<int> &bits,
+                              bool rerandomize = true);
+
+/**
+ * pack ciphertexts of the same exponent homomorphically, slot_num ciphertexts
+ * per packed ciphertext, so that the parties holding the same ciphertexts
+ * obtain the same packed ones without decryption, see PackedEncoder
+ *
+ * @param pk: public key
+ * @param encoder: the packed encoder of the public key
+ * @param res: the packed ciphertexts, of encoder.packed_size(size) elements
+ * @param ciphers: the ciphertexts, with values fitting the slots
+ * @param size: the number of ciphertexts
+ */
+void djcs_t_aux_pack_ciphers(const djcs_t_public_key *pk,
+                             const PackedEncoder &encoder, EncodedNumber *res,
+                             const EncodedNumber *ciphers, int size);
+
 /**
  * copy a djcs_t public key from src to dest
  *
  * @param src: src public key object
  * @param dest: dest public key object
  */
-void djcs_t_public_key_copy(djcs_t_public_key *src, djcs_t_public_key *dest);
+void djcs_t_public_key_copy(const djcs_t_public_key *src,
+                            djcs_t_public_key *dest);
 
 /**
  * copy a djcs_t authenticate server from src to dest
@@ -368,7 +708,8 @@ void djcs_t_public_key_copy(djcs_t_public_key *src, djcs_t_public_key *dest);
  * @param src: src auth server object
  * @param dest: dest auth server object
  */
-void djcs_t_auth_server_copy(djcs_t_auth_server *src, djcs_t_auth_server *dest);
+void djcs_t_auth_server_copy(const djcs_t_auth_server *src,
+                             djcs_t_auth_server *dest);
 
 /**
  * copy a hcs_random from src to dest
@@ -0,0 +1,83 @@
+//
+// Created by root on 10/18/26.
+//
+
+#ifndef FALCON_INCLUDE_FALCON_OPERATOR_PHE_ENCRYPTED_WEIGHT_TABLE_H_
+#define FALCON_INCLUDE_FALCON_OPERATOR_PHE_ENCRYPTED_WEIGHT_TABLE_H_
+
+#include "falcon/common.h"
+#include "falcon/operator/phe/fixed_point_encoder.h"
+#include "gmp.h"
+#include "libhcs.h"
+
+/**
+ * Fixed-base windowed tables of a cipher vector (e.g., the encrypted
+ * weights of a model), for ciphers that are raised to many different
+ * plaintexts. For cipher c, window bits w and window k, the table stores
+ * c^{d * 2^{w * k}} for d in [1, 2^w), so that c^m is the product of one
+ * table entry per non-zero w-bit digit of m, without any squaring.
+ *
+ * The table is built once (e.g., per training iteration) and reused by all
+ * the rows of a plaintext matrix, see djcs_t_aux_vec_mat_ep_mult.
+ */
+class EncryptedWeightTable {
+public:
+  /**
+   * build the tables of a cipher vector
+   *
+   * @param pk: public key
+   * @param ciphers: the cipher vector, with the same exponent
+   * @param size: the size of the cipher vector
+   * @param max_bits: bit length of the largest exponent to be supported
+   * @param uses: the number of exponentiations of each cipher, to choose
+   *  the window, which is at most PHE_FIXED_BASE_MAX_WINDOW
+   */
+  EncryptedWeightTable(const djcs_t_public_key *pk, EncodedNumber *ciphers,
+                       int size, int max_bits, int uses);
+
+  ~EncryptedWeightTable();
+
+  EncryptedWeightTable(const EncryptedWeightTable &) = delete;
+  EncryptedWeightTable &operator=(const EncryptedWeightTable &) = delete;
+
+  /**
+   * multiply acc by ciphers[index]^e mod n^{s+1}, falls back to a modexp
+   * if e is longer than max_bits
+   *
+   * @param acc: the accumulator
+   * @param index: the cipher index
+   * @param e: the non-negative exponent
+   */
+  void mul_pow(mpz_t acc, int index, const mpz_t e) const;
+
+  /** get the number of ciphers */
+  int getter_size() const { return size; }
+
+  /** get the exponent of the ciphers */
+  int getter_exponent() const { return exponent; }
+
+  /** get the public key n of the ciphers */
+  void getter_n(mpz_t g_n) const;
+
+  /** get the largest supported exponent bit length */
+  int getter_max_bits() const { return max_bits; }
+
+  /** get the window bits */
+  int getter_window() const { return window; }
+
+private:
+  int size;
+  int max_bits;
+  int window;
+  int window_num;
+  int exponent;
+  // public key n, and the cipher modulus n^{s+1}
+  mpz_t n;
+  mpz_t modulus;
+  // the ciphers, for the fallback modexp
+  mpz_t *bases;
+  // tables[i][k * (2^w - 1) + d - 1] = ciphers[i]^{d * 2^{w * k}}
+  mpz_t **tables;
+};
+
+#endif // FALCON_INCLUDE_FALCON_OPERATOR_PHE_ENCRYPTED_WEIGHT_TABLE_H_
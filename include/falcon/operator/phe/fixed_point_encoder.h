@@ -59,6 +59,19 @@ public:
    */
   EncodedNumber &operator=(const EncodedNumber &number);
 
+  /**
+   * move constructor, takes the limbs of number without allocation
+   * @param number
+   */
+  EncodedNumber(EncodedNumber &&number) noexcept;
+
+  /**
+   * move assignment constructor, swaps the limbs with number
+   * @param number
+   * @return
+   */
+  EncodedNumber &operator=(EncodedNumber &&number) noexcept;
+
   /**
    * destructor
    */
@@ -141,10 +154,10 @@ public:
   void compute_decode_threshold(mpz_t max_int);
 
   /** set EncodedNumber max value n */
-  void setter_n(mpz_t s_n);
+  void setter_n(const mpz_t s_n);
 
   /** set EncodedNumber value*/
-  void setter_value(mpz_t s_value);
+  void setter_value(const mpz_t s_value);
 
   /** set EncodedNumber exponent */
   void setter_exponent(int s_exponent);
@@ -155,6 +168,9 @@ public:
   /** get EncodedNumber max value */
   void getter_n(mpz_t g_n) const;
 
+  /** check whether number has the same n, without copying n */
+  bool same_n(const EncodedNumber &number) const;
+
   /** get EncodedNumber value */
   void getter_value(mpz_t g_value) const;
 
@@ -0,0 +1,47 @@
+//
+// Created by root on 10/18/26.
+//
+
+#ifndef FALCON_INCLUDE_FALCON_OPERATOR_PHE_GMP_ARENA_H_
+#define FALCON_INCLUDE_FALCON_OPERATOR_PHE_GMP_ARENA_H_
+
+#include "falcon/common.h"
+#include "gmp.h"
+
+/**
+ * install the gmp memory functions backed by thread-local arenas: the limb
+ * blocks freed by a thread are kept in its arena, by power of two size
+ * class, and handed out again to the next allocations of that thread, so
+ * that the mpz_init/mpz_clear of temporaries and the EncodedNumber copies
+ * do not go to malloc/free. The blocks are plain malloc blocks, so that the
+ * ones allocated before the installation can be freed by the arenas as well.
+ * It should be called once at the start of the program, before any thread
+ * is spawned
+ */
+void gmp_arena_install();
+
+/**
+ * reset the arenas of all the threads at the end of an iteration: each
+ * thread returns its cached blocks to the system on its next allocation,
+ * so that the memory of one iteration is not held in the next one
+ */
+void gmp_arena_reset();
+
+/**
+ * get the number of bytes cached in the arena of the calling thread
+ *
+ * @return the cached bytes
+ */
+long gmp_arena_cached_bytes();
+
+/**
+ * get a thread-local scratch mpz_t of the phe operators, initialized once
+ * per thread. Only the leaf operators that do not call other operators
+ * between two uses of a scratch may use them
+ *
+ * @param index: the scratch index in [0, PHE_SCRATCH_SIZE)
+ * @return the scratch
+ */
+mpz_ptr phe_scratch(int index);
+
+#endif // FALCON_INCLUDE_FALCON_OPERATOR_PHE_GMP_ARENA_H_
@@ -0,0 +1,112 @@
+//
+// Created by root on 10/18/26.
+//
+
+#ifndef FALCON_INCLUDE_FALCON_OPERATOR_PHE_MONT_KERNEL_H_
+#define FALCON_INCLUDE_FALCON_OPERATOR_PHE_MONT_KERNEL_H_
+
+#include "falcon/common.h"
+#include "gmp.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Multi-buffer modular exponentiation for the ciphertext modulus n^{s+1}.
+ *
+ * The kernels keep PHE_MONT_KERNEL_LANES independent exponentiations in the
+ * lanes of AVX-512 registers, in radix 2^52 Montgomery form, and multiply
+ * them with the IFMA instructions. They are specialized on the number of
+ * 52-bit digits of the modulus, one for each supported PHE_KEY_SIZE (n^2 of
+ * 1024, 2048 and 4096 bits), so that the loops have fixed trip counts. The
+ * cpu is checked at runtime, and gmp's mpz_powm is used when the kernels are
+ * not supported, for other moduli, and for negative exponents.
+ */
+
+/**
+ * check whether the running cpu has a kernel for the modulus size
+ *
+ * @param modulus_bits: the bit length of the modulus
+ * @return true if mont_powm_batch uses the multi-buffer kernel
+ */
+bool mont_kernel_available(int modulus_bits);
+
+/**
+ * The constants of a modulus for the kernels: its 52-bit digits,
+ * -m^{-1} mod 2^52 and the Montgomery form of one in every lane. They can
+ * be computed once per key, see PheKeyContext
+ */
+struct MontModulus {
+  /**
+   * precompute the constants of a modulus
+   *
+   * @param modulus: the odd modulus
+   */
+  explicit MontModulus(const mpz_t modulus);
+
+  ~MontModulus();
+
+  MontModulus(const MontModulus &) = delete;
+  MontModulus &operator=(const MontModulus &) = delete;
+
+  mpz_t modulus;
+  // the digits of the kernel, 0 when gmp is used
+  int digit_num;
+  std::vector<uint64_t> m;
+  uint64_t k0;
+  std::vector<uint64_t> one;
+};
+
+/**
+ * compute rops[i] = bases[i]^{exponents[i]} mod modulus for each i, with
+ * PHE_MONT_KERNEL_LANES exponentiations at once. rops can be the same array
+ * as bases
+ *
+ * @param rops: the results
+ * @param bases: the bases
+ * @param exponents: the exponents
+ * @param size: number of exponentiations
+ * @param modulus: the odd modulus
+ */
+void mont_powm_batch(mpz_t *rops, mpz_t *bases, mpz_t *exponents, int size,
+                     const mpz_t modulus);
+
+/**
+ * compute rops[i] = bases[i]^{exponent} mod modulus for each i, e.g., the
+ * partial decryption c^{2 * delta * s_i} of a cipher vector
+ *
+ * @param rops: the results
+ * @param bases: the bases
+ * @param exponent: the exponent shared by the bases
+ * @param size: number of exponentiations
+ * @param modulus: the odd modulus
+ */
+void mont_powm_batch_fixed_exp(mpz_t *rops, mpz_t *bases,
+                               const mpz_t exponent, int size,
+                               const mpz_t modulus);
+
+/**
+ * mont_powm_batch with the precomputed constants of the modulus
+ *
+ * @param ctx: the constants of the modulus
+ * @param rops: the results
+ * @param bases: the bases
+ * @param exponents: the exponents
+ * @param size: number of exponentiations
+ */
+void mont_powm_batch(const MontModulus &ctx, mpz_t *rops, mpz_t *bases,
+                     mpz_t *exponents, int size);
+
+/**
+ * mont_powm_batch_fixed_exp with the precomputed constants of the modulus
+ *
+ * @param ctx: the constants of the modulus
+ * @param rops: the results
+ * @param bases: the bases
+ * @param exponent: the exponent shared by the bases
+ * @param size: number of exponentiations
+ */
+void mont_powm_batch_fixed_exp(const MontModulus &ctx, mpz_t *rops,
+                               mpz_t *bases, const mpz_t exponent, int size);
+
+#endif // FALCON_INCLUDE_FALCON_OPERATOR_PHE_MONT_KERNEL_H_
@@ -0,0 +1,48 @@
+//
+// Created by root on 10/18/26.
+//
+
+#ifndef FALCON_INCLUDE_FALCON_OPERATOR_PHE_MULTI_EXP_H_
+#define FALCON_INCLUDE_FALCON_OPERATOR_PHE_MULTI_EXP_H_
+
+#include "falcon/common.h"
+#include "gmp.h"
+
+/**
+ * choose the window bits of the bucket multi-exponentiation that minimize
+ * (max_bits / w) * (size + 2^{w+1}) modular multiplications
+ *
+ * @param size: number of bases
+ * @param max_bits: bit length of the largest exponent
+ * @return the window bits
+ */
+int multi_exp_window(int size, int max_bits);
+
+/**
+ * read the w-bit digit of an exponent starting at a bit position
+ *
+ * @param exponent: the exponent
+ * @param pos: the lowest bit of the digit
+ * @param w: digit bits
+ * @return the digit
+ */
+unsigned long multi_exp_digit(const mpz_t exponent, int pos, int w);
+
+/**
+ * simultaneous multi-exponentiation prod_i bases[i]^{exponents[i]} mod
+ * modulus, by the Pippenger bucket method: the exponents are cut into
+ * windows of w bits, and for each window the bases are multiplied into the
+ * bucket of their digit, so each base costs one multiplication per window
+ * instead of a full modular exponentiation
+ *
+ * @param rop: the result
+ * @param bases: the bases
+ * @param exponents: the exponents, should be non-negative
+ * @param size: number of bases
+ * @param modulus: the modulus
+ * @param window: window bits, 0 selects it by multi_exp_window
+ */
+void multi_exp(mpz_t rop, mpz_t *bases, mpz_t *exponents, int size,
+               const mpz_t modulus, int window = PHE_MULTI_EXP_WINDOW);
+
+#endif // FALCON_INCLUDE_FALCON_OPERATOR_PHE_MULTI_EXP_H_
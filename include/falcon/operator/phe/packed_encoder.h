@@ -0,0 +1,74 @@
+//
+// Created by root on 10/18/26.
+//
+
+#ifndef FALCON_INCLUDE_FALCON_OPERATOR_PHE_PACKED_ENCODER_H_
+#define FALCON_INCLUDE_FALCON_OPERATOR_PHE_PACKED_ENCODER_H_
+
+#include "falcon/operator/phe/fixed_point_encoder.h"
+
+/**
+ * Packs several fixed point values of the same exponent into one plaintext,
+ * so that one ciphertext, one partial decryption and one share combination
+ * serve slot_num values. The i-th value v_i is placed in the slot of
+ * slot_bits = value_bits + guard_bits + 1 bits at offset i * slot_bits,
+ * i.e., the packed plaintext is sum_i v_i * 2^{i * slot_bits} (mod n).
+ *
+ * Slots are signed and are unpacked from the lowest one, so a negative slot
+ * borrows from the next one and is repaid when unpacking. On the packed
+ * ciphertexts, djcs_t_aux_ee_add adds the slots element-wise and
+ * djcs_t_aux_ep_mul multiplies all the slots by the same scalar. The guard
+ * bits absorb the growth: after adding up to 2^{guard_bits} packed values, or
+ * multiplying by a scalar of at most guard_bits bits, each slot still fits.
+ */
+class PackedEncoder {
+public:
+  /**
+   * create an encoder for the plaintext modulus n
+   *
+   * @param n: the plaintext modulus of the public key
+   * @param value_bits: the bit length bound of |v| of the encoded values
+   * @param guard_bits: the bits reserved for the growth by homomorphic ops
+   */
+  PackedEncoder(const mpz_t n, int value_bits, int guard_bits);
+
+  ~PackedEncoder();
+
+  PackedEncoder(const PackedEncoder &) = delete;
+  PackedEncoder &operator=(const PackedEncoder &) = delete;
+
+  /**
+   * pack plaintexts of the same exponent, slot_num values per packed number
+   *
+   * @param res: the packed plaintexts, of packed_size(size) elements
+   * @param plains: the plaintexts, each |v| < 2^{value_bits + guard_bits}
+   * @param size: the number of plaintexts
+   */
+  void pack(EncodedNumber *res, const EncodedNumber *plains, int size) const;
+
+  /**
+   * unpack the decrypted packed plaintexts
+   *
+   * @param res: the unpacked plaintexts, of size elements
+   * @param packed: the packed plaintexts, of packed_size(size) elements
+   * @param size: the number of unpacked plaintexts
+   */
+  void unpack(EncodedNumber *res, const EncodedNumber *packed,
+              int size) const;
+
+  /** get the number of packed numbers needed for size values */
+  int packed_size(int size) const { return (size + slot_num - 1) / slot_num; }
+
+  /** get the number of values per packed number */
+  int getter_slot_num() const { return slot_num; }
+
+  /** get the bit width of a slot */
+  int getter_slot_bits() const { return slot_bits; }
+
+private:
+  mpz_t n;
+  int slot_bits;
+  int slot_num;
+};
+
+#endif // FALCON_INCLUDE_FALCON_OPERATOR_PHE_PACKED_ENCODER_H_
@@ -0,0 +1,76 @@
+//
+// Created by root on 10/18/26.
+//
+
+#ifndef FALCON_INCLUDE_FALCON_OPERATOR_PHE_PHE_CONSTANT_FACTORY_H_
+#define FALCON_INCLUDE_FALCON_OPERATOR_PHE_PHE_CONSTANT_FACTORY_H_
+
+#include "falcon/operator/phe/fixed_point_encoder.h"
+#include "falcon/operator/phe/phe_random_pool.h"
+
+#include <memory>
+
+/**
+ * A factory of encrypted zeros and encrypted constants bound to one public
+ * key. It has two modes:
+ *  (1) fresh: the ciphertext g^m * r^{n^s} takes r^{n^s} from the
+ *      precomputed randomness pool, i.e., the pool is a reservoir of
+ *      encryptions of zero, so no modexp is on the online path;
+ *  (2) trivial: the deterministic ciphertext g^m (r = 1), which is only
+ *      safe for accumulators that are added with fresh ciphertexts (or
+ *      re-randomized) before they leave the party.
+ */
+class PheConstantFactory {
+public:
+  /**
+   * bind the factory to a randomness pool, the factory borrows the public
+   * key of the pool
+   *
+   * @param pool: randomness pool
+   */
+  explicit PheConstantFactory(std::shared_ptr<PheRandomPool> pool);
+
+  PheConstantFactory(const PheConstantFactory &) = delete;
+  PheConstantFactory &operator=(const PheConstantFactory &) = delete;
+
+  /**
+   * create an encrypted zero with the given precision
+   *
+   * @param res: the encrypted zero
+   * @param precision: fixed point precision, the exponent is -precision
+   * @param trivial: whether to return the deterministic ciphertext
+   */
+  void encrypt_zero(EncodedNumber &res,
+                    int precision = PHE_FIXED_POINT_PRECISION,
+                    bool trivial = false) const;
+
+  /**
+   * create an array of encrypted zeros with the given precision
+   *
+   * @param res: the encrypted zeros
+   * @param size: the array size
+   * @param precision: fixed point precision, the exponent is -precision
+   * @param trivial: whether to return the deterministic ciphertexts
+   */
+  void encrypt_zeros(EncodedNumber *res, int size,
+                     int precision = PHE_FIXED_POINT_PRECISION,
+                     bool trivial = false) const;
+
+  /**
+   * create an encrypted constant, keeping the exponent of the plaintext
+   *
+   * @param res: the encrypted constant
+   * @param plain: the encoded constant
+   * @param trivial: whether to return the deterministic ciphertext
+   */
+  void encrypt_constant(EncodedNumber &res, const EncodedNumber &plain,
+                        bool trivial = false) const;
+
+private:
+  // the public key borrowed from the key context of the pool
+  const djcs_t_public_key *pub_key;
+  // the reservoir of encryptions of zero
+  std::shared_ptr<PheRandomPool> random_pool;
+};
+
+#endif // FALCON_INCLUDE_FALCON_OPERATOR_PHE_PHE_CONSTANT_FACTORY_H_
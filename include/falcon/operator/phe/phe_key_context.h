@@ -0,0 +1,60 @@
+//
+// Created by root on 10/18/26.
+//
+
+#ifndef FALCON_INCLUDE_FALCON_OPERATOR_PHE_PHE_KEY_CONTEXT_H_
+#define FALCON_INCLUDE_FALCON_OPERATOR_PHE_PHE_KEY_CONTEXT_H_
+
+#include "falcon/operator/phe/mont_kernel.h"
+#include "gmp.h"
+#include "libhcs.h"
+
+#include <memory>
+
+/**
+ * The immutable phe keys of a party with the constants derived from them.
+ * The party owns one context through a shared_ptr, its copies share it, and
+ * the operators borrow the keys instead of copying them on every call. The
+ * borrowed keys must not be modified or freed.
+ */
+class PheKeyContext {
+public:
+  /**
+   * copy the keys and precompute the constants
+   *
+   * @param pk: public key
+   * @param au: authenticate server (i.e., private key share) of the party
+   */
+  PheKeyContext(const djcs_t_public_key *pk, const djcs_t_auth_server *au);
+
+  ~PheKeyContext();
+
+  PheKeyContext(const PheKeyContext &) = delete;
+  PheKeyContext &operator=(const PheKeyContext &) = delete;
+
+  /** borrow the public key */
+  const djcs_t_public_key *getter_pub_key() const { return pub_key; }
+
+  /** borrow the authenticate server */
+  const djcs_t_auth_server *getter_auth_server() const { return auth_server; }
+
+  /** get the plaintext modulus n */
+  mpz_srcptr getter_n() const { return pub_key->n[0]; }
+
+  /** get the ciphertext modulus n^{s+1} */
+  mpz_srcptr getter_cipher_modulus() const { return pub_key->n[pub_key->s]; }
+
+  /** get the partial decryption exponent 2 * delta * s_i */
+  mpz_srcptr getter_decrypt_exponent() const { return decrypt_exponent; }
+
+  /** get the Montgomery constants of the ciphertext modulus */
+  const MontModulus &getter_mont_modulus() const { return *mont_modulus; }
+
+private:
+  djcs_t_public_key *pub_key;
+  djcs_t_auth_server *auth_server;
+  mpz_t decrypt_exponent;
+  std::unique_ptr<MontModulus> mont_modulus;
+};
+
+#endif // FALCON_INCLUDE_FALCON_OPERATOR_PHE_PHE_KEY_CONTEXT_H_
@@ -0,0 +1,135 @@
+//
+// Created by root on 10/18/26.
+//
+
+#ifndef FALCON_INCLUDE_FALCON_OPERATOR_PHE_PHE_RANDOM_POOL_H_
+#define FALCON_INCLUDE_FALCON_OPERATOR_PHE_PHE_RANDOM_POOL_H_
+
+#include "falcon/common.h"
+#include "falcon/operator/phe/phe_key_context.h"
+#include "gmp.h"
+#include "libhcs.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A pool of precomputed djcs_t encryption randomness, i.e., r^{n^s} mod
+ * n^{s+1} for random r in Z_n^*. Background threads keep the pool filled,
+ * so that an online encryption only costs one modular multiplication
+ * (see djcs_t_aux_encrypt with a PheRandomPool).
+ *
+ * The producers sleep when the pool is full, and are woken up once the
+ * number of available values drops below the refill watermark. When the
+ * pool is empty, the value is computed inline and counted as a miss.
+ */
+class PheRandomPool {
+public:
+  /**
+   * create the pool and launch the background refill threads
+   *
+   * @param key_context: the shared phe keys, the pool borrows the public key
+   * @param capacity: maximum number of precomputed values
+   * @param watermark: refill starts when the pool size drops below it
+   * @param thread_num: number of background refill threads
+   */
+  PheRandomPool(std::shared_ptr<const PheKeyContext> key_context,
+                int capacity = PHE_RANDOM_POOL_CAPACITY,
+                int watermark = PHE_RANDOM_POOL_WATERMARK,
+                int thread_num = PHE_RANDOM_POOL_THREADS);
+
+  /**
+   * stop the refill threads and free the precomputed values
+   */
+  ~PheRandomPool();
+
+  PheRandomPool(const PheRandomPool &) = delete;
+  PheRandomPool &operator=(const PheRandomPool &) = delete;
+
+  /**
+   * take one precomputed r^{n^s} mod n^{s+1} from the pool,
+   * compute it inline if the pool is empty
+   *
+   * @param rn: the returned randomness
+   */
+  void fetch(mpz_t rn);
+
+  /**
+   * compute g^m mod n^{s+1}, uses 1 + m * n mod n^2 when g = n + 1 and s = 1
+   *
+   * @param rop: the result
+   * @param m: the plaintext
+   */
+  void pow_g(mpz_t rop, const mpz_t m) const;
+
+  /** get the phe keys the pool is built on */
+  const std::shared_ptr<const PheKeyContext> &getter_key_context() const {
+    return key_context;
+  }
+
+  /** get the modulus n^{s+1} of the ciphertext space */
+  void getter_cipher_modulus(mpz_t g_modulus) const;
+
+  /** get the number of precomputed values currently available */
+  int getter_size();
+
+  /** get the pool capacity */
+  int getter_capacity() const { return capacity; }
+
+  /** get the refill watermark */
+  int getter_watermark() const { return watermark; }
+
+  /** get the number of fetches served by a precomputed value */
+  long getter_hits() const { return hits.load(); }
+
+  /** get the number of fetches computed inline */
+  long getter_misses() const { return misses.load(); }
+
+private:
+  /**
+   * the loop executed by each refill thread
+   */
+  void refill();
+
+  /**
+   * compute num fresh r^{n^s} mod n^{s+1} at once
+   *
+   * @param hr: random generator
+   * @param rns: the computed randomness
+   * @param num: the number of values
+   */
+  void generate(hcs_random *hr, mpz_t *rns, int num) const;
+
+  // the shared phe keys, kept alive for the refill threads
+  std::shared_ptr<const PheKeyContext> key_context;
+  // the public key borrowed from key_context
+  const djcs_t_public_key *pub_key;
+  // whether g = n + 1 and s = 1, so that g^m is a multiplication
+  bool fast_pow_g;
+  // ring buffer of precomputed values
+  mpz_t *slots;
+  int capacity;
+  int watermark;
+  int head;
+  int size;
+  // whether the refill threads should produce values
+  bool refilling;
+  // protect the ring buffer
+  std::mutex pool_mutex;
+  // notify refill threads when the size drops below the watermark
+  std::condition_variable refill_cv;
+  // random generator for inline computation on a miss
+  hcs_random *miss_random;
+  std::mutex miss_mutex;
+  std::vector<std::thread> refill_threads;
+  bool stopped;
+  // statistics
+  std::atomic<long> hits;
+  std::atomic<long> misses;
+};
+
+#endif // FALCON_INCLUDE_FALCON_OPERATOR_PHE_PHE_RANDOM_POOL_H_
@@ -0,0 +1,73 @@
+//
+// Created by root on 10/18/26.
+//
+
+#ifndef FALCON_INCLUDE_FALCON_OPERATOR_PHE_PHE_RANDOM_STREAM_H_
+#define FALCON_INCLUDE_FALCON_OPERATOR_PHE_PHE_RANDOM_STREAM_H_
+
+#include "falcon/common.h"
+#include "libhcs.h"
+
+/**
+ * Per-thread hcs_random streams for the parallel encryption loops, so that
+ * the threads neither share nor lock one generator.
+ *
+ * By default each thread seeds its stream from the system (urandom, as
+ * hcs_reseed_random), and reseeds it after every init. The deterministic
+ * mode is for benchmarks only: the stream is reseeded at the start of every
+ * chunk of a loop from the master seed, the loop number and the chunk begin,
+ * so the ciphertexts only depend on the master seed and the call order, not
+ * on the number of threads or the scheduling. Anyone who knows the seed can
+ * recompute the randomness, so secrets such as the masks of the secret
+ * shares are always drawn from phe_secret_random_stream. The loops use
+ * chunks of PHE_RANDOM_STREAM_GRAIN elements:
+ *
+ *   unsigned long loop = phe_random_stream_next_loop();
+ *   crypto_parallel_for_chunks(0, size, [&](int begin, int end) {
+ *     hcs_random *hr = phe_random_stream(loop, begin);
+ *     ...
+ *   }, PHE_RANDOM_STREAM_GRAIN);
+ *
+ * A thread keeps one stream per chunk nesting depth (crypto_parallel_depth),
+ * so a stream can be used until its chunk returns, also across a nested
+ * loop during which the thread runs chunks of other loops.
+ */
+
+/**
+ * set the mode and the master seed, should be called before the parallel
+ * loops run
+ *
+ * @param master_seed: the master seed of the deterministic mode, 0 draws
+ *  one from the system
+ * @param deterministic: whether to reseed the streams per chunk
+ */
+void phe_random_stream_init(unsigned long master_seed, bool deterministic);
+
+/** check whether the streams are in the deterministic mode */
+bool phe_random_stream_deterministic();
+
+/**
+ * get the number of the next parallel loop, called once by the thread that
+ * starts the loop
+ */
+unsigned long phe_random_stream_next_loop();
+
+/**
+ * get the calling thread's stream for a chunk of a loop, at the nesting
+ * depth of the chunk
+ *
+ * @param loop: the loop number from phe_random_stream_next_loop
+ * @param chunk_begin: the first index of the chunk
+ * @return the stream, owned by the calling thread
+ */
+hcs_random *phe_random_stream(unsigned long loop, long chunk_begin);
+
+/**
+ * get the calling thread's stream for secrets, at the nesting depth of the
+ * chunk, which is seeded from the system also in the deterministic mode
+ *
+ * @return the stream, owned by the calling thread
+ */
+hcs_random *phe_secret_random_stream();
+
+#endif // FALCON_INCLUDE_FALCON_OPERATOR_PHE_PHE_RANDOM_STREAM_H_
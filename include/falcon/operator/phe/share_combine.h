@@ -0,0 +1,89 @@
+//
+// Created by root on 10/18/26.
+//
+
+#ifndef FALCON_INCLUDE_FALCON_OPERATOR_PHE_SHARE_COMBINE_H_
+#define FALCON_INCLUDE_FALCON_OPERATOR_PHE_SHARE_COMBINE_H_
+
+#include "falcon/operator/phe/phe_key_context.h"
+#include "gmp.h"
+#include "libhcs.h"
+
+#include <memory>
+#include <vector>
+
+/**
+ * The constants of the djcs_t threshold share combination for one public
+ * key and one set of parties, computed once instead of per ciphertext:
+ * the Lagrange coefficients 2 * lambda_i of the parties (with
+ * lambda_i = delta * prod_{j != i} x_j / (x_j - x_i), x_i = i + 1), and the
+ * inverse of 4 * delta^2 mod n.
+ *
+ * The combination of the shares c_i of one ciphertext is
+ * L(prod_i c_i^{2 * lambda_i} mod n^2) * (4 * delta^2)^{-1} mod n,
+ * with L(u) = (u - 1) / n, i.e., the djcs_t_share_combine of libhcs for s = 1.
+ */
+class ShareCombineContext {
+public:
+  /**
+   * precompute the constants
+   *
+   * @param key_context: the shared phe keys, the context borrows the public
+   *  key
+   * @param party_ids: the (0-based) ids of the parties whose shares are
+   *  combined, their shares are given in this order
+   */
+  ShareCombineContext(std::shared_ptr<const PheKeyContext> key_context,
+                      const std::vector<int> &party_ids);
+
+  ~ShareCombineContext();
+
+  ShareCombineContext(const ShareCombineContext &) = delete;
+  ShareCombineContext &operator=(const ShareCombineContext &) = delete;
+
+  /**
+   * combine the decryption shares of one ciphertext
+   *
+   * @param rop: the plaintext in [0, n)
+   * @param shares: the shares, in the order of party_ids
+   * @param scratch: a caller provided temporary, so that no allocation is
+   *  needed per ciphertext
+   */
+  void combine(mpz_t rop, mpz_t *shares, mpz_t scratch) const;
+
+  /**
+   * get the coefficient 2 * lambda_i of a party, the shares raised to their
+   * coefficients can be multiplied in any order before finish
+   *
+   * @param rop: the signed coefficient
+   * @param index: the index of the party in party_ids
+   */
+  void getter_coefficient(mpz_t rop, int index) const;
+
+  /**
+   * decrypt the product prod_i c_i^{2 * lambda_i} mod n^2 of the shares
+   *
+   * @param rop: the plaintext in [0, n)
+   * @param product: the product of the shares raised to their coefficients
+   */
+  void finish(mpz_t rop, const mpz_t product) const;
+
+  /** get the number of combined parties */
+  int getter_party_num() const { return (int)party_ids.size(); }
+
+  /** get the public key of the context */
+  const djcs_t_public_key *getter_pub_key() const { return pub_key; }
+
+private:
+  std::shared_ptr<const PheKeyContext> key_context;
+  // the public key borrowed from key_context
+  const djcs_t_public_key *pub_key;
+  std::vector<int> party_ids;
+  // |2 * lambda_i| and whether lambda_i is negative
+  mpz_t *lambda_abs;
+  std::vector<bool> lambda_negative;
+  // (4 * delta^2)^{-1} mod n
+  mpz_t inv_four_delta_square;
+};
+
+#endif // FALCON_INCLUDE_FALCON_OPERATOR_PHE_SHARE_COMBINE_H_
@@ -0,0 +1,217 @@
+//
+// Created by root on 10/18/26.
+//
+
+#ifndef FALCON_INCLUDE_FALCON_PARTY_COLLECTIVES_H_
+#define FALCON_INCLUDE_FALCON_PARTY_COLLECTIVES_H_
+
+#include <falcon/common.h>
+#include <falcon/operator/phe/fixed_point_encoder.h>
+#include <falcon/party/party.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Collective operations among all the parties.
+ *
+ * The transfers with all the peers of a collective run concurrently on the
+ * asynchronous party channels: the messages to every peer are queued at
+ * once and the receives from every peer are posted before any of them is
+ * waited for, so that a round takes the time of the slowest peer instead
+ * of the sum over the peers. The encoded number collectives stream the
+ * arrays in chunks (see EncodedNumberStreamWriter), so that the root
+ * combines the chunks received from all the parties while the next ones
+ * are being produced and sent. All the parties call a collective with the
+ * same root and sizes.
+ */
+
+/** a function of the chunk [begin, end) of an array */
+typedef std::function<void(int, int)> ChunkFunction;
+
+/**
+ * a function that combines the chunk [begin, end) of the arrays of all the
+ * parties, gathered[id] is the array of party id
+ */
+typedef std::function<void(EncodedNumber **, int, int)> CombineFunction;
+
+/**
+ * a function that combines n elements of the chunks of all the parties into
+ * dest, chunks[id] is the chunk of party id
+ */
+typedef std::function<void(EncodedNumber **, EncodedNumber *, int)>
+    BatchCombineFunction;
+
+/**
+ * broadcast a message from root to all the other parties
+ *
+ * @param party: the participating party
+ * @param root: the party that has the message
+ * @param message: the message at root, set to it at the other parties
+ * @param tag: the message tag
+ */
+void broadcast_message(const Party &party, int root, std::string &message,
+                       const MessageTag &tag = MessageTag());
+
+/**
+ * gather a message of each party at root
+ *
+ * @param party: the participating party
+ * @param root: the party that gathers the messages
+ * @param message: the message of this party
+ * @param tag: the message tag
+ * @return the messages indexed by party id at root, empty at the others
+ */
+std::vector<std::string> gather_messages(const Party &party, int root,
+                                         const std::string &message,
+                                         const MessageTag &tag = MessageTag());
+
+/**
+ * scatter a message to each party from root
+ *
+ * @param party: the participating party
+ * @param root: the party that has the messages
+ * @param messages: the messages indexed by party id at root
+ * @param tag: the message tag
+ * @return the message of this party
+ */
+std::string scatter_messages(const Party &party, int root,
+                             const std::vector<std::string> &messages,
+                             const MessageTag &tag = MessageTag());
+
+/**
+ * gather a message of each party at every party
+ *
+ * @param party: the participating party
+ * @param message: the message of this party
+ * @param tag: the message tag
+ * @return the messages indexed by party id
+ */
+std::vector<std::string>
+all_gather_messages(const Party &party, const std::string &message,
+                    const MessageTag &tag = MessageTag());
+
+/**
+ * stream an encoded number array from root to all the other parties
+ *
+ * @param party: the participating party
+ * @param root: the party that has the array
+ * @param numbers: the array at root, received at the other parties
+ * @param size: the size of the array
+ * @param produce: if given, called at root on each chunk before it is sent
+ */
+void broadcast_encoded_numbers(const Party &party, int root,
+                               EncodedNumber *numbers, int size,
+                               const ChunkFunction &produce = nullptr);
+
+/**
+ * gather the encoded number array of each party at root
+ *
+ * @param party: the participating party
+ * @param root: the party that gathers the arrays
+ * @param numbers: the array of this party
+ * @param gathered: at root, the arrays of size indexed by party id, where
+ *   gathered[root] may be numbers, not used at the other parties
+ * @param size: the size of the arrays
+ * @param produce: if given, called on each chunk of numbers before it is
+ *   sent
+ * @param consume: if given, called at root on each chunk once it is
+ *   gathered from all the parties
+ */
+void gather_encoded_numbers(const Party &party, int root,
+                            EncodedNumber *numbers, EncodedNumber **gathered,
+                            int size, const ChunkFunction &produce = nullptr,
+                            const ChunkFunction &consume = nullptr);
+
+/**
+ * gather the encoded number array of each party at root, combine them
+ * chunk by chunk into result, and optionally stream result to all the
+ * other parties as it is combined
+ *
+ * @param party: the participating party
+ * @param root: the party that combines the arrays
+ * @param numbers: the array of this party
+ * @param result: the combined array, at root, or at all the parties if
+ *   to_all
+ * @param size: the size of the arrays
+ * @param combine: called at root on each gathered chunk to fill result
+ * @param to_all: whether to send result to the other parties
+ * @param produce: if given, called on each chunk of numbers before it is
+ *   sent
+ */
+void combine_encoded_numbers(const Party &party, int root,
+                             EncodedNumber *numbers, EncodedNumber *result,
+                             int size, const CombineFunction &combine,
+                             bool to_all,
+                             const ChunkFunction &produce = nullptr);
+
+/**
+ * combine the encoded number arrays of all the parties, with the combination
+ * sharded by index range: the arrays are split in party_num shards, each
+ * party gathers the shard of its party id from all the parties and combines
+ * it, and the combined shards are gathered at every party (all-gather). So
+ * the combination work and the traffic are spread over all the parties
+ * instead of one root
+ *
+ * @param party: the participating party
+ * @param numbers: the array of this party
+ * @param result: the combined array, at all the parties
+ * @param size: the size of the arrays
+ * @param combine: called on each gathered chunk of the own shard
+ * @param produce: if given, called once on each chunk of numbers before it
+ *   is sent, the own shard last
+ */
+void shard_combine_encoded_numbers(const Party &party, EncodedNumber *numbers,
+                                   EncodedNumber *result, int size,
+                                   const BatchCombineFunction &combine,
+                                   const ChunkFunction &produce = nullptr);
+
+/**
+ * set the topology of reduce_encoded_numbers and collaborative_decrypt for
+ * the job, all the parties must use the same one. STAR_TOPOLOGY by default
+ *
+ * @param topology: the reduction topology
+ */
+void reduce_topology_init(falcon::ReduceTopology topology);
+
+/** get the topology of reduce_encoded_numbers */
+falcon::ReduceTopology reduce_topology();
+
+/**
+ * parse a topology name, "star", "tree" or "ring"
+ *
+ * @param name: the topology name
+ * @return the topology
+ */
+falcon::ReduceTopology parse_reduce_topology(const std::string &name);
+
+/**
+ * homomorphically add the cipher arrays of all the parties at root, along
+ * the topology of reduce_topology():
+ *  - STAR_TOPOLOGY: root receives and adds the arrays of all the parties,
+ *    and sends the sum to each of them
+ *  - TREE_TOPOLOGY: each party adds the partial sums of its children in a
+ *    binary tree rooted at root and sends it to its parent, the sum is sent
+ *    back down the tree
+ *  - RING_TOPOLOGY: the arrays are split in party_num segments, each party
+ *    adds one segment along the ring (reduce-scatter), and the segments are
+ *    passed around the ring (all-gather) or sent to root
+ * so that with the tree and the ring, the traffic of each party does not
+ * grow with party_num
+ *
+ * @param party: the participating party
+ * @param root: the party that adds the arrays
+ * @param ciphers: the cipher array of this party
+ * @param result: the sum, at root, or at all the parties if to_all
+ * @param size: the size of the arrays
+ * @param to_all: whether to send the sum to the other parties
+ * @param produce: if given, called once on each chunk of ciphers before the
+ *   chunk is used, in an order that depends on the topology
+ */
+void reduce_encoded_numbers(const Party &party, int root,
+                            EncodedNumber *ciphers, EncodedNumber *result,
+                            int size, bool to_all,
+                            const ChunkFunction &produce = nullptr);
+
+#endif // FALCON_INCLUDE_FALCON_PARTY_COLLECTIVES_H_
@@ -0,0 +1,167 @@
+//
+// Created by root on 10/18/26.
+//
+
+#ifndef FALCON_INCLUDE_FALCON_PARTY_ENCODED_NUMBER_STREAM_H_
+#define FALCON_INCLUDE_FALCON_PARTY_ENCODED_NUMBER_STREAM_H_
+
+#include <falcon/common.h>
+#include <falcon/operator/phe/fixed_point_encoder.h>
+#include <falcon/operator/phe/phe_key_context.h>
+#include <falcon/party/party.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * Chunked transfer of a large encoded number array over a party channel.
+ *
+ * The stream starts with a header message of the array size and the chunk
+ * size, followed by one binary serialized message per chunk of chunk_size
+ * elements. The writer serializes the chunks as the caller produces them and
+ * a background thread sends them, while the reader receives and deserializes
+ * them in a background thread into the destination array, so that the
+ * sender computes the next chunks and the receiver consumes the received
+ * ones while the previous chunks are on the wire. The n of the elements is
+ * omitted and taken from the party's key context, as the streamed arrays are
+ * ciphertexts or plaintexts of the phe key. The channel must not be used in
+ * the same direction by other messages until the stream is finished.
+ */
+class EncodedNumberStreamWriter {
+public:
+  /**
+   * start a stream to a party, the header is sent in the background
+   *
+   * @param party: the participating party
+   * @param dest_party_id: the party id to be sent
+   * @param size: the number of elements of the array
+   * @param chunk_size: the number of elements per message
+   */
+  EncodedNumberStreamWriter(const Party &party, int dest_party_id, int size,
+                            int chunk_size = PHE_STREAM_CHUNK_SIZE);
+
+  /** finish the stream */
+  ~EncodedNumberStreamWriter();
+
+  EncodedNumberStreamWriter(const EncodedNumberStreamWriter &) = delete;
+  EncodedNumberStreamWriter &
+  operator=(const EncodedNumberStreamWriter &) = delete;
+
+  /**
+   * send the complete chunks of numbers[0, end) that are not sent yet, the
+   * rest is sent by a later call. Blocks when PHE_STREAM_QUEUE_CHUNKS
+   * serialized chunks are waiting for the channel
+   *
+   * @param numbers: the whole array, the elements before end must not be
+   *   changed until the stream is finished
+   * @param end: the number of produced elements, non-decreasing over calls
+   */
+  void write(EncodedNumber *numbers, int end);
+
+  /**
+   * wait until all the chunks are sent, all the elements must be written
+   */
+  void finish();
+
+private:
+  /** the loop of the sending thread */
+  void send_loop();
+
+  const Party &party;
+  int dest_party_id;
+  int size;
+  int chunk_size;
+  // the number of elements serialized so far
+  int written;
+  std::deque<std::string> queue;
+  bool closed;
+  std::mutex queue_mutex;
+  std::condition_variable queue_cv;
+  std::thread sender;
+};
+
+class EncodedNumberStreamReader {
+public:
+  /**
+   * start receiving a stream from a party into numbers in the background
+   *
+   * @param party: the participating party
+   * @param src_party_id: the party that sends the array
+   * @param numbers: the destination array, valid until the stream is finished
+   * @param size: the number of elements of the array
+   */
+  EncodedNumberStreamReader(const Party &party, int src_party_id,
+                            EncodedNumber *numbers, int size);
+
+  /** finish the stream */
+  ~EncodedNumberStreamReader();
+
+  EncodedNumberStreamReader(const EncodedNumberStreamReader &) = delete;
+  EncodedNumberStreamReader &
+  operator=(const EncodedNumberStreamReader &) = delete;
+
+  /**
+   * wait until numbers[0, end) are received and deserialized
+   *
+   * @param end: the number of elements to wait for
+   */
+  void wait(int end);
+
+  /** wait until the whole array is received */
+  void finish();
+
+private:
+  /** the loop of the receiving thread */
+  void recv_loop();
+
+  const Party &party;
+  int src_party_id;
+  EncodedNumber *numbers;
+  int size;
+  // keeps the n of the received elements alive
+  std::shared_ptr<const PheKeyContext> key_context;
+  // the number of elements deserialized so far
+  int received;
+  std::mutex received_mutex;
+  std::condition_variable received_cv;
+  std::thread receiver;
+};
+
+/**
+ * stream an encoded number array to a party, optionally producing each
+ * chunk right before it is sent
+ *
+ * @param party: the participating party
+ * @param dest_party_id: the party id to be sent
+ * @param numbers: the array to be sent
+ * @param size: the number of elements of the array
+ * @param produce: if given, called on each chunk [begin, end) to fill it
+ * @param chunk_size: the number of elements per chunk
+ */
+void send_encoded_number_stream(
+    const Party &party, int dest_party_id, EncodedNumber *numbers, int size,
+    const std::function<void(int, int)> &produce = nullptr,
+    int chunk_size = PHE_STREAM_CHUNK_SIZE);
+
+/**
+ * receive a streamed encoded number array from a party, optionally
+ * consuming each chunk as soon as it is received
+ *
+ * @param party: the participating party
+ * @param src_party_id: the party that sends the array
+ * @param numbers: the destination array
+ * @param size: the number of elements of the array
+ * @param consume: if given, called on each received chunk [begin, end)
+ * @param chunk_size: the number of elements per consumed chunk
+ */
+void recv_encoded_number_stream(
+    const Party &party, int src_party_id, EncodedNumber *numbers, int size,
+    const std::function<void(int, int)> &consume = nullptr,
+    int chunk_size = PHE_STREAM_CHUNK_SIZE);
+
+#endif // FALCON_INCLUDE_FALCON_PARTY_ENCODED_NUMBER_STREAM_H_
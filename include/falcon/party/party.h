@@ -7,13 +7,18 @@
 
 #include <falcon/common.h>
 #include <falcon/operator/phe/djcs_t_aux.h>
+#include <falcon/operator/phe/phe_constant_factory.h>
 #include <libhcs.h>
 
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "falcon/network/Comm.hpp"
+#include "falcon/network/async_channel.h"
+
+class SpdzSession;
 
 class Party {
 public:
@@ -27,14 +32,28 @@ public:
   falcon::FLSetting fl_setting;
   // communication channel with other parties
   std::vector<shared_ptr<CommParty>> channels;
+  // asynchronous tagged channels on top of channels, which carry all the
+  // messages of the party once the network is initialized
+  std::vector<std::shared_ptr<AsyncChannel>> async_channels;
   // boost i/o functionality
   boost::asio::io_service io_service;
   // host names of other parties
   std::vector<std::string> host_names;
   // port array of mpc engines
   std::vector<int> executor_mpc_ports;
+  // client connections to the mpc engines, shared by the copies of the party
+  std::shared_ptr<SpdzSession> spdz_session;
   // random generator of PHE
   hcs_random *phe_random;
+  // precomputed encryption randomness, shared by the copies of the party
+  std::shared_ptr<PheRandomPool> phe_random_pool;
+  // encrypted zeros and constants drawn from phe_random_pool
+  std::shared_ptr<PheConstantFactory> phe_constant_factory;
+  // share combination constants of the phe key and all the parties
+  std::shared_ptr<ShareCombineContext> phe_share_combiner;
+  // immutable phe keys and their derived constants, borrowed by the
+  // operators instead of copying the keys
+  std::shared_ptr<const PheKeyContext> phe_key_context;
 
 private:
   // sample number in the local dataset
@@ -118,6 +137,32 @@ public:
    */
   void init_with_key_file(const std::string &key_file);
 
+  /**
+   * (re)create the shared key context from the current phe public key
+   * and auth server, the contexts borrowed before stay valid until they
+   * are released by their holders
+   */
+  void init_phe_key_context();
+
+  /**
+   * (re)compute the share combination constants for the current key
+   * context and the parties {0, ..., party_num - 1}
+   */
+  void init_phe_share_combiner();
+
+  /**
+   * (re)create the precomputed encryption randomness pool for the
+   * current key context, background threads start filling it,
+   * and the encrypted constant factory on top of it
+   *
+   * @param capacity: maximum number of precomputed values
+   * @param watermark: refill starts when the pool size drops below it
+   * @param thread_num: number of background refill threads
+   */
+  void init_phe_random_pool(int capacity = PHE_RANDOM_POOL_CAPACITY,
+                            int watermark = PHE_RANDOM_POOL_WATERMARK,
+                            int thread_num = PHE_RANDOM_POOL_THREADS);
+
   /**
    * export the phe key string for transmission
    *
@@ -133,7 +178,7 @@ public:
   void load_phe_key_string(const std::string &phe_keys_str);
 
   /**
-   * send message via channel commParty
+   * send message via channel commParty, blocks until the message is written
    *
    * @param id: other party id
    * @param message: sent message
@@ -141,7 +186,8 @@ public:
   void send_message(int id, std::string message) const;
 
   /**
-   * send long message via channel commParty
+   * send long message via channel commParty, blocks until the message is
+   * written
    *
    * @param id: other party id
    * @param message: sent message
@@ -167,6 +213,28 @@ public:
    */
   void recv_long_message(int id, std::string &message) const;
 
+  /**
+   * queue a tagged message to another party, blocks while the queue to the
+   * party is full
+   *
+   * @param id: other party id
+   * @param tag: the message tag, e.g., (phase, node, batch)
+   * @param message: sent message
+   * @return a future that is ready when the message is written
+   */
+  std::future<void> async_send(int id, const MessageTag &tag,
+                               std::string message) const;
+
+  /**
+   * receive the next message of a tag from another party, the messages of
+   * other tags are kept until they are received
+   *
+   * @param id: other party id
+   * @param tag: the message tag, e.g., (phase, node, batch)
+   * @return a future of the received message
+   */
+  std::future<std::string> async_recv(int id, const MessageTag &tag) const;
+
   /**
    * split the dataset into training and testing dataset
    *
@@ -81,46 +81,57 @@ void deserialize_encoded_number(EncodedNumber &number,
                                 const std::string &input_message);
 
 /**
- * serialize encoded number array
+ * serialize encoded number array, in the binary format
+ * (BinaryEncodedNumberArray) with raw fixed width values
  *
  * @param number_array: an EncodedNumber array
  * @param size: size of array
  * @param output_message: serialized string
+ * @param omit_n: whether to omit n when the elements share it, the receiver
+ *   then gives it from its key context
  */
 void serialize_encoded_number_array(EncodedNumber *number_array, int size,
-                                    std::string &output_message);
+                                    std::string &output_message,
+                                    bool omit_n = false);
 
 /**
- * deserialize encoded number array
+ * deserialize encoded number array, of the binary or the legacy format
  *
  * @param number_array: an EncodedNumber array
  * @param size: size of array (need to specify before deserialization)
  * @param input_message: serialized string
+ * @param n: the n of the elements if omitted by the sender
  */
 void deserialize_encoded_number_array(EncodedNumber *number_array, int size,
-                                      const std::string &input_message);
+                                      const std::string &input_message,
+                                      mpz_srcptr n = nullptr);
 
 /**
- * serialize encoded number matrix
+ * serialize encoded number matrix, in the binary format
  *
  * @param number_matrix: an EncodedNumber matrix
  * @param row_size: row number
  * @param column_size: column number
  * @param output_message: serialized string
+ * @param omit_n: whether to omit n when the elements share it
  */
 void serialize_encoded_number_matrix(EncodedNumber **number_matrix,
                                      int row_size, int column_size,
-                                     std::string &output_message);
+                                     std::string &output_message,
+                                     bool omit_n = false);
 
 /**
- * deserialize encoded number array
+ * deserialize encoded number matrix, of the binary or the legacy format
  *
- * @param number_array: an EncodedNumber array
- * @param size: size of array (need to specify before deserialization)
+ * @param number_matrix: an EncodedNumber matrix
+ * @param row_size: row number
+ * @param column_size: column number
  * @param input_message: serialized string
+ * @param n: the n of the elements if omitted by the sender
  */
 void deserialize_encoded_number_matrix(EncodedNumber **number_matrix,
                                        int row_size, int column_size,
-                                       const std::string &input_message);
+                                       const std::string &input_message,
+                                       mpz_srcptr n = nullptr);
 
 #endif // FALCON_SRC_EXECUTOR_UTILS_PB_CONVERTER_COMMON_CONVERTER_H_
@@ -0,0 +1,182 @@
+//
+// Created by root on 10/18/26.
+//
+
+#ifndef FALCON_INCLUDE_FALCON_UTILS_THREAD_POOL_H_
+#define FALCON_INCLUDE_FALCON_UTILS_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * The executor-wide pool for the parallel loops of the crypto operators.
+ *
+ * A parallel loop is split into chunks that the caller and the idle workers
+ * claim one by one, so the work is balanced when the chunks take different
+ * time. The caller always runs chunks of its own loop, and while it waits
+ * for the chunks claimed by others it runs chunks of the other loops, so a
+ * loop nested in a chunk (e.g., an operator called from a tree or forest
+ * loop) neither deadlocks nor oversubscribes the cpus: it is shared among
+ * the same thread_num threads. The workers are long-lived, so thread_local
+ * state such as phe_scratch is reused across loops.
+ *
+ * A chunk run by a waiting caller may belong to an unrelated loop, so the
+ * thread_local state that a chunk keeps across a nested loop is indexed by
+ * crypto_parallel_depth, e.g., the per-thread phe_random_stream.
+ */
+class CryptoThreadPool {
+public:
+  /**
+   * launch the pool
+   *
+   * @param thread_num: the number of threads including the caller, the pool
+   *   launches thread_num - 1 workers
+   */
+  explicit CryptoThreadPool(int thread_num);
+
+  /** stop and join the workers */
+  ~CryptoThreadPool();
+
+  CryptoThreadPool(const CryptoThreadPool &) = delete;
+  CryptoThreadPool &operator=(const CryptoThreadPool &) = delete;
+
+  /**
+   * run body(chunk_begin, chunk_end) over the chunks of [begin, end), and
+   * return when all the chunks are finished. The chunks of a given grain
+   * are the same for any number of threads
+   *
+   * @param begin: the first index
+   * @param end: the index after the last one
+   * @param grain: the chunk size, 0 selects about 4 chunks per thread
+   * @param body: the chunk function, called concurrently
+   */
+  void parallel_for(int begin, int end, int grain,
+                    const std::function<void(int, int)> &body);
+
+  /** get the number of threads including the caller */
+  int getter_thread_num() const { return (int)workers.size() + 1; }
+
+private:
+  struct Loop {
+    const std::function<void(int, int)> *body;
+    int begin;
+    int end;
+    int grain;
+    // the next unclaimed index
+    std::atomic<int> next;
+    // the number of chunks not finished yet
+    int pending;
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+  };
+
+  /**
+   * claim a chunk of a loop
+   *
+   * @return false if all the chunks are claimed
+   */
+  static bool claim(Loop *loop, int &chunk_begin, int &chunk_end);
+
+  /** run a claimed chunk and count it as finished */
+  static void run(Loop *loop, int chunk_begin, int chunk_end);
+
+  /**
+   * claim and run a chunk of any posted loop
+   *
+   * @return false if no chunk is available
+   */
+  bool help();
+
+  /** the loop executed by each worker */
+  void work();
+
+  std::vector<std::thread> workers;
+  // the loops with unclaimed chunks, claimed under loops_mutex so that a
+  // loop is not finished and released while being claimed
+  std::vector<Loop *> loops;
+  std::mutex loops_mutex;
+  std::condition_variable loops_cv;
+  bool stopped;
+};
+
+/**
+ * get the number of cpus available to the process: the cpu affinity, capped
+ * by the cgroup cpu quota (cgroup v2 cpu.max or v1 cpu.cfs_quota_us)
+ *
+ * @return the number of cpus, at least 1
+ */
+int available_cpu_num();
+
+/**
+ * (re)create the executor-wide crypto pool, e.g., from the main function,
+ * logs an error and exits if a loop is running on the current pool
+ *
+ * @param thread_num: the number of threads, 0 selects available_cpu_num()
+ */
+void crypto_thread_pool_init(int thread_num);
+
+/**
+ * A use of the executor-wide crypto pool, which keeps the pool from being
+ * replaced by crypto_thread_pool_init while it lives. The pool is created
+ * with available_cpu_num() threads on first use if crypto_thread_pool_init
+ * was not called
+ */
+class CryptoThreadPoolUse {
+public:
+  CryptoThreadPoolUse();
+  ~CryptoThreadPoolUse();
+
+  CryptoThreadPoolUse(const CryptoThreadPoolUse &) = delete;
+  CryptoThreadPoolUse &operator=(const CryptoThreadPoolUse &) = delete;
+
+  CryptoThreadPool *operator->() const { return pool; }
+
+private:
+  CryptoThreadPool *pool;
+};
+
+/**
+ * get the number of crypto chunks on the calling thread's stack, i.e., 0
+ * outside any chunk, 1 in the chunk of a loop, 2 in a chunk run from a
+ * nested loop (including the chunks of other loops run while waiting)
+ */
+int crypto_parallel_depth();
+
+/**
+ * run fn(i) for each i in [begin, end) on the crypto pool
+ *
+ * @param begin: the first index
+ * @param end: the index after the last one
+ * @param fn: the function of an index
+ * @param grain: the chunk size, 0 selects it from the pool size
+ */
+template <typename F>
+void crypto_parallel_for(int begin, int end, F &&fn, int grain = 0) {
+  CryptoThreadPoolUse pool;
+  pool->parallel_for(begin, end, grain, [&fn](int chunk_begin, int chunk_end) {
+    for (int i = chunk_begin; i < chunk_end; i++) {
+      fn(i);
+    }
+  });
+}
+
+/**
+ * run fn(chunk_begin, chunk_end) over the chunks of [begin, end) on the
+ * crypto pool, for loops with temporaries initialized once per chunk
+ *
+ * @param begin: the first index
+ * @param end: the index after the last one
+ * @param fn: the function of a chunk
+ * @param grain: the chunk size, 0 selects it from the pool size
+ */
+template <typename F>
+void crypto_parallel_for_chunks(int begin, int end, F &&fn, int grain = 0) {
+  CryptoThreadPoolUse pool;
+  pool->parallel_for(begin, end, grain, fn);
+}
+
+#endif // FALCON_INCLUDE_FALCON_UTILS_THREAD_POOL_H_
@@ -107,8 +107,8 @@ void init_encrypted_model_weights(const Party &party,
                                   std::vector<int> party_weight_sizes,
                                   EncodedNumber *encrypted_vector,
                                   int precision) {
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   int global_weight_size =
       std::accumulate(party_weight_sizes.begin(), party_weight_sizes.end(), 0);
   double limit = sqrt(2.0 / static_cast<double>(global_weight_size));
@@ -147,10 +147,10 @@ void init_encrypted_model_weights(const Party &party,
     // double v = static_cast<double>(rand()) / static_cast<double>(RAND_MAX);
     EncodedNumber t;
     t.set_double(phe_pub_key->n[0], v, precision);
-    djcs_t_aux_encrypt(phe_pub_key, party.phe_random, encrypted_vector[i], t);
+    djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                       encrypted_vector[i], t);
     start_idx += 1;
   }
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void split_dataset(Party *party, bool fit_bias,
@@ -203,8 +203,8 @@ void compute_encrypted_residual(const Party &party,
                                 EncodedNumber *predicted_labels,
                                 EncodedNumber *encrypted_batch_losses) {
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   // convert batch loss shares back to encrypted losses
   int cur_batch_size = static_cast<int>(batch_indexes.size());
@@ -228,14 +228,13 @@ void compute_encrypted_residual(const Party &party,
                                  ACTIVE_PARTY_ID);
   log_info("Finish compute encrypted loss and sync up with all parties");
 
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void encode_samples(const Party &party,
                     const std::vector<std::vector<double>> &used_samples,
                     EncodedNumber **encoded_samples, int precision) {
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   // retrieve batch samples and encode (notice to use cur_batch_size
   // instead of default batch size to avoid unexpected batch)
@@ -249,15 +248,14 @@ void encode_samples(const Party &party,
     }
   }
 
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void get_encrypted_2d_true_labels(const Party &party, int output_layer_size,
                                   const std::vector<double> &plain_batch_labels,
                                   EncodedNumber **batch_true_labels,
                                   int precision) {
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   // note that the output_layer_size implicitly specifies regression or
   // classification
   int cur_sample_size = static_cast<int>(plain_batch_labels.size());
@@ -266,8 +264,8 @@ void get_encrypted_2d_true_labels(const Party &party, int output_layer_size,
       // regression
       batch_true_labels[i][0].set_double(phe_pub_key->n[0],
                                          plain_batch_labels[i], precision);
-      djcs_t_aux_encrypt(phe_pub_key, party.phe_random, batch_true_labels[i][0],
-                         batch_true_labels[i][0]);
+      djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                         batch_true_labels[i][0], batch_true_labels[i][0]);
     } else {
       // classification, the label is actually the index that to set 1.0
       int true_label_idx = static_cast<int>(plain_batch_labels[i]);
@@ -277,12 +275,11 @@ void get_encrypted_2d_true_labels(const Party &party, int output_layer_size,
         } else {
           batch_true_labels[i][j].set_double(phe_pub_key->n[0], 0.0, precision);
         }
-        djcs_t_aux_encrypt(phe_pub_key, party.phe_random,
+        djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
                            batch_true_labels[i][j], batch_true_labels[i][j]);
       }
     }
   }
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void display_encrypted_matrix(const Party &party, int row_size, int col_size,
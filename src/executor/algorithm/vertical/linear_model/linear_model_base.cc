@@ -29,6 +29,7 @@ SOFTWARE.
 #include <falcon/algorithm/vertical/linear_model/linear_model_base.h>
 #include <falcon/common.h>
 #include <falcon/operator/conversion/op_conv.h>
+#include <falcon/party/collectives.h>
 #include <falcon/party/info_exchange.h>
 #include <falcon/utils/logger/logger.h>
 #include <falcon/utils/pb_converter/common_converter.h>
@@ -72,71 +73,30 @@ void LinearModel::compute_batch_phe_aggregation(
     EncodedNumber **encoded_batch_samples, int precision,
     EncodedNumber *encrypted_batch_aggregation) const {
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
-  // each party compute local homomorphic aggregation
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
+  // each party compute local homomorphic aggregation, in chunks of samples
+  // that are sent to the active party as soon as they are computed
   auto *local_batch_phe_aggregation = new EncodedNumber[cur_batch_size];
-  djcs_t_aux_vec_mat_ep_mult(
-      phe_pub_key, party.phe_random, local_batch_phe_aggregation, local_weights,
-      encoded_batch_samples, cur_batch_size, weight_size);
-  // every party sends the local aggregation to the active party
-  if (party.party_type == falcon::ACTIVE_PARTY) {
-    // copy self local aggregation results
-    for (int i = 0; i < cur_batch_size; i++) {
-      // each element (i) in local_batch_phe_aggregation is [W].Xi,
-      // Xi is a part of feature vector in example i
-      encrypted_batch_aggregation[i] = local_batch_phe_aggregation[i];
-    }
-
-    // 1. active party receive serialized string from other parties
-    // deserialize and sum to batch_phe_aggregation
-    for (int id = 0; id < party.party_num; id++) {
-      if (id != party.party_id) {
-        auto *recv_batch_phe_aggregation = new EncodedNumber[cur_batch_size];
-        std::string recv_local_aggregation_str;
-        party.recv_long_message(id, recv_local_aggregation_str);
-        deserialize_encoded_number_array(recv_batch_phe_aggregation,
-                                         cur_batch_size,
-                                         recv_local_aggregation_str);
-        // homomorphic addition of the received aggregations
-        // After addition, each element (i) in batch_phe_aggregation is
-        // [W1].Xi1+[W2].Xi2+...+[Wn].Xin Xin is example i's n-th feature,
-        // W1 is first element in weigh vector
-        for (int i = 0; i < cur_batch_size; i++) {
-          djcs_t_aux_ee_add(phe_pub_key, encrypted_batch_aggregation[i],
-                            encrypted_batch_aggregation[i],
-                            recv_batch_phe_aggregation[i]);
-        }
-        delete[] recv_batch_phe_aggregation;
-      }
-    }
-    // 2. active party serialize and send the aggregated
-    // batch_phe_aggregation to other parties
-    std::string global_aggregation_str;
-    serialize_encoded_number_array(encrypted_batch_aggregation, cur_batch_size,
-                                   global_aggregation_str);
-    for (int id = 0; id < party.party_num; id++) {
-      if (id != party.party_id) {
-        party.send_long_message(id, global_aggregation_str);
-      }
-    }
-  } else {
-    // if it's passive party, it will not do the aggregation,
-    // 1. it just serializes local batch aggregation and send to active party
-    std::string local_aggregation_str;
-    serialize_encoded_number_array(local_batch_phe_aggregation, cur_batch_size,
-                                   local_aggregation_str);
-    party.send_long_message(ACTIVE_PARTY_ID, local_aggregation_str);
-    // 2. passive party receive the global batch aggregation
-    // from the active party
-    std::string recv_global_aggregation_str;
-    party.recv_long_message(ACTIVE_PARTY_ID, recv_global_aggregation_str);
-    deserialize_encoded_number_array(encrypted_batch_aggregation,
-                                     cur_batch_size,
-                                     recv_global_aggregation_str);
-  }
+  auto local_aggregate = [&](int begin, int end) {
+    djcs_t_aux_vec_mat_ep_mult(phe_pub_key, party.phe_random,
+                               local_batch_phe_aggregation + begin,
+                               local_weights, encoded_batch_samples + begin,
+                               end - begin, weight_size);
+    // the products are deterministic in the local features, so they are
+    // re-randomized before leaving the party
+    djcs_t_aux_vec_rerandomize(phe_pub_key, party.phe_random_pool.get(),
+                               local_batch_phe_aggregation + begin,
+                               local_batch_phe_aggregation + begin,
+                               end - begin);
+  };
+  // the active party homomorphically adds the local aggregations of all
+  // the parties, each element (i) of the sum is [W1].Xi1+[W2].Xi2+...+
+  // [Wn].Xin, Xin is example i's n-th feature, and streams it back
+  reduce_encoded_numbers(party, ACTIVE_PARTY_ID, local_batch_phe_aggregation,
+                         encrypted_batch_aggregation, cur_batch_size, true,
+                         local_aggregate);
 
-  djcs_t_free_public_key(phe_pub_key);
   delete[] local_batch_phe_aggregation;
 }
 
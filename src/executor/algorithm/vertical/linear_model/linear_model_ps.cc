@@ -190,18 +190,15 @@ void LinearParameterServer::distributed_predict(
 void LinearParameterServer::update_encrypted_weights(
     const std::vector<string> &encoded_messages, int weight_size,
     int weight_phe_precision, EncodedNumber *updated_weights) const {
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   auto encrypted_aggregated_gradients = new EncodedNumber[weight_size];
-  // first, need to initialize and encrypt the gradients
-  for (int i = 0; i < weight_size; i++) {
-    encrypted_aggregated_gradients[i].set_double(phe_pub_key->n[0], 0.0,
-                                                 PHE_FIXED_POINT_PRECISION);
-    djcs_t_aux_encrypt(phe_pub_key, party.phe_random,
-                       encrypted_aggregated_gradients[i],
-                       encrypted_aggregated_gradients[i]);
-  }
+  // first, need to initialize the gradients, the received encrypted
+  // gradients are added to them, so the trivial encrypted zero is enough
+  party.phe_constant_factory->encrypt_zeros(encrypted_aggregated_gradients,
+                                            weight_size,
+                                            PHE_FIXED_POINT_PRECISION, true);
 
   log_info("[LinearParameterServer::update_encrypted_weights] decode encrypted "
            "messages and add to encrypted gradients");
@@ -234,6 +231,5 @@ void LinearParameterServer::update_encrypted_weights(
                           encrypted_aggregated_gradients[j]);
   }
 
-  djcs_t_free_public_key(phe_pub_key);
   delete[] encrypted_aggregated_gradients;
 }
\ No newline at end of file
@@ -31,7 +31,9 @@ SOFTWARE.
 #include <falcon/common.h>
 #include <falcon/model/model_io.h>
 #include <falcon/operator/conversion/op_conv.h>
+#include <falcon/operator/phe/gmp_arena.h>
 #include <falcon/operator/mpc/spdz_connector.h>
+#include <falcon/operator/mpc/spdz_session.h>
 #include <falcon/party/info_exchange.h>
 #include <falcon/utils/logger/log_alg_params.h>
 #include <falcon/utils/logger/logger.h>
@@ -85,8 +87,8 @@ void LinearRegressionBuilder::backward_computation(
     EncodedNumber *predicted_labels, const std::vector<int> &batch_indexes,
     int precision, EncodedNumber *encrypted_gradients) {
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   // convert batch loss shares back to encrypted losses
   int cur_batch_size = (int)batch_indexes.size();
@@ -120,8 +122,8 @@ void LinearRegressionBuilder::backward_computation(
       batch_true_labels[i].set_double(phe_pub_key->n[0],
                                       training_labels[batch_indexes[i]],
                                       PHE_FIXED_POINT_PRECISION);
-      djcs_t_aux_encrypt(phe_pub_key, party.phe_random, batch_true_labels[i],
-                         batch_true_labels[i]);
+      djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                         batch_true_labels[i], batch_true_labels[i]);
     }
   }
   compute_encrypted_residual(party, batch_indexes, batch_true_labels, precision,
@@ -183,12 +185,17 @@ void LinearRegressionBuilder::backward_computation(
       batch_feature_j[i] = encoded_batch_samples[i][j];
     }
     // compute homomorphic inner product between feature j and weights
-    djcs_t_aux_inner_product(phe_pub_key, party.phe_random, gradient,
-                             encrypted_batch_losses, batch_feature_j,
-                             cur_batch_size);
+    djcs_t_aux_signed_inner_product(phe_pub_key, gradient,
+                                    encrypted_batch_losses, batch_feature_j,
+                                    cur_batch_size);
     common_gradients[j] = gradient;
     delete[] batch_feature_j;
   }
+  // the gradients are deterministic in the local samples and end up in the
+  // weights sent to other parties, so they are re-randomized
+  djcs_t_aux_vec_rerandomize(phe_pub_key, party.phe_random_pool.get(),
+                             common_gradients, common_gradients,
+                             linear_reg_model.weight_size);
 
   // if no regularization
   if (!with_regularization) {
@@ -217,8 +224,10 @@ void LinearRegressionBuilder::backward_computation(
       // first compute the last item of the l2 regularization
       // then, add the second item to the common_gradients
       for (int j = 0; j < linear_reg_model.weight_size; j++) {
-        djcs_t_aux_ep_mul(phe_pub_key, regularized_gradients[j],
-                          linear_reg_model.local_weights[j], encoded_constant);
+        // fold the alignment to the common gradients into the constant
+        djcs_t_aux_ep_mul_ext(phe_pub_key, regularized_gradients[j],
+                              linear_reg_model.local_weights[j],
+                              encoded_constant, common_gradients_precision);
         djcs_t_aux_ee_add_ext(phe_pub_key, encrypted_gradients[j],
                               common_gradients[j], regularized_gradients[j]);
       }
@@ -248,8 +257,10 @@ void LinearRegressionBuilder::backward_computation(
                                   PHE_FIXED_POINT_PRECISION);
       // then, add the second item to the common_gradients
       for (int j = 0; j < linear_reg_model.weight_size; j++) {
-        djcs_t_aux_ep_mul(phe_pub_key, regularized_gradients[j],
-                          regularized_gradients[j], encoded_constant);
+        // fold the alignment to the common gradients into the constant
+        djcs_t_aux_ep_mul_ext(phe_pub_key, regularized_gradients[j],
+                              regularized_gradients[j], encoded_constant,
+                              common_gradients_precision);
         djcs_t_aux_ee_add_ext(phe_pub_key, encrypted_gradients[j],
                               common_gradients[j], regularized_gradients[j]);
       }
@@ -257,7 +268,6 @@ void LinearRegressionBuilder::backward_computation(
     delete[] regularized_gradients;
   }
 
-  djcs_t_free_public_key(phe_pub_key);
   delete[] encrypted_batch_losses;
   for (int i = 0; i < cur_batch_size; i++) {
     delete[] encoded_batch_samples[i];
@@ -274,8 +284,8 @@ void LinearRegressionBuilder::lime_backward_computation(
     const std::vector<double> &sss_sample_weights,
     EncodedNumber *encrypted_gradients) {
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   // convert batch loss shares back to encrypted losses
   int cur_batch_size = (int)batch_indexes.size();
@@ -425,12 +435,17 @@ void LinearRegressionBuilder::lime_backward_computation(
       batch_feature_j[i] = encoded_batch_samples[i][j];
     }
     // compute homomorphic inner product between feature j and weights
-    djcs_t_aux_inner_product(phe_pub_key, party.phe_random, gradient,
-                             encrypted_batch_losses, batch_feature_j,
-                             cur_batch_size);
+    djcs_t_aux_signed_inner_product(phe_pub_key, gradient,
+                                    encrypted_batch_losses, batch_feature_j,
+                                    cur_batch_size);
     common_gradients[j] = gradient;
     delete[] batch_feature_j;
   }
+  // the gradients are deterministic in the local samples and end up in the
+  // weights sent to other parties, so they are re-randomized
+  djcs_t_aux_vec_rerandomize(phe_pub_key, party.phe_random_pool.get(),
+                             common_gradients, common_gradients,
+                             linear_reg_model.weight_size);
 
 //  /***** debug info start ******/
 //  log_info("[debug] display common_gradients");
@@ -500,8 +515,10 @@ void LinearRegressionBuilder::lime_backward_computation(
       // first compute the last item of the l2 regularization
       // then, add the second item to the common_gradients
       for (int j = 0; j < linear_reg_model.weight_size; j++) {
-        djcs_t_aux_ep_mul(phe_pub_key, regularized_gradients[j],
-                          linear_reg_model.local_weights[j], encoded_constant);
+        // fold the alignment to the common gradients into the constant
+        djcs_t_aux_ep_mul_ext(phe_pub_key, regularized_gradients[j],
+                              linear_reg_model.local_weights[j],
+                              encoded_constant, common_gradients_precision);
         djcs_t_aux_ee_add_ext(phe_pub_key, encrypted_gradients[j],
                               common_gradients[j], regularized_gradients[j]);
       }
@@ -572,8 +589,10 @@ void LinearRegressionBuilder::lime_backward_computation(
                                   PHE_FIXED_POINT_PRECISION);
       // then, add the second item to the common_gradients
       for (int j = 0; j < linear_reg_model.weight_size; j++) {
-        djcs_t_aux_ep_mul(phe_pub_key, regularized_gradients[j],
-                          regularized_gradients[j], encoded_constant);
+        // fold the alignment to the common gradients into the constant
+        djcs_t_aux_ep_mul_ext(phe_pub_key, regularized_gradients[j],
+                              regularized_gradients[j], encoded_constant,
+                              common_gradients_precision);
         djcs_t_aux_ee_add_ext(phe_pub_key, encrypted_gradients[j],
                               common_gradients[j], regularized_gradients[j]);
       }
@@ -621,7 +640,6 @@ void LinearRegressionBuilder::lime_backward_computation(
     delete[] regularized_gradients;
   }
 
-  djcs_t_free_public_key(phe_pub_key);
   delete[] encrypted_batch_losses;
   for (int i = 0; i < cur_batch_size; i++) {
     delete[] encoded_batch_samples[i];
@@ -700,16 +718,12 @@ void LinearRegressionBuilder::compute_l1_regularized_grad(
   // step 4
   // the spdz_linear_regression_computation will do the extracting sign with
   // *(-1) operation
-  std::promise<std::vector<double>> promise_values;
-  std::future<std::vector<double>> future_values = promise_values.get_future();
-  std::thread spdz_thread(
-      spdz_linear_regression_computation, party.party_num, party.party_id,
-      party.executor_mpc_ports, SPDZ_PLAYER_PATH, party.host_names,
-      global_weights_shares, global_weight_size, &promise_values);
+  std::future<std::vector<double>> future_values =
+      spdz_computation_async(spdz_linear_regression_computation,
+                             party.spdz_session, global_weights_shares,
+                             global_weight_size);
 
   std::vector<double> global_regularized_sign_shares = future_values.get();
-  // main thread wait spdz_thread to finish
-  spdz_thread.join();
 
   log_info("[compute_l1_regularized_grad]: finish connect to spdz parties and "
            "receive result shares");
@@ -726,8 +740,8 @@ void LinearRegressionBuilder::compute_l1_regularized_grad(
            "shares to ciphers");
 
   // step 6
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   EncodedNumber regularization_hyper_param;
   regularization_hyper_param.set_double(phe_pub_key->n[0], alpha,
                                         PHE_FIXED_POINT_PRECISION);
@@ -750,13 +764,12 @@ void LinearRegressionBuilder::compute_l1_regularized_grad(
 
   delete[] global_weights;
   delete[] global_regularized_grad;
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void LinearRegressionBuilder::update_encrypted_weights(
     Party &party, EncodedNumber *encrypted_gradients) {
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   // update the j-th weight in local_weight vector
   // need to make sure that the exponents of inner_product
   // and local weights are the same
@@ -778,65 +791,18 @@ void LinearRegressionBuilder::update_encrypted_weights(
                                                 PHE_FIXED_POINT_PRECISION);
   }
 
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void spdz_linear_regression_computation(
-    int party_num, int party_id, std::vector<int> mpc_port_bases,
-    const std::string &mpc_player_path,
-    std::vector<std::string> party_host_names,
+    std::shared_ptr<SpdzSession> spdz_session,
     const std::vector<double> &global_weights_shares, int global_weight_size,
     std::promise<std::vector<double>> *regularized_grad_shares) {
-  // Here put the whole setup socket code together, as using a function call
-  // would result in a problem when deleting the created sockets
-  // setup connections from this party to each spdz party socket
-  std::vector<ssl_socket *> mpc_sockets(party_num);
-  vector<int> plain_sockets(party_num);
-  // ssl_ctx ctx(mpc_player_path, "C" + to_string(party_id));
-  ssl_ctx ctx("C" + to_string(party_id));
-  // std::cout << "correct init ctx" << std::endl;
-  ssl_service io_service;
-  octetStream specification;
-  log_info("begin connect to spdz parties");
-  log_info("party_num = " + std::to_string(party_num));
-  for (int i = 0; i < party_num; i++) {
-    log_info("[spdz_linear_regression_computation]: "
-             "base:" +
-             std::to_string(mpc_port_bases[i]) + ", mpc_port_bases[i] + i: " +
-             std::to_string(mpc_port_bases[i] + i));
-
-    set_up_client_socket(plain_sockets[i], party_host_names[i].c_str(),
-                         mpc_port_bases[i] + i);
-    send(plain_sockets[i], (octet *)&party_id, sizeof(int));
-    mpc_sockets[i] =
-        new ssl_socket(io_service, ctx, plain_sockets[i], "P" + to_string(i),
-                       "C" + to_string(party_id), true);
-    if (i == 0) {
-      // receive gfp prime
-      specification.Receive(mpc_sockets[0]);
-    }
-    LOG(INFO) << "Set up socket connections for " << i
-              << "-th spdz party succeed,"
-                 " sockets = "
-              << mpc_sockets[i] << ", port_num = " << mpc_port_bases[i] + i
-              << ".";
-  }
-  log_info("Finish setup socket connections to spdz engines.");
-  int type = specification.get<int>();
-  switch (type) {
-  case 'p': {
-    gfp::init_field(specification.get<bigint>());
-    LOG(INFO) << "Using prime " << gfp::pr();
-    break;
-  }
-  default:
-    LOG(ERROR) << "Type " << type << " not implemented";
-    exit(EXIT_FAILURE);
-  }
-  log_info("Finish initializing gfp field.");
-  // std::cout << "Finish initializing gfp field." << std::endl;
-  // std::cout << "batch aggregation size = " << batch_aggregation_shares.size()
-  // << std::endl;
+  // the computation runs on the party's spdz connections, which are opened
+  // by the first computation of the session
+  SpdzComputation computation(*spdz_session);
+  std::vector<ssl_socket *> &mpc_sockets = computation.sockets();
+  int party_num = spdz_session->getter_party_num();
+  int party_id = spdz_session->getter_party_id();
 
   // send data to spdz parties
   if (party_id == ACTIVE_PARTY_ID) {
@@ -856,16 +822,6 @@ void spdz_linear_regression_computation(
   std::vector<double> return_values =
       receive_result(mpc_sockets, party_num, global_weight_size);
   regularized_grad_shares->set_value(return_values);
-
-  for (int i = 0; i < party_num; i++) {
-    close_client_socket(plain_sockets[i]);
-  }
-
-  // free memory and close mpc_sockets
-  for (int i = 0; i < party_num; i++) {
-    delete mpc_sockets[i];
-    mpc_sockets[i] = nullptr;
-  }
 }
 
 void LinearRegressionBuilder::train(Party party) {
@@ -925,6 +881,8 @@ void LinearRegressionBuilder::train(Party party) {
 
   // step 2: iteratively computation
   for (int iter = 0; iter < max_iteration; iter++) {
+    // release the gmp blocks cached by the previous iteration
+    gmp_arena_reset();
     log_info("-------- Iteration " + std::to_string(iter) + " --------");
     struct timespec iter_start;
     clock_gettime(CLOCK_MONOTONIC, &iter_start);
@@ -1085,6 +1043,8 @@ void LinearRegressionBuilder::lime_train(
 
   // step 2: iteratively computation
   for (int iter = 0; iter < max_iteration; iter++) {
+    // release the gmp blocks cached by the previous iteration
+    gmp_arena_reset();
     log_info("-------- Iteration " + std::to_string(iter) + " --------");
     struct timespec iter_start;
     clock_gettime(CLOCK_MONOTONIC, &iter_start);
@@ -1247,6 +1207,8 @@ void LinearRegressionBuilder::distributed_train(const Party &party,
   bigint::init_thread();
 
   for (int iter = 0; iter < max_iteration; iter++) {
+    // release the gmp blocks cached by the previous iteration
+    gmp_arena_reset();
     struct timespec iter_start;
     clock_gettime(CLOCK_MONOTONIC, &iter_start);
     log_info("-------- Worker Iteration " + std::to_string(iter) + " --------");
@@ -1416,6 +1378,8 @@ void LinearRegressionBuilder::distributed_lime_train(
   bigint::init_thread();
 
   for (int iter = 0; iter < max_iteration; iter++) {
+    // release the gmp blocks cached by the previous iteration
+    gmp_arena_reset();
     struct timespec iter_start;
     clock_gettime(CLOCK_MONOTONIC, &iter_start);
     log_info("-------- Worker Iteration " + std::to_string(iter) + " --------");
@@ -1578,10 +1542,6 @@ void LinearRegressionBuilder::eval(Party party, falcon::DatasetType eval_type,
   //     predicted labels step 3: active party aggregates and call collaborative
   //     decryption step 4: active party computes mse metrics
 
-  // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
-
   // step 1: init test data
   int dataset_size = (eval_type == falcon::TRAIN) ? (int)training_data.size()
                                                   : (int)testing_data.size();
@@ -1612,7 +1572,6 @@ void LinearRegressionBuilder::eval(Party party, falcon::DatasetType eval_type,
   }
 
   // free memory
-  djcs_t_free_public_key(phe_pub_key);
   delete[] predicted_labels;
   delete[] decrypted_labels;
 
@@ -1641,10 +1600,6 @@ LinearRegressionBuilder::loss_computation(const Party &party,
   struct timespec start;
   clock_gettime(CLOCK_MONOTONIC, &start);
 
-  // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
-
   // step 1: init test data
   int dataset_size = (dataset_type == falcon::TRAIN) ? (int)training_data.size()
                                                      : (int)testing_data.size();
@@ -1729,7 +1684,6 @@ LinearRegressionBuilder::loss_computation(const Party &party,
   log_info("The loss on " + dataset_str + " is: " + std::to_string(loss));
 
   // free memory
-  djcs_t_free_public_key(phe_pub_key);
   delete[] encrypted_aggregation;
   delete[] decrypted_aggregation;
 
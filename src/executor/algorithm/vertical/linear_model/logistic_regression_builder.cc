@@ -32,6 +32,8 @@ SOFTWARE.
 #include <falcon/algorithm/vertical/linear_model/logistic_regression_builder.h>
 #include <falcon/common.h>
 #include <falcon/operator/conversion/op_conv.h>
+#include <falcon/operator/mpc/spdz_session.h>
+#include <falcon/operator/phe/gmp_arena.h>
 #include <falcon/party/info_exchange.h>
 #include <falcon/utils/logger/logger.h>
 #include <falcon/utils/math/math_ops.h>
@@ -92,8 +94,8 @@ void LogisticRegressionBuilder::backward_computation(
     int precision, EncodedNumber *encrypted_gradients) {
 
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   // convert batch loss shares back to encrypted losses
   int cur_batch_size = (int)batch_indexes.size();
@@ -106,8 +108,8 @@ void LogisticRegressionBuilder::backward_computation(
       batch_true_labels[i].set_double(phe_pub_key->n[0],
                                       training_labels[batch_indexes[i]],
                                       predicted_label_precision);
-      djcs_t_aux_encrypt(phe_pub_key, party.phe_random, batch_true_labels[i],
-                         batch_true_labels[i]);
+      djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                         batch_true_labels[i], batch_true_labels[i]);
     }
   }
 
@@ -151,13 +153,18 @@ void LogisticRegressionBuilder::backward_computation(
     for (int i = 0; i < cur_batch_size; i++) {
       batch_feature_j[i] = encoded_batch_samples[i][j];
     }
-    djcs_t_aux_inner_product(phe_pub_key, party.phe_random, gradient,
-                             encrypted_batch_losses, batch_feature_j,
-                             cur_batch_size);
+    djcs_t_aux_signed_inner_product(phe_pub_key, gradient,
+                                    encrypted_batch_losses, batch_feature_j,
+                                    cur_batch_size);
     common_gradients[j] = gradient;
 
     delete[] batch_feature_j;
   }
+  // the gradients are deterministic in the local samples and end up in the
+  // weights sent to other parties, so they are re-randomized
+  djcs_t_aux_vec_rerandomize(phe_pub_key, party.phe_random_pool.get(),
+                             common_gradients, common_gradients,
+                             log_reg_model.weight_size);
 
   if (!with_regularization) {
     // if without regularization, directly assign the common gradients
@@ -181,8 +188,10 @@ void LogisticRegressionBuilder::backward_computation(
                                   PHE_FIXED_POINT_PRECISION);
       // first compute the regularized gradients
       for (int j = 0; j < log_reg_model.weight_size; j++) {
-        djcs_t_aux_ep_mul(phe_pub_key, regularized_gradients[j],
-                          log_reg_model.local_weights[j], encoded_constant);
+        // fold the alignment to the common gradients into the constant
+        djcs_t_aux_ep_mul_ext(phe_pub_key, regularized_gradients[j],
+                              log_reg_model.local_weights[j], encoded_constant,
+                              common_gradients_precision);
       }
       //  20220621: this is not necessary, can increase the exponents via
       //  djsc_t_aux_ee_add_ext
@@ -219,8 +228,10 @@ void LogisticRegressionBuilder::backward_computation(
                                   PHE_FIXED_POINT_PRECISION);
       // then, add the second item to the common_gradients
       for (int j = 0; j < log_reg_model.weight_size; j++) {
-        djcs_t_aux_ep_mul(phe_pub_key, regularized_gradients[j],
-                          regularized_gradients[j], encoded_constant);
+        // fold the alignment to the common gradients into the constant
+        djcs_t_aux_ep_mul_ext(phe_pub_key, regularized_gradients[j],
+                              regularized_gradients[j], encoded_constant,
+                              common_gradients_precision);
         djcs_t_aux_ee_add_ext(phe_pub_key, encrypted_gradients[j],
                               common_gradients[j], regularized_gradients[j]);
       }
@@ -233,7 +244,6 @@ void LogisticRegressionBuilder::backward_computation(
     //    }
   }
 
-  djcs_t_free_public_key(phe_pub_key);
   // hcs_free_random(phe_random);
   delete[] encrypted_batch_losses;
   delete[] batch_true_labels;
@@ -314,16 +324,12 @@ void LogisticRegressionBuilder::compute_l1_regularized_grad(
   // the spdz_logistic_function_computation will do the extracting sign with
   // *(-1) operation
   falcon::SpdzLogRegCompType comp_type = falcon::L1_REGULARIZATION;
-  std::promise<std::vector<double>> promise_values;
-  std::future<std::vector<double>> future_values = promise_values.get_future();
-  std::thread spdz_thread(
-      spdz_logistic_function_computation, party.party_num, party.party_id,
-      party.executor_mpc_ports, SPDZ_PLAYER_PATH, party.host_names,
-      global_weights_shares, global_weight_size, comp_type, &promise_values);
+  std::future<std::vector<double>> future_values =
+      spdz_computation_async(spdz_logistic_function_computation,
+                             party.spdz_session, global_weights_shares,
+                             global_weight_size, comp_type);
 
   std::vector<double> global_regularized_sign_shares = future_values.get();
-  // main thread wait spdz_thread to finish
-  spdz_thread.join();
 
   log_info("[compute_l1_regularized_grad]: finish connect to spdz parties and "
            "receive result shares");
@@ -338,8 +344,8 @@ void LogisticRegressionBuilder::compute_l1_regularized_grad(
            "shares to ciphers");
 
   // step 6
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   EncodedNumber regularization_hyper_param;
   regularization_hyper_param.set_double(phe_pub_key->n[0], alpha,
                                         PHE_FIXED_POINT_PRECISION);
@@ -362,13 +368,12 @@ void LogisticRegressionBuilder::compute_l1_regularized_grad(
 
   delete[] global_weights;
   delete[] global_regularized_grad;
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void LogisticRegressionBuilder::update_encrypted_weights(
     Party &party, EncodedNumber *encrypted_gradients) {
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   // update the j-th weight in local_weight vector
   // need to make sure that the exponents of inner_product
@@ -386,7 +391,6 @@ void LogisticRegressionBuilder::update_encrypted_weights(
       PHE_MAXIMUM_PRECISION) {
     log_reg_model.truncate_weights_precision(party, PHE_FIXED_POINT_PRECISION);
   }
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void LogisticRegressionBuilder::train(Party party) {
@@ -494,6 +498,8 @@ void LogisticRegressionBuilder::train(Party party) {
 
   // step 2: iteratively computation
   for (int iter = 0; iter < max_iteration; iter++) {
+    // release the gmp blocks cached by the previous iteration
+    gmp_arena_reset();
     log_info("-------- Iteration " + std::to_string(iter) + " --------");
     struct timespec iter_start_time;
     clock_gettime(CLOCK_MONOTONIC, &iter_start_time);
@@ -680,6 +686,8 @@ void LogisticRegressionBuilder::distributed_train(const Party &party,
   bigint::init_thread();
 
   for (int iter = 0; iter < max_iteration; iter++) {
+    // release the gmp blocks cached by the previous iteration
+    gmp_arena_reset();
     struct timespec iter_start_time;
     clock_gettime(CLOCK_MONOTONIC, &iter_start_time);
 
@@ -871,10 +879,6 @@ void LogisticRegressionBuilder::eval(Party party, falcon::DatasetType eval_type,
   ///     collaborative decryption step 4: active party computes the logistic
   ///     function and compare the clf metrics
 
-  // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
-
   // step 1: init test data
   int dataset_size =
       (eval_type == falcon::TRAIN) ? training_data.size() : testing_data.size();
@@ -902,7 +906,6 @@ void LogisticRegressionBuilder::eval(Party party, falcon::DatasetType eval_type,
   }
 
   // free memory
-  djcs_t_free_public_key(phe_pub_key);
   delete[] predicted_labels;
   delete[] decrypted_labels;
 
@@ -1036,10 +1039,6 @@ void LogisticRegressionBuilder::loss_computation(
   std::string dataset_str =
       (dataset_type == falcon::TRAIN ? "training dataset" : "testing dataset");
 
-  // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
-
   // step 1: init test data
   int dataset_size = (dataset_type == falcon::TRAIN) ? (int)training_data.size()
                                                      : (int)testing_data.size();
@@ -1102,7 +1101,6 @@ void LogisticRegressionBuilder::loss_computation(
   }
 
   // free memory
-  djcs_t_free_public_key(phe_pub_key);
   delete[] encrypted_aggregation;
   delete[] decrypted_aggregation;
 
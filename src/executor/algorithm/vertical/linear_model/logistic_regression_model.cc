@@ -31,6 +31,7 @@ SOFTWARE.
 #include <falcon/common.h>
 #include <falcon/operator/conversion/op_conv.h>
 #include <falcon/operator/mpc/spdz_connector.h>
+#include <falcon/operator/mpc/spdz_session.h>
 #include <falcon/party/info_exchange.h>
 #include <falcon/utils/logger/logger.h>
 #include <falcon/utils/pb_converter/common_converter.h>
@@ -94,8 +95,8 @@ void LogisticRegressionModel::predict_proba(
     const Party &party, std::vector<std::vector<double>> predicted_samples,
     EncodedNumber **predicted_labels) const {
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   // note that currently only support 2-class classification
   int cur_sample_size = (int)predicted_samples.size();
   int feature_num = (int)predicted_samples[0].size();
@@ -122,7 +123,7 @@ void LogisticRegressionModel::predict_proba(
     EncodedNumber pos_one_double, neg_one_int;
     pos_one_double.set_double(phe_pub_key->n[0], positive_one,
                               prediction_precision);
-    djcs_t_aux_encrypt(phe_pub_key, party.phe_random, pos_one_double,
+    djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(), pos_one_double,
                        pos_one_double);
     neg_one_int.set_integer(phe_pub_key->n[0], negative_one);
     for (int i = 0; i < cur_sample_size; i++) {
@@ -142,7 +143,6 @@ void LogisticRegressionModel::predict_proba(
     predicted_labels[i][0] = predicted_labels_neg[i];
     predicted_labels[i][1] = predicted_labels_pos[i];
   }
-  djcs_t_free_public_key(phe_pub_key);
   delete[] predicted_labels_pos;
   delete[] predicted_labels_neg;
 }
@@ -173,15 +173,11 @@ void LogisticRegressionModel::forward_computation(
   // step 2.3: communicate with spdz parties and receive results
   // the spdz_logistic_function_computation will do the 1/(1+e^(wx)) operation
   falcon::SpdzLogRegCompType comp_type = falcon::LOG_FUNC;
-  std::promise<std::vector<double>> promise_values;
-  std::future<std::vector<double>> future_values = promise_values.get_future();
-  std::thread spdz_thread(
-      spdz_logistic_function_computation, party.party_num, party.party_id,
-      party.executor_mpc_ports, SPDZ_PLAYER_PATH, party.host_names,
-      batch_aggregation_shares, cur_batch_size, comp_type, &promise_values);
+  std::future<std::vector<double>> future_values =
+      spdz_computation_async(spdz_logistic_function_computation,
+                             party.spdz_session, batch_aggregation_shares,
+                             cur_batch_size, comp_type);
   vector<double> batch_logistic_shares = future_values.get();
-  // main thread wait spdz_thread to finish
-  spdz_thread.join();
   log_info("[forward_computation]: call spdz_logistic_function_computation to "
            "do 1/(1+e^(wx)) operation success");
 
@@ -218,62 +214,16 @@ void retrieve_prediction_result(
 }
 
 void spdz_logistic_function_computation(
-    int party_num, int party_id, std::vector<int> mpc_port_bases,
-    const std::string &mpc_player_path,
-    std::vector<std::string> party_host_names,
+    std::shared_ptr<SpdzSession> spdz_session,
     std::vector<double> private_values, int private_value_size,
     falcon::SpdzLogRegCompType comp_type,
     std::promise<std::vector<double>> *res_shares) {
-  // Here put the whole setup socket code together, as using a function call
-  // would result in a problem when deleting the created sockets
-  // setup connections from this party to each spdz party socket
-  std::vector<ssl_socket *> mpc_sockets(party_num);
-  vector<int> plain_sockets(party_num);
-  // ssl_ctx ctx(mpc_player_path, "C" + to_string(party_id));
-  ssl_ctx ctx("C" + to_string(party_id));
-  // std::cout << "correct init ctx" << std::endl;
-  ssl_service io_service;
-  octetStream specification;
-  log_info("begin connect to spdz parties");
-  log_info("party_num = " + std::to_string(party_num));
-  for (int i = 0; i < party_num; i++) {
-    log_info("[spdz_logistic_function_computation]: "
-             "base:" +
-             std::to_string(mpc_port_bases[i]) + ", mpc_port_bases[i] + i: " +
-             std::to_string(mpc_port_bases[i] + i));
-
-    set_up_client_socket(plain_sockets[i], party_host_names[i].c_str(),
-                         mpc_port_bases[i] + i);
-    send(plain_sockets[i], (octet *)&party_id, sizeof(int));
-    mpc_sockets[i] =
-        new ssl_socket(io_service, ctx, plain_sockets[i], "P" + to_string(i),
-                       "C" + to_string(party_id), true);
-    if (i == 0) {
-      // receive gfp prime
-      specification.Receive(mpc_sockets[0]);
-    }
-    LOG(INFO) << "Set up socket connections for " << i
-              << "-th spdz party succeed,"
-                 " sockets = "
-              << mpc_sockets[i] << ", port_num = " << mpc_port_bases[i] + i
-              << ".";
-  }
-  log_info("Finish setup socket connections to spdz engines.");
-  int type = specification.get<int>();
-  switch (type) {
-  case 'p': {
-    gfp::init_field(specification.get<bigint>());
-    LOG(INFO) << "Using prime " << gfp::pr();
-    break;
-  }
-  default:
-    LOG(ERROR) << "Type " << type << " not implemented";
-    exit(1);
-  }
-  log_info("Finish initializing gfp field.");
-  // std::cout << "Finish initializing gfp field." << std::endl;
-  // std::cout << "batch aggregation size = " << batch_aggregation_shares.size()
-  // << std::endl;
+  // the computation runs on the party's spdz connections, which are opened
+  // by the first computation of the session
+  SpdzComputation computation(*spdz_session);
+  std::vector<ssl_socket *> &mpc_sockets = computation.sockets();
+  int party_num = spdz_session->getter_party_num();
+  int party_id = spdz_session->getter_party_id();
 
   // send data to spdz parties
   if (party_id == ACTIVE_PARTY_ID) {
@@ -299,14 +249,4 @@ void spdz_logistic_function_computation(
   std::vector<double> return_values =
       receive_result(mpc_sockets, party_num, private_value_size);
   res_shares->set_value(return_values);
-
-  for (int i = 0; i < party_num; i++) {
-    close_client_socket(plain_sockets[i]);
-  }
-
-  // free memory and close mpc_sockets
-  for (int i = 0; i < party_num; i++) {
-    delete mpc_sockets[i];
-    mpc_sockets[i] = nullptr;
-  }
 }
@@ -115,8 +115,8 @@ Layer::~Layer() {
 
 void Layer::init_encrypted_weights(const Party &party, int precision) {
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   // according to sklearn init coef function, here
   // set factor=6.0 if the activation function is not 'logistic' or 'sigmoid'
@@ -155,18 +155,19 @@ void Layer::init_encrypted_weights(const Party &party, int precision) {
     for (int j = 0; j < m_num_outputs; j++) {
       EncodedNumber t;
       t.set_double(phe_pub_key->n[0], plain_rand_weight_mat[i][j], precision);
-      djcs_t_aux_encrypt(phe_pub_key, party.phe_random, m_weight_mat[i][j], t);
+      djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                         m_weight_mat[i][j], t);
     }
   }
   if (m_fit_bias) {
     for (int j = 0; j < m_num_outputs; j++) {
       EncodedNumber t;
       t.set_double(phe_pub_key->n[0], plain_rand_bias_vec[j], precision);
-      djcs_t_aux_encrypt(phe_pub_key, party.phe_random, m_bias[j], t);
+      djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(), m_bias[j],
+                         t);
     }
   }
 
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void Layer::comp_1st_layer_agg_output(
@@ -181,8 +182,8 @@ void Layer::comp_1st_layer_agg_output(
     exit(EXIT_FAILURE);
   }
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   int precision = std::abs(encoded_batch_samples[0][0].getter_exponent()) +
                   std::abs(m_weight_mat[0][0].getter_exponent());
@@ -238,6 +239,13 @@ void Layer::comp_1st_layer_agg_output(
                              local_weight_mat, encoded_batch_samples,
                              local_n_features, m_num_outputs, cur_batch_size,
                              local_n_features);
+  // the products are deterministic in the local samples, so they are
+  // re-randomized before leaving the party
+  for (int i = 0; i < cur_batch_size; i++) {
+    djcs_t_aux_vec_rerandomize(phe_pub_key, party.phe_random_pool.get(),
+                               local_mat_mul_res[i], local_mat_mul_res[i],
+                               m_num_outputs);
+  }
   log_info("[comp_1st_layer_agg_output] djcs_t_aux_mat_mat_ep_mult finished");
 
   // the active party aggregate the result and broadcast
@@ -312,7 +320,6 @@ void Layer::comp_1st_layer_agg_output(
     delete[] local_mat_mul_res[i];
   }
   delete[] local_mat_mul_res;
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void Layer::comp_other_layer_agg_output(
@@ -335,8 +342,8 @@ void Layer::comp_other_layer_agg_output(
     exit(EXIT_FAILURE);
   }
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   //  log_info("[comp_other_layer_agg_output] display mlp model m_weight_mat for
   //  debug"); display_encrypted_matrix(party, m_num_inputs, m_num_outputs,
@@ -429,5 +436,4 @@ void Layer::comp_other_layer_agg_output(
     delete[] ciphers_shares_mul_res[i];
   }
   delete[] ciphers_shares_mul_res;
-  djcs_t_free_public_key(phe_pub_key);
 }
\ No newline at end of file
@@ -29,6 +29,7 @@ SOFTWARE.
 #include <falcon/algorithm/model_builder_helper.h>
 #include <falcon/algorithm/vertical/nn/mlp.h>
 #include <falcon/operator/conversion/op_conv.h>
+#include <falcon/operator/mpc/spdz_session.h>
 #include <falcon/party/info_exchange.h>
 #include <falcon/utils/alg/vec_util.h>
 #include <falcon/utils/logger/logger.h>
@@ -113,8 +114,8 @@ void MlpModel::predict(
            std::to_string(m_is_classification));
 
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   int pred_size = (int)predicted_samples.size();
   int label_size = m_num_outputs;
@@ -160,8 +161,8 @@ void MlpModel::predict(
         decrypted_labels_pos[i].decode(x);
         double label = (x >= LOGREG_THRES) ? 1.0 : 0.0;
         predicted_labels[i].set_double(phe_pub_key->n[0], label);
-        djcs_t_aux_encrypt(phe_pub_key, party.phe_random, predicted_labels[i],
-                           predicted_labels[i]);
+        djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                           predicted_labels[i], predicted_labels[i]);
       }
     }
     broadcast_encoded_number_array(party, predicted_labels, pred_size,
@@ -184,8 +185,8 @@ void MlpModel::predict(
         }
         double arg = argmax(labels_i);
         predicted_labels[i].set_double(phe_pub_key->n[0], arg);
-        djcs_t_aux_encrypt(phe_pub_key, party.phe_random, predicted_labels[i],
-                           predicted_labels[i]);
+        djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                           predicted_labels[i], predicted_labels[i]);
       }
       delete[] decrypted_labels_i;
     }
@@ -199,7 +200,6 @@ void MlpModel::predict(
     delete[] predicted_labels_proba[i];
   }
   delete[] predicted_labels_proba;
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void MlpModel::predict_proba(
@@ -210,8 +210,8 @@ void MlpModel::predict_proba(
            std::to_string(m_is_classification));
 
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   int pred_size = (int)predicted_samples.size();
   std::vector<int> local_weight_sizes =
@@ -245,8 +245,8 @@ void MlpModel::predict_proba(
       EncodedNumber pos_one_double, neg_one_int;
       pos_one_double.set_double(phe_pub_key->n[0], positive_one,
                                 prediction_precision);
-      djcs_t_aux_encrypt(phe_pub_key, party.phe_random, pos_one_double,
-                         pos_one_double);
+      djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                         pos_one_double, pos_one_double);
       neg_one_int.set_integer(phe_pub_key->n[0], negative_one);
       for (int i = 0; i < pred_size; i++) {
         EncodedNumber label_neg;
@@ -282,15 +282,14 @@ void MlpModel::predict_proba(
   }
   delete[] encoded_batch_samples;
   delete[] forward_predictions;
-  djcs_t_free_public_key(phe_pub_key);
 }
 
-void MlpModel::forward_computation(const Party &party, int cur_batch_size,
-                                   const std::vector<int> &local_weight_sizes,
-                                   EncodedNumber **encoded_batch_samples,
-                                   EncodedNumber **predicted_labels,
-                                   TripleDVec &activation_shares,
-                                   TripleDVec &deriv_activation_shares) const {
+void MlpModel::forward_computation(
+    const Party &party, int cur_batch_size,
+    const std::vector<int> &local_weight_sizes,
+    EncodedNumber **encoded_batch_samples, EncodedNumber **predicted_labels,
+    TripleDVec &activation_shares, TripleDVec &deriv_activation_shares,
+    const std::function<void()> &overlap) const {
   // we compute the forward computation layer-by-layer
   // for the first hidden layer, the input is the encoded_batch_samples
   // distributed among parties for the other layers, the input is the secret
@@ -365,18 +364,19 @@ void MlpModel::forward_computation(const Party &party, int cur_batch_size,
     public_values.push_back(func);
 
     falcon::SpdzMlpCompType comp_type = falcon::ACTIVATION;
-    std::promise<std::vector<double>> promise_values;
     std::future<std::vector<double>> future_values =
-        promise_values.get_future();
-    std::thread spdz_pruning_check_thread(
-        spdz_mlp_computation, party.party_num, party.party_id,
-        party.executor_mpc_ports, party.host_names, public_values.size(),
-        public_values, flatten_layer_enc_outputs_shares.size(),
-        flatten_layer_enc_outputs_shares, comp_type, &promise_values);
+        spdz_computation_async(spdz_mlp_computation, party.spdz_session,
+                               public_values.size(), public_values,
+                               flatten_layer_enc_outputs_shares.size(),
+                               flatten_layer_enc_outputs_shares, comp_type);
+    // the output layer is the last spdz computation of the batch, so the
+    // work for the next batch can run while it is pending
+    if (overlap && l_idx == m_n_layers - 2) {
+      overlap();
+    }
     // the result values are as follows (assume to be private, i.e., secret
     // shares):
     std::vector<double> spdz_res = future_values.get();
-    spdz_pruning_check_thread.join();
     log_info("[forward_computation]: communicate with spdz finished");
     log_info("[forward_computation]: spdz_res.size() = " +
              std::to_string(spdz_res.size()));
@@ -527,18 +527,14 @@ void MlpModel::forward_computation_fast(
     public_values.push_back(func);
 
     falcon::SpdzMlpCompType comp_type = falcon::ACTIVATION_FAST;
-    std::promise<std::vector<double>> promise_values;
     std::future<std::vector<double>> future_values =
-        promise_values.get_future();
-    std::thread spdz_pruning_check_thread(
-        spdz_mlp_computation, party.party_num, party.party_id,
-        party.executor_mpc_ports, party.host_names, public_values.size(),
-        public_values, flatten_layer_enc_outputs_shares.size(),
-        flatten_layer_enc_outputs_shares, comp_type, &promise_values);
+        spdz_computation_async(spdz_mlp_computation, party.spdz_session,
+                               public_values.size(), public_values,
+                               flatten_layer_enc_outputs_shares.size(),
+                               flatten_layer_enc_outputs_shares, comp_type);
     // the result values are as follows (assume to be private, i.e., secret
     // shares):
     std::vector<double> res = future_values.get();
-    spdz_pruning_check_thread.join();
     log_info("[forward_computation_fast]: communicate with spdz finished");
 
     //    for (int i = 0; i < flatten_layer_enc_outputs_shares.size(); i++) {
@@ -628,74 +624,20 @@ void MlpModel::display_model(const Party &party) {
   }
 }
 
-void spdz_mlp_computation(int party_num, int party_id,
-                          std::vector<int> mpc_port_bases,
-                          std::vector<std::string> party_host_names,
+void spdz_mlp_computation(std::shared_ptr<SpdzSession> spdz_session,
                           int public_value_size,
                           const std::vector<int> &public_values,
                           int private_value_size,
                           const std::vector<double> &private_values,
                           falcon::SpdzMlpCompType mlp_comp_type,
                           std::promise<std::vector<double>> *res) {
-  std::vector<ssl_socket *> mpc_sockets(party_num);
-  //  setup_sockets(party_num,
-  //                party_id,
-  //                std::move(mpc_player_path),
-  //                std::move(party_host_names),
-  //                mpc_port_base,
-  //                mpc_sockets);
-  // Here put the whole setup socket code together, as using a function call
-  // would result in a problem when deleting the created sockets
-  // setup connections from this party to each spdz party socket
-  vector<int> plain_sockets(party_num);
-  // ssl_ctx ctx(mpc_player_path, "C" + to_string(party_id));
-  ssl_ctx ctx("C" + to_string(party_id));
-  // std::cout << "correct init ctx" << std::endl;
-  ssl_service io_service;
-  octetStream specification;
-  log_info("[spdz_mlp_computation] begin connect to spdz parties");
-  log_info("[spdz_mlp_computation] party_num = " + std::to_string(party_num));
-  for (int i = 0; i < party_num; i++) {
-    set_up_client_socket(plain_sockets[i], party_host_names[i].c_str(),
-                         mpc_port_bases[i] + i);
-    send(plain_sockets[i], (octet *)&party_id, sizeof(int));
-    mpc_sockets[i] =
-        new ssl_socket(io_service, ctx, plain_sockets[i], "P" + to_string(i),
-                       "C" + to_string(party_id), true);
-    if (i == 0) {
-      // receive gfp prime
-      specification.Receive(mpc_sockets[0]);
-    }
-    std::cout << "Set up socket connections for " << i
-              << "-th spdz party succeed,"
-                 " sockets = "
-              << mpc_sockets[i] << ", port_num = " << mpc_port_bases[i] + i
-              << "." << endl;
-    LOG(INFO) << "Set up socket connections for " << i
-              << "-th spdz party succeed,"
-                 " sockets = "
-              << mpc_sockets[i] << ", port_num = " << mpc_port_bases[i] + i
-              << ".";
-  }
-  log_info("[spdz_mlp_computation] Finish setup socket connections to spdz "
-           "engines.");
-  int type = specification.get<int>();
-  switch (type) {
-  case 'p': {
-    gfp::init_field(specification.get<bigint>());
-    std::cout << "Using prime " << gfp::pr() << std::endl;
-    LOG(INFO) << "Using prime " << gfp::pr();
-    break;
-  }
-  default:
-    log_info("[spdz_mlp_computation] Type " + std::to_string(type) +
-             " not implemented");
-    exit(EXIT_FAILURE);
-  }
-  log_info("[spdz_mlp_computation] Finish initializing gfp field.");
-  // std::cout << "Finish initializing gfp field." << std::endl;
-  // std::cout << "batch aggregation size = " << batch_aggregation_shares.size()
-  // << std::endl; send data to spdz parties
+  // the computation runs on the party's spdz connections, which are opened
+  // by the first computation of the session
+  SpdzComputation computation(*spdz_session);
+  std::vector<ssl_socket *> &mpc_sockets = computation.sockets();
+  int party_num = spdz_session->getter_party_num();
+  int party_id = spdz_session->getter_party_id();
+
   log_info("[spdz_mlp_computation] party_id = " + std::to_string(party_id));
   if (party_id == ACTIVE_PARTY_ID) {
     // the active party sends computation id for spdz computation
@@ -743,14 +685,4 @@ void spdz_mlp_computation(int party_num, int party_id,
     log_info("[spdz_mlp_computation] SPDZ mlp computation type is not found.");
     exit(EXIT_FAILURE);
   }
-
-  for (int i = 0; i < party_num; i++) {
-    close_client_socket(plain_sockets[i]);
-  }
-
-  // free memory and close mpc_sockets
-  for (int i = 0; i < party_num; i++) {
-    delete mpc_sockets[i];
-    mpc_sockets[i] = nullptr;
-  }
 }
\ No newline at end of file
@@ -32,6 +32,7 @@ SOFTWARE.
 #include <falcon/common.h>
 #include <falcon/model/model_io.h>
 #include <falcon/operator/conversion/op_conv.h>
+#include <falcon/operator/phe/gmp_arena.h>
 #include <falcon/operator/mpc/spdz_connector.h>
 #include <falcon/party/info_exchange.h>
 #include <falcon/utils/alg/vec_util.h>
@@ -320,8 +321,8 @@ void MlpBuilder::compute_last_layer_delta(
     EncodedNumber ***deltas, const std::vector<int> &batch_indexes) {
   log_info("[compute_last_layer_delta] computing the last layer delta");
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   int prec = (int)std::abs(predicted_labels[0][0].getter_exponent());
   int cur_sample_size = (int)batch_indexes.size();
@@ -368,7 +369,6 @@ void MlpBuilder::compute_last_layer_delta(
       "[MlpBuilder::compute_last_layer_delta] deltas[layer_idx][0][0].prec = " +
       std::to_string(std::abs(deltas[layer_idx][0][0].getter_exponent())));
 
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void MlpBuilder::compute_loss_grad(
@@ -392,8 +392,8 @@ void MlpBuilder::compute_loss_grad(
            std::to_string(layer_idx));
 
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   int ciphers_row_size = sample_size;
   int ciphers_column_size = mlp_model.m_layers[layer_idx].m_num_outputs;
@@ -481,6 +481,13 @@ void MlpBuilder::compute_loss_grad(
                                deltas[layer_idx], encoded_trans_batch_samples,
                                sample_size, layer_output_size, local_n_features,
                                sample_size);
+    // the products are deterministic in the local samples, so they are
+    // re-randomized before leaving the party
+    for (int i = 0; i < local_n_features; i++) {
+      djcs_t_aux_vec_rerandomize(phe_pub_key, party.phe_random_pool.get(),
+                                 local_agg_mat[i], local_agg_mat[i],
+                                 layer_output_size);
+    }
 
     log_info("[compute_loss_grad] finish local aggregation");
 
@@ -594,8 +601,8 @@ void MlpBuilder::compute_loss_grad(
              std::to_string(layer_delta_prec));
     for (int i = 0; i < ciphers_column_size; i++) {
       layer_bias_grad[i].set_double(phe_pub_key->n[0], 0.0, layer_delta_prec);
-      djcs_t_aux_encrypt(phe_pub_key, party.phe_random, layer_bias_grad[i],
-                         layer_bias_grad[i]);
+      djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                         layer_bias_grad[i], layer_bias_grad[i]);
     }
     // aggregate the delta for each neuron in the layer
     for (int i = 0; i < ciphers_column_size; i++) {
@@ -640,7 +647,6 @@ void MlpBuilder::compute_loss_grad(
     delete[] layer_delta[i];
   }
   delete[] layer_delta;
-  djcs_t_free_public_key(phe_pub_key);
 
   log_info("[MlpBuilder::compute_loss_grad] layer_idx = " +
            std::to_string(layer_idx));
@@ -663,8 +669,8 @@ void MlpBuilder::compute_reg_grad(const Party &party, int layer_idx,
   }
 
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   // the regularization term is { - learning_rate * alpha * [w] / sample_size}
   double constant = 0 - (learning_rate * alpha / ((double)sample_size));
@@ -686,7 +692,6 @@ void MlpBuilder::compute_reg_grad(const Party &party, int layer_idx,
   log_info("[compute_reg_grad] reg_grad[0][0].type = " +
            std::to_string(reg_grad[0][0].getter_type()));
 
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void MlpBuilder::update_layer_delta(const Party &party, int layer_idx,
@@ -788,8 +793,8 @@ void MlpBuilder::inplace_derivatives(
     int delta_row_size, int delta_col_size, int phe_precision) {
   log_info("[MlpBuilder::inplace_derivatives] update the delta ");
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   int deriv_shares_row_size = (int)deriv_shares.size();
   int deriv_shares_col_size = (int)deriv_shares[0].size();
@@ -851,7 +856,6 @@ void MlpBuilder::inplace_derivatives(
     delete[] encoded_deriv_shares[i];
   }
   delete[] encoded_deriv_shares;
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void MlpBuilder::update_encrypted_weights(const Party &party,
@@ -859,8 +863,8 @@ void MlpBuilder::update_encrypted_weights(const Party &party,
                                           EncodedNumber **bias_grads) {
   log_info("[update_encrypted_weights] start to update encrypted weights");
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   //  int layer_size = (int) mlp_model.m_layers.size();
   // update the encrypted weights and bias for each layer
   for (int i = 0; i < mlp_model.m_n_layers - 1; i++) {
@@ -883,7 +887,6 @@ void MlpBuilder::update_encrypted_weights(const Party &party,
   // sample precision for the encrypted weights and bias
   post_proc_model_weights(party);
 
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void MlpBuilder::display_gradients(const Party &party,
@@ -936,8 +939,8 @@ void MlpBuilder::post_proc_model_weights(const Party &party) {
   // increase the precision to maximum precision
   log_info("[post_proc_model_weights]");
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   // step 1
   int max_prec = 0;
   for (int i = 0; i < mlp_model.m_layers.size(); i++) {
@@ -995,7 +998,6 @@ void MlpBuilder::post_proc_model_weights(const Party &party) {
                                      ACTIVE_PARTY_ID);
     }
   }
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void MlpBuilder::train(Party party) {
@@ -1127,38 +1129,53 @@ void MlpBuilder::train(Party party) {
   log_info("[train] mlp_model.m_n_layers = " +
            std::to_string(mlp_model.m_n_layers));
 
-  // step 2: iteratively computation
-  for (int iter = 0; iter < max_iteration; iter++) {
-    log_info("-------- Iteration " + std::to_string(iter) + " --------");
-    struct timespec iter_start;
-    clock_gettime(CLOCK_MONOTONIC, &iter_start);
-
+  // the batch of the next iteration, selected and encoded while spdz
+  // computes the output layer activation of the current one
+  std::vector<int> next_batch_indexes;
+  std::vector<std::vector<double>> next_batch_samples;
+  EncodedNumber **next_encoded_batch_samples = nullptr;
+  auto prepare_batch = [&](int iter) {
     // select batch_index
-    std::vector<int> batch_indexes =
+    next_batch_indexes =
         sync_batch_idx(party, batch_size, batch_iter_indexes[iter]);
     log_info("-------- Iteration " + std::to_string(iter) +
              ", select_batch_idx success --------");
-    //    for (int i = 0; i < batch_indexes.size(); i++) {
-    //      log_info("[train] batch_indexes[" + std::to_string(i) + "] = " +
-    //      std::to_string(batch_indexes[i]));
-    //    }
     // get training data with selected batch_index
-    std::vector<std::vector<double>> batch_samples;
-    for (int index : batch_indexes) {
-      batch_samples.push_back(training_data[index]);
+    next_batch_samples.clear();
+    for (int index : next_batch_indexes) {
+      next_batch_samples.push_back(training_data[index]);
     }
-    log_info("[train] batch_samples[0][0] = " +
-             std::to_string(batch_samples[0][0]));
-
     // encode the training data
-    int cur_sample_size = (int)batch_samples.size();
-    auto **encoded_batch_samples = new EncodedNumber *[cur_sample_size];
-    for (int i = 0; i < cur_sample_size; i++) {
-      encoded_batch_samples[i] = new EncodedNumber[n_features];
+    int next_sample_size = (int)next_batch_samples.size();
+    next_encoded_batch_samples = new EncodedNumber *[next_sample_size];
+    for (int i = 0; i < next_sample_size; i++) {
+      next_encoded_batch_samples[i] = new EncodedNumber[n_features];
     }
-    encode_samples(party, batch_samples, encoded_batch_samples);
+    encode_samples(party, next_batch_samples, next_encoded_batch_samples);
     log_info("-------- Iteration " + std::to_string(iter) +
              ", encode training data success --------");
+  };
+  if (max_iteration > 0) {
+    prepare_batch(0);
+  }
+
+  // step 2: iteratively computation
+  for (int iter = 0; iter < max_iteration; iter++) {
+    // release the gmp blocks cached by the previous iteration
+    gmp_arena_reset();
+    log_info("-------- Iteration " + std::to_string(iter) + " --------");
+    struct timespec iter_start;
+    clock_gettime(CLOCK_MONOTONIC, &iter_start);
+
+    // take the batch prepared by the previous iteration
+    std::vector<int> batch_indexes = std::move(next_batch_indexes);
+    std::vector<std::vector<double>> batch_samples =
+        std::move(next_batch_samples);
+    EncodedNumber **encoded_batch_samples = next_encoded_batch_samples;
+    next_encoded_batch_samples = nullptr;
+    log_info("[train] batch_samples[0][0] = " +
+             std::to_string(batch_samples[0][0]));
+    int cur_sample_size = (int)batch_samples.size();
 
     // forward computation for the predicted labels
     auto **predicted_labels = new EncodedNumber *[batch_indexes.size()];
@@ -1189,10 +1206,14 @@ void MlpBuilder::train(Party party) {
              "-th "
              "iteration init time = " +
              std::to_string(iter_init_consumed_time));
-    mlp_model.forward_computation(party, cur_sample_size, sync_arr,
-                                  encoded_batch_samples, predicted_labels,
-                                  layer_activation_shares,
-                                  layer_deriv_activation_shares);
+    mlp_model.forward_computation(
+        party, cur_sample_size, sync_arr, encoded_batch_samples,
+        predicted_labels, layer_activation_shares,
+        layer_deriv_activation_shares, [&]() {
+          if (iter + 1 < max_iteration) {
+            prepare_batch(iter + 1);
+          }
+        });
     log_info("-------- Iteration " + std::to_string(iter) +
              ", forward computation success --------");
     log_info("[train] predicted_labels' precision is: " +
@@ -1279,6 +1300,8 @@ void MlpBuilder::distributed_train(const Party &party, const Worker &worker) {
 
   // step 2: iteratively computation
   for (int iter = 0; iter < max_iteration; iter++) {
+    // release the gmp blocks cached by the previous iteration
+    gmp_arena_reset();
     log_info("-------- Iteration " + std::to_string(iter) + " --------");
     struct timespec iter_start;
     clock_gettime(CLOCK_MONOTONIC, &iter_start);
@@ -1430,10 +1453,6 @@ void MlpBuilder::eval(Party party, falcon::DatasetType eval_type,
   //     predicted labels step 3: active party aggregates and call collaborative
   //     decryption step 4: active party computes mse metrics
 
-  // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
-
   // step 1: init test data
   int dataset_size = (eval_type == falcon::TRAIN) ? (int)training_data.size()
                                                   : (int)testing_data.size();
@@ -1512,7 +1531,6 @@ void MlpBuilder::eval(Party party, falcon::DatasetType eval_type,
   }
 
   // free memory
-  djcs_t_free_public_key(phe_pub_key);
   delete[] predicted_labels;
   delete[] decrypted_labels;
 
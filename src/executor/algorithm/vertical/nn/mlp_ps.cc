@@ -365,8 +365,8 @@ void MlpParameterServer::distributed_eval(falcon::DatasetType eval_type,
 
 void MlpParameterServer::update_encrypted_weights(
     const std::vector<string> &encoded_messages) {
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   int idx = 0;
   // deserialize encrypted message, and add to encrypted
@@ -428,7 +428,6 @@ void MlpParameterServer::update_encrypted_weights(
     idx += 1;
   }
 
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void MlpParameterServer::save_model(const std::string &model_save_file) {
@@ -36,8 +36,8 @@ EncodedNumber PearsonCorrelation::calculate_score(
     EncodedNumber *encrypted_weight) {
 
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   // if no feature weights, default all weight value to be 1
   if (encrypted_weight == NULL) {
@@ -45,8 +45,8 @@ EncodedNumber PearsonCorrelation::calculate_score(
     for (int i = 0; i < sample_size; i++) {
       encrypted_weight[i].set_double(phe_pub_key->n[0], 1,
                                      PHE_FIXED_POINT_PRECISION);
-      djcs_t_aux_encrypt(phe_pub_key, party.phe_random, encrypted_weight[i],
-                         encrypted_weight[i]);
+      djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                         encrypted_weight[i], encrypted_weight[i]);
     }
   }
 
@@ -64,7 +64,7 @@ EncodedNumber PearsonCorrelation::calculate_score(
   for (int i = 0; i < plain_samples.size(); i++) {
     encrypted_feature_vector[i].set_double(phe_pub_key->n[0], plain_samples[i],
                                            PHE_FIXED_POINT_PRECISION);
-    djcs_t_aux_encrypt(phe_pub_key, party.phe_random,
+    djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
                        encrypted_feature_vector[i],
                        encrypted_feature_vector[i]);
   }
@@ -84,8 +84,8 @@ EncodedNumber PearsonCorrelation::calculate_weighted_mean(
     std::vector<double> plain_samples, int sample_size) {
 
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   EncodedNumber numerator;
 
@@ -100,6 +100,8 @@ EncodedNumber PearsonCorrelation::calculate_weighted_mean(
   djcs_t_aux_inner_product(phe_pub_key, party.phe_random, numerator,
                            encrypted_weight, plain_samples_encoded,
                            sample_size);
+  djcs_t_aux_vec_rerandomize(phe_pub_key, party.phe_random_pool.get(),
+                             &numerator, &numerator, 1);
 
   for (int i = 0; i < sample_size; i++) {
     djcs_t_aux_ee_add(phe_pub_key, denominator, encrypted_weight[i],
@@ -115,8 +117,8 @@ EncodedNumber PearsonCorrelation::calculate_weighted_mean(
     EncodedNumber *encrypted_samples, int sample_size) {
 
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   // init numerator and denominator
   EncodedNumber numerator;
@@ -151,8 +153,8 @@ EncodedNumber PearsonCorrelation::calculate_weighted_variance(
     int sample_size) {
 
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   // compute [0-meanX] => mean
   int neg_one = -1;
@@ -197,8 +199,8 @@ EncodedNumber PearsonCorrelation::calculate_weight_covariance(
     int sample_size) {
 
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   // compute [0-meanX] => mean
   int neg_one = -1;
@@ -212,7 +214,7 @@ EncodedNumber PearsonCorrelation::calculate_weight_covariance(
   for (int i = 0; i < plain_samples.size(); i++) {
     encrypted_feature_vector[i].set_double(phe_pub_key->n[0], plain_samples[i],
                                            PHE_FIXED_POINT_PRECISION);
-    djcs_t_aux_encrypt(phe_pub_key, party.phe_random,
+    djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
                        encrypted_feature_vector[i],
                        encrypted_feature_vector[i]);
   }
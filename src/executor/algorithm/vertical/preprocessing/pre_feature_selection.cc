@@ -57,8 +57,8 @@ void FeatSel::select_features(Party party, int num_samples,
   }
 
   // 0. retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   // 1. Active party sends local labels to other party, while passive party
   // receive and save locally.
@@ -74,7 +74,7 @@ void FeatSel::select_features(Party party, int num_samples,
                                                 PHE_FIXED_POINT_PRECISION);
 
       // encrypted label
-      djcs_t_aux_encrypt(phe_pub_key, party.phe_random,
+      djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
                          selected_sample_true_labels[i],
                          selected_sample_true_labels[i]);
     }
@@ -29,6 +29,7 @@ SOFTWARE.
 #include "falcon/algorithm/vertical/preprocessing/weighted_pearson.h"
 #include <falcon/utils/logger/logger.h>
 #include <falcon/operator/conversion/op_conv.h>
+#include <falcon/operator/mpc/spdz_session.h>
 #include <falcon/utils/pb_converter/network_converter.h>
 #include <future>
 #include <cmath>
@@ -36,7 +37,7 @@ SOFTWARE.
 #include <omp.h>
 
 void convert_cipher_to_negative(
-    djcs_t_public_key *phe_pub_key,
+    const djcs_t_public_key *phe_pub_key,
     const EncodedNumber &cipher_value,
     EncodedNumber &result) {
   EncodedNumber neg_one_int;
@@ -443,8 +444,8 @@ void get_local_features_correlations(const Party &party,
                                      std::vector<int> &party_id_loop_ups,
                                      std::vector<int> &party_feature_id_look_ups
 ) {
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   // 1. init
   // get batch_true_labels_precision
@@ -481,7 +482,8 @@ void get_local_features_correlations(const Party &party,
   int weight_cipher_exp = abs(sss_weight_cipher[0].getter_exponent());
   EncodedNumber sum_sss_weight_cipher_num;
   sum_sss_weight_cipher_num.set_double(phe_pub_key->n[0], 0, weight_cipher_exp);
-  djcs_t_aux_encrypt(phe_pub_key, party.phe_random, sum_sss_weight_cipher_num, sum_sss_weight_cipher_num);
+  djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                     sum_sss_weight_cipher_num, sum_sss_weight_cipher_num);
 
   for (int i = 0; i < num_instance; i++) {
 //    log_info("Debug: exp of the weight number = " + std::to_string(i) + " is "
@@ -664,6 +666,11 @@ void get_local_features_correlations(const Party &party,
                              sss_weight_cipher,
                              feature_vector_plains[feature_id],
                              num_instance);
+    djcs_t_aux_vec_rerandomize(phe_pub_key,
+                               party.phe_random_pool.get(),
+                               &feature_multiply_w_cipher[feature_id],
+                               &feature_multiply_w_cipher[feature_id],
+                               1);
     log_info("[pearson_fl] 8.1 feature_id " + std::to_string(feature_id) + "mat mul finished");
 
     party_local_tmp_wf[feature_id][0] = feature_multiply_w_cipher[feature_id];
@@ -673,8 +680,7 @@ void get_local_features_correlations(const Party &party,
       local_encrypted_feature[feature_id][sample_id].set_double(phe_pub_key->n[0],
                                                                 train_data[sample_id][feature_id],
                                                                 PHE_FIXED_POINT_PRECISION);
-      djcs_t_aux_encrypt(phe_pub_key,
-                         party.phe_random,
+      djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
                          local_encrypted_feature[feature_id][sample_id],
                          local_encrypted_feature[feature_id][sample_id]);
     }
@@ -832,8 +838,7 @@ void get_local_features_correlations(const Party &party,
       squared_feature_value_cipher_mat[i][feature_id].set_double(phe_pub_key->n[0],
                                                                  train_data[i][feature_id] * train_data[i][feature_id],
                                                                  PHE_FIXED_POINT_PRECISION * PHE_FIXED_POINT_PRECISION);
-      djcs_t_aux_encrypt(phe_pub_key,
-                         party.phe_random,
+      djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
                          squared_feature_value_cipher_mat[i][feature_id],
                          squared_feature_value_cipher_mat[i][feature_id]);
 
@@ -992,7 +997,6 @@ void get_local_features_correlations(const Party &party,
   delete[] q1_cipher[0];
   delete[] q1_cipher;
 
-  djcs_t_free_public_key(phe_pub_key);
 
 #ifdef SAVE_BASELINE
   for (int feature_indx = 0; feature_indx < debug_vec_p.size(); feature_indx++) {
@@ -1071,23 +1075,17 @@ std::vector<int> jointly_get_top_k_features(const Party &party,
   // set the computation type is select top K
   falcon::SpdzLimeCompType comp_type = falcon::PEARSON_TopK;
   // set the value for reading from threads
-  std::promise<std::vector<double>> promise_values;
-  std::future<std::vector<double>> future_values = promise_values.get_future();
   // start compute
-  std::thread spdz_pearson_comp(spdz_lime_computation,
-                                party.party_num,
-                                party.party_id,
-                                party.executor_mpc_ports,
-                                party.host_names,
-                                public_values.size(),
-                                public_values,
-                                feature_cor_shares.size(),
-                                feature_cor_shares,
-                                comp_type,
-                                &promise_values);
+  std::future<std::vector<double>> future_values =
+      spdz_computation_async(spdz_lime_computation,
+                             party.spdz_session,
+                             public_values.size(),
+                             public_values,
+                             feature_cor_shares.size(),
+                             feature_cor_shares,
+                             comp_type);
   // get value feature id in share
   std::vector<double> feature_index_share = future_values.get();
-  spdz_pearson_comp.join();
 
   log_info("[jointly_get_top_k_features] num_explained_features = " + std::to_string(num_explained_features));
 
@@ -1142,22 +1140,16 @@ std::vector<double> WeightedMean(const Party &party,
   private_values.push_back(weight_sum_share);
   std::vector<int> public_values;
   falcon::SpdzLimeCompType comp_type = falcon::PEARSON_Division;
-  std::promise<std::vector<double>> promise_values_mean_y;
-  std::future<std::vector<double>> future_values_mean_y = promise_values_mean_y.get_future();
-  std::thread spdz_dist_mean_y(spdz_lime_computation,
-                               party.party_num,
-                               party.party_id,
-                               party.executor_mpc_ports,
-                               party.host_names,
-                               0,
-                               public_values, // no public value needed
-                               private_values.size(), // 2
-                               private_values, // <mean_y>, <sum_w>
-                               comp_type,
-                               &promise_values_mean_y);
+  std::future<std::vector<double>> future_values_mean_y =
+      spdz_computation_async(spdz_lime_computation,
+                             party.spdz_session,
+                             0,
+                             public_values, // no public value needed
+                             private_values.size(), // 2
+                             private_values, // <mean_y>, <sum_w>
+                             comp_type);
   // each party have a share locally
   std::vector<double> weighted_mean_share_vec = future_values_mean_y.get();
-  spdz_dist_mean_y.join();
 
   // convert mean_y share into mean_y cipher, all party have such cipher
   secret_shares_to_ciphers(party,
@@ -1191,78 +1183,31 @@ std::vector<double> compute_wpcc(
   }
   private_values_wpcc.push_back(q2_shares);
   falcon::SpdzLimeCompType comp_type_wpcc = falcon::PEARSON_Div_with_SquareRoot;
-  std::promise<std::vector<double>> promise_values_wpcc;
-  std::future<std::vector<double>> future_values_wpcc = promise_values_wpcc.get_future();
-  std::thread spdz_dist_wpcc(spdz_lime_computation,
-                             party.party_num,
-                             party.party_id,
-                             party.executor_mpc_ports,
-                             party.host_names,
+  std::future<std::vector<double>> future_values_wpcc =
+      spdz_computation_async(spdz_lime_computation,
+                             party.spdz_session,
                              public_values.size(), // 1
                              public_values, // no public value needed
                              private_values_wpcc.size(), // 2 * vec_size + 1
                              private_values_wpcc, // <mean_y>, <sum_w>
-                             comp_type_wpcc,
-                             &promise_values_wpcc);
+                             comp_type_wpcc);
   std::vector<double> wpcc_shares = future_values_wpcc.get();
-  spdz_dist_wpcc.join();
   return wpcc_shares;
 }
 
-void spdz_lime_computation(int party_num,
-                           int party_id,
-                           std::vector<int> mpc_port_bases,
-                           std::vector<std::string> party_host_names,
+void spdz_lime_computation(std::shared_ptr<SpdzSession> spdz_session,
                            int public_value_size,
                            const std::vector<int> &public_values,
                            int private_value_size,
                            const std::vector<double> &private_values,
                            falcon::SpdzLimeCompType lime_comp_type,
                            std::promise<std::vector<double>> *res) {
-  // Here put the whole setup socket code together, as using a function call
-  // would result in a problem when deleting the created sockets
-  // setup connections from this party to each spdz party socket
-  std::vector<ssl_socket *> mpc_sockets(party_num);
-  vector<int> plain_sockets(party_num);
-  // ssl_ctx ctx(mpc_player_path, "C" + to_string(party_id));
-  ssl_ctx ctx("C" + to_string(party_id));
-  // std::cout << "correct init ctx" << std::endl;
-  ssl_service io_service;
-  octetStream specification;
-  log_info("begin connect to spdz parties");
-  log_info("party_num = " + std::to_string(party_num));
-  for (int i = 0; i < party_num; i++) {
-    log_info(
-        "[spdz_lime_computation]: falcon client is connecting with MPC server = " + std::to_string(i) + " at port = "
-            + std::to_string(mpc_port_bases[i] + i) + " ......");
-
-    set_up_client_socket(plain_sockets[i], party_host_names[i].c_str(), mpc_port_bases[i] + i);
-    send(plain_sockets[i], (octet *) &party_id, sizeof(int));
-    mpc_sockets[i] = new ssl_socket(io_service, ctx, plain_sockets[i],
-                                    "P" + to_string(i), "C" + to_string(party_id), true);
-    if (i == 0) {
-      // receive gfp prime
-      specification.Receive(mpc_sockets[0]);
-    }
-    LOG(INFO) << "Set up socket connections for " << i << "-th spdz party succeed,"
-                                                          " sockets = " << mpc_sockets[i] << ", port_num = "
-              << mpc_port_bases[i] + i << ".";
-  }
-  log_info("Finish setup socket connections to spdz engines.");
-  int type = specification.get<int>();
-  // todo, 'p' is 112 , but what 112 means?
-  switch (type) {
-    case 'p': {
-      gfp::init_field(specification.get<bigint>());
-      LOG(INFO) << "Using prime " << gfp::pr();
-      break;
-    }
-    default:LOG(ERROR) << "Type " << type << " not implemented";
-      exit(1);
-  }
-  log_info("Finish initializing gfp field.");
-  // std::cout << "Finish initializing gfp field." << std::endl;
-  // std::cout << "batch aggregation size = " << batch_aggregation_shares.size() << std::endl;
+  // the computation runs on the party's spdz connections, which are opened
+  // by the first computation of the session
+  SpdzComputation computation(*spdz_session);
+  std::vector<ssl_socket *> &mpc_sockets = computation.sockets();
+  int party_num = spdz_session->getter_party_num();
+  int party_id = spdz_session->getter_party_id();
 
   // send data to spdz parties
   log_info("party_id = " + std::to_string(party_id));
@@ -1329,16 +1274,6 @@ void spdz_lime_computation(int party_num,
     default:LOG(INFO) << "SPDZ lime computation type is not found.";
       exit(1);
   }
-
-  for (int i = 0; i < party_num; i++) {
-    close_client_socket(plain_sockets[i]);
-  }
-
-  // free memory and close mpc_sockets
-  for (int i = 0; i < party_num; i++) {
-    delete mpc_sockets[i];
-    mpc_sockets[i] = nullptr;
-  }
 }
 
 /***********************************************************/
@@ -1356,8 +1291,8 @@ void ps_get_wpcc_pre_info(const WeightedPearsonPS &ps,
                           std::vector<double> &q2_shares
 ) {
 
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  ps.party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      ps.party.phe_key_context->getter_pub_key();
 
   // 1. init
   // get batch_true_labels_precision
@@ -1394,7 +1329,8 @@ void ps_get_wpcc_pre_info(const WeightedPearsonPS &ps,
   int weight_cipher_exp = abs(sss_weight_cipher[0].getter_exponent());
   EncodedNumber sum_sss_weight_cipher_num;
   sum_sss_weight_cipher_num.set_double(phe_pub_key->n[0], 0, weight_cipher_exp);
-  djcs_t_aux_encrypt(phe_pub_key, ps.party.phe_random, sum_sss_weight_cipher_num, sum_sss_weight_cipher_num);
+  djcs_t_aux_encrypt(phe_pub_key, ps.party.phe_random_pool.get(),
+                     sum_sss_weight_cipher_num, sum_sss_weight_cipher_num);
 
   for (int i = 0; i < num_instance; i++) {
 //    log_info("[WPCC_PS]: Debug: exp of the weight number = " + std::to_string(i) + " is "
@@ -1514,7 +1450,6 @@ void ps_get_wpcc_pre_info(const WeightedPearsonPS &ps,
 //  }
 
   log_info("[WPCC_PS]: 8. each party compute F*[W] in parallel done");
-  djcs_t_free_public_key(phe_pub_key);
 
   // clean the code
   delete[] sum_sss_weight_cipher;
@@ -1545,8 +1480,8 @@ void worker_calculate_wpcc_batch_pre_info(const Party &party,
                                           EncodedNumber *predictions,
                                           EncodedNumber *mean_y_cipher,
                                           std::vector<double> &partial_e_share_vec) {
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   log_info("[worker] wk_index = " + std::to_string(wk_index));
 
@@ -1617,7 +1552,6 @@ void worker_calculate_wpcc_batch_pre_info(const Party &party,
   log_info("[pearson_fl]: 6. decrypt finished.");
 
   delete[] e_cipher_vec;
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void worker_calculate_wpcc_per_feature(const Party &party,
@@ -1632,8 +1566,8 @@ void worker_calculate_wpcc_per_feature(const Party &party,
                                        const std::vector<int> &global_partyid_look_up_vec,
                                        const std::vector<int> &global_party_local_feature_id_look_up_vec) {
 
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   int num_instance = (int) train_data.size();
 
   // 2. jointly convert <w> into ciphertext [w],
@@ -1719,6 +1653,11 @@ void worker_calculate_wpcc_per_feature(const Party &party,
                              sss_weight_cipher,
                              feature_vector_plains[worker_f_id],
                              num_instance);
+    djcs_t_aux_vec_rerandomize(phe_pub_key,
+                               party.phe_random_pool.get(),
+                               &feature_multiply_w_cipher[worker_f_id],
+                               &feature_multiply_w_cipher[worker_f_id],
+                               1);
     party_local_tmp_wf[feature_id][0] = feature_multiply_w_cipher[worker_f_id];
 
     log_info("[pearson_fl]: each party also encrypt the feature vector ");
@@ -1727,8 +1666,7 @@ void worker_calculate_wpcc_per_feature(const Party &party,
       local_encrypted_feature[feature_id][sample_id].set_double(phe_pub_key->n[0],
                                                                 train_data[sample_id][feature_id],
                                                                 PHE_FIXED_POINT_PRECISION);
-      djcs_t_aux_encrypt(phe_pub_key,
-                         party.phe_random,
+      djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
                          local_encrypted_feature[feature_id][sample_id],
                          local_encrypted_feature[feature_id][sample_id]);
     }
@@ -1877,8 +1815,7 @@ void worker_calculate_wpcc_per_feature(const Party &party,
                                                                   train_data[i][feature_id] * train_data[i][feature_id],
                                                                   PHE_FIXED_POINT_PRECISION
                                                                       * PHE_FIXED_POINT_PRECISION);
-      djcs_t_aux_encrypt(phe_pub_key,
-                         party.phe_random,
+      djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
                          squared_feature_value_cipher_mat[i][worker_f_id],
                          squared_feature_value_cipher_mat[i][worker_f_id]);
 
@@ -2017,7 +1954,6 @@ void worker_calculate_wpcc_per_feature(const Party &party,
   delete[] feature_vector_plains;
   delete[] feature_multiply_w_cipher;
 
-  djcs_t_free_public_key(phe_pub_key);
 
   log_info("[pearson_fl]: 10. All done, begin to clear the memory");
 }
@@ -33,10 +33,7 @@ WeightedPearsonPS::WeightedPearsonPS(const WeightedPearsonPS &obj) : party(obj.p
 WeightedPearsonPS::WeightedPearsonPS(
     const Party &m_party, const string &ps_network_config_pb_str) :
     ParameterServer(ps_network_config_pb_str), party(m_party) {
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
   log_info("[WeightedPearsonPS::initialized]: okay.");
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 std::vector<int> WeightedPearsonPS::partition_examples(std::vector<int> nums){
@@ -32,6 +32,7 @@ SOFTWARE.
 #include <falcon/common.h>
 #include <falcon/operator/conversion/op_conv.h>
 #include <falcon/operator/mpc/spdz_connector.h>
+#include <falcon/operator/mpc/spdz_session.h>
 #include <falcon/party/info_exchange.h>
 #include <falcon/utils/pb_converter/common_converter.h>
 
@@ -78,8 +79,8 @@ void ForestModel::predict(
   ///     results back to ciphertext
 
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   // init predicted forest labels to record the predictions, the first dimension
   // is the number of trees in the forest, and the second dimension is the
@@ -106,8 +107,8 @@ void ForestModel::predict(
       for (int i = 0; i < predicted_sample_size; i++) {
         auto *aggregation = new EncodedNumber[1];
         aggregation[0].set_double(phe_pub_key->n[0], 0.0, cipher_precision);
-        djcs_t_aux_encrypt(phe_pub_key, party.phe_random, aggregation[0],
-                           aggregation[0]);
+        djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                           aggregation[0], aggregation[0]);
         // aggregate the predicted labels for sample i
         for (int tree_id = 0; tree_id < tree_size; tree_id++) {
           djcs_t_aux_ee_add(phe_pub_key, aggregation[0], aggregation[0],
@@ -153,16 +154,12 @@ void ForestModel::predict(
     // communicate with spdz parties and receive results to compute labels
     // first send computation type, tree type, class num
     // then send private values
-    std::promise<std::vector<double>> promise_values;
     std::future<std::vector<double>> future_values =
-        promise_values.get_future();
-    std::thread spdz_pruning_check_thread(
-        spdz_tree_computation, party.party_num, party.party_id,
-        party.executor_mpc_ports, party.host_names, public_values.size(),
-        public_values, private_values.size(), private_values, comp_type,
-        &promise_values);
+        spdz_computation_async(spdz_tree_computation, party.spdz_session,
+                               public_values.size(), public_values,
+                               private_values.size(), private_values,
+                               comp_type);
     std::vector<double> predicted_sample_shares = future_values.get();
-    spdz_pruning_check_thread.join();
 
     // convert the secret shares to ciphertext, which is the predicted labels
     secret_shares_to_ciphers(party, predicted_labels, predicted_sample_shares,
@@ -171,7 +168,6 @@ void ForestModel::predict(
   }
 
   // free memory
-  djcs_t_free_public_key(phe_pub_key);
   for (int tree_id = 0; tree_id < tree_size; tree_id++) {
     delete[] predicted_forest_labels[tree_id];
   }
@@ -198,8 +194,8 @@ void ForestModel::predict_proba(
     //     secret shared results back to ciphertext
 
     // retrieve phe pub key and phe random
-    djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-    party.getter_phe_pub_key(phe_pub_key);
+    const djcs_t_public_key *phe_pub_key =
+        party.phe_key_context->getter_pub_key();
 
     // init predicted forest labels to record the predictions, the first
     // dimension is the number of trees in the forest, and the second dimension
@@ -282,7 +278,7 @@ void ForestModel::predict_proba(
           predicted_labels[i][j].set_double(phe_pub_key->n[0],
                                             samples_pred_prob[i][j],
                                             2 * PHE_FIXED_POINT_PRECISION);
-          djcs_t_aux_encrypt(phe_pub_key, party.phe_random,
+          djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
                              predicted_labels[i][j], predicted_labels[i][j]);
         }
       }
@@ -295,7 +291,6 @@ void ForestModel::predict_proba(
     }
 
     // free memory
-    djcs_t_free_public_key(phe_pub_key);
     for (int tree_id = 0; tree_id < tree_size; tree_id++) {
       delete[] predicted_forest_labels[tree_id];
       delete[] decrypted_forest_labels[tree_id];
@@ -31,6 +31,7 @@ SOFTWARE.
 #include <falcon/algorithm/vertical/tree/gbdt_model.h>
 #include <falcon/model/model_io.h>
 #include <falcon/operator/conversion/op_conv.h>
+#include <falcon/operator/mpc/spdz_session.h>
 #include <falcon/party/info_exchange.h>
 #include <falcon/utils/logger/log_alg_params.h>
 #include <falcon/utils/logger/logger.h>
@@ -131,8 +132,8 @@ void GbdtBuilder::train_regression_task(Party party) {
   int sample_size = (int)training_data.size();
   auto *raw_predictions = new EncodedNumber[sample_size];
   // retrieve phe pub key
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   // init loss function, for regression loss, class num is set to 1
   LeastSquareError least_square_error(gbdt_model.tree_type, 1);
   // get the initial encrypted raw_predictions, all parties obtain
@@ -147,7 +148,7 @@ void GbdtBuilder::train_regression_task(Party party) {
     for (int i = 0; i < sample_size; i++) {
       encrypted_true_labels[i].set_double(phe_pub_key->n[0],
                                           training_labels[i]);
-      djcs_t_aux_encrypt(phe_pub_key, party.phe_random,
+      djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
                          encrypted_true_labels[i], encrypted_true_labels[i]);
     }
   }
@@ -201,7 +202,6 @@ void GbdtBuilder::train_regression_task(Party party) {
     delete[] flatten_residuals;
   }
   // free retrieved public key
-  djcs_t_free_public_key(phe_pub_key);
   delete[] raw_predictions;
   delete[] encrypted_true_labels;
 }
@@ -241,8 +241,8 @@ void GbdtBuilder::train_classification_task(Party party) {
   log_info("Begin train a gbdt classification task");
   log_info("gbdt_model.class_num = " + std::to_string(gbdt_model.class_num));
   // retrieve phe pub key
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   int sample_size = (int)training_data.size();
   // check class_num, for binary classification, use BinomialDeviance loss
   // for multi-class classification, use MultinomialDeviance loss
@@ -267,7 +267,7 @@ void GbdtBuilder::train_classification_task(Party party) {
       for (int i = 0; i < sample_size; i++) {
         encrypted_true_labels[i].set_double(phe_pub_key->n[0],
                                             training_labels[i]);
-        djcs_t_aux_encrypt(phe_pub_key, party.phe_random,
+        djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
                            encrypted_true_labels[i], encrypted_true_labels[i]);
       }
     }
@@ -371,7 +371,7 @@ void GbdtBuilder::train_classification_task(Party party) {
           int index = c * sample_size + i;
           encrypted_true_labels[index].set_double(phe_pub_key->n[0],
                                                   one_hot_labels[i]);
-          djcs_t_aux_encrypt(phe_pub_key, party.phe_random,
+          djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
                              encrypted_true_labels[index],
                              encrypted_true_labels[index]);
         }
@@ -479,7 +479,6 @@ void GbdtBuilder::train_classification_task(Party party) {
   }
 
   // free retrieved public key
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void GbdtBuilder::square_encrypted_residual(Party party,
@@ -511,15 +510,11 @@ void GbdtBuilder::square_encrypted_residual(Party party,
   // communicate with spdz parties and receive results to compute labels
   // first send computation type, tree type, class num
   // then send private values
-  std::promise<std::vector<double>> promise_values;
-  std::future<std::vector<double>> future_values = promise_values.get_future();
-  std::thread spdz_pruning_check_thread(
-      spdz_tree_computation, party.party_num, party.party_id,
-      party.executor_mpc_ports, party.host_names, public_values.size(),
-      public_values, private_values.size(), private_values, comp_type,
-      &promise_values);
+  std::future<std::vector<double>> future_values =
+      spdz_computation_async(spdz_tree_computation, party.spdz_session,
+                             public_values.size(), public_values,
+                             private_values.size(), private_values, comp_type);
   std::vector<double> squared_residuals_shares = future_values.get();
-  spdz_pruning_check_thread.join();
 
   // convert the secret shares to ciphertext, which is encrypted square
   // residuals
@@ -28,6 +28,7 @@ SOFTWARE.
 
 #include <falcon/algorithm/vertical/tree/gbdt_loss.h>
 #include <falcon/operator/conversion/op_conv.h>
+#include <falcon/operator/mpc/spdz_session.h>
 #include <falcon/party/info_exchange.h>
 #include <falcon/utils/pb_converter/common_converter.h>
 
@@ -104,8 +105,8 @@ void LeastSquareError::negative_gradient(Party party,
   // the active party compute the encrypted residual and broadcast
   if (party.party_type == falcon::ACTIVE_PARTY) {
     // retrieve phe pub key
-    djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-    party.getter_phe_pub_key(phe_pub_key);
+    const djcs_t_public_key *phe_pub_key =
+        party.phe_key_context->getter_pub_key();
     EncodedNumber negative_one;
     negative_one.set_integer(phe_pub_key->n[0], -1);
     for (int i = 0; i < size; i++) {
@@ -114,7 +115,6 @@ void LeastSquareError::negative_gradient(Party party,
       djcs_t_aux_ee_add(phe_pub_key, residuals[i], ground_truth_labels[i], tmp);
     }
     // free retrieved public key
-    djcs_t_free_public_key(phe_pub_key);
   }
   // active party broadcasts the residuals
   broadcast_encoded_number_array(party, residuals, size, ACTIVE_PARTY_ID);
@@ -145,15 +145,14 @@ void LeastSquareError::get_init_raw_predictions(
                                        decltype(labels)::value_type(0));
     dummy_prediction = label_sum / (double)labels.size();
     // retrieve phe pub key
-    djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-    party.getter_phe_pub_key(phe_pub_key);
+    const djcs_t_public_key *phe_pub_key =
+        party.phe_key_context->getter_pub_key();
     for (int i = 0; i < size; i++) {
       raw_predictions[i].set_double(phe_pub_key->n[0], dummy_prediction);
-      djcs_t_aux_encrypt(phe_pub_key, party.phe_random, raw_predictions[i],
-                         raw_predictions[i]);
+      djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                         raw_predictions[i], raw_predictions[i]);
     }
     // free retrieved public key
-    djcs_t_free_public_key(phe_pub_key);
   }
   // active party broadcasts the raw_predictions to other parties
   broadcast_encoded_number_array(party, raw_predictions, size, ACTIVE_PARTY_ID);
@@ -185,8 +184,8 @@ void BinomialDeviance::negative_gradient(Party party,
                                 PHE_FIXED_POINT_PRECISION);
   // compute the negative gradient, i.e., residuals
   // retrieve phe pub key
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   EncodedNumber negative_one;
   negative_one.set_integer(phe_pub_key->n[0], -1);
   for (int i = 0; i < size; i++) {
@@ -196,7 +195,6 @@ void BinomialDeviance::negative_gradient(Party party,
   }
 
   // free retrieved public key
-  djcs_t_free_public_key(phe_pub_key);
   delete[] expit_raw_predictions;
 }
 
@@ -245,15 +243,14 @@ void BinomialDeviance::get_init_raw_predictions(
     double odds = p / (1 - p);
     dummy_prediction = log(odds);
     // retrieve phe pub key
-    djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-    party.getter_phe_pub_key(phe_pub_key);
+    const djcs_t_public_key *phe_pub_key =
+        party.phe_key_context->getter_pub_key();
     for (int i = 0; i < size; i++) {
       raw_predictions[i].set_double(phe_pub_key->n[0], dummy_prediction);
-      djcs_t_aux_encrypt(phe_pub_key, party.phe_random, raw_predictions[i],
-                         raw_predictions[i]);
+      djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                         raw_predictions[i], raw_predictions[i]);
     }
     // free retrieved public key
-    djcs_t_free_public_key(phe_pub_key);
   }
   // active party broadcasts the raw_predictions to other parties
   broadcast_encoded_number_array(party, raw_predictions, size, ACTIVE_PARTY_ID);
@@ -303,8 +300,8 @@ void MultinomialDeviance::negative_gradient(Party party,
       num_trees_per_estimator, PHE_FIXED_POINT_PRECISION);
   // compute the negative gradient, i.e., residuals
   // retrieve phe pub key
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   EncodedNumber negative_one;
   negative_one.set_integer(phe_pub_key->n[0], -1);
   for (int i = 0; i < size; i++) {
@@ -315,7 +312,6 @@ void MultinomialDeviance::negative_gradient(Party party,
   }
 
   // free retrieved public key
-  djcs_t_free_public_key(phe_pub_key);
   delete[] softmax_raw_predictions;
 }
 
@@ -348,8 +344,8 @@ void MultinomialDeviance::get_init_raw_predictions(
     int sample_size = size / num_trees_per_estimator;
     log_info("sample size = " + std::to_string(sample_size));
     // retrieve phe pub key
-    djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-    party.getter_phe_pub_key(phe_pub_key);
+    const djcs_t_public_key *phe_pub_key =
+        party.phe_key_context->getter_pub_key();
     for (int c = 0; c < num_trees_per_estimator; c++) {
       int num_event = 0;
       for (double l : labels) {
@@ -374,13 +370,12 @@ void MultinomialDeviance::get_init_raw_predictions(
         int real_sample_id = c * sample_size + i;
         raw_predictions[real_sample_id].set_double(phe_pub_key->n[0],
                                                    cur_dummy_prediction);
-        djcs_t_aux_encrypt(phe_pub_key, party.phe_random,
+        djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
                            raw_predictions[real_sample_id],
                            raw_predictions[real_sample_id]);
       }
     }
     // free retrieved public key
-    djcs_t_free_public_key(phe_pub_key);
   }
   // active party broadcasts the raw_predictions to other parties
   broadcast_encoded_number_array(party, raw_predictions, size, ACTIVE_PARTY_ID);
@@ -422,8 +417,8 @@ void update_raw_predictions_with_learning_rate(
   log_info("finish current tree model prediction");
 
   // retrieve phe pub key
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   auto *assists = new EncodedNumber[size];
   // if active party, update the raw_predictions
   if (party.party_type == falcon::ACTIVE_PARTY) {
@@ -447,7 +442,6 @@ void update_raw_predictions_with_learning_rate(
   log_info("finish truncate the cipher precision");
 
   // free retrieved public key
-  djcs_t_free_public_key(phe_pub_key);
   delete[] cur_predictions;
   delete[] assists;
 }
@@ -467,15 +461,12 @@ void compute_raw_predictions_expit(Party party, EncodedNumber *raw_predictions,
   // communicate with spdz parties and receive results to compute labels
   // first send computation type, tree type, class num
   // then send private values
-  std::promise<std::vector<double>> promise_values;
-  std::future<std::vector<double>> future_values = promise_values.get_future();
-  std::thread spdz_pruning_check_thread(
-      spdz_tree_computation, party.party_num, party.party_id,
-      party.executor_mpc_ports, party.host_names, public_values.size(),
-      public_values, raw_predictions_shares.size(), raw_predictions_shares,
-      comp_type, &promise_values);
+  std::future<std::vector<double>> future_values =
+      spdz_computation_async(spdz_tree_computation, party.spdz_session,
+                             public_values.size(), public_values,
+                             raw_predictions_shares.size(),
+                             raw_predictions_shares, comp_type);
   std::vector<double> expit_raw_predictions_shares = future_values.get();
-  spdz_pruning_check_thread.join();
   // step 3: convert the resulted shares back into ciphers,
   // which is encrypted expit raw predictions
   secret_shares_to_ciphers(party, expit_raw_predictions,
@@ -502,15 +493,12 @@ void compute_raw_predictions_softmax(Party party,
   // communicate with spdz parties and receive results to compute labels
   // first send computation type, tree type, class num
   // then send private values
-  std::promise<std::vector<double>> promise_values;
-  std::future<std::vector<double>> future_values = promise_values.get_future();
-  std::thread spdz_pruning_check_thread(
-      spdz_tree_computation, party.party_num, party.party_id,
-      party.executor_mpc_ports, party.host_names, public_values.size(),
-      public_values, raw_predictions_shares.size(), raw_predictions_shares,
-      comp_type, &promise_values);
+  std::future<std::vector<double>> future_values =
+      spdz_computation_async(spdz_tree_computation, party.spdz_session,
+                             public_values.size(), public_values,
+                             raw_predictions_shares.size(),
+                             raw_predictions_shares, comp_type);
   std::vector<double> softmax_raw_predictions_shares = future_values.get();
-  spdz_pruning_check_thread.join();
   // step 3: convert the resulted shares back into ciphers,
   // which is encrypted expit raw predictions
   secret_shares_to_ciphers(party, softmax_raw_predictions,
@@ -523,9 +511,6 @@ void update_terminal_regions_for_classification(
     EncodedNumber *ground_truth_labels, EncodedNumber *residuals,
     EncodedNumber *raw_predictions, int sample_size, double learning_rate,
     int class_num) {
-  // retrieve phe pub key
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
   // step 1: convert the residual to secret shares
   std::vector<double> residuals_shares;
   ciphers_to_secret_shares(party, residuals, residuals_shares, sample_size,
@@ -583,15 +568,11 @@ void update_terminal_regions_for_classification(
   // communicate with spdz parties and receive results to compute labels
   // first send computation type, tree type, class num
   // then send private values
-  std::promise<std::vector<double>> promise_values;
-  std::future<std::vector<double>> future_values = promise_values.get_future();
-  std::thread spdz_pruning_check_thread(
-      spdz_tree_computation, party.party_num, party.party_id,
-      party.executor_mpc_ports, party.host_names, public_values.size(),
-      public_values, private_values.size(), private_values, comp_type,
-      &promise_values);
+  std::future<std::vector<double>> future_values =
+      spdz_computation_async(spdz_tree_computation, party.spdz_session,
+                             public_values.size(), public_values,
+                             private_values.size(), private_values, comp_type);
   std::vector<double> updated_leaf_label_shares = future_values.get();
-  spdz_pruning_check_thread.join();
   log_info("Compute mpc update terminal region finished");
   // step 7: convert the returned new leaf label shares to ciphers
   auto *updated_leaf_labels = new EncodedNumber[leaf_node_num];
@@ -620,7 +601,6 @@ void update_terminal_regions_for_classification(
                                             learning_rate);
   log_info("Update the raw predictions finished");
   // free retrieved public key
-  djcs_t_free_public_key(phe_pub_key);
   delete[] pre_predictions;
   delete[] leaf_labels;
   delete[] updated_leaf_labels;
@@ -98,8 +98,8 @@ void GbdtModel::predict_single_estimator(
   /// 3. return the predicted labels
 
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   log_info("[GbdtModel.predict_single_estimator] predicted_sample_size = " +
            std::to_string(predicted_sample_size));
   // if active party, compute the encrypted dummy predictor and broadcast
@@ -110,8 +110,8 @@ void GbdtModel::predict_single_estimator(
     for (int i = 0; i < predicted_sample_size; i++) {
       raw_predictions[i].set_double(phe_pub_key->n[0], dummy_predictors[0],
                                     2 * PHE_FIXED_POINT_PRECISION);
-      djcs_t_aux_encrypt(phe_pub_key, party.phe_random, raw_predictions[i],
-                         raw_predictions[i]);
+      djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                         raw_predictions[i], raw_predictions[i]);
     }
   }
   broadcast_encoded_number_array(party, raw_predictions, predicted_sample_size,
@@ -146,7 +146,6 @@ void GbdtModel::predict_single_estimator(
         binary_classification_class_num, 2 * PHE_FIXED_POINT_PRECISION);
   }
   // free memory
-  djcs_t_free_public_key(phe_pub_key);
   delete[] raw_predictions;
 }
 
@@ -161,8 +160,8 @@ void GbdtModel::predict_multi_estimator(
   /// 3. compute the softmax of the predictions and return the predicted labels
 
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   // if active party, compute the encrypted dummy predictors and broadcast
   // init the encrypted predicted_labels with dummy prediction by 2 * precision
   auto *raw_predictions = new EncodedNumber[predicted_sample_size * class_num];
@@ -175,7 +174,7 @@ void GbdtModel::predict_multi_estimator(
         raw_predictions[real_id].set_double(phe_pub_key->n[0],
                                             dummy_predictors[0],
                                             2 * PHE_FIXED_POINT_PRECISION);
-        djcs_t_aux_encrypt(phe_pub_key, party.phe_random,
+        djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
                            raw_predictions[real_id], raw_predictions[real_id]);
       }
     }
@@ -212,6 +211,5 @@ void GbdtModel::predict_multi_estimator(
                                   predicted_sample_size, class_num,
                                   2 * PHE_FIXED_POINT_PRECISION);
   // free memory
-  djcs_t_free_public_key(phe_pub_key);
   delete[] raw_predictions;
 }
\ No newline at end of file
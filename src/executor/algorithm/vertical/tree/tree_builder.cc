@@ -31,6 +31,7 @@ SOFTWARE.
 #include <falcon/model/model_io.h>
 #include <falcon/operator/conversion/op_conv.h>
 #include <falcon/operator/mpc/spdz_connector.h>
+#include <falcon/operator/mpc/spdz_session.h>
 #include <falcon/party/info_exchange.h>
 #include <falcon/utils/alg/debug_util.h>
 #include <falcon/utils/alg/tree_util.h>
@@ -40,6 +41,8 @@ SOFTWARE.
 #include <falcon/utils/pb_converter/common_converter.h>
 #include <falcon/utils/pb_converter/tree_converter.h>
 
+#include <algorithm>
+#include <cmath>
 #include <ctime>
 #include <future>
 #include <iomanip> // std::setprecision
@@ -55,6 +58,26 @@ SOFTWARE.
 #include <google/protobuf/message_lite.h>
 #include <queue>
 
+LocalSplitStatistics::LocalSplitStatistics(int split_num, int class_num)
+    : split_num(split_num) {
+  statistics = new EncodedNumber *[split_num];
+  for (int i = 0; i < split_num; i++) {
+    // here 2 * class_num refers to left branch and right branch
+    statistics[i] = new EncodedNumber[2 * class_num];
+  }
+  left_sample_nums = new EncodedNumber[split_num];
+  right_sample_nums = new EncodedNumber[split_num];
+}
+
+LocalSplitStatistics::~LocalSplitStatistics() {
+  for (int i = 0; i < split_num; i++) {
+    delete[] statistics[i];
+  }
+  delete[] statistics;
+  delete[] left_sample_nums;
+  delete[] right_sample_nums;
+}
+
 DecisionTreeBuilder::DecisionTreeBuilder() {}
 
 DecisionTreeBuilder::~DecisionTreeBuilder() {
@@ -215,8 +238,8 @@ void DecisionTreeBuilder::precompute_feature_helpers() {
 
 void DecisionTreeBuilder::calc_root_impurity(const Party &party) {
   // retrieve phe pub key
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   auto *root_impu = new EncodedNumber[1];
   if (party.party_type == falcon::ACTIVE_PARTY) {
     double impu = root_impurity(training_labels, tree_type, class_num);
@@ -224,11 +247,10 @@ void DecisionTreeBuilder::calc_root_impurity(const Party &party) {
     root_impu[0].set_double(phe_pub_key->n[0], impu, PHE_FIXED_POINT_PRECISION);
   }
   broadcast_encoded_number_array(party, root_impu, 1, ACTIVE_PARTY_ID);
-  djcs_t_aux_encrypt(phe_pub_key, party.phe_random, tree.nodes[0].impurity,
-                     root_impu[0]);
+  djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                     tree.nodes[0].impurity, root_impu[0]);
 
   delete[] root_impu;
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void DecisionTreeBuilder::train(Party party) {
@@ -345,23 +367,23 @@ void DecisionTreeBuilder::train(Party party, EncodedNumber *encrypted_labels) {
 void DecisionTreeBuilder::initialize_sample_mask_iv(
     Party party, EncodedNumber *sample_mask_iv, int sample_num) {
   // retrieve phe pub key
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   // as the samples are available at the beginning of the training, init with 1
   EncodedNumber tmp;
   tmp.set_integer(phe_pub_key->n[0], 1);
   // init encrypted mask vector on the root node
   for (int i = 0; i < sample_num; i++) {
-    djcs_t_aux_encrypt(phe_pub_key, party.phe_random, sample_mask_iv[i], tmp);
+    djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                       sample_mask_iv[i], tmp);
   }
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void DecisionTreeBuilder::initialize_encrypted_labels(
     Party party, EncodedNumber *encrypted_labels, int sample_num) {
   // retrieve phe pub key
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   // if active party, compute the encrypted label info and broadcast
   if (party.party_type == falcon::ACTIVE_PARTY) {
@@ -377,7 +399,7 @@ void DecisionTreeBuilder::initialize_encrypted_labels(
           tmp_label.set_double(phe_pub_key->n[0], variance_stat_vecs[i][j]);
         }
         // encrypt the label
-        djcs_t_aux_encrypt(phe_pub_key, party.phe_random,
+        djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
                            encrypted_labels[i * sample_num + j], tmp_label);
       }
     }
@@ -388,7 +410,6 @@ void DecisionTreeBuilder::initialize_encrypted_labels(
   log_info("[DecisionTreeBuilder.train] Finish broadcasting the encrypted "
            "label info");
 
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void DecisionTreeBuilder::build_node(
@@ -430,12 +451,12 @@ void DecisionTreeBuilder::build_node(
   auto *encrypted_node_num = new EncodedNumber[1];
   auto *decrypted_node_num = new EncodedNumber[1];
   // retrieve phe pub key
-  djcs_t_public_key *phe_pub_key_tmp = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key_tmp);
+  const djcs_t_public_key *phe_pub_key_tmp =
+      party.phe_key_context->getter_pub_key();
   if (party.party_type == falcon::ACTIVE_PARTY) {
     encrypted_node_num[0].set_integer(phe_pub_key_tmp->n[0], 0);
-    djcs_t_aux_encrypt(phe_pub_key_tmp, party.phe_random, encrypted_node_num[0],
-                       encrypted_node_num[0]);
+    djcs_t_aux_encrypt(phe_pub_key_tmp, party.phe_random_pool.get(),
+                       encrypted_node_num[0], encrypted_node_num[0]);
     int sample_num = (int)training_data.size();
     for (int i = 0; i < sample_num; i++) {
       djcs_t_aux_ee_add_ext(phe_pub_key_tmp, encrypted_node_num[0],
@@ -466,12 +487,29 @@ void DecisionTreeBuilder::build_node(
   }
   delete[] encrypted_node_num;
   delete[] decrypted_node_num;
-  djcs_t_free_public_key(phe_pub_key_tmp);
 #endif
 
-  // step 1: check pruning condition via spdz computation
-  bool is_satisfied =
-      check_pruning_conditions(party, node_index, sample_mask_iv);
+  // step 1: check pruning condition via spdz computation, and compute the
+  // local split statistics of the node while spdz checks it if the node is
+  // likely to be split; the node sample number is secret, so it is estimated
+  // as if the tree were balanced, and small nodes compute the statistics in
+  // find_best_split once the check has passed
+  std::future<std::vector<double>> pruning_check =
+      check_pruning_conditions_async(party, node_index, sample_mask_iv);
+  int node_depth = tree.nodes[node_index].depth;
+  double estimated_sample_num =
+      std::ldexp((double)training_data.size(), -node_depth);
+  bool speculate =
+      node_depth < max_depth && estimated_sample_num >= 4.0 * min_samples_split;
+  log_info("[DecisionTreeBuilder.build_node] speculative split statistics = " +
+           std::to_string(speculate));
+  std::unique_ptr<LocalSplitStatistics> local_statistics;
+  if (speculate) {
+    local_statistics = compute_local_split_statistics(
+        party, node_index, available_feature_ids, sample_mask_iv,
+        encrypted_labels, use_sample_weights, sss_sample_weights);
+  }
+  bool is_satisfied = (int)pruning_check.get()[0] == 1;
   // step 2: if satisfied, compute label via spdz computation
   if (is_satisfied) {
     compute_leaf_statistics(party, node_index, sample_mask_iv, encrypted_labels,
@@ -481,10 +519,10 @@ void DecisionTreeBuilder::build_node(
 
   // step 3: invoke to find the best split using phe and spdz
   std::vector<int> party_split_nums;
-  std::vector<double> res =
-      find_best_split(party, node_index, available_feature_ids, sample_mask_iv,
-                      encrypted_labels, party_split_nums, use_sample_weights,
-                      sss_sample_weights);
+  std::vector<double> res = find_best_split(
+      party, node_index, available_feature_ids, sample_mask_iv,
+      encrypted_labels, party_split_nums, use_sample_weights,
+      sss_sample_weights, local_statistics.get());
   int best_split_index = (int)res[0];
   double left_impurity = res[1];
   double right_impurity = res[2];
@@ -622,16 +660,26 @@ void DecisionTreeBuilder::build_node(
 
 bool DecisionTreeBuilder::check_pruning_conditions(
     Party &party, int node_index, EncodedNumber *sample_mask_iv) {
-  bool is_satisfied = false;
+  std::vector<double> res =
+      check_pruning_conditions_async(party, node_index, sample_mask_iv).get();
+  // if returned value is 1, then it is a leaf node, need to compute label
+  // otherwise, it is not a leaf node, need to find the best split
+  return (int)res[0] == 1;
+}
+
+std::future<std::vector<double>>
+DecisionTreeBuilder::check_pruning_conditions_async(
+    Party &party, int node_index, EncodedNumber *sample_mask_iv) {
   // if current split depth is already equal to max_depth, return.
   if (tree.nodes[node_index].depth == max_depth) {
-    is_satisfied = true;
-    return is_satisfied;
+    std::promise<std::vector<double>> satisfied;
+    satisfied.set_value(std::vector<double>(1, 1.0));
+    return satisfied.get_future();
   }
   int sample_num = training_data.size();
   // retrieve phe pub key
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   // init temp values
   auto *encrypted_sample_count = new EncodedNumber[1];
   auto *encrypted_impurity = new EncodedNumber[1];
@@ -648,8 +696,8 @@ bool DecisionTreeBuilder::check_pruning_conditions(
     // compute the available sample_num as well as the impurity of the current
     // node
     encrypted_sample_count[0].set_integer(phe_pub_key->n[0], 0);
-    djcs_t_aux_encrypt(phe_pub_key, party.phe_random, encrypted_sample_count[0],
-                       encrypted_sample_count[0]);
+    djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                       encrypted_sample_count[0], encrypted_sample_count[0]);
     for (int i = 0; i < sample_num; i++) {
       djcs_t_aux_ee_add_ext(phe_pub_key, encrypted_sample_count[0],
                             encrypted_sample_count[0], sample_mask_iv[i]);
@@ -681,24 +729,12 @@ bool DecisionTreeBuilder::check_pruning_conditions(
   // check if encrypted sample count is less than a threshold
   // (prune_sample_num), or if the impurity satisfies the pruning condition
   // communicate with spdz parties and receive results
-  std::promise<std::vector<double>> promise_values;
-  std::future<std::vector<double>> future_values = promise_values.get_future();
-  std::thread spdz_pruning_check_thread(
-      spdz_tree_computation, party.party_num, party.party_id,
-      party.executor_mpc_ports, party.host_names, public_values.size(),
-      public_values, private_values.size(), private_values, comp_type,
-      &promise_values);
-  std::vector<double> res = future_values.get();
-  spdz_pruning_check_thread.join();
-  // if returned value is 1, then it is a leaf node, need to compute label
-  // otherwise, it is not a leaf node, need to find the best split
-  if ((int)res[0] == 1) {
-    is_satisfied = true;
-  }
   delete[] encrypted_sample_count;
   delete[] encrypted_impurity;
-  djcs_t_free_public_key(phe_pub_key);
-  return is_satisfied;
+  return spdz_computation_async(spdz_tree_computation, party.spdz_session,
+                                public_values.size(), public_values,
+                                private_values.size(), private_values,
+                                comp_type);
 }
 
 void DecisionTreeBuilder::compute_leaf_statistics(
@@ -709,8 +745,8 @@ void DecisionTreeBuilder::compute_leaf_statistics(
            "leaf values");
   int sample_num = (int)training_data.size();
   // retrieve phe pub key
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   // set spdz computation values
   falcon::SpdzTreeCompType comp_type = falcon::COMPUTE_LABEL;
   std::vector<int> public_values;
@@ -745,7 +781,7 @@ void DecisionTreeBuilder::compute_leaf_statistics(
                               encrypted_labels[0 * sample_num + i]);
       }
       encrypted_sample_num_aux[0].set_integer(phe_pub_key->n[0], 0);
-      djcs_t_aux_encrypt(phe_pub_key, party.phe_random,
+      djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
                          encrypted_sample_num_aux[0],
                          encrypted_sample_num_aux[0]);
       for (int i = 0; i < sample_num; i++) {
@@ -785,35 +821,31 @@ void DecisionTreeBuilder::compute_leaf_statistics(
   // communicate with spdz parties and receive results to compute labels
   // first send computation type, tree type, class num
   // then send private values
-  std::promise<std::vector<double>> promise_values;
-  std::future<std::vector<double>> future_values = promise_values.get_future();
-  std::thread spdz_pruning_check_thread(
-      spdz_tree_computation, party.party_num, party.party_id,
-      party.executor_mpc_ports, party.host_names, public_values.size(),
-      public_values, private_values.size(), private_values, comp_type,
-      &promise_values);
+  std::future<std::vector<double>> future_values =
+      spdz_computation_async(spdz_tree_computation, party.spdz_session,
+                             public_values.size(), public_values,
+                             private_values.size(), private_values, comp_type);
   std::vector<double> res = future_values.get();
-  spdz_pruning_check_thread.join();
 
   log_info("[DecisionTreeBuilder.compute_leaf_statistics] Node " +
            std::to_string(node_index) + " label = " + std::to_string(res[0]));
   EncodedNumber label;
   label.set_double(phe_pub_key->n[0], res[0], PHE_FIXED_POINT_PRECISION);
-  djcs_t_aux_encrypt(phe_pub_key, party.phe_random, label, label);
+  djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(), label, label);
   // now assume that it is only an encoded number, instead of a ciphertext
   // djcs_t_aux_encrypt(phe_pub_key, party.phe_random, label, label);
   tree.nodes[node_index].label = label;
   tree.nodes[node_index].node_type = falcon::LEAF;
   // the other node attributes should be updated in another place
 
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 std::vector<double> DecisionTreeBuilder::find_best_split(
     const Party &party, int node_index, std::vector<int> available_feature_ids,
     EncodedNumber *sample_mask_iv, EncodedNumber *encrypted_labels,
     std::vector<int> &party_split_nums, bool use_sample_weights,
-    const std::vector<double> &sss_sample_weights) {
+    const std::vector<double> &sss_sample_weights,
+    LocalSplitStatistics *local_statistics) {
   // step 3: active party computes some encrypted label
   // information and broadcast to the other clients
   // step 4: every party locally computes necessary encrypted statistics,
@@ -835,21 +867,27 @@ std::vector<double> DecisionTreeBuilder::find_best_split(
   // step 4.5: party converts the encrypted statistics matrix into secret shares
   // step 4.6: parties jointly send shares to spdz parties
 
-  int local_splits_num = 0, global_split_num = 0;
-  int available_local_feature_num = (int)available_feature_ids.size();
-  for (int i = 0; i < available_local_feature_num; i++) {
-    int feature_id = available_feature_ids[i];
-    local_splits_num =
-        local_splits_num + feature_helpers[feature_id].num_splits;
+  // compute local encrypted statistics, unless they are given
+  std::unique_ptr<LocalSplitStatistics> computed_statistics;
+  if (local_statistics == nullptr) {
+    computed_statistics = compute_local_split_statistics(
+        party, node_index, available_feature_ids, sample_mask_iv,
+        encrypted_labels, use_sample_weights, sss_sample_weights);
+    local_statistics = computed_statistics.get();
   }
+  log_info("[DecisionTreeBuilder.find_best_split] Finish computing local "
+           "statistics");
+  int local_splits_num = local_statistics->split_num, global_split_num = 0;
+  EncodedNumber **encrypted_statistics = local_statistics->statistics;
+  EncodedNumber *encrypted_left_branch_sample_nums =
+      local_statistics->left_sample_nums;
+  EncodedNumber *encrypted_right_branch_sample_nums =
+      local_statistics->right_sample_nums;
 
   // the global encrypted statistics for all possible splits
   EncodedNumber **global_encrypted_statistics;
   EncodedNumber *global_left_branch_sample_nums,
       *global_right_branch_sample_nums;
-  EncodedNumber **encrypted_statistics;
-  EncodedNumber *encrypted_left_branch_sample_nums,
-      *encrypted_right_branch_sample_nums;
   global_encrypted_statistics = new EncodedNumber *[MAX_GLOBAL_SPLIT_NUM];
   for (int i = 0; i < MAX_GLOBAL_SPLIT_NUM; i++) {
     global_encrypted_statistics[i] = new EncodedNumber[2 * class_num];
@@ -858,25 +896,6 @@ std::vector<double> DecisionTreeBuilder::find_best_split(
   global_right_branch_sample_nums = new EncodedNumber[MAX_GLOBAL_SPLIT_NUM];
   // std::vector<int> party_split_nums;
 
-  // compute local encrypted statistics
-  if (local_splits_num != 0) {
-    encrypted_statistics = new EncodedNumber *[local_splits_num];
-    for (int i = 0; i < local_splits_num; i++) {
-      // here 2 * class_num refers to left branch and right branch
-      encrypted_statistics[i] = new EncodedNumber[2 * class_num];
-    }
-    encrypted_left_branch_sample_nums = new EncodedNumber[local_splits_num];
-    encrypted_right_branch_sample_nums = new EncodedNumber[local_splits_num];
-    // call compute function
-    compute_encrypted_statistics(
-        party, node_index, available_feature_ids, sample_mask_iv,
-        encrypted_statistics, encrypted_labels,
-        encrypted_left_branch_sample_nums, encrypted_right_branch_sample_nums,
-        use_sample_weights, sss_sample_weights);
-  }
-  log_info("[DecisionTreeBuilder.find_best_split] Finish computing local "
-           "statistics");
-
   if (party.party_type == falcon::ACTIVE_PARTY) {
     // pack self
     if (local_splits_num == 0) {
@@ -1008,12 +1027,22 @@ std::vector<double> DecisionTreeBuilder::find_best_split(
   }
   log_info("[DecisionTreeBuilder.find_best_split]: branch_sample_nums_prec = " +
            std::to_string(branch_sample_nums_prec));
+  // the branch sample nums are bounded by the training data size, pack them
+  // into fewer ciphertexts for decryption, unless weighted by the samples
+  int sample_nums_bits = 0;
+  if (!use_sample_weights) {
+    while ((1L << sample_nums_bits) <= train_data_size) {
+      sample_nums_bits++;
+    }
+  }
   ciphers_to_secret_shares(party, global_left_branch_sample_nums,
                            left_sample_nums_shares, global_split_num,
-                           ACTIVE_PARTY_ID, branch_sample_nums_prec);
+                           ACTIVE_PARTY_ID, branch_sample_nums_prec,
+                           sample_nums_bits);
   ciphers_to_secret_shares(party, global_right_branch_sample_nums,
                            right_sample_nums_shares, global_split_num,
-                           ACTIVE_PARTY_ID, branch_sample_nums_prec);
+                           ACTIVE_PARTY_ID, branch_sample_nums_prec,
+                           sample_nums_bits);
   for (int i = 0; i < global_split_num; i++) {
     std::vector<double> tmp;
     ciphers_to_secret_shares(party, global_encrypted_statistics[i], tmp,
@@ -1049,52 +1078,64 @@ std::vector<double> DecisionTreeBuilder::find_best_split(
     private_values.push_back(right_sample_nums_shares[i]);
   }
   falcon::SpdzTreeCompType comp_type = falcon::FIND_BEST_SPLIT;
-  std::promise<std::vector<double>> promise_values;
-  std::future<std::vector<double>> future_values = promise_values.get_future();
-  std::thread spdz_pruning_check_thread(
-      spdz_tree_computation, party.party_num, party.party_id,
-      party.executor_mpc_ports, party.host_names, public_values.size(),
-      public_values, private_values.size(), private_values, comp_type,
-      &promise_values);
+  std::future<std::vector<double>> future_values =
+      spdz_computation_async(spdz_tree_computation, party.spdz_session,
+                             public_values.size(), public_values,
+                             private_values.size(), private_values, comp_type);
   // the result values are as follows (assume public in this version):
   // best_split_index (global), best_left_impurity, and best_right_impurity
   std::vector<double> res = future_values.get();
-  spdz_pruning_check_thread.join();
   log_info("[DecisionTreeBuilder.find_best_split]: communicate with spdz "
            "program finished");
 
   delete[] global_left_branch_sample_nums;
   delete[] global_right_branch_sample_nums;
-  delete[] encrypted_left_branch_sample_nums;
-  delete[] encrypted_right_branch_sample_nums;
   for (int i = 0; i < MAX_GLOBAL_SPLIT_NUM; i++) {
     delete[] global_encrypted_statistics[i];
   }
   delete[] global_encrypted_statistics;
-  for (int i = 0; i < local_splits_num; i++) {
-    delete[] encrypted_statistics[i];
-  }
-  delete[] encrypted_statistics;
 
   return res;
 }
 
+std::unique_ptr<LocalSplitStatistics>
+DecisionTreeBuilder::compute_local_split_statistics(
+    const Party &party, int node_index,
+    const std::vector<int> &available_feature_ids,
+    EncodedNumber *sample_mask_iv, EncodedNumber *encrypted_labels,
+    bool use_sample_weights, const std::vector<double> &sss_sample_weights) {
+  int local_splits_num = 0;
+  for (int feature_id : available_feature_ids) {
+    local_splits_num += feature_helpers[feature_id].num_splits;
+  }
+  std::unique_ptr<LocalSplitStatistics> local_statistics(
+      new LocalSplitStatistics(local_splits_num, class_num));
+  if (local_splits_num != 0) {
+    compute_encrypted_statistics(
+        party, node_index, available_feature_ids, sample_mask_iv,
+        local_statistics->statistics, encrypted_labels,
+        local_statistics->left_sample_nums,
+        local_statistics->right_sample_nums, use_sample_weights,
+        sss_sample_weights);
+  }
+  return local_statistics;
+}
+
 void DecisionTreeBuilder::encrypt_left_right_impu(
     const Party &party, double left_impurity, double right_impurity,
     EncodedNumber &encrypted_left_impurity,
     EncodedNumber &encrypted_right_impurity) {
   // retrieve phe pub key
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   encrypted_left_impurity.set_double(phe_pub_key->n[0], left_impurity,
                                      PHE_FIXED_POINT_PRECISION);
   encrypted_right_impurity.set_double(phe_pub_key->n[0], right_impurity,
                                       PHE_FIXED_POINT_PRECISION);
-  djcs_t_aux_encrypt(phe_pub_key, party.phe_random, encrypted_left_impurity,
-                     encrypted_left_impurity);
-  djcs_t_aux_encrypt(phe_pub_key, party.phe_random, encrypted_right_impurity,
-                     encrypted_right_impurity);
-  djcs_t_free_public_key(phe_pub_key);
+  djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                     encrypted_left_impurity, encrypted_left_impurity);
+  djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                     encrypted_right_impurity, encrypted_right_impurity);
 }
 
 void DecisionTreeBuilder::compute_encrypted_statistics(
@@ -1123,8 +1164,8 @@ void DecisionTreeBuilder::compute_encrypted_statistics(
   clock_gettime(CLOCK_MONOTONIC, &start);
 
   // retrieve phe pub key
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   int split_index = 0;
   int available_feature_num = (int)available_feature_ids.size();
   int sample_num = (int)training_data.size();
@@ -1171,17 +1212,16 @@ void DecisionTreeBuilder::compute_encrypted_statistics(
     // compute the encrypted aggregation of split_num + 1 buckets
     auto *left_sums = new EncodedNumber[split_num];
     auto *right_sums = new EncodedNumber[split_num];
+    // the accumulators below never leave the party, they are added to the
+    // fresh encryptions of the *_help accumulators before being written out,
+    // so they can start from the trivial (deterministic) encrypted zero
     EncodedNumber total_sum;
-    total_sum.set_double(phe_pub_key->n[0], 0.0, sorted_sample_iv_prec);
-    djcs_t_aux_encrypt(phe_pub_key, party.phe_random, total_sum, total_sum);
-    for (int idx = 0; idx < split_num; idx++) {
-      left_sums[idx].set_double(phe_pub_key->n[0], 0.0, sorted_sample_iv_prec);
-      right_sums[idx].set_double(phe_pub_key->n[0], 0.0, sorted_sample_iv_prec);
-      djcs_t_aux_encrypt(phe_pub_key, party.phe_random, left_sums[idx],
-                         left_sums[idx]);
-      djcs_t_aux_encrypt(phe_pub_key, party.phe_random, right_sums[idx],
-                         right_sums[idx]);
-    }
+    party.phe_constant_factory->encrypt_zero(total_sum, sorted_sample_iv_prec,
+                                             true);
+    party.phe_constant_factory->encrypt_zeros(left_sums, split_num,
+                                              sorted_sample_iv_prec, true);
+    party.phe_constant_factory->encrypt_zeros(right_sums, split_num,
+                                              sorted_sample_iv_prec, true);
     // compute the encrypted statistics for each class
     auto **left_stats = new EncodedNumber *[split_num];
     auto **right_stats = new EncodedNumber *[split_num];
@@ -1190,21 +1230,18 @@ void DecisionTreeBuilder::compute_encrypted_statistics(
       left_stats[k] = new EncodedNumber[class_num];
       right_stats[k] = new EncodedNumber[class_num];
     }
+    // the statistics accumulators start at the precision the statistics end
+    // up with, so that the additions below never need to align the precision
+    int labels_prec = std::max(PHE_FIXED_POINT_PRECISION,
+                               std::abs(encrypted_labels[0].getter_exponent()));
     for (int k = 0; k < split_num; k++) {
-      for (int c = 0; c < class_num; c++) {
-        left_stats[k][c].set_double(phe_pub_key->n[0], 0);
-        right_stats[k][c].set_double(phe_pub_key->n[0], 0);
-        djcs_t_aux_encrypt(phe_pub_key, party.phe_random, left_stats[k][c],
-                           left_stats[k][c]);
-        djcs_t_aux_encrypt(phe_pub_key, party.phe_random, right_stats[k][c],
-                           right_stats[k][c]);
-      }
-    }
-    for (int c = 0; c < class_num; c++) {
-      sums_stats[c].set_double(phe_pub_key->n[0], 0);
-      djcs_t_aux_encrypt(phe_pub_key, party.phe_random, sums_stats[c],
-                         sums_stats[c]);
+      party.phe_constant_factory->encrypt_zeros(left_stats[k], class_num,
+                                                labels_prec, true);
+      party.phe_constant_factory->encrypt_zeros(right_stats[k], class_num,
+                                                labels_prec, true);
     }
+    party.phe_constant_factory->encrypt_zeros(sums_stats, class_num,
+                                              labels_prec, true);
     // compute sample iv statistics by one traverse
     int split_iterator = 0;
     for (int sample_idx = 0; sample_idx < sample_num; sample_idx++) {
@@ -1246,25 +1283,21 @@ void DecisionTreeBuilder::compute_encrypted_statistics(
 
     // write the left sums to encrypted_left_sample_nums and update the right
     // sums
+    // the left helpers are written out, so they take fresh encrypted zeros
+    // from the reservoir, the right helpers are overwritten before use
     EncodedNumber left_num_help, right_num_help, plain_constant_help;
-    left_num_help.set_double(phe_pub_key->n[0], 0.0, sorted_sample_iv_prec);
-    right_num_help.set_double(phe_pub_key->n[0], 0.0, sorted_sample_iv_prec);
+    party.phe_constant_factory->encrypt_zero(left_num_help,
+                                             sorted_sample_iv_prec);
+    party.phe_constant_factory->encrypt_zero(right_num_help,
+                                             sorted_sample_iv_prec, true);
     plain_constant_help.set_integer(phe_pub_key->n[0], -1);
-    djcs_t_aux_encrypt(phe_pub_key, party.phe_random, left_num_help,
-                       left_num_help);
-    djcs_t_aux_encrypt(phe_pub_key, party.phe_random, right_num_help,
-                       right_num_help);
 
     auto *left_stat_help = new EncodedNumber[class_num];
     auto *right_stat_help = new EncodedNumber[class_num];
-    for (int c = 0; c < class_num; c++) {
-      left_stat_help[c].set_double(phe_pub_key->n[0], 0);
-      right_stat_help[c].set_double(phe_pub_key->n[0], 0);
-      djcs_t_aux_encrypt(phe_pub_key, party.phe_random, left_stat_help[c],
-                         left_stat_help[c]);
-      djcs_t_aux_encrypt(phe_pub_key, party.phe_random, right_stat_help[c],
-                         right_stat_help[c]);
-    }
+    party.phe_constant_factory->encrypt_zeros(left_stat_help, class_num,
+                                              labels_prec);
+    party.phe_constant_factory->encrypt_zeros(right_stat_help, class_num,
+                                              labels_prec, true);
 
     // compute right sample num of the current split by total_sum + (-1) *
     // left_sum_help
@@ -1272,16 +1305,16 @@ void DecisionTreeBuilder::compute_encrypted_statistics(
       djcs_t_aux_ee_add_ext(phe_pub_key, left_num_help, left_num_help,
                             left_sums[k]);
       encrypted_left_sample_nums[split_index] = left_num_help;
-      djcs_t_aux_ep_mul(phe_pub_key, right_num_help, left_num_help,
-                        plain_constant_help);
+      djcs_t_aux_signed_ep_mul(phe_pub_key, right_num_help, left_num_help,
+                               plain_constant_help);
       djcs_t_aux_ee_add_ext(phe_pub_key,
                             encrypted_right_sample_nums[split_index], total_sum,
                             right_num_help);
       for (int c = 0; c < class_num; c++) {
         djcs_t_aux_ee_add_ext(phe_pub_key, left_stat_help[c], left_stat_help[c],
                               left_stats[k][c]);
-        djcs_t_aux_ep_mul(phe_pub_key, right_stat_help[c], left_stat_help[c],
-                          plain_constant_help);
+        djcs_t_aux_signed_ep_mul(phe_pub_key, right_stat_help[c],
+                                 left_stat_help[c], plain_constant_help);
         djcs_t_aux_ee_add_ext(phe_pub_key, right_stat_help[c],
                               right_stat_help[c], sums_stats[c]);
         encrypted_statistics[split_index][2 * c] = left_stat_help[c];
@@ -1305,7 +1338,6 @@ void DecisionTreeBuilder::compute_encrypted_statistics(
     delete[] right_stat_help;
   }
   delete[] weighted_sample_mask_iv;
-  djcs_t_free_public_key(phe_pub_key);
 
   struct timespec finish;
   clock_gettime(CLOCK_MONOTONIC, &finish);
@@ -1394,23 +1426,22 @@ void DecisionTreeBuilder::update_mask_iv_and_labels(
     std::string &update_str_encrypted_labels_left,
     std::string &update_str_encrypted_labels_right) {
   // retrieve phe pub key
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   // compute between split_iv and sample_iv and update
-  std::vector<int> split_left_iv =
+  // the left child selects the parent by the left indicator vector (fresh
+  // randomness per sample), and the right child is parent minus left, as the
+  // right indicator vector is 1 - left, which is re-randomized by the same
+  // randomness
+  const std::vector<int> &split_left_iv =
       feature_helpers[j_star].split_ivs_left[s_star];
-  std::vector<int> split_right_iv =
-      feature_helpers[j_star].split_ivs_right[s_star];
-  for (int i = 0; i < sample_num; i++) {
-    EncodedNumber left, right;
-    left.set_integer(phe_pub_key->n[0], split_left_iv[i]);
-    right.set_integer(phe_pub_key->n[0], split_right_iv[i]);
-    djcs_t_aux_ep_mul(phe_pub_key, sample_mask_iv_left[i], sample_mask_iv[i],
-                      left);
-    djcs_t_aux_ep_mul(phe_pub_key, sample_mask_iv_right[i], sample_mask_iv[i],
-                      right);
-  }
+  djcs_t_aux_masked_select(phe_pub_key, party.phe_random_pool.get(),
+                           sample_mask_iv_left, sample_mask_iv, split_left_iv,
+                           sample_num);
+  djcs_t_aux_vec_ele_wise_ee_sub(phe_pub_key, sample_mask_iv_right,
+                                 sample_mask_iv, sample_mask_iv_left,
+                                 sample_num);
 
   // serialize and send to the other clients
   serialize_update_info(party.party_id, party.party_id, j_star, s_star,
@@ -1420,23 +1451,20 @@ void DecisionTreeBuilder::update_mask_iv_and_labels(
 
   // compute between split_iv and encrypted_labels and update
   for (int i = 0; i < class_num; i++) {
-    for (int j = 0; j < sample_num; j++) {
-      EncodedNumber left, right;
-      left.set_integer(phe_pub_key->n[0], split_left_iv[j]);
-      right.set_integer(phe_pub_key->n[0], split_right_iv[j]);
-      djcs_t_aux_ep_mul(phe_pub_key, encrypted_labels_left[i * sample_num + j],
-                        encrypted_labels[i * sample_num + j], left);
-      djcs_t_aux_ep_mul(phe_pub_key, encrypted_labels_right[i * sample_num + j],
-                        encrypted_labels[i * sample_num + j], right);
-    }
+    djcs_t_aux_masked_select(phe_pub_key, party.phe_random_pool.get(),
+                             encrypted_labels_left + i * sample_num,
+                             encrypted_labels + i * sample_num, split_left_iv,
+                             sample_num);
+    djcs_t_aux_vec_ele_wise_ee_sub(
+        phe_pub_key, encrypted_labels_right + i * sample_num,
+        encrypted_labels + i * sample_num,
+        encrypted_labels_left + i * sample_num, sample_num);
   }
   // serialize and send to the other client
   serialize_encoded_number_array(encrypted_labels_left, class_num * sample_num,
                                  update_str_encrypted_labels_left);
   serialize_encoded_number_array(encrypted_labels_right, class_num * sample_num,
                                  update_str_encrypted_labels_right);
-
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void DecisionTreeBuilder::lime_train(
@@ -2174,9 +2202,6 @@ void DecisionTreeBuilder::calc_eval_accuracy(
   // 4. If label is matched, correct_num += 1, otherwise, continue
   // 5. Return the final test accuracy by correct_num / dataset.size()
 
-  // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
   int dataset_size = (int)eval_dataset.size();
 
   // step 2: call tree model predict function to obtain predicted_labels
@@ -2240,77 +2265,22 @@ void DecisionTreeBuilder::calc_eval_accuracy(
 
   delete[] predicted_labels;
   delete[] decrypted_labels;
-  djcs_t_free_public_key(phe_pub_key);
 }
 
-void spdz_tree_computation(int party_num, int party_id,
-                           std::vector<int> mpc_tree_port_bases,
-                           std::vector<std::string> party_host_names,
+void spdz_tree_computation(std::shared_ptr<SpdzSession> spdz_session,
                            int public_value_size,
                            const std::vector<int> &public_values,
                            int private_value_size,
                            const std::vector<double> &private_values,
                            falcon::SpdzTreeCompType tree_comp_type,
                            std::promise<std::vector<double>> *res) {
-  std::vector<ssl_socket *> mpc_sockets(party_num);
-  //  setup_sockets(party_num,
-  //                party_id,
-  //                std::move(mpc_player_path),
-  //                std::move(party_host_names),
-  //                mpc_port_base,
-  //                mpc_sockets);
-  // Here put the whole setup socket code together, as using a function call
-  // would result in a problem when deleting the created sockets
-  // setup connections from this party to each spdz party socket
-  vector<int> plain_sockets(party_num);
-  // ssl_ctx ctx(mpc_player_path, "C" + to_string(party_id));
-  ssl_ctx ctx("C" + to_string(party_id));
-  // std::cout << "correct init ctx" << std::endl;
-  ssl_service io_service;
-  octetStream specification;
-  log_info("[spdz_tree_computation] begin connect to spdz parties");
-  log_info("[spdz_tree_computation] party_num = " + std::to_string(party_num));
-  for (int i = 0; i < party_num; i++) {
-    set_up_client_socket(plain_sockets[i], party_host_names[i].c_str(),
-                         mpc_tree_port_bases[i] + i);
-    send(plain_sockets[i], (octet *)&party_id, sizeof(int));
-    mpc_sockets[i] =
-        new ssl_socket(io_service, ctx, plain_sockets[i], "P" + to_string(i),
-                       "C" + to_string(party_id), true);
-    if (i == 0) {
-      // receive gfp prime
-      specification.Receive(mpc_sockets[0]);
-    }
-    std::cout << "Set up socket connections for " << i
-              << "-th spdz party succeed,"
-                 " sockets = "
-              << mpc_sockets[i] << ", port_num = " << mpc_tree_port_bases[i] + i
-              << "." << endl;
-    LOG(INFO) << "Set up socket connections for " << i
-              << "-th spdz party succeed,"
-                 " sockets = "
-              << mpc_sockets[i] << ", port_num = " << mpc_tree_port_bases[i] + i
-              << ".";
-  }
-  log_info("[spdz_tree_computation] Finish setup socket connections to spdz "
-           "engines.");
-  int type = specification.get<int>();
-  switch (type) {
-  case 'p': {
-    gfp::init_field(specification.get<bigint>());
-    std::cout << "Using prime " << gfp::pr() << std::endl;
-    LOG(INFO) << "Using prime " << gfp::pr();
-    break;
-  }
-  default:
-    log_info("[spdz_tree_computation] Type " + std::to_string(type) +
-             " not implemented");
-    exit(EXIT_FAILURE);
-  }
-  log_info("[spdz_tree_computation] Finish initializing gfp field.");
-  // std::cout << "Finish initializing gfp field." << std::endl;
-  // std::cout << "batch aggregation size = " << batch_aggregation_shares.size()
-  // << std::endl; send data to spdz parties
+  // the computation runs on the party's spdz connections, which are opened
+  // by the first computation of the session
+  SpdzComputation computation(*spdz_session);
+  std::vector<ssl_socket *> &mpc_sockets = computation.sockets();
+  int party_num = spdz_session->getter_party_num();
+  int party_id = spdz_session->getter_party_id();
+
   log_info("[spdz_tree_computation] party_id = " + std::to_string(party_id));
   if (party_id == ACTIVE_PARTY_ID) {
     // the active party sends computation id for spdz computation
@@ -2421,16 +2391,6 @@ void spdz_tree_computation(int party_num, int party_id,
         "[spdz_tree_computation] SPDZ tree computation type is not found.");
     exit(1);
   }
-
-  for (int i = 0; i < party_num; i++) {
-    close_client_socket(plain_sockets[i]);
-  }
-
-  // free memory and close mpc_sockets
-  for (int i = 0; i < party_num; i++) {
-    delete mpc_sockets[i];
-    mpc_sockets[i] = nullptr;
-  }
 }
 
 TreeModel DecisionTreeBuilder::aggregate_decrypt_tree_model(Party &party) {
@@ -203,8 +203,8 @@ void TreeModel::predict(Party &party,
   ///         and homomorphic add together, call share decryption
 
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   // step 1: organize the leaf label vector, compute the map
   log_info("Tree internal node num = " + std::to_string(internal_node_num));
@@ -222,7 +222,6 @@ void TreeModel::predict(Party &party,
     // 0: current leaf node doesn't need to be checked
     std::vector<int> binary_vector =
         comp_predict_vector(predicted_samples[i], node_index_2_leaf_index_map);
-    auto *encoded_binary_vector = new EncodedNumber[binary_vector.size()];
     auto *updated_label_vector = new EncodedNumber[binary_vector.size()];
 
     // print label for debug
@@ -233,17 +232,9 @@ void TreeModel::predict(Party &party,
     // update in Robin cycle, from the last client to client 0
     if (party.party_id == party.party_num - 1) {
       // updated_label_vector = new EncodedNumber[binary_vector.size()];
-      for (int j = 0; j < binary_vector.size(); j++) {
-        encoded_binary_vector[j].set_integer(phe_pub_key->n[0],
-                                             binary_vector[j]);
-        //        log_info("[predict]: label_vector[" + std::to_string(j) +
-        //        "].type = " + std::to_string(label_vector[j].getter_type()));
-        //        log_info("[predict]: encoded_binary_vector[" +
-        //        std::to_string(j) + "].type = " +
-        //        std::to_string(encoded_binary_vector[j].getter_type()));
-        djcs_t_aux_ep_mul(phe_pub_key, updated_label_vector[j], label_vector[j],
-                          encoded_binary_vector[j]);
-      }
+      djcs_t_aux_masked_select(phe_pub_key, party.phe_random_pool.get(),
+                               updated_label_vector, label_vector,
+                               binary_vector, (int)binary_vector.size());
       // send to the next client
       std::string send_s;
       serialize_encoded_number_array(updated_label_vector,
@@ -254,12 +245,9 @@ void TreeModel::predict(Party &party,
       party.recv_long_message(party.party_id + 1, recv_s);
       deserialize_encoded_number_array(updated_label_vector,
                                        (int)binary_vector.size(), recv_s);
-      for (int j = 0; j < binary_vector.size(); j++) {
-        encoded_binary_vector[j].set_integer(phe_pub_key->n[0],
-                                             binary_vector[j]);
-        djcs_t_aux_ep_mul(phe_pub_key, updated_label_vector[j],
-                          updated_label_vector[j], encoded_binary_vector[j]);
-      }
+      djcs_t_aux_masked_select(phe_pub_key, party.phe_random_pool.get(),
+                               updated_label_vector, updated_label_vector,
+                               binary_vector, (int)binary_vector.size());
       std::string resend_s;
       serialize_encoded_number_array(updated_label_vector,
                                      (int)binary_vector.size(), resend_s);
@@ -271,12 +259,9 @@ void TreeModel::predict(Party &party,
       party.recv_long_message(party.party_id + 1, final_recv_s);
       deserialize_encoded_number_array(updated_label_vector,
                                        (int)binary_vector.size(), final_recv_s);
-      for (int j = 0; j < binary_vector.size(); j++) {
-        encoded_binary_vector[j].set_integer(phe_pub_key->n[0],
-                                             binary_vector[j]);
-        djcs_t_aux_ep_mul(phe_pub_key, updated_label_vector[j],
-                          updated_label_vector[j], encoded_binary_vector[j]);
-      }
+      djcs_t_aux_masked_select(phe_pub_key, party.phe_random_pool.get(),
+                               updated_label_vector, updated_label_vector,
+                               binary_vector, (int)binary_vector.size());
     }
 
     // after computing, only one element in updated_label_vector is 1, other is
@@ -291,14 +276,13 @@ void TreeModel::predict(Party &party,
     if (party.party_type == falcon::ACTIVE_PARTY) {
       predicted_labels[i].set_double(phe_pub_key->n[0], 0,
                                      PHE_FIXED_POINT_PRECISION);
-      djcs_t_aux_encrypt(phe_pub_key, party.phe_random, predicted_labels[i],
-                         predicted_labels[i]);
+      djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                         predicted_labels[i], predicted_labels[i]);
       for (int j = 0; j < binary_vector.size(); j++) {
         djcs_t_aux_ee_add_ext(phe_pub_key, predicted_labels[i],
                               predicted_labels[i], updated_label_vector[j]);
       }
     }
-    delete[] encoded_binary_vector;
     delete[] updated_label_vector;
   }
 
@@ -319,7 +303,6 @@ void TreeModel::predict(Party &party,
   }
 
   delete[] label_vector;
-  djcs_t_free_public_key(phe_pub_key);
   log_info("Compute predictions on samples finished");
 }
 
@@ -297,13 +297,10 @@ void launch_log_reg_parameter_server(
 
   log_info("Init logistic regression model");
   log_info("[launch_log_reg_ps]: test party's content.");
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party->getter_phe_pub_key(phe_pub_key);
   log_info("[launch_log_reg_ps]: okay.");
 
   auto ps = new LogRegParameterServer(*log_reg_model_builder, *party,
                                       ps_network_config_pb_str);
-  djcs_t_free_public_key(phe_pub_key);
 
   // here need to send the train/test data/labels to workers
   // also, need to send the phe keys to workers
@@ -774,13 +771,10 @@ void launch_mlp_parameter_server(Party *party, const std::string &params_pb_str,
 
   log_info("Init MLP model");
   log_info("[launch_mlp_parameter_server]: test party's content.");
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party->getter_phe_pub_key(phe_pub_key);
   log_info("[launch_mlp_parameter_server]: okay.");
 
   auto ps =
       new MlpParameterServer(*mlp_builder, *party, ps_network_config_pb_str);
-  djcs_t_free_public_key(phe_pub_key);
 
   // here need to send the train/test data/labels to workers
   // also, need to send the phe keys to workers
@@ -36,6 +36,7 @@ SOFTWARE.
 #include <falcon/inference/interpretability/lime/scaler.h>
 #include <falcon/model/model_io.h>
 #include <falcon/operator/conversion/op_conv.h>
+#include <falcon/operator/mpc/spdz_session.h>
 #include <falcon/party/info_exchange.h>
 #include <falcon/utils/base64.h>
 #include <falcon/utils/io_util.h>
@@ -457,16 +458,12 @@ void LimeExplainer::compute_dist_weights(
     public_values.push_back(total_feature_size);
 
     falcon::SpdzLimeCompType comp_type = falcon::DIST_WEIGHT;
-    std::promise<std::vector<double>> promise_values;
     std::future<std::vector<double>> future_values =
-        promise_values.get_future();
-    std::thread spdz_dist_weights(
-        spdz_lime_computation, party.party_num, party.party_id,
-        party.executor_mpc_ports, party.host_names, public_values.size(),
-        public_values, squared_dist_shares.size(), squared_dist_shares,
-        comp_type, &promise_values);
+        spdz_computation_async(spdz_lime_computation, party.spdz_session,
+                               public_values.size(), public_values,
+                               squared_dist_shares.size(), squared_dist_shares,
+                               comp_type);
     res = future_values.get();
-    spdz_dist_weights.join();
     log_info("[compute_dist_weights]: communicate with spdz finished");
     log_info("[compute_dist_weights]: res.size = " +
              std::to_string(res.size()));
@@ -523,16 +520,12 @@ void LimeExplainer::compute_dist_weights(
     }
 
     falcon::SpdzLimeCompType comp_type = falcon::KERNELSHAP_WEIGHT;
-    std::promise<std::vector<double>> promise_values;
     std::future<std::vector<double>> future_values =
-        promise_values.get_future();
-    std::thread spdz_dist_weights(spdz_lime_computation, party.party_num,
-                                  party.party_id, party.executor_mpc_ports,
-                                  party.host_names, public_values.size(),
-                                  public_values, private_values.size(),
-                                  private_values, comp_type, &promise_values);
+        spdz_computation_async(spdz_lime_computation, party.spdz_session,
+                               public_values.size(), public_values,
+                               private_values.size(), private_values,
+                               comp_type);
     res = future_values.get();
-    spdz_dist_weights.join();
     log_info("[compute_dist_weights]: communicate with spdz finished");
     log_info("[compute_dist_weights]: res.size = " +
              std::to_string(res.size()));
@@ -579,15 +572,15 @@ std::vector<double> LimeExplainer::compute_squared_dist(
   // 20221223: no need to do the following, just return the local_squared_sum
   // and provide to mpc
   /*
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   auto *local_squared_dist = new EncodedNumber[sample_size];
   for (int i = 0; i < sample_size; i++) {
     local_squared_dist[i].set_double(phe_pub_key->n[0],
                                      local_squared_sum[i],
                                      PHE_FIXED_POINT_PRECISION);
-    djcs_t_aux_encrypt(phe_pub_key, party.phe_random,
+    djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
                        local_squared_dist[i], local_squared_dist[i]);
   }
 
@@ -628,7 +621,6 @@ std::vector<double> LimeExplainer::compute_squared_dist(
   ACTIVE_PARTY_ID);
 
   delete[] local_squared_dist;
-  djcs_t_free_public_key(phe_pub_key);
   */
 }
 
@@ -1149,8 +1141,8 @@ std::vector<double> LimeExplainer::lime_decision_tree_train(
     const std::string &ps_network_str, int is_distributed, int distributed_role,
     int worker_id) {
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   std::vector<double> local_explanations;
 
@@ -1354,7 +1346,6 @@ std::vector<double> LimeExplainer::lime_decision_tree_train(
     delete tree_model_builder;
     delete worker;
   }
-  djcs_t_free_public_key(phe_pub_key);
   delete[] encrypted_labels;
   delete[] predictions_square;
   delete[] assist_predictions;
@@ -1634,16 +1625,16 @@ void lime_conv_pred_plain2cipher(Party party, const std::string &params_str,
            std::to_string(column_num));
 
   // retrieve phe pub key and phe random
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   if (party.party_type == falcon::ACTIVE_PARTY) {
     for (int i = 0; i < row_num; i++) {
       for (int j = 0; j < column_num; j++) {
         predictions[i][j].set_double(phe_pub_key->n[0], plain_predictions[i][j],
                                      2 * PHE_FIXED_POINT_PRECISION);
-        djcs_t_aux_encrypt(phe_pub_key, party.phe_random, predictions[i][j],
-                           predictions[i][j]);
+        djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                           predictions[i][j], predictions[i][j]);
       }
     }
   }
@@ -1662,7 +1653,6 @@ void lime_conv_pred_plain2cipher(Party party, const std::string &params_str,
     delete[] predictions[i];
   }
   delete[] predictions;
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void save_data_pred4baseline(
@@ -37,10 +37,7 @@ LimeParameterServer::LimeParameterServer(
     : ParameterServer(ps_network_config_pb_str), party(m_party) {
   log_info("[LimeParameterServer::LimeParameterServer]: constructor. Test "
            "party's content.");
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
   log_info("[LimeParameterServer::LimeParameterServer]: okay.");
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 LimeParameterServer::~LimeParameterServer() = default;
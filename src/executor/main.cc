@@ -29,6 +29,11 @@ SOFTWARE.
 #include "falcon/algorithm/vertical/linear_model/logistic_regression_ps.h"
 #include "falcon/distributed/worker.h"
 #include "falcon/inference/server/inference_server.h"
+#include "falcon/operator/conversion/op_conv.h"
+#include "falcon/operator/mpc/spdz_session.h"
+#include "falcon/operator/phe/gmp_arena.h"
+#include "falcon/operator/phe/phe_random_stream.h"
+#include "falcon/party/collectives.h"
 #include "falcon/party/party.h"
 #include "falcon/utils/base64.h"
 #include <boost/program_options.hpp>
@@ -39,6 +44,7 @@ SOFTWARE.
 #include <falcon/inference/interpretability/lime/lime.h>
 #include <falcon/utils/logger/logger.h>
 #include <falcon/utils/parser.h>
+#include <falcon/utils/thread_pool.h>
 #include <glog/logging.h>
 #include <iostream>
 #include <string>
@@ -51,6 +57,8 @@ void print_arguments(const boost::program_options::variables_map &vm);
 void handle_eptr(std::exception_ptr eptr);
 
 int main(int argc, char *argv[]) {
+  // before any thread is spawned, route the gmp allocations to the arenas
+  gmp_arena_install();
   google::InitGoogleLogging(argv[0]);
   std::cout << "------------- Entered executor -------------" << std::endl;
   // basic arguments
@@ -67,6 +75,14 @@ int main(int argc, char *argv[]) {
   // for serving params
   int is_inference = 0;
   std::string inference_endpoint;
+  // threads of the crypto pool, 0 for the cpu quota of the process
+  int crypto_threads = 0;
+  // master seed of the encryption randomness streams, 0 for a random one
+  unsigned long phe_random_seed = 0;
+  int phe_deterministic = 0;
+  std::string reduce_topology_name = "star";
+  int sharded_decrypt_mode = 0;
+  int spdz_persistent_session = 0;
 
   // parse the arguments
   try {
@@ -111,7 +127,22 @@ int main(int argc, char *argv[]) {
                               "ps network file")(
             "worker-id", po::value<int>(&worker_id),
             "worker id")("distributed-role", po::value<int>(&distributed_role),
-                         "distributed role, worker:1, parameter server:0");
+                         "distributed role, worker:1, parameter server:0")(
+            "crypto-threads", po::value<int>(&crypto_threads),
+            "threads of the crypto operators, 0 for the cpu quota")(
+            "phe-random-seed", po::value<unsigned long>(&phe_random_seed),
+            "master seed of the deterministic mode, 0 for a random one")(
+            "phe-deterministic", po::value<int>(&phe_deterministic),
+            "reproducible encryption randomness for benchmarks, 1 to enable")(
+            "reduce-topology", po::value<std::string>(&reduce_topology_name),
+            "topology of the ciphertext reductions: star, tree or ring")(
+            "sharded-decrypt", po::value<int>(&sharded_decrypt_mode),
+            "combine the decryption shares by index range at all the "
+            "parties, 1 to enable")(
+            "spdz-persistent-session",
+            po::value<int>(&spdz_persistent_session),
+            "keep the connections to the mpc engines across the computations, "
+            "1 to enable");
 
     po::variables_map vm;
     po::store(po::command_line_parser(argc, argv).options(description).run(),
@@ -127,6 +158,13 @@ int main(int argc, char *argv[]) {
     LOG(INFO) << "Init log file.";
     // print the received arguments
     print_arguments(vm);
+    crypto_thread_pool_init(crypto_threads);
+    log_info("Crypto thread pool size = " +
+             std::to_string(CryptoThreadPoolUse()->getter_thread_num()));
+    phe_random_stream_init(phe_random_seed, phe_deterministic == 1);
+    reduce_topology_init(parse_reduce_topology(reduce_topology_name));
+    sharded_decrypt_init(sharded_decrypt_mode == 1);
+    spdz_session_persistent_init(spdz_persistent_session == 1);
   } catch (std::exception &e) {
     cout << e.what() << "\n";
     return 1;
@@ -46,6 +46,13 @@ void CommParty::writeWithSize(const byte* data, int size) {
 	write(data, size);
 }
 
+void CommParty::writeWithSize(const byte* header, int headerSize, const byte* data, int size) {
+	int totalSize = headerSize + size;
+	write((const byte *)&totalSize, sizeof(int));
+	write(header, headerSize);
+	write(data, size);
+}
+
 int CommParty::readSize() {
 	byte buf[sizeof(int)];
 	read(buf, sizeof(int));
@@ -117,6 +124,29 @@ size_t CommPartyTCPSynced::write(const byte* data, int size, int peer, int proto
                             boost::asio::transfer_all(), ec);
 }
 
+void CommPartyTCPSynced::writeWithSize(const byte* header, int headerSize, const byte* data, int size) {
+  // a single gather write of the size, the header and the data, which
+  // throws if the connection fails
+  int totalSize = headerSize + size;
+  std::vector<boost::asio::const_buffer> buffers = {
+      boost::asio::buffer(&totalSize, sizeof(int)),
+      boost::asio::buffer(header, headerSize),
+      boost::asio::buffer(data, size)};
+  bytesOut += sizeof(int) + totalSize;
+  boost::asio::write(socketForWrite(), buffers);
+}
+
+void CommPartyTCPSynced::shutdown() {
+  // the errors of a connection that is already closed are ignored
+  boost::system::error_code ec;
+  if (role != 1) {
+    serverSocket.shutdown(tcp::socket::shutdown_both, ec);
+  }
+  if (role != 0) {
+    clientSocket.shutdown(tcp::socket::shutdown_both, ec);
+  }
+}
+
 CommPartyTCPSynced::~CommPartyTCPSynced() {
   if (role != 1) {
     acceptor_.close();
@@ -0,0 +1,197 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//
+// Created by root on 10/18/26.
+//
+
+#include <falcon/network/async_channel.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// the frame header: phase, node and batch of the tag
+static const int TAG_BYTES = 3 * sizeof(int);
+
+AsyncChannel::AsyncChannel(std::shared_ptr<CommParty> channel,
+                           long max_pending_bytes)
+    : state(std::make_shared<State>()) {
+  state->channel = std::move(channel);
+  state->max_pending_bytes = max_pending_bytes;
+  sender = std::thread(&AsyncChannel::send_loop, state);
+  receiver = std::thread(&AsyncChannel::recv_loop, state);
+}
+
+AsyncChannel::~AsyncChannel() {
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->closed = true;
+  }
+  state->send_cv.notify_all();
+  state->recv_cv.notify_all();
+  sender.join();
+  // the receiving thread may be blocked on the socket, which fails its read
+  // once the connection is shut down
+  state->channel->shutdown();
+  receiver.join();
+}
+
+std::future<void> AsyncChannel::send(const MessageTag &tag,
+                                     std::string message) {
+  OutMessage out;
+  out.header[0] = tag.phase;
+  out.header[1] = tag.node;
+  out.header[2] = tag.batch;
+  out.payload = std::move(message);
+  std::future<void> written = out.written.get_future();
+  long bytes = TAG_BYTES + (long)out.payload.size();
+
+  std::unique_lock<std::mutex> lock(state->mutex);
+  // a message larger than the limit is sent alone
+  state->send_cv.wait(lock, [this, bytes] {
+    return state->out_bytes == 0 ||
+           state->out_bytes + bytes <= state->max_pending_bytes;
+  });
+  state->out_queue.push_back(std::move(out));
+  state->out_bytes += bytes;
+  lock.unlock();
+  state->send_cv.notify_all();
+  return written;
+}
+
+std::future<std::string> AsyncChannel::recv(const MessageTag &tag) {
+  std::promise<std::string> received;
+  std::future<std::string> message = received.get_future();
+
+  std::lock_guard<std::mutex> lock(state->mutex);
+  auto it = state->mailbox.find(tag);
+  if (it != state->mailbox.end()) {
+    state->mailbox_bytes -= (long)it->second.front().size();
+    received.set_value(std::move(it->second.front()));
+    it->second.pop_front();
+    if (it->second.empty()) {
+      state->mailbox.erase(it);
+    }
+  } else if (state->error) {
+    received.set_exception(state->error);
+  } else {
+    state->waiting[tag].push_back(std::move(received));
+    state->waiting_num++;
+  }
+  // a full mailbox or a new receive may resume the receiving thread
+  state->recv_cv.notify_all();
+  return message;
+}
+
+void AsyncChannel::send_loop(std::shared_ptr<State> state) {
+  while (true) {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->send_cv.wait(
+        lock, [&state] { return state->closed || !state->out_queue.empty(); });
+    if (state->out_queue.empty()) {
+      return;
+    }
+    OutMessage out = std::move(state->out_queue.front());
+    state->out_queue.pop_front();
+    lock.unlock();
+
+    long bytes = TAG_BYTES + (long)out.payload.size();
+    try {
+      state->channel->writeWithSize((const byte *)out.header, TAG_BYTES,
+                                    (const byte *)out.payload.data(),
+                                    (int)out.payload.size());
+      out.written.set_value();
+    } catch (...) {
+      out.written.set_exception(std::current_exception());
+    }
+
+    lock.lock();
+    // the queued bytes are released once written, so that the memory of
+    // the queue is bounded
+    state->out_bytes -= bytes;
+    lock.unlock();
+    state->send_cv.notify_all();
+  }
+}
+
+void AsyncChannel::recv_loop(std::shared_ptr<State> state) {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(state->mutex);
+      state->recv_cv.wait(lock, [&state] {
+        return state->closed ||
+               state->mailbox_bytes <= state->max_pending_bytes ||
+               state->waiting_num > 0;
+      });
+      if (state->closed) {
+        return;
+      }
+    }
+
+    std::vector<byte> frame;
+    MessageTag tag;
+    std::string message;
+    try {
+      state->channel->readWithSizeIntoVector(frame);
+      if (frame.size() < (size_t)TAG_BYTES) {
+        throw std::runtime_error("The async channel frame is malformed.");
+      }
+      int header[3];
+      memcpy(header, frame.data(), TAG_BYTES);
+      tag = MessageTag(header[0], header[1], header[2]);
+      message.assign(reinterpret_cast<const char *>(frame.data()) + TAG_BYTES,
+                     frame.size() - TAG_BYTES);
+    } catch (...) {
+      // fail the pending and later receives
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->error = std::current_exception();
+      for (auto &it : state->waiting) {
+        for (auto &received : it.second) {
+          received.set_exception(state->error);
+        }
+      }
+      state->waiting.clear();
+      state->waiting_num = 0;
+      return;
+    }
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    auto it = state->waiting.find(tag);
+    if (it != state->waiting.end()) {
+      std::promise<std::string> received = std::move(it->second.front());
+      it->second.pop_front();
+      if (it->second.empty()) {
+        state->waiting.erase(it);
+      }
+      state->waiting_num--;
+      lock.unlock();
+      received.set_value(std::move(message));
+    } else {
+      state->mailbox_bytes += (long)message.size();
+      state->mailbox[tag].push_back(std::move(message));
+    }
+  }
+}
@@ -27,169 +27,175 @@ SOFTWARE.
 //
 
 #include <falcon/operator/conversion/op_conv.h>
+#include <falcon/operator/phe/phe_random_stream.h>
+#include <falcon/party/collectives.h>
 #include <falcon/party/info_exchange.h>
 #include <falcon/utils/base64.h>
 #include <falcon/utils/pb_converter/common_converter.h>
-#include <omp.h>
+#include <falcon/utils/thread_pool.h>
+#include <algorithm>
 
 #include <utility>
 
+static bool current_sharded_decrypt = false;
+
+void sharded_decrypt_init(bool sharded) { current_sharded_decrypt = sharded; }
+
+bool sharded_decrypt() { return current_sharded_decrypt; }
+
 void collaborative_decrypt(const Party &party, EncodedNumber *src_ciphers,
                            EncodedNumber *dest_plains, int size,
                            int req_party_id) {
+  if (reduce_topology() != falcon::STAR_TOPOLOGY) {
+    // each party raises its decryption shares to its coefficient, the
+    // weighted shares are multiplied along the reduction topology, and each
+    // party decrypts the products
+    auto *weighted_shares = new EncodedNumber[size];
+    auto *products = new EncodedNumber[size];
+    reduce_encoded_numbers(
+        party, req_party_id, weighted_shares, products, size, true,
+        [&](int begin, int end) {
+          djcs_t_aux_weighted_partial_decrypt_batch(
+              *party.phe_key_context, *party.phe_share_combiner,
+              party.party_id, weighted_shares + begin, src_ciphers + begin,
+              end - begin);
+        });
+    djcs_t_aux_weighted_share_combine_batch(*party.phe_share_combiner,
+                                            dest_plains, products, size);
+    delete[] weighted_shares;
+    delete[] products;
+    return;
+  }
 
-  //  log_info("[collaborative_decrypt] size = " + std::to_string(size));
-  //  const clock_t co_dec_start_time = clock();
-
-  // retrieve phe pub key and auth server
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  djcs_t_auth_server *phe_auth_server = djcs_t_init_auth_server();
-  party.getter_phe_pub_key(phe_pub_key);
-  party.getter_phe_auth_server(phe_auth_server);
-  // partially decrypt the ciphertext vector
+  // the decryption shares are computed, gathered and combined in chunks, so
+  // that the request party combines the received chunks while the other
+  // parties are still decrypting the next ones, and dest_plains is streamed
+  // back to them as it is combined
   auto *partial_decryption = new EncodedNumber[size];
-  omp_set_num_threads(NUM_OMP_THREADS);
-#pragma omp parallel for
-  for (int i = 0; i < size; i++) {
-    djcs_t_aux_partial_decrypt(phe_pub_key, phe_auth_server,
-                               partial_decryption[i], src_ciphers[i]);
+  auto partial_decrypt = [&](int begin, int end) {
+    // partially decrypt the ciphertext vector, with the decryption exponent
+    // precomputed in the party's key context
+    djcs_t_aux_partial_decrypt_batch(*party.phe_key_context,
+                                     partial_decryption + begin,
+                                     src_ciphers + begin, end - begin);
+  };
+
+  // create 2D-array m*n to store the decryption shares of a chunk,
+  // m = chunk size, n = party_num, such that each row i represents
+  // all the shares for the i-th ciphertext of the chunk
+  int chunk_size = std::min(size, PHE_STREAM_CHUNK_SIZE);
+  auto **decryption_shares = new EncodedNumber *[chunk_size];
+  for (int i = 0; i < chunk_size; i++) {
+    decryption_shares[i] = new EncodedNumber[party.party_num];
   }
-  //  const clock_t local_partial_dec_time = clock();
-  //  double local_dec_consumed_time =
-  //      double(local_partial_dec_time - co_dec_start_time) / CLOCKS_PER_SEC;
-  //  log_info("Collaborative local decryption time = " +
-  //  std::to_string(local_dec_consumed_time));
-
-  if (party.party_id == req_party_id) {
-    //
-    //    const clock_t agg_dec_shares_start_time = clock();
-
-    // create 2D-array m*n to store the decryption shares,
-    // m = size, n = party_num, such that each row i represents
-    // all the shares for the i-th ciphertext
-    auto **decryption_shares = new EncodedNumber *[size];
-    for (int i = 0; i < size; i++) {
-      decryption_shares[i] = new EncodedNumber[party.party_num];
-    }
-
-    // collect all the decryption shares
+  auto share_combine = [&](EncodedNumber **party_shares, EncodedNumber *dest,
+                           int n) {
     for (int id = 0; id < party.party_num; id++) {
-      if (id == party.party_id) {
-        // copy self partially decrypted shares
-        for (int i = 0; i < size; i++) {
-          decryption_shares[i][id] = partial_decryption[i];
-        }
-      } else {
-        std::string recv_partial_decryption_str;
-        party.recv_long_message(id, recv_partial_decryption_str);
-        auto *recv_partial_decryption = new EncodedNumber[size];
-        deserialize_encoded_number_array(recv_partial_decryption, size,
-                                         recv_partial_decryption_str);
-        // copy other party's decrypted shares
-        for (int i = 0; i < size; i++) {
-          decryption_shares[i][id] = recv_partial_decryption[i];
-        }
-        delete[] recv_partial_decryption;
+      for (int i = 0; i < n; i++) {
+        decryption_shares[i][id] = party_shares[id][i];
       }
     }
-
-    // share combine for decryption
-    omp_set_num_threads(NUM_OMP_THREADS);
-#pragma omp parallel for
-    for (int i = 0; i < size; i++) {
-      djcs_t_aux_share_combine(phe_pub_key, dest_plains[i],
-                               decryption_shares[i], party.party_num);
-    }
-
-    // free memory
-    for (int i = 0; i < size; i++) {
-      delete[] decryption_shares[i];
-    }
-    delete[] decryption_shares;
-
-    // serialize dest_plains and broadcast to all passive parties
-    std::string dest_plain_str;
-    serialize_encoded_number_array(dest_plains, size, dest_plain_str);
-    for (int id = 0; id < party.party_num; id++) {
-      if (id != party.party_id) {
-        party.send_long_message(id, dest_plain_str);
-      }
-    }
-    //
-    //    const clock_t agg_dec_shares_end_time = clock();
-    //    double active_party_agg_shares_time =
-    //        double(agg_dec_shares_end_time - agg_dec_shares_start_time) /
-    //        CLOCKS_PER_SEC;
-    //    log_info("Active party aggregate decryption shares time = " +
-    //    std::to_string(active_party_agg_shares_time));
-
+    // share combine for decryption, with the precomputed constants
+    djcs_t_aux_share_combine_batch(*party.phe_share_combiner, dest,
+                                   decryption_shares, n);
+  };
+  if (current_sharded_decrypt) {
+    // each party combines the shares of its own index range
+    shard_combine_encoded_numbers(party, partial_decryption, dest_plains,
+                                  size, share_combine, partial_decrypt);
   } else {
-    // send decrypted shares to the req_party_id
-    std::string partial_decryption_str;
-    serialize_encoded_number_array(partial_decryption, size,
-                                   partial_decryption_str);
-    party.send_long_message(req_party_id, partial_decryption_str);
+    std::vector<EncodedNumber *> chunk_shares(party.party_num);
+    combine_encoded_numbers(
+        party, req_party_id, partial_decryption, dest_plains, size,
+        [&](EncodedNumber **party_shares, int begin, int end) {
+          for (int id = 0; id < party.party_num; id++) {
+            chunk_shares[id] = party_shares[id] + begin;
+          }
+          share_combine(chunk_shares.data(), dest_plains + begin,
+                        end - begin);
+        },
+        true, partial_decrypt);
+  }
 
-    // receive and set dest_plains from active party
-    std::string recv_dest_plain_str;
-    party.recv_long_message(req_party_id, recv_dest_plain_str);
-    deserialize_encoded_number_array(dest_plains, size, recv_dest_plain_str);
+  for (int i = 0; i < chunk_size; i++) {
+    delete[] decryption_shares[i];
   }
+  delete[] decryption_shares;
+  delete[] partial_decryption;
+}
 
-  //  const clock_t co_dec_end_time = clock();
-  //  double co_dec_consumed_time =
-  //      double(co_dec_end_time - co_dec_start_time) / CLOCKS_PER_SEC;
-  //  log_info("Collaborative decryption time = " +
-  //  std::to_string(co_dec_consumed_time));
+void packed_collaborative_decrypt(const Party &party,
+                                  const PackedEncoder &encoder,
+                                  EncodedNumber *src_ciphers,
+                                  EncodedNumber *dest_plains, int size,
+                                  int req_party_id) {
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
+  // every party packs the same ciphertexts into the same packed ones
+  int packed_size = encoder.packed_size(size);
+  auto *packed_ciphers = new EncodedNumber[packed_size];
+  auto *packed_plains = new EncodedNumber[packed_size];
+  djcs_t_aux_pack_ciphers(phe_pub_key, encoder, packed_ciphers, src_ciphers,
+                          size);
+  collaborative_decrypt(party, packed_ciphers, packed_plains, packed_size,
+                        req_party_id);
+  encoder.unpack(dest_plains, packed_plains, size);
 
-  delete[] partial_decryption;
-  djcs_t_free_public_key(phe_pub_key);
-  djcs_t_free_auth_server(phe_auth_server);
+  delete[] packed_ciphers;
+  delete[] packed_plains;
 }
 
 void ciphers_to_secret_shares(const Party &party, EncodedNumber *src_ciphers,
                               std::vector<double> &secret_shares, int size,
-                              int req_party_id, int phe_precision) {
+                              int req_party_id, int phe_precision,
+                              int packing_value_bits) {
   // retrieve phe pub key and auth server
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   // each party generates a random vector with size values
   // (the request party will add the summation to the share)
   // ui randomly chooses ri belongs to Zq and encrypts it as [ri]
   auto *encrypted_shares = new EncodedNumber[size];
   secret_shares = std::vector<double>(size, 0.0);
 
-  omp_set_num_threads(NUM_OMP_THREADS);
-#pragma omp parallel for
-  for (int i = 0; i < size; i++) {
-    // TODO: check how to replace with spdz random values
-    if (phe_precision != 0) {
+  // the share masks are drawn from the system seeded streams, only the
+  // deterministic mode (for benchmarks) encrypts with the per-chunk streams
+  // instead of the background pool
+  unsigned long loop = phe_random_stream_next_loop();
+  bool deterministic = phe_random_stream_deterministic();
+  crypto_parallel_for_chunks(0, size, [&](int begin, int end) {
+    hcs_random *stream = phe_random_stream(loop, begin);
+    hcs_random *secret_stream = phe_secret_random_stream();
+    for (int i = begin; i < end; i++) {
+      // TODO: check how to replace with spdz random values
       // 1. each party randomly choose a value and encrypt it.
-      auto s = static_cast<double>(rand() % MAXIMUM_RAND_VALUE);
-      encrypted_shares[i].set_double(phe_pub_key->n[0], s, phe_precision);
-      djcs_t_aux_encrypt(phe_pub_key, party.phe_random, encrypted_shares[i],
-                         encrypted_shares[i]);
+      int s = (int)gmp_urandomm_ui(secret_stream->rstate, MAXIMUM_RAND_VALUE);
+      if (phe_precision != 0) {
+        encrypted_shares[i].set_double(phe_pub_key->n[0], (double)s,
+                                       phe_precision);
+      } else {
+        encrypted_shares[i].set_integer(phe_pub_key->n[0], s);
+      }
+      if (deterministic) {
+        djcs_t_aux_encrypt(phe_pub_key, stream, encrypted_shares[i],
+                           encrypted_shares[i]);
+      } else {
+        djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                           encrypted_shares[i], encrypted_shares[i]);
+      }
       // 2. get -r
       secret_shares[i] = 0 - s;
-    } else {
-      int s = rand() % MAXIMUM_RAND_VALUE;
-      encrypted_shares[i].set_integer(phe_pub_key->n[0], s);
-      djcs_t_aux_encrypt(phe_pub_key, party.phe_random, encrypted_shares[i],
-                         encrypted_shares[i]);
-      secret_shares[i] = 0 - s;
     }
-  }
+  }, PHE_RANDOM_STREAM_GRAIN);
 
   // 4. request party aggregate the shares and invoke collaborative decryption
   auto *aggregated_shares = new EncodedNumber[size];
   if (party.party_id == req_party_id) {
-    omp_set_num_threads(NUM_OMP_THREADS);
-#pragma omp parallel for
-    for (int i = 0; i < size; i++) {
+    crypto_parallel_for(0, size, [&](int i) {
       aggregated_shares[i] = encrypted_shares[i];
       djcs_t_aux_ee_add_ext(phe_pub_key, aggregated_shares[i],
                             aggregated_shares[i], src_ciphers[i]);
-    }
+    });
     // recv message and add to aggregated shares,
     // u1 computes [e] = [x]+[r1]+..+[rm]
     for (int id = 0; id < party.party_num; id++) {
@@ -198,20 +204,19 @@ void ciphers_to_secret_shares(const Party &party, EncodedNumber *src_ciphers,
         party.recv_long_message(id, recv_encrypted_shares_str);
         auto *recv_encrypted_shares = new EncodedNumber[size];
         deserialize_encoded_number_array(recv_encrypted_shares, size,
-                                         recv_encrypted_shares_str);
-        omp_set_num_threads(NUM_OMP_THREADS);
-#pragma omp parallel for
-        for (int i = 0; i < size; i++) {
+                                         recv_encrypted_shares_str,
+                                         party.phe_key_context->getter_n());
+        crypto_parallel_for(0, size, [&](int i) {
           djcs_t_aux_ee_add_ext(phe_pub_key, aggregated_shares[i],
                                 aggregated_shares[i], recv_encrypted_shares[i]);
-        }
+        });
         delete[] recv_encrypted_shares;
       }
     }
     // serialize and send to other parties
     std::string aggregated_shares_str;
     serialize_encoded_number_array(aggregated_shares, size,
-                                   aggregated_shares_str);
+                                   aggregated_shares_str, true);
     for (int id = 0; id < party.party_num; id++) {
       if (id != party.party_id) {
         party.send_long_message(id, aggregated_shares_str);
@@ -222,19 +227,43 @@ void ciphers_to_secret_shares(const Party &party, EncodedNumber *src_ciphers,
     // ui sends [ri] to u1
     std::string encrypted_shares_str;
     serialize_encoded_number_array(encrypted_shares, size,
-                                   encrypted_shares_str);
+                                   encrypted_shares_str, true);
     party.send_long_message(req_party_id, encrypted_shares_str);
 
     // receive aggregated shares from the request party
     std::string recv_aggregated_shares_str;
     party.recv_long_message(req_party_id, recv_aggregated_shares_str);
     deserialize_encoded_number_array(aggregated_shares, size,
-                                     recv_aggregated_shares_str);
+                                     recv_aggregated_shares_str,
+                                     party.phe_key_context->getter_n());
   }
   // 5. collaborative decrypt the aggregated shares, clients jointly decrypt [e]
   auto *decrypted_sum = new EncodedNumber[size];
-  collaborative_decrypt(party, aggregated_shares, decrypted_sum, size,
-                        req_party_id);
+  // the parties hold the same aggregated shares and make the same choice
+  bool same_exponent = true;
+  for (int i = 1; i < size; i++) {
+    if (aggregated_shares[i].getter_exponent() !=
+        aggregated_shares[0].getter_exponent()) {
+      same_exponent = false;
+      break;
+    }
+  }
+  if (packing_value_bits > 0 && size > 0 && same_exponent) {
+    // e = x + r1 + ... + rm with ri < 2^15, scaled by the aggregated
+    // precision, so |e| < 2^{max(bits(x), 15) + bits(m) + precision}
+    int party_num_bits = 0;
+    while ((1 << party_num_bits) <= party.party_num) {
+      party_num_bits++;
+    }
+    int sum_bits = std::max(packing_value_bits, 15) + party_num_bits +
+                   std::abs(aggregated_shares[0].getter_exponent());
+    PackedEncoder encoder(phe_pub_key->n[0], sum_bits, 0);
+    packed_collaborative_decrypt(party, encoder, aggregated_shares,
+                                 decrypted_sum, size, req_party_id);
+  } else {
+    collaborative_decrypt(party, aggregated_shares, decrypted_sum, size,
+                          req_party_id);
+  }
   // if request party, add the decoded results to the secret shares
   // 6. u1 sets [x]1 = e − r1 mod q
   if (party.party_id == req_party_id) {
@@ -254,7 +283,6 @@ void ciphers_to_secret_shares(const Party &party, EncodedNumber *src_ciphers,
   delete[] encrypted_shares;
   delete[] aggregated_shares;
   delete[] decrypted_sum;
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void ciphers_mat_to_secret_shares_mat(
@@ -274,16 +302,16 @@ void secret_shares_to_ciphers(const Party &party, EncodedNumber *dest_ciphers,
                               std::vector<double> secret_shares, int size,
                               int req_party_id, int phe_precision) {
   // retrieve phe pub key and auth server
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   // encode and encrypt the secret shares and send to req_party,
   // req_party aggregates and send back to the other parties
   auto *encrypted_shares = new EncodedNumber[size];
   for (int i = 0; i < size; i++) {
     encrypted_shares[i].set_double(phe_pub_key->n[0], secret_shares[i],
                                    phe_precision);
-    djcs_t_aux_encrypt(phe_pub_key, party.phe_random, encrypted_shares[i],
-                       encrypted_shares[i]);
+    djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                       encrypted_shares[i], encrypted_shares[i]);
   }
 
   if (party.party_id == req_party_id) {
@@ -299,21 +327,20 @@ void secret_shares_to_ciphers(const Party &party, EncodedNumber *dest_ciphers,
         party.recv_long_message(id, recv_encrypted_shares_str);
         auto *recv_encrypted_shares = new EncodedNumber[size];
         deserialize_encoded_number_array(recv_encrypted_shares, size,
-                                         recv_encrypted_shares_str);
+                                         recv_encrypted_shares_str,
+                                         party.phe_key_context->getter_n());
         // homomorphic aggregation
-        omp_set_num_threads(NUM_OMP_THREADS);
-#pragma omp parallel for
-        for (int i = 0; i < size; i++) {
+        crypto_parallel_for(0, size, [&](int i) {
           djcs_t_aux_ee_add_ext(phe_pub_key, dest_ciphers[i], dest_ciphers[i],
                                 recv_encrypted_shares[i]);
-        }
+        });
         delete[] recv_encrypted_shares;
       }
     }
 
     // serialize dest_ciphers and broadcast
     std::string dest_ciphers_str;
-    serialize_encoded_number_array(dest_ciphers, size, dest_ciphers_str);
+    serialize_encoded_number_array(dest_ciphers, size, dest_ciphers_str, true);
     for (int id = 0; id < party.party_num; id++) {
       if (id != party.party_id) {
         party.send_long_message(id, dest_ciphers_str);
@@ -323,17 +350,17 @@ void secret_shares_to_ciphers(const Party &party, EncodedNumber *dest_ciphers,
     // serialize and send to req_party
     std::string encrypted_shares_str;
     serialize_encoded_number_array(encrypted_shares, size,
-                                   encrypted_shares_str);
+                                   encrypted_shares_str, true);
     party.send_long_message(req_party_id, encrypted_shares_str);
 
     // receive and set dest_ciphers
     std::string recv_dest_ciphers_str;
     party.recv_long_message(req_party_id, recv_dest_ciphers_str);
-    deserialize_encoded_number_array(dest_ciphers, size, recv_dest_ciphers_str);
+    deserialize_encoded_number_array(dest_ciphers, size, recv_dest_ciphers_str,
+                                     party.phe_key_context->getter_n());
   }
 
   delete[] encrypted_shares;
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void secret_shares_to_plain_double(const Party &party,
@@ -401,8 +428,8 @@ void ciphers_ele_wise_multi(const Party &party, EncodedNumber *res,
                             EncodedNumber *ciphers1, EncodedNumber *ciphers2,
                             int size, int req_party_id) {
   // retrieve phe pub key and auth server
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
   // step 1: convert ciphers 1 to secret shares
   int cipher1_precision = std::abs(ciphers1[0].getter_exponent());
   int cipher2_precision = std::abs(ciphers2[0].getter_exponent());
@@ -414,14 +441,12 @@ void ciphers_ele_wise_multi(const Party &party, EncodedNumber *res,
   // step 2: aggregate the plaintext and ciphers2 multiplication
   auto *global_aggregation = new EncodedNumber[size];
   auto *local_aggregation = new EncodedNumber[size];
-  omp_set_num_threads(NUM_OMP_THREADS);
-#pragma omp parallel for
-  for (int i = 0; i < size; i++) {
+  crypto_parallel_for(0, size, [&](int i) {
     encoded_ciphers1_shares[i].set_double(phe_pub_key->n[0],
                                           ciphers1_shares[i]);
     djcs_t_aux_ep_mul(phe_pub_key, local_aggregation[i], ciphers2[i],
                       encoded_ciphers1_shares[i]);
-  }
+  });
   if (party.party_id == req_party_id) {
     for (int i = 0; i < size; i++) {
       global_aggregation[i] = local_aggregation[i];
@@ -432,7 +457,8 @@ void ciphers_ele_wise_multi(const Party &party, EncodedNumber *res,
         std::string recv_local_aggregation_str;
         party.recv_long_message(id, recv_local_aggregation_str);
         deserialize_encoded_number_array(recv_local_aggregation, size,
-                                         recv_local_aggregation_str);
+                                         recv_local_aggregation_str,
+                                         party.phe_key_context->getter_n());
         for (int i = 0; i < size; i++) {
           djcs_t_aux_ee_add(phe_pub_key, global_aggregation[i],
                             global_aggregation[i], recv_local_aggregation[i]);
@@ -444,7 +470,7 @@ void ciphers_ele_wise_multi(const Party &party, EncodedNumber *res,
     // serialize and send to req_party_id
     std::string local_aggregation_str;
     serialize_encoded_number_array(local_aggregation, size,
-                                   local_aggregation_str);
+                                   local_aggregation_str, true);
     party.send_long_message(req_party_id, local_aggregation_str);
   }
   broadcast_encoded_number_array(party, global_aggregation, size, req_party_id);
@@ -457,7 +483,6 @@ void ciphers_ele_wise_multi(const Party &party, EncodedNumber *res,
   delete[] encoded_ciphers1_shares;
   delete[] global_aggregation;
   delete[] local_aggregation;
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void transpose_encoded_mat(EncodedNumber **source_mat, int n_source_row,
@@ -479,8 +504,8 @@ void cipher_shares_mat_mul(const Party &party,
                            int n_shares_col, int n_ciphers_row,
                            int n_ciphers_col, EncodedNumber **ret) {
   // retrieve phe pub key and auth server
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   // sanity check
   if (n_shares_row != shares.size() || n_shares_col != shares[0].size()) {
@@ -527,6 +552,13 @@ void cipher_shares_mat_mul(const Party &party,
   djcs_t_aux_mat_mat_ep_mult(phe_pub_key, party.phe_random, local_mul_res,
                              ciphers, encoded_shares, n_ciphers_row,
                              n_ciphers_col, n_shares_row, n_shares_col);
+  // the products are deterministic in the local shares, so they are
+  // re-randomized before leaving the party
+  for (int i = 0; i < n_shares_row; i++) {
+    djcs_t_aux_vec_rerandomize(phe_pub_key, party.phe_random_pool.get(),
+                               local_mul_res[i], local_mul_res[i],
+                               n_ciphers_col);
+  }
 
   //  broadcast_encoded_number_matrix(party, local_mul_res, n_shares_row,
   //  n_ciphers_col, 0); log_info("[cipher_shares_mat_mul] display local_mul_res
@@ -596,7 +628,6 @@ void cipher_shares_mat_mul(const Party &party,
   }
   delete[] encoded_shares;
   delete[] local_mul_res;
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 void cipher_shares_ele_wise_vec_mul(const Party &party,
@@ -608,8 +639,8 @@ void cipher_shares_ele_wise_vec_mul(const Party &party,
     exit(EXIT_FAILURE);
   }
   // retrieve phe pub key and auth server
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   auto *local_agg = new EncodedNumber[size];
   auto *plain_shares = new EncodedNumber[size];
@@ -630,7 +661,8 @@ void cipher_shares_ele_wise_vec_mul(const Party &party,
         party.recv_long_message(id, recv_local_agg_str);
         auto *recv_local_agg = new EncodedNumber[size];
         deserialize_encoded_number_array(recv_local_agg, size,
-                                         recv_local_agg_str);
+                                         recv_local_agg_str,
+                                         party.phe_key_context->getter_n());
         djcs_t_aux_vec_ele_wise_ee_add_ext(phe_pub_key, ret, ret,
                                            recv_local_agg, size);
         delete[] recv_local_agg;
@@ -638,7 +670,7 @@ void cipher_shares_ele_wise_vec_mul(const Party &party,
     }
   } else {
     std::string local_agg_str;
-    serialize_encoded_number_array(local_agg, size, local_agg_str);
+    serialize_encoded_number_array(local_agg, size, local_agg_str, true);
     party.send_long_message(ACTIVE_PARTY_ID, local_agg_str);
   }
 
@@ -646,7 +678,6 @@ void cipher_shares_ele_wise_vec_mul(const Party &party,
 
   delete[] local_agg;
   delete[] plain_shares;
-  djcs_t_free_public_key(phe_pub_key);
 }
 
 std::vector<double> display_shares_vector(const Party &party,
@@ -725,8 +756,8 @@ display_shares_matrix(const Party &party,
 void cipher_share_mul(const Party &party, const double &share,
                       const EncodedNumber &cipher, EncodedNumber &ret) {
   // each party get local key
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   // convert share to encoded number
   EncodedNumber encoded_cipher;
@@ -735,5 +766,4 @@ void cipher_share_mul(const Party &party, const double &share,
   // calculate squared mean value f
   djcs_t_aux_ep_mul(phe_pub_key, ret, cipher, encoded_cipher);
 
-  djcs_t_free_public_key(phe_pub_key);
 }
@@ -0,0 +1,137 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//
+// Created by root on 10/18/26.
+//
+
+#include <falcon/operator/mpc/spdz_session.h>
+
+#include <utility>
+
+static bool current_spdz_session_persistent = false;
+
+void spdz_session_persistent_init(bool persistent) {
+  current_spdz_session_persistent = persistent;
+}
+
+bool spdz_session_persistent() { return current_spdz_session_persistent; }
+
+SpdzSession::SpdzSession(int party_num, int party_id,
+                         std::vector<int> port_bases,
+                         std::vector<std::string> host_names, bool persistent)
+    : party_num(party_num), party_id(party_id),
+      port_bases(std::move(port_bases)), host_names(std::move(host_names)),
+      persistent(persistent), plain_sockets(party_num),
+      sockets(party_num, nullptr), connected(false), failed(false) {}
+
+SpdzSession::~SpdzSession() { close(); }
+
+std::shared_future<void> SpdzSession::enqueue(std::shared_future<void> end) {
+  std::lock_guard<std::mutex> guard(queue_mutex);
+  std::shared_future<void> previous = last_end;
+  last_end = end;
+  return previous;
+}
+
+void SpdzSession::mark_failed() {
+  std::lock_guard<std::mutex> guard(mutex);
+  failed = true;
+}
+
+void SpdzSession::close() {
+  if (connected) {
+    disconnect();
+    connected = false;
+  }
+}
+
+void SpdzSession::connect() {
+  if (!ctx) {
+    ctx.reset(new ssl_ctx("C" + to_string(party_id)));
+  }
+  octetStream specification;
+  for (int i = 0; i < party_num; i++) {
+    set_up_client_socket(plain_sockets[i], host_names[i].c_str(),
+                         port_bases[i] + i);
+    send(plain_sockets[i], (octet *)&party_id, sizeof(int));
+    sockets[i] =
+        new ssl_socket(io_service, *ctx, plain_sockets[i], "P" + to_string(i),
+                       "C" + to_string(party_id), true);
+    if (i == 0) {
+      // receive gfp prime
+      specification.Receive(sockets[0]);
+    }
+    LOG(INFO) << "Set up socket connections for " << i
+              << "-th spdz party succeed,"
+                 " sockets = "
+              << sockets[i] << ", port_num = " << port_bases[i] + i << ".";
+  }
+  log_info("Finish setup socket connections to spdz engines.");
+
+  int type = specification.get<int>();
+  switch (type) {
+  case 'p': {
+    // the field is global, it is only set up again if the prime changes
+    bigint prime = specification.get<bigint>();
+    if (gfp::pr() != prime) {
+      gfp::init_field(prime);
+      LOG(INFO) << "Using prime " << gfp::pr();
+    }
+    break;
+  }
+  default:
+    log_error("Type " + std::to_string(type) + " not implemented");
+    exit(EXIT_FAILURE);
+  }
+}
+
+void SpdzSession::disconnect() {
+  for (int i = 0; i < party_num; i++) {
+    close_client_socket(plain_sockets[i]);
+  }
+  // free memory and close sockets
+  for (int i = 0; i < party_num; i++) {
+    delete sockets[i];
+    sockets[i] = nullptr;
+  }
+}
+
+SpdzComputation::SpdzComputation(SpdzSession &session)
+    : session(session), lock(session.mutex) {
+  if (session.failed) {
+    session.close();
+    session.failed = false;
+  }
+  if (!session.connected) {
+    session.connect();
+    session.connected = true;
+  }
+}
+
+SpdzComputation::~SpdzComputation() {
+  if (!session.persistent) {
+    session.close();
+  }
+}
@@ -0,0 +1,220 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//
+// Created by root on 10/18/26.
+//
+
+#include "falcon/operator/phe/cipher_vector.h"
+
+#include <falcon/utils/logger/logger.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+CipherModulus::CipherModulus(const djcs_t_public_key *pk) {
+  mpz_init_set(n, pk->n[0]);
+  mpz_init_set(cipher_modulus, pk->n[pk->s]);
+  limb_num = (int)mpz_size(cipher_modulus);
+}
+
+CipherModulus::~CipherModulus() {
+  mpz_clear(n);
+  mpz_clear(cipher_modulus);
+}
+
+CipherVector::CipherVector() : size(0), exponent(0) {}
+
+CipherVector::CipherVector(std::shared_ptr<const CipherModulus> modulus,
+                           int size, int exponent)
+    : modulus(std::move(modulus)), size(size), exponent(exponent) {
+  if (size < 0) {
+    log_error("The cipher vector size is negative.");
+    exit(EXIT_FAILURE);
+  }
+  limbs.assign((size_t)size * this->modulus->limb_num, 0);
+}
+
+CipherVector::CipherVector(std::shared_ptr<const CipherModulus> modulus,
+                           const EncodedNumber *ciphers, int size)
+    : CipherVector(std::move(modulus), size,
+                   size > 0 ? ciphers[0].getter_exponent() : 0) {
+  for (int i = 0; i < size; i++) {
+    setter_encoded_number(i, ciphers[i]);
+  }
+}
+
+CipherVector::CipherVector(CipherVector &&other) noexcept
+    : modulus(std::move(other.modulus)), size(other.size),
+      exponent(other.exponent), limbs(std::move(other.limbs)) {
+  other.size = 0;
+}
+
+CipherVector &CipherVector::operator=(CipherVector &&other) noexcept {
+  if (this != &other) {
+    modulus = std::move(other.modulus);
+    size = other.size;
+    exponent = other.exponent;
+    limbs = std::move(other.limbs);
+    other.size = 0;
+  }
+  return *this;
+}
+
+void CipherVector::getter_value(int index, mpz_t value) const {
+  mpz_t tmp;
+  mpz_set(value, view(index, tmp));
+}
+
+void CipherVector::setter_value(int index, const mpz_t value) {
+  if (index < 0 || index >= size) {
+    log_error("The cipher vector index is out of range.");
+    exit(EXIT_FAILURE);
+  }
+  int value_limbs = (int)mpz_size(value);
+  if (mpz_sgn(value) < 0 || value_limbs > modulus->limb_num) {
+    log_error("The ciphertext is out of the ciphertext space.");
+    exit(EXIT_FAILURE);
+  }
+  mp_limb_t *dst = limbs.data() + (size_t)index * modulus->limb_num;
+  if (value_limbs > 0) {
+    memcpy(dst, mpz_limbs_read(value), value_limbs * sizeof(mp_limb_t));
+  }
+  std::fill(dst + value_limbs, dst + modulus->limb_num, 0);
+}
+
+mpz_srcptr CipherVector::view(int index, mpz_t tmp) const {
+  if (index < 0 || index >= size) {
+    log_error("The cipher vector index is out of range.");
+    exit(EXIT_FAILURE);
+  }
+  // mpz_roinit_n normalizes the leading zero limbs of the fixed width value
+  return mpz_roinit_n(tmp, limbs.data() + (size_t)index * modulus->limb_num,
+                      modulus->limb_num);
+}
+
+void CipherVector::getter_encoded_number(int index, EncodedNumber &res) const {
+  mpz_t value, n;
+  mpz_init(value);
+  mpz_init_set(n, modulus->n);
+  getter_value(index, value);
+  res.setter_n(n);
+  res.setter_value(value);
+  res.setter_exponent(exponent);
+  res.setter_type(Ciphertext);
+  mpz_clear(value);
+  mpz_clear(n);
+}
+
+void CipherVector::setter_encoded_number(int index,
+                                         const EncodedNumber &cipher) {
+  if (cipher.getter_type() != Ciphertext) {
+    log_error("The encoded number is not a ciphertext.");
+    exit(EXIT_FAILURE);
+  }
+  if (cipher.getter_exponent() != exponent) {
+    log_error("The ciphertext exponent does not match the cipher vector.");
+    exit(EXIT_FAILURE);
+  }
+  mpz_t value;
+  mpz_init(value);
+  cipher.getter_value(value);
+  setter_value(index, value);
+  mpz_clear(value);
+}
+
+void CipherVector::to_encoded_numbers(EncodedNumber *res) const {
+  for (int i = 0; i < size; i++) {
+    getter_encoded_number(i, res[i]);
+  }
+}
+
+CipherMatrix::CipherMatrix() : row_size(0), column_size(0) {}
+
+CipherMatrix::CipherMatrix(std::shared_ptr<const CipherModulus> modulus,
+                           int row_size, int column_size, int exponent)
+    : row_size(row_size), column_size(column_size),
+      data(std::move(modulus), row_size * column_size, exponent) {}
+
+CipherMatrix::CipherMatrix(std::shared_ptr<const CipherModulus> modulus,
+                           const EncodedNumber *ciphers, int row_size,
+                           int column_size)
+    : row_size(row_size), column_size(column_size),
+      data(std::move(modulus), ciphers, row_size * column_size) {}
+
+CipherMatrix::CipherMatrix(CipherMatrix &&other) noexcept
+    : row_size(other.row_size), column_size(other.column_size),
+      data(std::move(other.data)) {
+  other.row_size = 0;
+  other.column_size = 0;
+}
+
+CipherMatrix &CipherMatrix::operator=(CipherMatrix &&other) noexcept {
+  if (this != &other) {
+    row_size = other.row_size;
+    column_size = other.column_size;
+    data = std::move(other.data);
+    other.row_size = 0;
+    other.column_size = 0;
+  }
+  return *this;
+}
+
+void CipherMatrix::getter_value(int i, int j, mpz_t value) const {
+  data.getter_value(i * column_size + j, value);
+}
+
+void CipherMatrix::setter_value(int i, int j, const mpz_t value) {
+  data.setter_value(i * column_size + j, value);
+}
+
+mpz_srcptr CipherMatrix::view(int i, int j, mpz_t tmp) const {
+  return data.view(i * column_size + j, tmp);
+}
+
+void CipherMatrix::getter_row(int i, CipherVector &res) const {
+  res = CipherVector(data.getter_modulus(), column_size,
+                     data.getter_exponent());
+  mpz_t tmp;
+  for (int j = 0; j < column_size; j++) {
+    res.setter_value(j, view(i, j, tmp));
+  }
+}
+
+void CipherMatrix::setter_row(int i, const CipherVector &row) {
+  if (row.getter_size() != column_size ||
+      row.getter_exponent() != data.getter_exponent()) {
+    log_error("The row does not match the cipher matrix.");
+    exit(EXIT_FAILURE);
+  }
+  mpz_t tmp;
+  for (int j = 0; j < column_size; j++) {
+    setter_value(i, j, row.view(j, tmp));
+  }
+}
+
+void CipherMatrix::to_encoded_numbers(EncodedNumber *res) const {
+  data.to_encoded_numbers(res);
+}
@@ -27,68 +27,106 @@ SOFTWARE.
 //
 
 #include "falcon/operator/phe/djcs_t_aux.h"
+#include "falcon/operator/phe/gmp_arena.h"
+#include "falcon/operator/phe/mont_kernel.h"
+#include "falcon/operator/phe/multi_exp.h"
+#include "falcon/operator/phe/phe_random_stream.h"
 
+#include <algorithm>
 #include <cstdlib>
+#include <utility>
 #include <stdio.h>
 
 #include <falcon/utils/logger/logger.h>
+#include <falcon/utils/thread_pool.h>
 #include <glog/logging.h>
 
-#include "omp.h"
+/**
+ * the libhcs functions take non-const keys although they only read them,
+ * the borrowed const keys are passed through this cast
+ *
+ * @param pk: public key
+ * @return the same key without const
+ */
+static inline djcs_t_public_key *hcs_pub_key(const djcs_t_public_key *pk) {
+  return const_cast<djcs_t_public_key *>(pk);
+}
 
-void djcs_t_aux_encrypt(djcs_t_public_key *pk, hcs_random *hr,
+void djcs_t_aux_encrypt(const djcs_t_public_key *pk, hcs_random *hr,
                         EncodedNumber &res, const EncodedNumber &plain) {
   if (plain.getter_type() != Plaintext) {
     log_error("The given value is not Plaintext, and should not be encrypted.");
     exit(EXIT_FAILURE);
   }
 
-  mpz_t t1, t2, t3;
-  mpz_init(t1);
-  mpz_init(t2);
-  mpz_init(t3);
+  mpz_ptr t1 = phe_scratch(0);
+  mpz_ptr t2 = phe_scratch(1);
+  mpz_ptr t3 = phe_scratch(2);
   plain.getter_value(t1);
   plain.getter_n(t2);
 
-  djcs_t_encrypt(pk, hr, t3, t1);
+  djcs_t_encrypt(hcs_pub_key(pk), hr, t3, t1);
 
   res.setter_n(t2);
   res.setter_value(t3);
   res.setter_exponent(plain.getter_exponent());
   res.setter_type(Ciphertext);
+}
 
-  mpz_clear(t1);
-  mpz_clear(t2);
-  mpz_clear(t3);
+void djcs_t_aux_encrypt(const djcs_t_public_key *pk, PheRandomPool *pool,
+                        EncodedNumber &res, const EncodedNumber &plain) {
+  if (plain.getter_type() != Plaintext) {
+    log_error("The given value is not Plaintext, and should not be encrypted.");
+    exit(EXIT_FAILURE);
+  }
+  if (pool == nullptr) {
+    log_error("The randomness pool is not initialized.");
+    exit(EXIT_FAILURE);
+  }
+
+  mpz_ptr t1 = phe_scratch(0);
+  mpz_ptr t2 = phe_scratch(1);
+  mpz_ptr t3 = phe_scratch(2);
+  mpz_ptr rn = phe_scratch(3);
+  mpz_ptr modulus = phe_scratch(4);
+  plain.getter_value(t1);
+  plain.getter_n(t2);
+
+  // c = g^m * r^{n^s} mod n^{s+1}, where r^{n^s} is precomputed
+  pool->fetch(rn);
+  pool->pow_g(t3, t1);
+  pool->getter_cipher_modulus(modulus);
+  mpz_mul(t3, t3, rn);
+  mpz_mod(t3, t3, modulus);
+
+  res.setter_n(t2);
+  res.setter_value(t3);
+  res.setter_exponent(plain.getter_exponent());
+  res.setter_type(Ciphertext);
 }
 
-void djcs_t_aux_partial_decrypt(djcs_t_public_key *pk, djcs_t_auth_server *au,
-                                EncodedNumber &res,
+void djcs_t_aux_partial_decrypt(const djcs_t_public_key *pk,
+                                djcs_t_auth_server *au, EncodedNumber &res,
                                 const EncodedNumber &cipher) {
   if (cipher.getter_type() != Ciphertext) {
     log_error("The value is not ciphertext and cannot be decrypted.");
     exit(EXIT_FAILURE);
   }
 
-  mpz_t t1, t2, t3;
-  mpz_init(t1);
-  mpz_init(t2);
-  mpz_init(t3);
+  mpz_ptr t1 = phe_scratch(0);
+  mpz_ptr t2 = phe_scratch(1);
+  mpz_ptr t3 = phe_scratch(2);
   cipher.getter_n(t1);
   cipher.getter_value(t2);
 
   res.setter_n(t1);
   res.setter_exponent(cipher.getter_exponent());
   res.setter_type(Plaintext);
-  djcs_t_share_decrypt(pk, au, t3, t2);
+  djcs_t_share_decrypt(hcs_pub_key(pk), au, t3, t2);
   res.setter_value(t3);
-
-  mpz_clear(t1);
-  mpz_clear(t2);
-  mpz_clear(t3);
 }
 
-void djcs_t_aux_share_combine(djcs_t_public_key *pk, EncodedNumber &res,
+void djcs_t_aux_share_combine(const djcs_t_public_key *pk, EncodedNumber &res,
                               EncodedNumber *shares, int size) {
   auto *shares_value = (mpz_t *)malloc(size * sizeof(mpz_t));
   for (int i = 0; i < size; i++) {
@@ -99,7 +137,7 @@ void djcs_t_aux_share_combine(djcs_t_public_key *pk, EncodedNumber &res,
   mpz_t t1, t2;
   mpz_init(t1);
   mpz_init(t2);
-  djcs_t_share_combine(pk, t1, shares_value);
+  djcs_t_share_combine(hcs_pub_key(pk), t1, shares_value);
   shares[0].getter_n(t2);
   res.setter_value(t1);
   res.setter_n(t2);
@@ -114,7 +152,7 @@ void djcs_t_aux_share_combine(djcs_t_public_key *pk, EncodedNumber &res,
   mpz_clear(t2);
 }
 
-void djcs_t_aux_ee_add(djcs_t_public_key *pk, EncodedNumber &res,
+void djcs_t_aux_ee_add(const djcs_t_public_key *pk, EncodedNumber &res,
                        const EncodedNumber &cipher1,
                        const EncodedNumber &cipher2) {
   if (cipher1.getter_type() != Ciphertext) {
@@ -129,30 +167,53 @@ void djcs_t_aux_ee_add(djcs_t_public_key *pk, EncodedNumber &res,
   check_ee_add_exponent(cipher1, cipher2);
   check_encoded_public_key(cipher1, cipher2);
 
-  mpz_t t1;
-  mpz_init(t1);
+  mpz_ptr t1 = phe_scratch(0);
+  mpz_ptr t2 = phe_scratch(1);
+  mpz_ptr t3 = phe_scratch(2);
+  mpz_ptr sum = phe_scratch(3);
   cipher1.getter_n(t1);
 
-  mpz_t t2, t3, sum;
-  mpz_init(t2);
-  mpz_init(t3);
-  mpz_init(sum);
-
   cipher1.getter_value(t2);
   cipher2.getter_value(t3);
-  djcs_t_ee_add(pk, sum, t2, t3);
+  djcs_t_ee_add(hcs_pub_key(pk), sum, t2, t3);
   res.setter_n(t1);
   res.setter_value(sum);
   res.setter_type(Ciphertext);
   res.setter_exponent(cipher1.getter_exponent());
+}
 
-  mpz_clear(t1);
-  mpz_clear(t2);
-  mpz_clear(t3);
-  mpz_clear(sum);
+void djcs_t_aux_ee_sub(const djcs_t_public_key *pk, EncodedNumber &res,
+                       const EncodedNumber &cipher1,
+                       const EncodedNumber &cipher2) {
+  if (cipher1.getter_type() != Ciphertext ||
+      cipher2.getter_type() != Ciphertext) {
+    log_error("The inputs need be ciphertexts for homomorphic subtraction.");
+    exit(EXIT_FAILURE);
+  }
+
+  check_ee_add_exponent(cipher1, cipher2);
+  check_encoded_public_key(cipher1, cipher2);
+
+  mpz_ptr t1 = phe_scratch(0);
+  mpz_ptr t2 = phe_scratch(1);
+  mpz_ptr t3 = phe_scratch(2);
+  mpz_ptr diff = phe_scratch(3);
+  cipher1.getter_n(t1);
+
+  cipher1.getter_value(t2);
+  cipher2.getter_value(t3);
+  if (mpz_invert(t3, t3, pk->n[pk->s]) == 0) {
+    log_error("The ciphertext is not invertible.");
+    exit(EXIT_FAILURE);
+  }
+  djcs_t_ee_add(hcs_pub_key(pk), diff, t2, t3);
+  res.setter_n(t1);
+  res.setter_value(diff);
+  res.setter_type(Ciphertext);
+  res.setter_exponent(cipher1.getter_exponent());
 }
 
-void djcs_t_aux_ee_add_a_vector(djcs_t_public_key *pk, hcs_random *hr,
+void djcs_t_aux_ee_add_a_vector(const djcs_t_public_key *pk, hcs_random *hr,
                                 EncodedNumber &res, int size,
                                 EncodedNumber *cipher_vector) {
 
@@ -184,27 +245,46 @@ void djcs_t_aux_ee_add_a_vector(djcs_t_public_key *pk, hcs_random *hr,
   }
 }
 
-void djcs_t_aux_ee_add_ext(djcs_t_public_key *pk, EncodedNumber &res,
-                           EncodedNumber cipher1, EncodedNumber cipher2) {
+// scale a ciphertext by B^{diff}, i.e., increase the precision of the
+// plaintext by diff, the trivial encrypted zero (value 1) is kept as is
+static void scale_cipher(const djcs_t_public_key *pk, mpz_t cipher, int diff) {
+  if (diff == 0 || mpz_cmp_ui(cipher, 1) == 0) {
+    return;
+  }
+  mpz_ptr factor = phe_scratch(PHE_SCRATCH_SIZE - 1);
+  mpz_ui_pow_ui(factor, PHE_FIXED_POINT_BASE, diff);
+  mpz_powm(cipher, cipher, factor, pk->n[pk->s]);
+}
+
+void djcs_t_aux_ee_add_ext(const djcs_t_public_key *pk, EncodedNumber &res,
+                           const EncodedNumber &cipher1,
+                           const EncodedNumber &cipher2) {
   if (cipher1.getter_type() != Ciphertext ||
       cipher2.getter_type() != Ciphertext) {
     log_error("The two inputs need be ciphertexts for homomorphic addition.");
     exit(EXIT_FAILURE);
   }
-  int prec1 = std::abs(cipher1.getter_exponent());
-  int prec2 = std::abs(cipher2.getter_exponent());
-  if (prec1 < prec2) {
-    // increase cipher1's precision
-    djcs_t_aux_increase_prec(pk, cipher1, prec2, cipher1);
-  }
-  if (prec1 > prec2) {
-    // increase cipher2's precision
-    djcs_t_aux_increase_prec(pk, cipher2, prec1, cipher2);
-  }
-  djcs_t_aux_ee_add(pk, res, cipher1, cipher2);
+  check_encoded_public_key(cipher1, cipher2);
+
+  // the more negative exponent is the common one
+  int exponent1 = cipher1.getter_exponent();
+  int exponent2 = cipher2.getter_exponent();
+  int exponent = std::min(exponent1, exponent2);
+  mpz_ptr t1 = phe_scratch(0);
+  mpz_ptr t2 = phe_scratch(1);
+  cipher1.getter_value(t1);
+  cipher2.getter_value(t2);
+  scale_cipher(pk, t1, exponent1 - exponent);
+  scale_cipher(pk, t2, exponent2 - exponent);
+  djcs_t_ee_add(hcs_pub_key(pk), t1, t1, t2);
+
+  res.setter_n(pk->n[0]);
+  res.setter_value(t1);
+  res.setter_type(Ciphertext);
+  res.setter_exponent(exponent);
 }
 
-void djcs_t_aux_ep_mul(djcs_t_public_key *pk, EncodedNumber &res,
+void djcs_t_aux_ep_mul(const djcs_t_public_key *pk, EncodedNumber &res,
                        const EncodedNumber &cipher,
                        const EncodedNumber &plain) {
   if (cipher.getter_type() != Ciphertext || plain.getter_type() != Plaintext) {
@@ -214,30 +294,202 @@ void djcs_t_aux_ep_mul(djcs_t_public_key *pk, EncodedNumber &res,
 
   check_encoded_public_key(cipher, plain);
 
-  mpz_t t1;
-  mpz_init(t1);
+  mpz_ptr t1 = phe_scratch(0);
+  mpz_ptr t2 = phe_scratch(1);
+  mpz_ptr t3 = phe_scratch(2);
+  mpz_ptr mult = phe_scratch(3);
   cipher.getter_n(t1);
 
-  mpz_t t2, t3, mult;
-  mpz_init(t2);
-  mpz_init(t3);
-  mpz_init(mult);
   cipher.getter_value(t2);
   plain.getter_value(t3);
-  djcs_t_ep_mul(pk, mult, t2, t3);
+  djcs_t_ep_mul(hcs_pub_key(pk), mult, t2, t3);
 
   res.setter_n(t1);
   res.setter_value(mult);
   res.setter_exponent(cipher.getter_exponent() + plain.getter_exponent());
   res.setter_type(Ciphertext);
+}
 
-  mpz_clear(t1);
-  mpz_clear(t2);
-  mpz_clear(t3);
-  mpz_clear(mult);
+void djcs_t_aux_ep_mul_ext(const djcs_t_public_key *pk, EncodedNumber &res,
+                           const EncodedNumber &cipher,
+                           const EncodedNumber &plain, int target_precision) {
+  if (cipher.getter_type() != Ciphertext || plain.getter_type() != Plaintext) {
+    log_error("The input types do not match ciphertext or plaintext.");
+    exit(EXIT_FAILURE);
+  }
+
+  check_encoded_public_key(cipher, plain);
+
+  int exponent = cipher.getter_exponent() + plain.getter_exponent();
+  mpz_ptr t1 = phe_scratch(0);
+  mpz_ptr t2 = phe_scratch(1);
+  mpz_ptr mult = phe_scratch(2);
+  cipher.getter_value(t1);
+  plain.getter_value(t2);
+  if (exponent + target_precision > 0) {
+    // fold B^{diff} into the plaintext
+    mpz_ui_pow_ui(mult, PHE_FIXED_POINT_BASE, exponent + target_precision);
+    mpz_mul(t2, t2, mult);
+    exponent = 0 - target_precision;
+  }
+  djcs_t_ep_mul(hcs_pub_key(pk), mult, t1, t2);
+
+  res.setter_n(pk->n[0]);
+  res.setter_value(mult);
+  res.setter_exponent(exponent);
+  res.setter_type(Ciphertext);
+}
+
+// map the plaintext value to the centered representative in (-n/2, n/2]
+static void centered_plaintext(mpz_t m, const mpz_t n) {
+  mpz_mod(m, m, n);
+  mpz_t half;
+  mpz_init(half);
+  mpz_fdiv_q_2exp(half, n, 1);
+  if (mpz_cmp(m, half) > 0) {
+    mpz_sub(m, m, n);
+  }
+  mpz_clear(half);
+}
+
+// the product of bases[i]^{plains[i]} mod n^{s+1} with signed (centered)
+// plaintexts: the terms are partitioned by sign, the positive ones at the
+// front and the negative ones (negated) at the back, one multi-exponentiation
+// is run for each part and the negative part is inverted once.
+// bases and plains are reordered and plains are modified in place
+static void signed_multi_exp(const djcs_t_public_key *pk, mpz_t rop,
+                             mpz_t *bases, mpz_t *plains, int size) {
+  int pos_num = 0, neg_num = 0;
+  int i = 0;
+  while (i < size - neg_num) {
+    centered_plaintext(plains[i], pk->n[0]);
+    int sign = mpz_sgn(plains[i]);
+    if (sign > 0) {
+      mpz_swap(bases[pos_num], bases[i]);
+      mpz_swap(plains[pos_num], plains[i]);
+      pos_num++;
+      i++;
+    } else if (sign < 0) {
+      neg_num++;
+      mpz_swap(bases[size - neg_num], bases[i]);
+      mpz_swap(plains[size - neg_num], plains[i]);
+      mpz_neg(plains[size - neg_num], plains[size - neg_num]);
+    } else {
+      i++;
+    }
+  }
+
+  mpz_t neg_sum;
+  mpz_init(neg_sum);
+  multi_exp(rop, bases, plains, pos_num, pk->n[pk->s]);
+  multi_exp(neg_sum, bases + size - neg_num, plains + size - neg_num, neg_num,
+            pk->n[pk->s]);
+  if (mpz_cmp_ui(neg_sum, 1) != 0) {
+    if (mpz_invert(neg_sum, neg_sum, pk->n[pk->s]) == 0) {
+      log_error("The ciphertext is not invertible.");
+      exit(EXIT_FAILURE);
+    }
+    djcs_t_ee_add(hcs_pub_key(pk), rop, rop, neg_sum);
+  }
+  mpz_clear(neg_sum);
+}
+
+// the bit length of the largest centered plaintext of a matrix
+static int centered_max_bits(const djcs_t_public_key *pk,
+                             EncodedNumber **plains, int row_size,
+                             int column_size) {
+  int max_bits = 0;
+  mpz_t t;
+  mpz_init(t);
+  for (int i = 0; i < row_size; i++) {
+    for (int j = 0; j < column_size; j++) {
+      plains[i][j].getter_value(t);
+      centered_plaintext(t, pk->n[0]);
+      max_bits = std::max(max_bits, (int)mpz_sizeinbase(t, 2));
+    }
+  }
+  mpz_clear(t);
+  return max_bits;
 }
 
-void djcs_t_aux_increase_prec(djcs_t_public_key *pk, EncodedNumber &res,
+// signed inner product of the ciphers of a table and a plain vector, the
+// negative terms are multiplied together and inverted once
+static void table_inner_product(const djcs_t_public_key *pk,
+                                const EncryptedWeightTable &table,
+                                EncodedNumber &res, EncodedNumber *plains) {
+  mpz_t pos_sum, neg_sum, plain, t;
+  mpz_init_set_ui(pos_sum, 1);
+  mpz_init_set_ui(neg_sum, 1);
+  mpz_init(plain);
+  mpz_init(t);
+  for (int j = 0; j < table.getter_size(); j++) {
+    if (plains[j].getter_type() != Plaintext) {
+      log_error("The input types do not match ciphertext or plaintext.");
+      exit(EXIT_FAILURE);
+    }
+    plains[j].getter_value(plain);
+    centered_plaintext(plain, pk->n[0]);
+    if (mpz_sgn(plain) >= 0) {
+      table.mul_pow(pos_sum, j, plain);
+    } else {
+      mpz_neg(plain, plain);
+      table.mul_pow(neg_sum, j, plain);
+    }
+  }
+  if (mpz_cmp_ui(neg_sum, 1) != 0) {
+    if (mpz_invert(neg_sum, neg_sum, pk->n[pk->s]) == 0) {
+      log_error("The ciphertext is not invertible.");
+      exit(EXIT_FAILURE);
+    }
+    djcs_t_ee_add(hcs_pub_key(pk), pos_sum, pos_sum, neg_sum);
+  }
+  table.getter_n(t);
+  res.setter_n(t);
+  res.setter_value(pos_sum);
+  res.setter_exponent(table.getter_exponent() + plains[0].getter_exponent());
+  res.setter_type(Ciphertext);
+  mpz_clear(pos_sum);
+  mpz_clear(neg_sum);
+  mpz_clear(plain);
+  mpz_clear(t);
+}
+
+void djcs_t_aux_signed_ep_mul(const djcs_t_public_key *pk, EncodedNumber &res,
+                              const EncodedNumber &cipher,
+                              const EncodedNumber &plain) {
+  if (cipher.getter_type() != Ciphertext || plain.getter_type() != Plaintext) {
+    log_error("The input types do not match ciphertext or plaintext.");
+    exit(EXIT_FAILURE);
+  }
+
+  check_encoded_public_key(cipher, plain);
+
+  mpz_ptr t1 = phe_scratch(0);
+  mpz_ptr t2 = phe_scratch(1);
+  mpz_ptr t3 = phe_scratch(2);
+  mpz_ptr mult = phe_scratch(3);
+  cipher.getter_n(t1);
+
+  cipher.getter_value(t2);
+  plain.getter_value(t3);
+  centered_plaintext(t3, pk->n[0]);
+  if (mpz_sgn(t3) < 0) {
+    // c^{-|m|} = (c^{-1})^{|m|}
+    if (mpz_invert(t2, t2, pk->n[pk->s]) == 0) {
+      log_error("The ciphertext is not invertible.");
+      exit(EXIT_FAILURE);
+    }
+    mpz_neg(t3, t3);
+  }
+  mpz_powm(mult, t2, t3, pk->n[pk->s]);
+
+  res.setter_n(t1);
+  res.setter_value(mult);
+  res.setter_exponent(cipher.getter_exponent() + plain.getter_exponent());
+  res.setter_type(Ciphertext);
+}
+
+void djcs_t_aux_increase_prec(const djcs_t_public_key *pk, EncodedNumber &res,
                               int target_precision, EncodedNumber cipher) {
   if (cipher.getter_type() != Ciphertext) {
     log_error("The input type does not match ciphertext.");
@@ -248,21 +500,19 @@ void djcs_t_aux_increase_prec(djcs_t_public_key *pk, EncodedNumber &res,
     log_error("The target precision is less than current precision, cannot "
               "increase.");
     exit(EXIT_FAILURE);
-  } else if (target_precision == cur_precision) {
-    //    log_info("The precision is correct, no need to increase.");
-    return;
-  } else {
-    // init an encoded number plaintext of 1.0 with diff precision and multiply
-    int diff = target_precision - cur_precision;
-    EncodedNumber assist_plain;
-    assist_plain.set_double(pk->n[0], 1.0, diff);
-    djcs_t_aux_ep_mul(pk, res, cipher, assist_plain);
   }
+  // c^{B^diff}, which is free for the trivial encrypted zero
+  mpz_ptr t1 = phe_scratch(0);
+  cipher.getter_value(t1);
+  scale_cipher(pk, t1, target_precision - cur_precision);
+  res = std::move(cipher);
+  res.setter_value(t1);
+  res.setter_exponent(0 - target_precision);
 }
 
-void djcs_t_aux_double_vec_encryption(djcs_t_public_key *pk, hcs_random *hr,
-                                      EncodedNumber *res, int size,
-                                      const std::vector<double> &vec,
+void djcs_t_aux_double_vec_encryption(const djcs_t_public_key *pk,
+                                      hcs_random *hr, EncodedNumber *res,
+                                      int size, const std::vector<double> &vec,
                                       int phe_precision) {
   check_size(size);
   int vec_size = (int)vec.size();
@@ -276,7 +526,7 @@ void djcs_t_aux_double_vec_encryption(djcs_t_public_key *pk, hcs_random *hr,
   }
 }
 
-void djcs_t_aux_int_vec_encryption(djcs_t_public_key *pk, hcs_random *hr,
+void djcs_t_aux_int_vec_encryption(const djcs_t_public_key *pk, hcs_random *hr,
                                    EncodedNumber *res, int size,
                                    const std::vector<int> &vec,
                                    int phe_precision) {
@@ -292,7 +542,137 @@ void djcs_t_aux_int_vec_encryption(djcs_t_public_key *pk, hcs_random *hr,
   }
 }
 
-void djcs_t_aux_vec_aggregate(djcs_t_public_key *pk, EncodedNumber &res,
+static void partial_decrypt_batch(const MontModulus &mont, const mpz_t exp,
+                                  const mpz_t n, EncodedNumber *res,
+                                  EncodedNumber *ciphers, int size) {
+  check_size(size);
+  for (int i = 0; i < size; i++) {
+    if (ciphers[i].getter_type() != Ciphertext) {
+      log_error("The value is not ciphertext and cannot be decrypted.");
+      exit(EXIT_FAILURE);
+    }
+  }
+  // the same exponent for all the ciphertexts, raised by the multi-buffer
+  // kernel
+  auto *values = (mpz_t *)malloc(size * sizeof(mpz_t));
+  for (int i = 0; i < size; i++) {
+    mpz_init(values[i]);
+    ciphers[i].getter_value(values[i]);
+  }
+  mont_powm_batch_fixed_exp(mont, values, values, exp, size);
+  for (int i = 0; i < size; i++) {
+    res[i].setter_n(n);
+    res[i].setter_value(values[i]);
+    res[i].setter_exponent(ciphers[i].getter_exponent());
+    res[i].setter_type(Plaintext);
+    mpz_clear(values[i]);
+  }
+  free(values);
+}
+
+void djcs_t_aux_partial_decrypt_batch(const djcs_t_public_key *pk,
+                                      djcs_t_auth_server *au,
+                                      EncodedNumber *res,
+                                      EncodedNumber *ciphers, int size) {
+  // the share decryption is c^{2 * delta * s_i}
+  mpz_t exp;
+  mpz_init(exp);
+  mpz_mul(exp, au->si, pk->delta);
+  mpz_mul_ui(exp, exp, 2);
+  MontModulus mont(pk->n[pk->s]);
+  partial_decrypt_batch(mont, exp, pk->n[0], res, ciphers, size);
+  mpz_clear(exp);
+}
+
+void djcs_t_aux_partial_decrypt_batch(const PheKeyContext &ctx,
+                                      EncodedNumber *res,
+                                      EncodedNumber *ciphers, int size) {
+  partial_decrypt_batch(ctx.getter_mont_modulus(),
+                        ctx.getter_decrypt_exponent(), ctx.getter_n(), res,
+                        ciphers, size);
+}
+
+void djcs_t_aux_share_combine_batch(const ShareCombineContext &ctx,
+                                    EncodedNumber *res, EncodedNumber **shares,
+                                    int size) {
+  check_size(size);
+  int party_num = ctx.getter_party_num();
+  crypto_parallel_for_chunks(0, size, [&](int begin, int end) {
+    // per chunk buffers, reused by all the elements
+    auto *shares_value = (mpz_t *)malloc(party_num * sizeof(mpz_t));
+    for (int j = 0; j < party_num; j++) {
+      mpz_init(shares_value[j]);
+    }
+    mpz_t t1, scratch;
+    mpz_init(t1);
+    mpz_init(scratch);
+    for (int i = begin; i < end; i++) {
+      for (int j = 0; j < party_num; j++) {
+        shares[i][j].getter_value(shares_value[j]);
+      }
+      ctx.combine(t1, shares_value, scratch);
+      res[i].setter_value(t1);
+      shares[i][0].getter_n(t1);
+      res[i].setter_n(t1);
+      res[i].setter_type(Plaintext);
+      res[i].setter_exponent(shares[i][0].getter_exponent());
+    }
+    for (int j = 0; j < party_num; j++) {
+      mpz_clear(shares_value[j]);
+    }
+    free(shares_value);
+    mpz_clear(t1);
+    mpz_clear(scratch);
+  });
+}
+
+void djcs_t_aux_weighted_partial_decrypt_batch(
+    const PheKeyContext &ctx, const ShareCombineContext &combiner, int index,
+    EncodedNumber *res, EncodedNumber *ciphers, int size) {
+  // the exponent 2 * delta * s_i * |2 * lambda_i|, and the inverse of the
+  // shares for a negative lambda_i
+  mpz_t exp;
+  mpz_init(exp);
+  combiner.getter_coefficient(exp, index);
+  bool negative = mpz_sgn(exp) < 0;
+  mpz_abs(exp, exp);
+  mpz_mul(exp, exp, ctx.getter_decrypt_exponent());
+  partial_decrypt_batch(ctx.getter_mont_modulus(), exp, ctx.getter_n(), res,
+                        ciphers, size);
+  mpz_clear(exp);
+  const djcs_t_public_key *pk = ctx.getter_pub_key();
+  mpz_srcptr n_square = pk->n[pk->s];
+  crypto_parallel_for(0, size, [&](int i) {
+    if (negative) {
+      mpz_ptr t = phe_scratch(0);
+      res[i].getter_value(t);
+      mpz_invert(t, t, n_square);
+      res[i].setter_value(t);
+    }
+    res[i].setter_type(Ciphertext);
+  });
+}
+
+void djcs_t_aux_weighted_share_combine_batch(const ShareCombineContext &ctx,
+                                             EncodedNumber *res,
+                                             EncodedNumber *products,
+                                             int size) {
+  check_size(size);
+  crypto_parallel_for(0, size, [&](int i) {
+    mpz_ptr t = phe_scratch(0);
+    mpz_ptr n = phe_scratch(1);
+    int exponent = products[i].getter_exponent();
+    products[i].getter_n(n);
+    products[i].getter_value(t);
+    ctx.finish(t, t);
+    res[i].setter_n(n);
+    res[i].setter_value(t);
+    res[i].setter_type(Plaintext);
+    res[i].setter_exponent(exponent);
+  });
+}
+
+void djcs_t_aux_vec_aggregate(const djcs_t_public_key *pk, EncodedNumber &res,
                               EncodedNumber *ciphers, int size) {
   check_size(size);
   res = ciphers[0];
@@ -301,49 +681,182 @@ void djcs_t_aux_vec_aggregate(djcs_t_public_key *pk, EncodedNumber &res,
   }
 }
 
-void djcs_t_aux_vec_ele_wise_ee_add(djcs_t_public_key *pk, EncodedNumber *res,
-                                    EncodedNumber *ciphers1,
+void djcs_t_aux_vec_ele_wise_ee_add(const djcs_t_public_key *pk,
+                                    EncodedNumber *res, EncodedNumber *ciphers1,
                                     EncodedNumber *ciphers2, int size) {
   check_size(size);
   check_ee_add_exponent(ciphers1[0], ciphers2[0]);
   check_encoded_public_key(ciphers1[0], ciphers2[0]);
   auto *tmp_res = new EncodedNumber[size];
   // element-wise phe addition
-  omp_set_num_threads(NUM_OMP_THREADS);
-#pragma omp parallel for
-  for (int i = 0; i < size; i++) {
+  crypto_parallel_for(0, size, [&](int i) {
     //    tmp_res[i] = ciphers1[i];
     djcs_t_aux_ee_add(pk, tmp_res[i], ciphers1[i], ciphers2[i]);
-  }
+  });
   for (int i = 0; i < size; i++) {
-    res[i] = tmp_res[i];
+    res[i] = std::move(tmp_res[i]);
   }
   delete[] tmp_res;
 }
 
-void djcs_t_aux_vec_ele_wise_ee_add_ext(djcs_t_public_key *pk,
+void djcs_t_aux_vec_ele_wise_ee_add_ext(const djcs_t_public_key *pk,
                                         EncodedNumber *res,
                                         EncodedNumber *ciphers1,
                                         EncodedNumber *ciphers2, int size) {
   check_size(size);
   check_encoded_public_key(ciphers1[0], ciphers2[0]);
-  int prec1 = std::abs(ciphers1[0].getter_exponent());
-  int prec2 = std::abs(ciphers2[0].getter_exponent());
-  if (prec1 < prec2) {
-    // increase ciphers1's precision
-    djcs_t_aux_increase_prec_vec(pk, ciphers1, prec2, ciphers1, size);
+  // align each pair on the fly, the inputs keep their precision
+  crypto_parallel_for(0, size, [&](int i) {
+    djcs_t_aux_ee_add_ext(pk, res[i], ciphers1[i], ciphers2[i]);
+  });
+}
+
+void djcs_t_aux_vec_ele_wise_ee_sub(const djcs_t_public_key *pk,
+                                    EncodedNumber *res, EncodedNumber *ciphers1,
+                                    EncodedNumber *ciphers2, int size) {
+  check_size(size);
+  check_ee_add_exponent(ciphers1[0], ciphers2[0]);
+  check_encoded_public_key(ciphers1[0], ciphers2[0]);
+  crypto_parallel_for(0, size, [&](int i) {
+    djcs_t_aux_ee_sub(pk, res[i], ciphers1[i], ciphers2[i]);
+  });
+}
+
+void djcs_t_aux_masked_select(const djcs_t_public_key *pk, PheRandomPool *pool,
+                              EncodedNumber *res, EncodedNumber *ciphers,
+                              const std::vector<int> &bits, int size,
+                              bool rerandomize) {
+  check_size(size);
+  if ((int)bits.size() < size) {
+    log_error("The bit vector is shorter than the cipher vector.");
+    exit(EXIT_FAILURE);
   }
-  if (prec1 > prec2) {
-    // increase ciphers2's precision
-    djcs_t_aux_increase_prec_vec(pk, ciphers2, prec1, ciphers2, size);
+  if (rerandomize && pool == nullptr) {
+    log_error("The randomness pool is not initialized.");
+    exit(EXIT_FAILURE);
   }
+  crypto_parallel_for(0, size, [&](int i) {
+    if (ciphers[i].getter_type() != Ciphertext ||
+        (bits[i] != 0 && bits[i] != 1)) {
+      log_error("The masked select needs ciphertexts and a 0/1 bit vector.");
+      exit(EXIT_FAILURE);
+    }
+    if (bits[i] == 1 && !rerandomize) {
+      res[i] = ciphers[i];
+      return;
+    }
+    // the encryption of zero is r^{n^s}, or 1 for the trivial one
+    mpz_t t1, t2;
+    mpz_init(t1);
+    mpz_init(t2);
+    if (rerandomize) {
+      pool->fetch(t1);
+    } else {
+      mpz_set_ui(t1, 1);
+    }
+    if (bits[i] == 1) {
+      ciphers[i].getter_value(t2);
+      djcs_t_ee_add(hcs_pub_key(pk), t1, t1, t2);
+    }
+    ciphers[i].getter_n(t2);
+    res[i].setter_n(t2);
+    res[i].setter_value(t1);
+    res[i].setter_exponent(ciphers[i].getter_exponent());
+    res[i].setter_type(Ciphertext);
+    mpz_clear(t1);
+    mpz_clear(t2);
+  });
+}
 
-  djcs_t_aux_vec_ele_wise_ee_add(pk, res, ciphers1, ciphers2, size);
+void djcs_t_aux_vec_rerandomize(const djcs_t_public_key *pk,
+                                PheRandomPool *pool, EncodedNumber *res,
+                                EncodedNumber *ciphers, int size) {
+  check_size(size);
+  if (pool == nullptr) {
+    log_error("The randomness pool is not initialized.");
+    exit(EXIT_FAILURE);
+  }
+  crypto_parallel_for(0, size, [&](int i) {
+    if (ciphers[i].getter_type() != Ciphertext) {
+      log_error("The value is not ciphertext and cannot be re-randomized.");
+      exit(EXIT_FAILURE);
+    }
+    // c * r^{n^s} encrypts the same plaintext with fresh randomness
+    mpz_t t1, t2;
+    mpz_init(t1);
+    mpz_init(t2);
+    pool->fetch(t1);
+    ciphers[i].getter_value(t2);
+    djcs_t_ee_add(hcs_pub_key(pk), t1, t1, t2);
+    ciphers[i].getter_n(t2);
+    res[i].setter_n(t2);
+    res[i].setter_value(t1);
+    res[i].setter_exponent(ciphers[i].getter_exponent());
+    res[i].setter_type(Ciphertext);
+    mpz_clear(t1);
+    mpz_clear(t2);
+  });
 }
 
-void djcs_t_aux_inner_product(djcs_t_public_key *pk, hcs_random *hr,
+void djcs_t_aux_inner_product(const djcs_t_public_key *pk, hcs_random *hr,
                               EncodedNumber &res, EncodedNumber *ciphers,
                               EncodedNumber *plains, int size) {
+  // the homomorphic dot product is computed by multi-exponentiation, and the
+  // sum starts from the trivial encryption of zero (r = 1) instead of a fresh
+  // encryption, so hr is not needed; the callers re-randomize the result
+  // before sending it, see djcs_t_aux_vec_rerandomize
+  djcs_t_aux_signed_inner_product(pk, res, ciphers, plains, size);
+}
+
+void djcs_t_aux_vec_ele_wise_ep_mul(const djcs_t_public_key *pk,
+                                    EncodedNumber *res, EncodedNumber *ciphers,
+                                    EncodedNumber *plains, int size) {
+  check_size(size);
+  for (int i = 0; i < size; i++) {
+    if (ciphers[i].getter_type() != Ciphertext ||
+        plains[i].getter_type() != Plaintext) {
+      log_error("The input types do not match ciphertext or plaintext.");
+      exit(EXIT_FAILURE);
+    }
+    check_encoded_public_key(ciphers[i], plains[i]);
+  }
+  // c_i^{p_i} of independent exponents, raised by the multi-buffer kernel
+  auto *bases = (mpz_t *)malloc(size * sizeof(mpz_t));
+  auto *exps = (mpz_t *)malloc(size * sizeof(mpz_t));
+  for (int i = 0; i < size; i++) {
+    mpz_init(bases[i]);
+    mpz_init(exps[i]);
+    ciphers[i].getter_value(bases[i]);
+    plains[i].getter_value(exps[i]);
+  }
+  mont_powm_batch(bases, bases, exps, size, pk->n[pk->s]);
+  for (int i = 0; i < size; i++) {
+    int exponent = ciphers[i].getter_exponent() + plains[i].getter_exponent();
+    res[i].setter_n(pk->n[0]);
+    res[i].setter_value(bases[i]);
+    res[i].setter_exponent(exponent);
+    res[i].setter_type(Ciphertext);
+    mpz_clear(bases[i]);
+    mpz_clear(exps[i]);
+  }
+  free(bases);
+  free(exps);
+}
+
+void djcs_t_aux_vec_ele_wise_signed_ep_mul(const djcs_t_public_key *pk,
+                                           EncodedNumber *res,
+                                           EncodedNumber *ciphers,
+                                           EncodedNumber *plains, int size) {
+  check_size(size);
+  check_encoded_public_key(ciphers[0], plains[0]);
+  crypto_parallel_for(0, size, [&](int i) {
+    djcs_t_aux_signed_ep_mul(pk, res[i], ciphers[i], plains[i]);
+  });
+}
+
+void djcs_t_aux_signed_inner_product(const djcs_t_public_key *pk,
+                                     EncodedNumber &res, EncodedNumber *ciphers,
+                                     EncodedNumber *plains, int size) {
   check_size(size);
   check_encoded_public_key(ciphers[0], plains[0]);
 
@@ -365,33 +878,10 @@ void djcs_t_aux_inner_product(djcs_t_public_key *pk, hcs_random *hr,
     ciphers[i].getter_value(mpz_ciphers[i]);
     plains[i].getter_value(mpz_plains[i]);
   }
+  signed_multi_exp(pk, t1, mpz_ciphers, mpz_plains, size);
+  res.setter_value(t1);
 
-  // homomorphic dot product
-  mpz_t sum, t2; // why need another sum1 that can only be correct? weired
-  mpz_init(sum);
-  mpz_init(t2);
-  mpz_set_si(t2, 0);
-  djcs_t_encrypt(pk, hr, sum, t2);
-
-  for (int j = 0; j < size; j++) {
-    // store the encrypted_exact_answer
-    mpz_t tmp;
-    mpz_init(tmp);
-    // Multiply a plaintext value mpz_plains[j] with an encrypted value
-    // mpz_ciphers[j], storing the result in tmp.
-    djcs_t_ep_mul(pk, tmp, mpz_ciphers[j], mpz_plains[j]);
-    // Add an encrypted value tmp to an encrypted value sum, storing the result
-    // in sum.
-    djcs_t_ee_add(pk, sum, sum, tmp);
-
-    mpz_clear(tmp);
-  }
-  res.setter_value(sum);
-
-  // clear everything
   mpz_clear(t1);
-  mpz_clear(t2);
-  mpz_clear(sum);
   for (int i = 0; i < size; i++) {
     mpz_clear(mpz_ciphers[i]);
     mpz_clear(mpz_plains[i]);
@@ -400,32 +890,18 @@ void djcs_t_aux_inner_product(djcs_t_public_key *pk, hcs_random *hr,
   free(mpz_plains);
 }
 
-void djcs_t_aux_vec_ele_wise_ep_mul(djcs_t_public_key *pk, EncodedNumber *res,
-                                    EncodedNumber *ciphers,
-                                    EncodedNumber *plains, int size) {
+void djcs_t_aux_increase_prec_vec(const djcs_t_public_key *pk,
+                                  EncodedNumber *res, int target_precision,
+                                  EncodedNumber *ciphers, int size) {
   check_size(size);
-  check_encoded_public_key(ciphers[0], plains[0]);
-  omp_set_num_threads(NUM_OMP_THREADS);
-#pragma omp parallel for
-  for (int i = 0; i < size; i++) {
-    djcs_t_aux_ep_mul(pk, res[i], ciphers[i], plains[i]);
-  }
-}
-
-void djcs_t_aux_increase_prec_vec(djcs_t_public_key *pk, EncodedNumber *res,
-                                  int target_precision, EncodedNumber *ciphers,
-                                  int size) {
-  check_size(size);
-  omp_set_num_threads(NUM_OMP_THREADS);
-#pragma omp parallel for
-  for (int i = 0; i < size; i++) {
+  crypto_parallel_for(0, size, [&](int i) {
     djcs_t_aux_increase_prec(pk, res[i], target_precision, ciphers[i]);
-  }
+  });
 }
 
 void djcs_t_aux_double_mat_encryption(
-    djcs_t_public_key *pk, hcs_random *hr, EncodedNumber **res, int row_size,
-    int column_size, const std::vector<std::vector<double>> &mat,
+    const djcs_t_public_key *pk, hcs_random *hr, EncodedNumber **res,
+    int row_size, int column_size, const std::vector<std::vector<double>> &mat,
     int phe_precision) {
   check_size(row_size);
   check_size(column_size);
@@ -435,17 +911,20 @@ void djcs_t_aux_double_mat_encryption(
     log_error("The result size is not equal to mat size");
     exit(EXIT_FAILURE);
   }
-  omp_set_num_threads(NUM_OMP_THREADS);
-#pragma omp parallel for
-  for (int i = 0; i < row_size; i++) {
-    for (int j = 0; j < column_size; j++) {
+  // each thread encrypts with its own stream instead of sharing hr
+  unsigned long loop = phe_random_stream_next_loop();
+  int size = row_size * column_size;
+  crypto_parallel_for_chunks(0, size, [&](int begin, int end) {
+    hcs_random *stream = phe_random_stream(loop, begin);
+    for (int k = begin; k < end; k++) {
+      int i = k / column_size, j = k % column_size;
       res[i][j].set_double(pk->n[0], mat[i][j], phe_precision);
-      djcs_t_aux_encrypt(pk, hr, res[i][j], res[i][j]);
+      djcs_t_aux_encrypt(pk, stream, res[i][j], res[i][j]);
     }
-  }
+  }, PHE_RANDOM_STREAM_GRAIN);
 }
 
-void djcs_t_aux_matrix_ele_wise_ee_add(djcs_t_public_key *pk,
+void djcs_t_aux_matrix_ele_wise_ee_add(const djcs_t_public_key *pk,
                                        EncodedNumber **res,
                                        EncodedNumber **cipher_mat1,
                                        EncodedNumber **cipher_mat2,
@@ -460,7 +939,7 @@ void djcs_t_aux_matrix_ele_wise_ee_add(djcs_t_public_key *pk,
   }
 }
 
-void djcs_t_aux_matrix_ele_wise_ee_add_ext(djcs_t_public_key *pk,
+void djcs_t_aux_matrix_ele_wise_ee_add_ext(const djcs_t_public_key *pk,
                                            EncodedNumber **res,
                                            EncodedNumber **cipher_mat1,
                                            EncodedNumber **cipher_mat2,
@@ -468,39 +947,62 @@ void djcs_t_aux_matrix_ele_wise_ee_add_ext(djcs_t_public_key *pk,
   check_size(row_size);
   check_size(column_size);
   check_encoded_public_key(cipher_mat1[0][0], cipher_mat2[0][0]);
-
-  int prec1 = std::abs(cipher_mat1[0][0].getter_exponent());
-  int prec2 = std::abs(cipher_mat2[0][0].getter_exponent());
-  if (prec1 < prec2) {
-    // increase cipher_mat1's precision
-    djcs_t_aux_increase_prec_mat(pk, cipher_mat1, prec2, cipher_mat1, row_size,
-                                 column_size);
-  }
-  if (prec1 > prec2) {
-    // increase cipher_mat2's precision
-    djcs_t_aux_increase_prec_mat(pk, cipher_mat2, prec1, cipher_mat2, row_size,
-                                 column_size);
-  }
-
-  djcs_t_aux_matrix_ele_wise_ee_add(pk, res, cipher_mat1, cipher_mat2, row_size,
-                                    column_size);
+  // align each pair on the fly, the inputs keep their precision
+  crypto_parallel_for(0, row_size * column_size, [&](int k) {
+    int i = k / column_size, j = k % column_size;
+    djcs_t_aux_ee_add_ext(pk, res[i][j], cipher_mat1[i][j], cipher_mat2[i][j]);
+  });
 }
 
-void djcs_t_aux_vec_mat_ep_mult(djcs_t_public_key *pk, hcs_random *hr,
+void djcs_t_aux_vec_mat_ep_mult(const djcs_t_public_key *pk, hcs_random *hr,
                                 EncodedNumber *res, EncodedNumber *ciphers,
                                 EncodedNumber **plains, int row_size,
                                 int column_size) {
   check_size(row_size);
   check_size(column_size);
   check_encoded_public_key(ciphers[0], plains[0][0]);
-  omp_set_num_threads(NUM_OMP_THREADS);
-#pragma omp parallel for
-  for (int i = 0; i < row_size; i++) {
+  if (row_size >= PHE_FIXED_BASE_THRESHOLD) {
+    EncryptedWeightTable table(
+        pk, ciphers, column_size,
+        centered_max_bits(pk, plains, row_size, column_size), row_size);
+    djcs_t_aux_vec_mat_ep_mult(pk, table, res, plains, row_size, column_size);
+    return;
+  }
+  crypto_parallel_for(0, row_size, [&](int i) {
     djcs_t_aux_inner_product(pk, hr, res[i], ciphers, plains[i], column_size);
+  });
+}
+
+void djcs_t_aux_vec_mat_ep_mult(const djcs_t_public_key *pk,
+                                const EncryptedWeightTable &table,
+                                EncodedNumber *res, EncodedNumber **plains,
+                                int row_size, int column_size) {
+  check_size(row_size);
+  check_size(column_size);
+  if (column_size != table.getter_size()) {
+    log_error("The plaintext column size is not equal to the table size.");
+    exit(EXIT_FAILURE);
   }
+  crypto_parallel_for(0, row_size, [&](int i) {
+    table_inner_product(pk, table, res[i], plains[i]);
+  });
+}
+
+void djcs_t_aux_vec_mat_signed_ep_mult(const djcs_t_public_key *pk,
+                                       EncodedNumber *res,
+                                       EncodedNumber *ciphers,
+                                       EncodedNumber **plains, int row_size,
+                                       int column_size) {
+  check_size(row_size);
+  check_size(column_size);
+  check_encoded_public_key(ciphers[0], plains[0][0]);
+  crypto_parallel_for(0, row_size, [&](int i) {
+    djcs_t_aux_signed_inner_product(pk, res[i], ciphers, plains[i],
+                                    column_size);
+  });
 }
 
-void djcs_t_aux_mat_mat_ep_mult(djcs_t_public_key *pk, hcs_random *hr,
+void djcs_t_aux_mat_mat_ep_mult(const djcs_t_public_key *pk, hcs_random *hr,
                                 EncodedNumber **res, EncodedNumber **cipher_mat,
                                 EncodedNumber **plain_mat, int cipher_row_size,
                                 int cipher_column_size, int plain_row_size,
@@ -513,28 +1015,47 @@ void djcs_t_aux_mat_mat_ep_mult(djcs_t_public_key *pk, hcs_random *hr,
     log_error("The plaintext column size is not equal to ciphertext row size");
     exit(EXIT_FAILURE);
   }
-  // matrix multiplication
-  omp_set_num_threads(NUM_OMP_THREADS);
-#pragma omp parallel for
-  for (int i = 0; i < plain_row_size; i++) {
-    //    log_info("[djcs_t_aux_mat_mat_ep_mult] i = " + std::to_string(i));
+  // re-arrange the ciphertext columns once for calling inner product
+  auto **cipher_columns = new EncodedNumber *[cipher_column_size];
+  for (int j = 0; j < cipher_column_size; j++) {
+    cipher_columns[j] = new EncodedNumber[cipher_row_size];
+    for (int k = 0; k < cipher_row_size; k++) {
+      cipher_columns[j][k] = cipher_mat[k][j];
+    }
+  }
+  if (plain_row_size >= PHE_FIXED_BASE_THRESHOLD) {
+    // each cipher column is exponentiated by every plaintext row
+    int max_bits = centered_max_bits(pk, plain_mat, plain_row_size,
+                                     plain_column_size);
     for (int j = 0; j < cipher_column_size; j++) {
-      // re-arrange the ciphertext vector for calling inner product
-      auto *cipher_vec_j = new EncodedNumber[cipher_row_size];
-      for (int k = 0; k < cipher_row_size; k++) {
-        cipher_vec_j[k] = cipher_mat[k][j];
-      }
-      djcs_t_aux_inner_product(pk, hr, res[i][j], cipher_vec_j, plain_mat[i],
-                               cipher_row_size);
-      delete[] cipher_vec_j;
+      EncryptedWeightTable table(pk, cipher_columns[j], cipher_row_size,
+                                 max_bits, plain_row_size);
+      crypto_parallel_for(0, plain_row_size, [&](int i) {
+        table_inner_product(pk, table, res[i][j], plain_mat[i]);
+      });
     }
+  } else {
+    // matrix multiplication, parallel over the output elements
+    crypto_parallel_for(0, plain_row_size * cipher_column_size, [&](int k) {
+      int i = k / cipher_column_size, j = k % cipher_column_size;
+      djcs_t_aux_inner_product(pk, hr, res[i][j], cipher_columns[j],
+                               plain_mat[i], cipher_row_size);
+    });
   }
+  for (int j = 0; j < cipher_column_size; j++) {
+    delete[] cipher_columns[j];
+  }
+  delete[] cipher_columns;
 }
 
-void djcs_t_aux_ele_wise_mat_mat_ep_mult(
-    djcs_t_public_key *pk, EncodedNumber **res, EncodedNumber **cipher_mat,
-    EncodedNumber **plain_mat, int cipher_row_size, int cipher_column_size,
-    int plain_row_size, int plain_column_size) {
+void djcs_t_aux_ele_wise_mat_mat_ep_mult(const djcs_t_public_key *pk,
+                                         EncodedNumber **res,
+                                         EncodedNumber **cipher_mat,
+                                         EncodedNumber **plain_mat,
+                                         int cipher_row_size,
+                                         int cipher_column_size,
+                                         int plain_row_size,
+                                         int plain_column_size) {
   if ((plain_row_size != cipher_row_size) ||
       (plain_column_size != cipher_column_size)) {
     log_error("The two matrix dimension do not match for element-wise "
@@ -547,23 +1068,186 @@ void djcs_t_aux_ele_wise_mat_mat_ep_mult(
   }
 }
 
-void djcs_t_aux_increase_prec_mat(djcs_t_public_key *pk, EncodedNumber **res,
-                                  int target_precision,
+void djcs_t_aux_increase_prec_mat(const djcs_t_public_key *pk,
+                                  EncodedNumber **res, int target_precision,
                                   EncodedNumber **cipher_mat, int row_size,
                                   int column_size) {
   check_size(row_size);
   check_size(column_size);
-  omp_set_num_threads(NUM_OMP_THREADS);
-#pragma omp parallel for
-  for (int i = 0; i < row_size; i++) {
+  crypto_parallel_for(0, row_size, [&](int i) {
     for (int j = 0; j < column_size; j++) {
       djcs_t_aux_increase_prec(pk, res[i][j], target_precision,
                                cipher_mat[i][j]);
     }
+  });
+}
+
+void djcs_t_aux_vec_ele_wise_ee_add(const djcs_t_public_key *pk,
+                                    CipherVector &res,
+                                    const CipherVector &ciphers1,
+                                    const CipherVector &ciphers2) {
+  int size = ciphers1.getter_size();
+  check_size(size);
+  if (ciphers2.getter_size() != size ||
+      ciphers1.getter_exponent() != ciphers2.getter_exponent()) {
+    log_error("The two cipher vectors do not match.");
+    exit(EXIT_FAILURE);
+  }
+  if (&res != &ciphers1 && &res != &ciphers2) {
+    res = CipherVector(ciphers1.getter_modulus(), size,
+                       ciphers1.getter_exponent());
+  }
+  crypto_parallel_for_chunks(0, size, [&](int begin, int end) {
+    mpz_t sum, view1, view2;
+    mpz_init(sum);
+    for (int i = begin; i < end; i++) {
+      mpz_mul(sum, ciphers1.view(i, view1), ciphers2.view(i, view2));
+      mpz_mod(sum, sum, pk->n[pk->s]);
+      res.setter_value(i, sum);
+    }
+    mpz_clear(sum);
+  });
+}
+
+void djcs_t_aux_vec_aggregate(const djcs_t_public_key *pk, EncodedNumber &res,
+                              const CipherVector &ciphers) {
+  check_size(ciphers.getter_size());
+  mpz_t sum, view;
+  mpz_init_set(sum, ciphers.view(0, view));
+  for (int i = 1; i < ciphers.getter_size(); i++) {
+    mpz_mul(sum, sum, ciphers.view(i, view));
+    mpz_mod(sum, sum, pk->n[pk->s]);
+  }
+  res.setter_value(sum);
+  mpz_set(sum, pk->n[0]);
+  res.setter_n(sum);
+  res.setter_exponent(ciphers.getter_exponent());
+  res.setter_type(Ciphertext);
+  mpz_clear(sum);
+}
+
+void djcs_t_aux_signed_inner_product(const djcs_t_public_key *pk,
+                                     EncodedNumber &res,
+                                     const CipherVector &ciphers,
+                                     EncodedNumber *plains) {
+  int size = ciphers.getter_size();
+  check_size(size);
+  auto *mpz_ciphers = (mpz_t *)malloc(size * sizeof(mpz_t));
+  auto *mpz_plains = (mpz_t *)malloc(size * sizeof(mpz_t));
+  mpz_t view;
+  for (int i = 0; i < size; i++) {
+    mpz_init_set(mpz_ciphers[i], ciphers.view(i, view));
+    mpz_init(mpz_plains[i]);
+    plains[i].getter_value(mpz_plains[i]);
+  }
+  mpz_t t1;
+  mpz_init(t1);
+  signed_multi_exp(pk, t1, mpz_ciphers, mpz_plains, size);
+  res.setter_value(t1);
+  mpz_set(t1, pk->n[0]);
+  res.setter_n(t1);
+  res.setter_exponent(ciphers.getter_exponent() + plains[0].getter_exponent());
+  res.setter_type(Ciphertext);
+
+  mpz_clear(t1);
+  for (int i = 0; i < size; i++) {
+    mpz_clear(mpz_ciphers[i]);
+    mpz_clear(mpz_plains[i]);
+  }
+  free(mpz_ciphers);
+  free(mpz_plains);
+}
+
+void djcs_t_aux_masked_select(const djcs_t_public_key *pk, PheRandomPool *pool,
+                              CipherVector &res, const CipherVector &ciphers,
+                              const std::vector<int> &bits, bool rerandomize) {
+  int size = ciphers.getter_size();
+  check_size(size);
+  if ((int)bits.size() < size) {
+    log_error("The bit vector is shorter than the cipher vector.");
+    exit(EXIT_FAILURE);
+  }
+  if (rerandomize && pool == nullptr) {
+    log_error("The randomness pool is not initialized.");
+    exit(EXIT_FAILURE);
+  }
+  if (&res != &ciphers) {
+    res = CipherVector(ciphers.getter_modulus(), size,
+                       ciphers.getter_exponent());
+  }
+  crypto_parallel_for_chunks(0, size, [&](int begin, int end) {
+    mpz_t t1, view;
+    mpz_init(t1);
+    for (int i = begin; i < end; i++) {
+      if (bits[i] != 0 && bits[i] != 1) {
+        log_error("The masked select needs a 0/1 bit vector.");
+        exit(EXIT_FAILURE);
+      }
+      if (bits[i] == 1 && !rerandomize) {
+        if (&res != &ciphers) {
+          res.setter_value(i, ciphers.view(i, view));
+        }
+        continue;
+      }
+      // the encryption of zero is r^{n^s}, or 1 for the trivial one
+      if (rerandomize) {
+        pool->fetch(t1);
+      } else {
+        mpz_set_ui(t1, 1);
+      }
+      if (bits[i] == 1) {
+        mpz_mul(t1, t1, ciphers.view(i, view));
+        mpz_mod(t1, t1, pk->n[pk->s]);
+      }
+      res.setter_value(i, t1);
+    }
+    mpz_clear(t1);
+  });
+}
+
+void djcs_t_aux_pack_ciphers(const djcs_t_public_key *pk,
+                             const PackedEncoder &encoder, EncodedNumber *res,
+                             const EncodedNumber *ciphers, int size) {
+  check_size(size);
+  int slot_bits = encoder.getter_slot_bits();
+  int slot_num = encoder.getter_slot_num();
+  int packed_size = encoder.packed_size(size);
+  for (int i = 1; i < size; i++) {
+    check_encoded_public_key(ciphers[0], ciphers[i]);
+    check_ee_add_exponent(ciphers[0], ciphers[i]);
   }
+  mpz_t shift;
+  mpz_init(shift);
+  mpz_setbit(shift, slot_bits);
+  crypto_parallel_for_chunks(0, packed_size, [&](int chunk_begin,
+                                                 int chunk_end) {
+    mpz_t acc, c;
+    mpz_init(acc);
+    mpz_init(c);
+    for (int p = chunk_begin; p < chunk_end; p++) {
+      int begin = p * slot_num;
+      int end = std::min(begin + slot_num, size);
+      // Horner from the highest slot: [acc] = [acc]^{2^{slot_bits}} * [c_i]
+      ciphers[end - 1].getter_value(acc);
+      for (int i = end - 2; i >= begin; i--) {
+        mpz_powm(acc, acc, shift, pk->n[pk->s]);
+        ciphers[i].getter_value(c);
+        mpz_mul(acc, acc, c);
+        mpz_mod(acc, acc, pk->n[pk->s]);
+      }
+      res[p].setter_n(pk->n[0]);
+      res[p].setter_value(acc);
+      res[p].setter_exponent(ciphers[begin].getter_exponent());
+      res[p].setter_type(Ciphertext);
+    }
+    mpz_clear(acc);
+    mpz_clear(c);
+  });
+  mpz_clear(shift);
 }
 
-void djcs_t_public_key_copy(djcs_t_public_key *src, djcs_t_public_key *dest) {
+void djcs_t_public_key_copy(const djcs_t_public_key *src,
+                            djcs_t_public_key *dest) {
   dest->s = src->s;
   dest->l = src->l;
   dest->w = src->w;
@@ -575,7 +1259,7 @@ void djcs_t_public_key_copy(djcs_t_public_key *src, djcs_t_public_key *dest) {
   }
 }
 
-void djcs_t_auth_server_copy(djcs_t_auth_server *src,
+void djcs_t_auth_server_copy(const djcs_t_auth_server *src,
                              djcs_t_auth_server *dest) {
   dest->i = src->i;
   mpz_set(dest->si, src->si);
@@ -595,17 +1279,10 @@ void check_size(int size) {
 
 void check_encoded_public_key(const EncodedNumber &num1,
                               const EncodedNumber &num2) {
-  mpz_t t1, t2;
-  mpz_init(t1);
-  mpz_init(t2);
-  num1.getter_n(t1);
-  num2.getter_n(t2);
-  if (mpz_cmp(t1, t2) != 0) {
+  if (!num1.same_n(num2)) {
     log_error("The two EncodedNumbers are not with the same public key.");
     exit(EXIT_FAILURE);
   }
-  mpz_clear(t1);
-  mpz_clear(t2);
 }
 
 void check_ee_add_exponent(const EncodedNumber &num1,
@@ -0,0 +1,125 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//
+// Created by root on 10/18/26.
+//
+
+#include "falcon/operator/phe/encrypted_weight_table.h"
+#include "falcon/operator/phe/multi_exp.h"
+
+#include <falcon/utils/logger/logger.h>
+#include <falcon/utils/thread_pool.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+EncryptedWeightTable::EncryptedWeightTable(const djcs_t_public_key *pk,
+                                           EncodedNumber *ciphers, int size,
+                                           int max_bits, int uses)
+    : size(size), max_bits(std::max(max_bits, 1)) {
+  if (size <= 0) {
+    log_error("The cipher vector of the weight table is empty.");
+    exit(EXIT_FAILURE);
+  }
+  // the cost (max_bits / w) * (uses + 2^w) is proportional to the one of
+  // a multi-exponentiation over 2 * uses terms
+  window = std::min(multi_exp_window(2 * uses, this->max_bits),
+                    PHE_FIXED_BASE_MAX_WINDOW);
+  window_num = (this->max_bits + window - 1) / window;
+  exponent = ciphers[0].getter_exponent();
+  mpz_init(n);
+  mpz_init_set(modulus, pk->n[pk->s]);
+  ciphers[0].getter_n(n);
+
+  int digit_num = (1 << window) - 1;
+  bases = (mpz_t *)malloc(size * sizeof(mpz_t));
+  tables = (mpz_t **)malloc(size * sizeof(mpz_t *));
+  for (int i = 0; i < size; i++) {
+    if (ciphers[i].getter_type() != Ciphertext) {
+      log_error("The weight table can only be built on ciphertexts.");
+      exit(EXIT_FAILURE);
+    }
+    mpz_init(bases[i]);
+    ciphers[i].getter_value(bases[i]);
+    tables[i] = (mpz_t *)malloc(window_num * digit_num * sizeof(mpz_t));
+  }
+  crypto_parallel_for(0, size, [&](int i) {
+    // b = c^{2^{w * k}} for the current window k
+    mpz_t b;
+    mpz_init_set(b, bases[i]);
+    for (int k = 0; k < window_num; k++) {
+      mpz_t *row = tables[i] + k * digit_num;
+      mpz_init_set(row[0], b);
+      for (int d = 1; d < digit_num; d++) {
+        mpz_init(row[d]);
+        mpz_mul(row[d], row[d - 1], b);
+        mpz_mod(row[d], row[d], modulus);
+      }
+      mpz_mul(b, row[digit_num - 1], b);
+      mpz_mod(b, b, modulus);
+    }
+    mpz_clear(b);
+  });
+}
+
+EncryptedWeightTable::~EncryptedWeightTable() {
+  int digit_num = (1 << window) - 1;
+  for (int i = 0; i < size; i++) {
+    for (int e = 0; e < window_num * digit_num; e++) {
+      mpz_clear(tables[i][e]);
+    }
+    free(tables[i]);
+    mpz_clear(bases[i]);
+  }
+  free(tables);
+  free(bases);
+  mpz_clear(n);
+  mpz_clear(modulus);
+}
+
+void EncryptedWeightTable::mul_pow(mpz_t acc, int index, const mpz_t e) const {
+  if (mpz_sgn(e) == 0) {
+    return;
+  }
+  if ((int)mpz_sizeinbase(e, 2) > max_bits) {
+    mpz_t t;
+    mpz_init(t);
+    mpz_powm(t, bases[index], e, modulus);
+    mpz_mul(acc, acc, t);
+    mpz_mod(acc, acc, modulus);
+    mpz_clear(t);
+    return;
+  }
+  int digit_num = (1 << window) - 1;
+  for (int k = 0; k < window_num; k++) {
+    unsigned long d = multi_exp_digit(e, k * window, window);
+    if (d != 0) {
+      mpz_mul(acc, acc, tables[index][k * digit_num + d - 1]);
+      mpz_mod(acc, acc, modulus);
+    }
+  }
+}
+
+void EncryptedWeightTable::getter_n(mpz_t g_n) const { mpz_set(g_n, n); }
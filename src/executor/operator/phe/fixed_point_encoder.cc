@@ -40,45 +40,37 @@ EncodedNumber::EncodedNumber() {
 }
 
 EncodedNumber::EncodedNumber(const EncodedNumber &number) {
+  mpz_init_set(n, number.n);
+  mpz_init_set(value, number.value);
+  exponent = number.exponent;
+  type = number.type;
+}
+
+EncodedNumber &EncodedNumber::operator=(const EncodedNumber &number) {
+  // mpz_set reuses the limbs of this number when they are large enough
+  mpz_set(n, number.n);
+  mpz_set(value, number.value);
+  exponent = number.exponent;
+  type = number.type;
+  return *this;
+}
+
+EncodedNumber::EncodedNumber(EncodedNumber &&number) noexcept {
+  // the moved-from number is left with the empty limbs of this one
   mpz_init(n);
   mpz_init(value);
-
-  mpz_t n_helper, value_helper;
-  mpz_init(n_helper);
-  mpz_init(value_helper);
-  // assign the "n" value of the EncodedNumber instance "number" to n_helper
-  number.getter_n(n_helper);
-  number.getter_value(value_helper);
-
-  // assign the value of n_helper to n of current EncodedNumber instance
-  mpz_set(n, n_helper);
-  mpz_set(value, value_helper);
-  exponent = number.getter_exponent();
-  type = number.getter_type();
-
-  // delete from memory
-  mpz_clear(n_helper);
-  mpz_clear(value_helper);
+  mpz_swap(n, number.n);
+  mpz_swap(value, number.value);
+  exponent = number.exponent;
+  type = number.type;
 }
 
-EncodedNumber &EncodedNumber::operator=(const EncodedNumber &number) {
-  // need to make sure the number has been initialized beforehand
-  // mpz_init(n);
-  // mpz_init(value);
-
-  mpz_t n_helper, value_helper;
-  mpz_init(n_helper);
-  mpz_init(value_helper);
-  number.getter_n(n_helper);
-  number.getter_value(value_helper);
-
-  mpz_set(n, n_helper);
-  mpz_set(value, value_helper);
-  exponent = number.getter_exponent();
-  type = number.getter_type();
-
-  mpz_clear(n_helper);
-  mpz_clear(value_helper);
+EncodedNumber &EncodedNumber::operator=(EncodedNumber &&number) noexcept {
+  mpz_swap(n, number.n);
+  mpz_swap(value, number.value);
+  exponent = number.exponent;
+  type = number.type;
+  return *this;
 }
 
 EncodedNumber::~EncodedNumber() {
@@ -236,11 +228,13 @@ void EncodedNumber::compute_decode_threshold(mpz_t max_int) {
   mpz_clear(t);
 }
 
-void EncodedNumber::setter_n(mpz_t s_n) { mpz_set(n, s_n); }
+void EncodedNumber::setter_n(const mpz_t s_n) { mpz_set(n, s_n); }
 
 void EncodedNumber::setter_exponent(int s_exponent) { exponent = s_exponent; }
 
-void EncodedNumber::setter_value(mpz_t s_value) { mpz_set(value, s_value); }
+void EncodedNumber::setter_value(const mpz_t s_value) {
+  mpz_set(value, s_value);
+}
 
 void EncodedNumber::setter_type(EncodedNumberType s_type) { type = s_type; }
 
@@ -254,6 +248,10 @@ void EncodedNumber::getter_value(mpz_t g_value) const {
 
 EncodedNumberType EncodedNumber::getter_type() const { return type; }
 
+bool EncodedNumber::same_n(const EncodedNumber &number) const {
+  return mpz_cmp(n, number.n) == 0;
+}
+
 // helper functions bellow
 long long fixed_pointed_integer_representation(double value, int precision) {
   auto ex = (long long)pow(PHE_FIXED_POINT_BASE, precision);
@@ -0,0 +1,208 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//
+// Created by root on 10/18/26.
+//
+
+#include "falcon/operator/phe/gmp_arena.h"
+
+#include <falcon/utils/logger/logger.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static const int MIN_BLOCK_BITS = 4;
+static const int CLASS_NUM = PHE_GMP_ARENA_MAX_BLOCK_BITS - MIN_BLOCK_BITS + 1;
+
+// bumped by gmp_arena_reset, each arena releases its blocks when it sees a
+// new epoch
+static std::atomic<unsigned> arena_epoch(0);
+
+// the smallest size class that holds size bytes, -1 if it is too large
+static int alloc_class(size_t size) {
+  int bits = MIN_BLOCK_BITS;
+  while (bits <= PHE_GMP_ARENA_MAX_BLOCK_BITS && ((size_t)1 << bits) < size) {
+    bits++;
+  }
+  return bits > PHE_GMP_ARENA_MAX_BLOCK_BITS ? -1 : bits - MIN_BLOCK_BITS;
+}
+
+// the largest size class that fits in a freed block of size bytes, -1 if
+// the block is too small or too large to be cached. The size is the one
+// gmp asked for, so that a block is never cached in a class larger than
+// its capacity, whether it was allocated by the arenas (rounded up to its
+// class) or by plain malloc before the installation
+static int free_class(size_t size) {
+  if (size < ((size_t)1 << MIN_BLOCK_BITS) ||
+      size >= ((size_t)1 << (PHE_GMP_ARENA_MAX_BLOCK_BITS + 1))) {
+    return -1;
+  }
+  int bits = MIN_BLOCK_BITS;
+  while (bits < PHE_GMP_ARENA_MAX_BLOCK_BITS &&
+         ((size_t)1 << (bits + 1)) <= size) {
+    bits++;
+  }
+  return bits - MIN_BLOCK_BITS;
+}
+
+static size_t class_bytes(int c) { return (size_t)1 << (c + MIN_BLOCK_BITS); }
+
+// set when the arena of the thread is destroyed, the blocks freed after that
+// (e.g., by other thread-local destructors) go back to the system
+static thread_local bool arena_destroyed = false;
+
+struct GmpArena {
+  std::vector<void *> blocks[CLASS_NUM];
+  unsigned epoch;
+  long cached_bytes;
+
+  GmpArena() : epoch(arena_epoch.load(std::memory_order_relaxed)) {
+    cached_bytes = 0;
+    for (auto &b : blocks) {
+      b.reserve(PHE_GMP_ARENA_CLASS_CAPACITY);
+    }
+  }
+
+  ~GmpArena() {
+    release();
+    arena_destroyed = true;
+  }
+
+  void release() {
+    for (auto &b : blocks) {
+      for (void *p : b) {
+        free(p);
+      }
+      b.clear();
+    }
+    cached_bytes = 0;
+  }
+
+  void check_epoch() {
+    unsigned current = arena_epoch.load(std::memory_order_relaxed);
+    if (epoch != current) {
+      release();
+      epoch = current;
+    }
+  }
+};
+
+static GmpArena *thread_arena() {
+  if (arena_destroyed) {
+    return nullptr;
+  }
+  static thread_local GmpArena arena;
+  return &arena;
+}
+
+static void *arena_alloc(size_t size) {
+  int c = alloc_class(size);
+  GmpArena *arena = thread_arena();
+  if (c >= 0 && arena != nullptr) {
+    arena->check_epoch();
+    if (!arena->blocks[c].empty()) {
+      void *p = arena->blocks[c].back();
+      arena->blocks[c].pop_back();
+      arena->cached_bytes -= (long)class_bytes(c);
+      return p;
+    }
+    size = class_bytes(c);
+  }
+  void *p = malloc(size);
+  if (p == nullptr) {
+    log_error("The gmp memory allocation failed.");
+    exit(EXIT_FAILURE);
+  }
+  return p;
+}
+
+static void arena_free(void *p, size_t size) {
+  if (p == nullptr) {
+    return;
+  }
+  int c = free_class(size);
+  GmpArena *arena = thread_arena();
+  if (c >= 0 && arena != nullptr) {
+    arena->check_epoch();
+    if ((int)arena->blocks[c].size() < PHE_GMP_ARENA_CLASS_CAPACITY) {
+      arena->blocks[c].push_back(p);
+      arena->cached_bytes += (long)class_bytes(c);
+      return;
+    }
+  }
+  free(p);
+}
+
+static void *arena_realloc(void *p, size_t old_size, size_t new_size) {
+  if (p == nullptr) {
+    return arena_alloc(new_size);
+  }
+  if (new_size <= old_size) {
+    return p;
+  }
+  void *q = arena_alloc(new_size);
+  memcpy(q, p, std::min(old_size, new_size));
+  arena_free(p, old_size);
+  return q;
+}
+
+struct PheScratch {
+  mpz_t values[PHE_SCRATCH_SIZE];
+
+  PheScratch() {
+    for (auto &v : values) {
+      mpz_init(v);
+    }
+  }
+
+  ~PheScratch() {
+    for (auto &v : values) {
+      mpz_clear(v);
+    }
+  }
+};
+
+void gmp_arena_install() {
+  mp_set_memory_functions(arena_alloc, arena_realloc, arena_free);
+}
+
+void gmp_arena_reset() { arena_epoch.fetch_add(1, std::memory_order_relaxed); }
+
+long gmp_arena_cached_bytes() {
+  GmpArena *arena = thread_arena();
+  if (arena == nullptr) {
+    return 0;
+  }
+  arena->check_epoch();
+  return arena->cached_bytes;
+}
+
+mpz_ptr phe_scratch(int index) {
+  static thread_local PheScratch scratch;
+  return scratch.values[index];
+}
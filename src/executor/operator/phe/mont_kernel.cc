@@ -0,0 +1,416 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//
+// Created by root on 10/18/26.
+//
+
+#include "falcon/operator/phe/mont_kernel.h"
+#include "falcon/operator/phe/multi_exp.h"
+
+#include "falcon/utils/thread_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__GNUC__) && GMP_NUMB_BITS == 64
+#define FALCON_MONT_KERNEL_IFMA 1
+#include <immintrin.h>
+#endif
+
+// radix 2^52 digits, one per 64-bit lane
+#define MONT_DIGIT_BITS 52
+#define MONT_LANES PHE_MONT_KERNEL_LANES
+
+static const uint64_t MONT_DIGIT_MASK = (1ULL << MONT_DIGIT_BITS) - 1;
+
+/**
+ * the digits of the modulus of each kernel, the smallest one with
+ * 52 * digits >= modulus_bits + 2 is used, so that the almost Montgomery
+ * products of values in [0, 2m) stay in [0, 2m)
+ */
+static const int MONT_KERNEL_DIGITS[] = {20, 40, 79};
+
+static int kernel_digits(int modulus_bits) {
+  for (int digits : MONT_KERNEL_DIGITS) {
+    if (MONT_DIGIT_BITS * digits >= modulus_bits + 2) {
+      return digits;
+    }
+  }
+  return 0;
+}
+
+/**
+ * choose the window bits that minimize the number of products, i.e.,
+ * 2^w - 2 for the table, max_bits squarings and max_bits / w multiplications
+ */
+static int kernel_window(int max_bits) {
+  int best_window = 1;
+  int best_cost = -1;
+  for (int w = 1; w <= PHE_MONT_KERNEL_MAX_WINDOW; w++) {
+    int cost = (1 << w) - 2 + (max_bits + w - 1) / w;
+    if (best_cost < 0 || cost < best_cost) {
+      best_cost = cost;
+      best_window = w;
+    }
+  }
+  return best_window;
+}
+
+static uint64_t mpz_digit(const mpz_t x, int j) {
+  int bit = MONT_DIGIT_BITS * j;
+  int limb = bit / 64, offset = bit % 64;
+  uint64_t digit = (uint64_t)mpz_getlimbn(x, limb) >> offset;
+  if (offset > 64 - MONT_DIGIT_BITS) {
+    digit |= (uint64_t)mpz_getlimbn(x, limb + 1) << (64 - offset);
+  }
+  return digit & MONT_DIGIT_MASK;
+}
+
+/**
+ * write x in [0, 2^{52 * digits}) into one lane of the digit-major layout
+ * digits[j * MONT_LANES + lane]
+ */
+static void mpz_to_lane(uint64_t *digits, int digit_num, int lane,
+                        const mpz_t x) {
+  for (int j = 0; j < digit_num; j++) {
+    digits[j * MONT_LANES + lane] = mpz_digit(x, j);
+  }
+}
+
+static void lane_to_mpz(mpz_t x, const uint64_t *digits, int digit_num,
+                        int lane) {
+  int limb_num = (MONT_DIGIT_BITS * digit_num + 63) / 64 + 1;
+  mp_limb_t *limbs = mpz_limbs_write(x, limb_num);
+  std::fill(limbs, limbs + limb_num, 0);
+  for (int j = 0; j < digit_num; j++) {
+    uint64_t digit = digits[j * MONT_LANES + lane];
+    int bit = MONT_DIGIT_BITS * j;
+    int limb = bit / 64, offset = bit % 64;
+    limbs[limb] |= (mp_limb_t)(digit << offset);
+    if (offset > 64 - MONT_DIGIT_BITS) {
+      limbs[limb + 1] |= (mp_limb_t)(digit >> (64 - offset));
+    }
+  }
+  while (limb_num > 0 && limbs[limb_num - 1] == 0) {
+    limb_num--;
+  }
+  mpz_limbs_finish(x, limb_num);
+}
+
+#ifdef FALCON_MONT_KERNEL_IFMA
+
+/**
+ * the almost Montgomery product r = a * b / 2^{52 * D} mod m of the lanes,
+ * for a, b in [0, 2m) and the result in [0, 2m). Only the carry of the
+ * lowest digit is propagated per round, the other digits accumulate at most
+ * 4 * D products of 52 bits, which fits in 64 bits for D < 2^9. r can be the
+ * same array as a or b
+ */
+template <int D>
+__attribute__((target("avx512f,avx512ifma"))) static inline void
+ifma_amm(__m512i *r, const __m512i *a, const __m512i *b, const __m512i *m,
+         __m512i k0) {
+  const __m512i zero = _mm512_setzero_si512();
+  __m512i acc[D + 1];
+  for (int j = 0; j <= D; j++) {
+    acc[j] = zero;
+  }
+  for (int i = 0; i < D; i++) {
+    __m512i ai = a[i];
+    for (int j = 0; j < D; j++) {
+      acc[j] = _mm512_madd52lo_epu64(acc[j], ai, b[j]);
+    }
+    // q = -acc / m mod 2^52 clears the lowest digit
+    __m512i q = _mm512_madd52lo_epu64(zero, acc[0], k0);
+    for (int j = 0; j < D; j++) {
+      acc[j] = _mm512_madd52lo_epu64(acc[j], q, m[j]);
+    }
+    acc[1] = _mm512_add_epi64(acc[1], _mm512_srli_epi64(acc[0], 52));
+    // shift by one digit, the high halves belong to the next digit
+    for (int j = 0; j < D; j++) {
+      acc[j] = _mm512_madd52hi_epu64(acc[j + 1], ai, b[j]);
+      acc[j] = _mm512_madd52hi_epu64(acc[j], q, m[j]);
+    }
+  }
+  const __m512i mask = _mm512_set1_epi64((long long)MONT_DIGIT_MASK);
+  __m512i carry = zero;
+  for (int j = 0; j < D; j++) {
+    __m512i t = _mm512_add_epi64(acc[j], carry);
+    carry = _mm512_srli_epi64(t, 52);
+    r[j] = _mm512_and_si512(t, mask);
+  }
+}
+
+/**
+ * the fixed window exponentiation of the lanes, in Montgomery form
+ *
+ * @param res: the results x^{e} * R mod m, D * MONT_LANES digits
+ * @param base: the bases x * R mod m, D * MONT_LANES digits
+ * @param one: R mod m, D * MONT_LANES digits
+ * @param exps: the exponents of the lanes
+ * @param max_bits: the bit length of the largest exponent
+ * @param m: the modulus, D digits
+ * @param k0: -m^{-1} mod 2^52
+ * @param table: 2^window * D * MONT_LANES digits of scratch
+ * @param window: window bits
+ */
+template <int D>
+__attribute__((target("avx512f,avx512ifma"))) static void
+ifma_powm(uint64_t *res, const uint64_t *base, const uint64_t *one,
+          mpz_srcptr *exps, int max_bits, const uint64_t *m, uint64_t k0,
+          uint64_t *table, int window) {
+  __m512i modulus[D], x[D], t[D];
+  const __m512i vk0 = _mm512_set1_epi64((long long)k0);
+  for (int j = 0; j < D; j++) {
+    modulus[j] = _mm512_set1_epi64((long long)m[j]);
+  }
+
+  // table[k] = base^k, table[0] = one
+  const int stride = D * MONT_LANES;
+  for (int j = 0; j < D; j++) {
+    x[j] = _mm512_loadu_si512(base + j * MONT_LANES);
+    t[j] = x[j];
+    _mm512_storeu_si512(table + j * MONT_LANES,
+                        _mm512_loadu_si512(one + j * MONT_LANES));
+    _mm512_storeu_si512(table + stride + j * MONT_LANES, x[j]);
+  }
+  for (int k = 2; k < (1 << window); k++) {
+    ifma_amm<D>(t, t, x, modulus, vk0);
+    for (int j = 0; j < D; j++) {
+      _mm512_storeu_si512(table + k * stride + j * MONT_LANES, t[j]);
+    }
+  }
+
+  // from the highest window, x = x^{2^w} * table[digit] per lane
+  const __m512i lanes = _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0);
+  int window_num = (max_bits + window - 1) / window;
+  for (int j = 0; j < D; j++) {
+    x[j] = _mm512_loadu_si512(one + j * MONT_LANES);
+  }
+  for (int win = window_num - 1; win >= 0; win--) {
+    long long offsets[MONT_LANES];
+    for (int l = 0; l < MONT_LANES; l++) {
+      offsets[l] = (long long)multi_exp_digit(exps[l], win * window, window) *
+                   stride;
+    }
+    __m512i index = _mm512_add_epi64(_mm512_loadu_si512(offsets), lanes);
+    for (int j = 0; j < D; j++) {
+      t[j] = _mm512_i64gather_epi64(index, (const long long *)table, 8);
+      index = _mm512_add_epi64(index, _mm512_set1_epi64(MONT_LANES));
+    }
+    if (win == window_num - 1) {
+      for (int j = 0; j < D; j++) {
+        x[j] = t[j];
+      }
+      continue;
+    }
+    for (int s = 0; s < window; s++) {
+      ifma_amm<D>(x, x, x, modulus, vk0);
+    }
+    ifma_amm<D>(x, x, t, modulus, vk0);
+  }
+
+  // leave the Montgomery form, x * 1 / R is in [0, m]
+  for (int j = 0; j < D; j++) {
+    t[j] = _mm512_setzero_si512();
+  }
+  t[0] = _mm512_set1_epi64(1);
+  ifma_amm<D>(x, x, t, modulus, vk0);
+  for (int j = 0; j < D; j++) {
+    _mm512_storeu_si512(res + j * MONT_LANES, x[j]);
+  }
+}
+
+static bool cpu_has_ifma() {
+  static const bool has_ifma = __builtin_cpu_supports("avx512f") &&
+                               __builtin_cpu_supports("avx512ifma");
+  return has_ifma;
+}
+
+#endif
+
+bool mont_kernel_available(int modulus_bits) {
+#ifdef FALCON_MONT_KERNEL_IFMA
+  return PHE_MONT_KERNEL_ENABLED && cpu_has_ifma() &&
+         kernel_digits(modulus_bits) > 0;
+#else
+  return false;
+#endif
+}
+
+MontModulus::MontModulus(const mpz_t pmodulus) : digit_num(0), k0(0) {
+  mpz_init_set(modulus, pmodulus);
+  int modulus_bits = (int)mpz_sizeinbase(modulus, 2);
+  if (!mont_kernel_available(modulus_bits) || mpz_even_p(modulus)) {
+    return;
+  }
+  digit_num = kernel_digits(modulus_bits);
+  m.resize(digit_num);
+  for (int j = 0; j < digit_num; j++) {
+    m[j] = mpz_digit(modulus, j);
+  }
+  mpz_t t, radix;
+  mpz_init(t);
+  mpz_init(radix);
+  mpz_setbit(radix, MONT_DIGIT_BITS);
+  mpz_invert(t, modulus, radix);
+  mpz_sub(t, radix, t);
+  k0 = (uint64_t)mpz_get_ui(t);
+  mpz_set_ui(t, 0);
+  mpz_setbit(t, MONT_DIGIT_BITS * digit_num);
+  mpz_mod(t, t, modulus);
+  one.resize(digit_num * MONT_LANES);
+  for (int l = 0; l < MONT_LANES; l++) {
+    mpz_to_lane(one.data(), digit_num, l, t);
+  }
+  mpz_clear(t);
+  mpz_clear(radix);
+}
+
+MontModulus::~MontModulus() { mpz_clear(modulus); }
+
+/**
+ * raise the lanes of one group, lane_num <= MONT_LANES, with the unused
+ * lanes set to one^0
+ */
+static void powm_group(const MontModulus &ctx, mpz_t *rops, mpz_t *bases,
+                       mpz_srcptr *exps, const int *indexes, int lane_num) {
+#ifdef FALCON_MONT_KERNEL_IFMA
+  int digit_num = ctx.digit_num;
+  mpz_srcptr modulus = ctx.modulus;
+  thread_local std::vector<uint64_t> base, res, table;
+  mpz_t t, zero;
+  mpz_init(t);
+  mpz_init(zero);
+  base.assign(ctx.one.begin(), ctx.one.end());
+  res.resize(digit_num * MONT_LANES);
+  mpz_srcptr lane_exps[MONT_LANES];
+  int max_bits = 0;
+  for (int l = 0; l < MONT_LANES; l++) {
+    lane_exps[l] = zero;
+    if (l >= lane_num) {
+      continue;
+    }
+    int i = indexes[l];
+    lane_exps[l] = exps[i];
+    if (mpz_sgn(exps[i]) > 0) {
+      max_bits = std::max(max_bits, (int)mpz_sizeinbase(exps[i], 2));
+    }
+    // to the Montgomery form x * R mod m
+    mpz_mul_2exp(t, bases[i], MONT_DIGIT_BITS * digit_num);
+    mpz_mod(t, t, modulus);
+    mpz_to_lane(base.data(), digit_num, l, t);
+  }
+  int window = kernel_window(max_bits);
+  table.resize((size_t)(1 << window) * digit_num * MONT_LANES);
+  switch (digit_num) {
+  case 20:
+    ifma_powm<20>(res.data(), base.data(), ctx.one.data(), lane_exps,
+                  max_bits, ctx.m.data(), ctx.k0, table.data(), window);
+    break;
+  case 40:
+    ifma_powm<40>(res.data(), base.data(), ctx.one.data(), lane_exps,
+                  max_bits, ctx.m.data(), ctx.k0, table.data(), window);
+    break;
+  default:
+    ifma_powm<79>(res.data(), base.data(), ctx.one.data(), lane_exps,
+                  max_bits, ctx.m.data(), ctx.k0, table.data(), window);
+    break;
+  }
+  for (int l = 0; l < lane_num; l++) {
+    int i = indexes[l];
+    lane_to_mpz(rops[i], res.data(), digit_num, l);
+    if (mpz_cmp(rops[i], modulus) >= 0) {
+      mpz_sub(rops[i], rops[i], modulus);
+    }
+  }
+  mpz_clear(t);
+  mpz_clear(zero);
+#endif
+}
+
+static void powm_batch(const MontModulus &ctx, mpz_t *rops, mpz_t *bases,
+                       mpz_srcptr *exps, int size) {
+  if (ctx.digit_num == 0) {
+    crypto_parallel_for(0, size, [&](int i) {
+      mpz_powm(rops[i], bases[i], exps[i], ctx.modulus);
+    });
+    return;
+  }
+
+  // negative exponents need an inversion, they are left to gmp
+  std::vector<int> indexes;
+  for (int i = 0; i < size; i++) {
+    if (mpz_sgn(exps[i]) < 0) {
+      mpz_powm(rops[i], bases[i], exps[i], ctx.modulus);
+    } else {
+      indexes.push_back(i);
+    }
+  }
+  int group_num = ((int)indexes.size() + MONT_LANES - 1) / MONT_LANES;
+  // one group per chunk, the groups are few and heavy
+  crypto_parallel_for(0, group_num, [&](int g) {
+    int begin = g * MONT_LANES;
+    int lane_num = std::min(MONT_LANES, (int)indexes.size() - begin);
+    if (lane_num < PHE_MONT_KERNEL_MIN_LANES) {
+      for (int l = 0; l < lane_num; l++) {
+        int i = indexes[begin + l];
+        mpz_powm(rops[i], bases[i], exps[i], ctx.modulus);
+      }
+    } else {
+      powm_group(ctx, rops, bases, exps, indexes.data() + begin, lane_num);
+    }
+  }, 1);
+}
+
+void mont_powm_batch(const MontModulus &ctx, mpz_t *rops, mpz_t *bases,
+                     mpz_t *exponents, int size) {
+  std::vector<mpz_srcptr> exps(size);
+  for (int i = 0; i < size; i++) {
+    exps[i] = exponents[i];
+  }
+  powm_batch(ctx, rops, bases, exps.data(), size);
+}
+
+void mont_powm_batch_fixed_exp(const MontModulus &ctx, mpz_t *rops,
+                               mpz_t *bases, const mpz_t exponent,
+                               int size) {
+  std::vector<mpz_srcptr> exps(size, exponent);
+  powm_batch(ctx, rops, bases, exps.data(), size);
+}
+
+void mont_powm_batch(mpz_t *rops, mpz_t *bases, mpz_t *exponents, int size,
+                     const mpz_t modulus) {
+  MontModulus ctx(modulus);
+  mont_powm_batch(ctx, rops, bases, exponents, size);
+}
+
+void mont_powm_batch_fixed_exp(mpz_t *rops, mpz_t *bases,
+                               const mpz_t exponent, int size,
+                               const mpz_t modulus) {
+  MontModulus ctx(modulus);
+  mont_powm_batch_fixed_exp(ctx, rops, bases, exponent, size);
+}
@@ -0,0 +1,139 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//
+// Created by root on 10/18/26.
+//
+
+#include "falcon/operator/phe/multi_exp.h"
+
+#include <falcon/utils/logger/logger.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+int multi_exp_window(int size, int max_bits) {
+  int best_window = 1;
+  double best_cost = -1;
+  for (int w = 1; w <= 16; w++) {
+    double windows = (max_bits + w - 1) / w;
+    double cost = windows * (size + (double)(2L << w));
+    if (best_cost < 0 || cost < best_cost) {
+      best_cost = cost;
+      best_window = w;
+    }
+  }
+  return best_window;
+}
+
+unsigned long multi_exp_digit(const mpz_t exponent, int pos, int w) {
+  unsigned long digit = 0;
+  for (int k = w - 1; k >= 0; k--) {
+    digit = (digit << 1) | (unsigned long)mpz_tstbit(exponent, pos + k);
+  }
+  return digit;
+}
+
+void multi_exp(mpz_t rop, mpz_t *bases, mpz_t *exponents, int size,
+               const mpz_t modulus, int window) {
+  int max_bits = 0;
+  for (int i = 0; i < size; i++) {
+    if (mpz_sgn(exponents[i]) < 0) {
+      log_error("The multi-exponentiation needs non-negative exponents.");
+      exit(EXIT_FAILURE);
+    }
+    if (mpz_sgn(exponents[i]) > 0) {
+      max_bits = std::max(max_bits, (int)mpz_sizeinbase(exponents[i], 2));
+    }
+  }
+  mpz_set_ui(rop, 1);
+  if (max_bits == 0) {
+    return;
+  }
+  int w = (window > 0) ? window : multi_exp_window(size, max_bits);
+  int bucket_num = (1 << w) - 1;
+
+  // buckets[d - 1] holds the product of the bases whose current digit is d
+  auto *buckets = (mpz_t *)malloc(bucket_num * sizeof(mpz_t));
+  auto *used = (bool *)malloc(bucket_num * sizeof(bool));
+  for (int d = 0; d < bucket_num; d++) {
+    mpz_init(buckets[d]);
+  }
+  mpz_t acc, running, total;
+  mpz_init_set_ui(acc, 1);
+  mpz_init(running);
+  mpz_init(total);
+
+  int window_num = (max_bits + w - 1) / w;
+  for (int win = window_num - 1; win >= 0; win--) {
+    // acc = acc^{2^w}
+    if (win != window_num - 1) {
+      for (int k = 0; k < w; k++) {
+        mpz_mul(acc, acc, acc);
+        mpz_mod(acc, acc, modulus);
+      }
+    }
+    std::fill(used, used + bucket_num, false);
+    for (int i = 0; i < size; i++) {
+      unsigned long d = multi_exp_digit(exponents[i], win * w, w);
+      if (d == 0) {
+        continue;
+      }
+      if (used[d - 1]) {
+        mpz_mul(buckets[d - 1], buckets[d - 1], bases[i]);
+        mpz_mod(buckets[d - 1], buckets[d - 1], modulus);
+      } else {
+        mpz_set(buckets[d - 1], bases[i]);
+        used[d - 1] = true;
+      }
+    }
+    // prod_d buckets[d]^d by the running products from the largest digit
+    mpz_set_ui(running, 1);
+    mpz_set_ui(total, 1);
+    bool non_empty = false;
+    for (int d = bucket_num; d >= 1; d--) {
+      if (used[d - 1]) {
+        mpz_mul(running, running, buckets[d - 1]);
+        mpz_mod(running, running, modulus);
+        non_empty = true;
+      }
+      if (non_empty) {
+        mpz_mul(total, total, running);
+        mpz_mod(total, total, modulus);
+      }
+    }
+    mpz_mul(acc, acc, total);
+    mpz_mod(acc, acc, modulus);
+  }
+  mpz_set(rop, acc);
+
+  for (int d = 0; d < bucket_num; d++) {
+    mpz_clear(buckets[d]);
+  }
+  free(buckets);
+  free(used);
+  mpz_clear(acc);
+  mpz_clear(running);
+  mpz_clear(total);
+}
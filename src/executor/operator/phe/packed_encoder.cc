@@ -0,0 +1,134 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//
+// Created by root on 10/18/26.
+//
+
+#include "falcon/operator/phe/packed_encoder.h"
+
+#include <falcon/utils/logger/logger.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+PackedEncoder::PackedEncoder(const mpz_t pn, int value_bits, int guard_bits) {
+  if (value_bits <= 0 || guard_bits < 0) {
+    log_error("[PackedEncoder] invalid value bits or guard bits.");
+    exit(EXIT_FAILURE);
+  }
+  mpz_init_set(n, pn);
+  slot_bits = value_bits + guard_bits + 1;
+  // the packed value must stay in (-n/2, n/2) to be decoded with its sign
+  slot_num = ((int)mpz_sizeinbase(n, 2) - 2) / slot_bits;
+  if (slot_num < 1) {
+    log_error("[PackedEncoder] the slot is wider than the plaintext space.");
+    exit(EXIT_FAILURE);
+  }
+}
+
+PackedEncoder::~PackedEncoder() { mpz_clear(n); }
+
+void PackedEncoder::pack(EncodedNumber *res, const EncodedNumber *plains,
+                         int size) const {
+  mpz_t half_n, bound, acc, v;
+  mpz_init(half_n);
+  mpz_init(bound);
+  mpz_init(acc);
+  mpz_init(v);
+  mpz_fdiv_q_2exp(half_n, n, 1);
+  mpz_setbit(bound, slot_bits - 1);
+  for (int p = 0; p < packed_size(size); p++) {
+    int begin = p * slot_num;
+    int end = std::min(begin + slot_num, size);
+    mpz_set_ui(acc, 0);
+    // Horner from the highest slot: acc = acc * 2^{slot_bits} + v_i
+    for (int i = end - 1; i >= begin; i--) {
+      if (plains[i].getter_exponent() != plains[begin].getter_exponent()) {
+        log_error("[PackedEncoder.pack] the exponents are not the same.");
+        exit(EXIT_FAILURE);
+      }
+      // values may be stored either signed or modulo n
+      plains[i].getter_value(v);
+      mpz_mod(v, v, n);
+      if (mpz_cmp(v, half_n) > 0) {
+        mpz_sub(v, v, n);
+      }
+      if (mpz_cmpabs(v, bound) >= 0) {
+        log_error("[PackedEncoder.pack] the value overflows the slot.");
+        exit(EXIT_FAILURE);
+      }
+      mpz_mul_2exp(acc, acc, slot_bits);
+      mpz_add(acc, acc, v);
+    }
+    mpz_mod(acc, acc, n);
+    res[p].setter_n(n);
+    res[p].setter_value(acc);
+    res[p].setter_exponent(plains[begin].getter_exponent());
+    res[p].setter_type(Plaintext);
+  }
+  mpz_clear(half_n);
+  mpz_clear(bound);
+  mpz_clear(acc);
+  mpz_clear(v);
+}
+
+void PackedEncoder::unpack(EncodedNumber *res, const EncodedNumber *packed,
+                           int size) const {
+  mpz_t half_n, half_slot, acc, v;
+  mpz_init(half_n);
+  mpz_init(half_slot);
+  mpz_init(acc);
+  mpz_init(v);
+  mpz_fdiv_q_2exp(half_n, n, 1);
+  mpz_setbit(half_slot, slot_bits - 1);
+  for (int p = 0; p < packed_size(size); p++) {
+    int begin = p * slot_num;
+    int end = std::min(begin + slot_num, size);
+    packed[p].getter_value(acc);
+    mpz_mod(acc, acc, n);
+    if (mpz_cmp(acc, half_n) > 0) {
+      mpz_sub(acc, acc, n);
+    }
+    for (int i = begin; i < end; i++) {
+      // the lowest slot, centered to [-2^{slot_bits-1}, 2^{slot_bits-1})
+      mpz_fdiv_r_2exp(v, acc, slot_bits);
+      if (mpz_cmp(v, half_slot) >= 0) {
+        mpz_submul_ui(v, half_slot, 2);
+      }
+      mpz_sub(acc, acc, v);
+      mpz_fdiv_q_2exp(acc, acc, slot_bits);
+      // store as a decrypted number, the negative values modulo n
+      mpz_mod(v, v, n);
+      res[i].setter_n(n);
+      res[i].setter_value(v);
+      res[i].setter_exponent(packed[p].getter_exponent());
+      res[i].setter_type(Plaintext);
+    }
+  }
+  mpz_clear(half_n);
+  mpz_clear(half_slot);
+  mpz_clear(acc);
+  mpz_clear(v);
+}
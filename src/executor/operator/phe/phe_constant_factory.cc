@@ -0,0 +1,89 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//
+// Created by root on 10/18/26.
+//
+
+#include "falcon/operator/phe/phe_constant_factory.h"
+#include "falcon/operator/phe/djcs_t_aux.h"
+
+#include <falcon/utils/logger/logger.h>
+
+PheConstantFactory::PheConstantFactory(std::shared_ptr<PheRandomPool> pool)
+    : random_pool(std::move(pool)) {
+  if (random_pool == nullptr) {
+    log_error("The randomness pool is not initialized.");
+    exit(EXIT_FAILURE);
+  }
+  pub_key = random_pool->getter_key_context()->getter_pub_key();
+}
+
+void PheConstantFactory::encrypt_zero(EncodedNumber &res, int precision,
+                                      bool trivial) const {
+  // g^0 = 1, so an encryption of zero is the randomness itself
+  mpz_t t;
+  mpz_init(t);
+  if (trivial) {
+    mpz_set_ui(t, 1);
+  } else {
+    random_pool->fetch(t);
+  }
+  res.setter_n(pub_key->n[0]);
+  res.setter_value(t);
+  res.setter_exponent(0 - precision);
+  res.setter_type(Ciphertext);
+  mpz_clear(t);
+}
+
+void PheConstantFactory::encrypt_zeros(EncodedNumber *res, int size,
+                                       int precision, bool trivial) const {
+  for (int i = 0; i < size; i++) {
+    encrypt_zero(res[i], precision, trivial);
+  }
+}
+
+void PheConstantFactory::encrypt_constant(EncodedNumber &res,
+                                          const EncodedNumber &plain,
+                                          bool trivial) const {
+  if (!trivial) {
+    djcs_t_aux_encrypt(pub_key, random_pool.get(), res, plain);
+    return;
+  }
+  if (plain.getter_type() != Plaintext) {
+    log_error("The given value is not Plaintext, and should not be encrypted.");
+    exit(EXIT_FAILURE);
+  }
+  mpz_t m, t;
+  mpz_init(m);
+  mpz_init(t);
+  plain.getter_value(m);
+  random_pool->pow_g(t, m);
+  res.setter_n(pub_key->n[0]);
+  res.setter_value(t);
+  res.setter_exponent(plain.getter_exponent());
+  res.setter_type(Ciphertext);
+  mpz_clear(m);
+  mpz_clear(t);
+}
@@ -0,0 +1,49 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//
+// Created by root on 10/18/26.
+//
+
+#include "falcon/operator/phe/phe_key_context.h"
+#include "falcon/operator/phe/djcs_t_aux.h"
+
+PheKeyContext::PheKeyContext(const djcs_t_public_key *pk,
+                             const djcs_t_auth_server *au) {
+  pub_key = djcs_t_init_public_key();
+  auth_server = djcs_t_init_auth_server();
+  djcs_t_public_key_copy(pk, pub_key);
+  djcs_t_auth_server_copy(au, auth_server);
+  mpz_init(decrypt_exponent);
+  mpz_mul(decrypt_exponent, auth_server->si, pub_key->delta);
+  mpz_mul_ui(decrypt_exponent, decrypt_exponent, 2);
+  mont_modulus.reset(new MontModulus(pub_key->n[pub_key->s]));
+}
+
+PheKeyContext::~PheKeyContext() {
+  mont_modulus.reset();
+  mpz_clear(decrypt_exponent);
+  djcs_t_free_public_key(pub_key);
+  djcs_t_free_auth_server(auth_server);
+}
@@ -0,0 +1,176 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//
+// Created by root on 10/18/26.
+//
+
+#include "falcon/operator/phe/phe_random_pool.h"
+#include "falcon/operator/phe/djcs_t_aux.h"
+#include "falcon/operator/phe/mont_kernel.h"
+
+#include <falcon/utils/logger/logger.h>
+
+#include <algorithm>
+#include <utility>
+
+PheRandomPool::PheRandomPool(std::shared_ptr<const PheKeyContext> key_context,
+                             int capacity, int watermark, int thread_num)
+    : key_context(std::move(key_context)),
+      capacity(std::max(capacity, 1)),
+      watermark(std::min(std::max(watermark, 1), std::max(capacity, 1))),
+      head(0), size(0), refilling(true), stopped(false), hits(0), misses(0) {
+  if (this->key_context == nullptr) {
+    log_error("The phe key context is not initialized.");
+    exit(EXIT_FAILURE);
+  }
+  pub_key = this->key_context->getter_pub_key();
+  mpz_t t;
+  mpz_init(t);
+  mpz_add_ui(t, pub_key->n[0], 1);
+  fast_pow_g = (pub_key->s == 1) && (mpz_cmp(t, pub_key->g) == 0);
+  mpz_clear(t);
+
+  slots = (mpz_t *)malloc(this->capacity * sizeof(mpz_t));
+  for (int i = 0; i < this->capacity; i++) {
+    mpz_init(slots[i]);
+  }
+  miss_random = hcs_init_random();
+  for (int i = 0; i < thread_num; i++) {
+    refill_threads.emplace_back(&PheRandomPool::refill, this);
+  }
+  log_info("[PheRandomPool] capacity = " + std::to_string(this->capacity) +
+           ", watermark = " + std::to_string(this->watermark) +
+           ", refill threads = " + std::to_string(thread_num));
+}
+
+PheRandomPool::~PheRandomPool() {
+  {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    stopped = true;
+  }
+  refill_cv.notify_all();
+  for (auto &t : refill_threads) {
+    t.join();
+  }
+  log_info("[PheRandomPool] hits = " + std::to_string(hits.load()) +
+           ", misses = " + std::to_string(misses.load()));
+  for (int i = 0; i < capacity; i++) {
+    mpz_clear(slots[i]);
+  }
+  free(slots);
+  hcs_free_random(miss_random);
+}
+
+void PheRandomPool::fetch(mpz_t rn) {
+  {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    if (size > 0) {
+      // hand over the precomputed value, the slot keeps rn's old limbs
+      mpz_swap(rn, slots[head]);
+      head = (head + 1) % capacity;
+      size--;
+      if (!refilling && size < watermark) {
+        refilling = true;
+        refill_cv.notify_all();
+      }
+      hits++;
+      return;
+    }
+  }
+  misses++;
+  // the pool is drained, only the random draw needs to be serialized
+  {
+    std::lock_guard<std::mutex> lock(miss_mutex);
+    do {
+      mpz_urandomm(rn, miss_random->rstate, pub_key->n[0]);
+    } while (mpz_cmp_ui(rn, 0) == 0);
+  }
+  mpz_powm(rn, rn, pub_key->n[pub_key->s - 1], pub_key->n[pub_key->s]);
+}
+
+void PheRandomPool::pow_g(mpz_t rop, const mpz_t m) const {
+  if (fast_pow_g) {
+    // (1 + n)^m = 1 + m * n mod n^2, also holds for negative m
+    mpz_mul(rop, m, pub_key->n[0]);
+    mpz_add_ui(rop, rop, 1);
+    mpz_mod(rop, rop, pub_key->n[pub_key->s]);
+  } else {
+    mpz_powm(rop, pub_key->g, m, pub_key->n[pub_key->s]);
+  }
+}
+
+void PheRandomPool::getter_cipher_modulus(mpz_t g_modulus) const {
+  mpz_set(g_modulus, pub_key->n[pub_key->s]);
+}
+
+int PheRandomPool::getter_size() {
+  std::lock_guard<std::mutex> lock(pool_mutex);
+  return size;
+}
+
+void PheRandomPool::refill() {
+  hcs_random *hr = hcs_init_random();
+  // a batch of values is raised at once by the multi-buffer kernel
+  const int batch = PHE_MONT_KERNEL_LANES;
+  mpz_t rns[PHE_MONT_KERNEL_LANES];
+  for (int i = 0; i < batch; i++) {
+    mpz_init(rns[i]);
+  }
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(pool_mutex);
+      refill_cv.wait(lock, [this] { return stopped || refilling; });
+      if (stopped) {
+        break;
+      }
+    }
+    generate(hr, rns, batch);
+    {
+      std::lock_guard<std::mutex> lock(pool_mutex);
+      for (int i = 0; i < batch && size < capacity; i++) {
+        mpz_swap(slots[(head + size) % capacity], rns[i]);
+        size++;
+      }
+      if (size == capacity) {
+        refilling = false;
+      }
+    }
+  }
+  for (int i = 0; i < batch; i++) {
+    mpz_clear(rns[i]);
+  }
+  hcs_free_random(hr);
+}
+
+void PheRandomPool::generate(hcs_random *hr, mpz_t *rns, int num) const {
+  // r is drawn from Z_n, which is in Z_n^* with overwhelming probability
+  for (int i = 0; i < num; i++) {
+    do {
+      mpz_urandomm(rns[i], hr->rstate, pub_key->n[0]);
+    } while (mpz_cmp_ui(rns[i], 0) == 0);
+  }
+  mont_powm_batch_fixed_exp(key_context->getter_mont_modulus(), rns, rns,
+                            pub_key->n[pub_key->s - 1], num);
+}
@@ -0,0 +1,137 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//
+// Created by root on 10/18/26.
+//
+
+#include "falcon/operator/phe/phe_random_stream.h"
+#include "falcon/utils/thread_pool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <falcon/utils/logger/logger.h>
+
+static std::atomic<unsigned long> master_seed(0);
+static std::atomic<bool> deterministic_mode(false);
+// bumped by every init, so that the threads reseed their streams
+static std::atomic<unsigned long> generation(1);
+static std::atomic<unsigned long> next_loop(0);
+
+/** a stream of a thread, freed when the thread exits */
+struct ThreadStream {
+  hcs_random *hr = nullptr;
+  // the generation the stream was seeded in, 0 if never seeded
+  unsigned long seeded_generation = 0;
+
+  ~ThreadStream() {
+    if (hr != nullptr) {
+      hcs_free_random(hr);
+    }
+  }
+};
+
+// the streams of a thread, one per chunk nesting depth, so that a chunk
+// run by the thread while another chunk waits in a nested loop does not
+// reseed or advance the waiting chunk's stream
+static thread_local std::vector<std::unique_ptr<ThreadStream>> thread_streams;
+// the system seeded streams of a thread for the secrets, one per depth
+static thread_local std::vector<std::unique_ptr<ThreadStream>> secret_streams;
+
+/**
+ * get the stream of the calling thread at the current chunk nesting depth,
+ * a new stream is seeded from the system by hcs_init_random
+ *
+ * @param streams: the streams of the thread, one per depth
+ * @return the stream
+ */
+static ThreadStream &
+depth_stream(std::vector<std::unique_ptr<ThreadStream>> &streams) {
+  int depth = crypto_parallel_depth();
+  if ((int)streams.size() <= depth) {
+    streams.resize(depth + 1);
+  }
+  if (streams[depth] == nullptr) {
+    streams[depth].reset(new ThreadStream());
+    streams[depth]->hr = hcs_init_random();
+  }
+  return *streams[depth];
+}
+
+/**
+ * seed a stream from the master seed, the loop and the chunk, the gmp
+ * generator scrambles the seed so that nearby words give unrelated streams
+ *
+ * @param hr: the stream
+ * @param loop: the loop number
+ * @param chunk_begin: the first index of the chunk
+ */
+static void seed_stream(hcs_random *hr, unsigned long loop,
+                        unsigned long chunk_begin) {
+  uint64_t words[3] = {master_seed.load(), loop, chunk_begin};
+  mpz_t seed;
+  mpz_init(seed);
+  mpz_import(seed, 3, -1, sizeof(uint64_t), 0, 0, words);
+  gmp_randseed(hr->rstate, seed);
+  mpz_clear(seed);
+}
+
+void phe_random_stream_init(unsigned long seed, bool deterministic) {
+  if (deterministic && seed == 0) {
+    std::random_device device;
+    seed = ((unsigned long)device() << 32) ^ device();
+  }
+  master_seed.store(seed);
+  deterministic_mode.store(deterministic);
+  next_loop.store(0);
+  generation++;
+}
+
+bool phe_random_stream_deterministic() { return deterministic_mode.load(); }
+
+unsigned long phe_random_stream_next_loop() { return next_loop++; }
+
+hcs_random *phe_random_stream(unsigned long loop, long chunk_begin) {
+  ThreadStream &thread_stream = depth_stream(thread_streams);
+  if (deterministic_mode.load()) {
+    seed_stream(thread_stream.hr, loop, (unsigned long)chunk_begin);
+  } else if (thread_stream.seeded_generation != generation.load()) {
+    // the full entropy of the system, as the libhcs generators
+    if (hcs_reseed_random(thread_stream.hr) == 0) {
+      log_error("Cannot seed the phe random stream from the system.");
+      exit(EXIT_FAILURE);
+    }
+    thread_stream.seeded_generation = generation.load();
+  }
+  return thread_stream.hr;
+}
+
+hcs_random *phe_secret_random_stream() {
+  return depth_stream(secret_streams).hr;
+}
@@ -0,0 +1,120 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//
+// Created by root on 10/18/26.
+//
+
+#include "falcon/operator/phe/share_combine.h"
+#include "falcon/operator/phe/djcs_t_aux.h"
+
+#include <falcon/utils/logger/logger.h>
+
+#include <cstdlib>
+#include <utility>
+
+ShareCombineContext::ShareCombineContext(
+    std::shared_ptr<const PheKeyContext> key_context,
+    const std::vector<int> &party_ids)
+    : key_context(std::move(key_context)), party_ids(party_ids) {
+  if (this->key_context == nullptr) {
+    log_error("The phe key context is not initialized.");
+    exit(EXIT_FAILURE);
+  }
+  pub_key = this->key_context->getter_pub_key();
+  if (pub_key->s != 1) {
+    log_error("The batched share combination only supports s = 1.");
+    exit(EXIT_FAILURE);
+  }
+  if (party_ids.empty()) {
+    log_error("The party set of the share combination is empty.");
+    exit(EXIT_FAILURE);
+  }
+  int party_num = (int)party_ids.size();
+  lambda_abs = (mpz_t *)malloc(party_num * sizeof(mpz_t));
+  mpz_t num, den;
+  mpz_init(num);
+  mpz_init(den);
+  for (int i = 0; i < party_num; i++) {
+    // lambda_i = delta * prod_{j != i} x_j / (x_j - x_i), which is an integer
+    // as delta = l! is divisible by the denominator
+    mpz_set(num, pub_key->delta);
+    mpz_set_ui(den, 1);
+    for (int j = 0; j < party_num; j++) {
+      if (j == i) {
+        continue;
+      }
+      mpz_mul_si(num, num, party_ids[j] + 1);
+      mpz_mul_si(den, den, party_ids[j] - party_ids[i]);
+    }
+    mpz_init(lambda_abs[i]);
+    mpz_divexact(lambda_abs[i], num, den);
+    lambda_negative.push_back(mpz_sgn(lambda_abs[i]) < 0);
+    mpz_abs(lambda_abs[i], lambda_abs[i]);
+    mpz_mul_ui(lambda_abs[i], lambda_abs[i], 2);
+  }
+  mpz_init(inv_four_delta_square);
+  mpz_pow_ui(inv_four_delta_square, pub_key->delta, 2);
+  mpz_mul_ui(inv_four_delta_square, inv_four_delta_square, 4);
+  mpz_invert(inv_four_delta_square, inv_four_delta_square, pub_key->n[0]);
+  mpz_clear(num);
+  mpz_clear(den);
+}
+
+ShareCombineContext::~ShareCombineContext() {
+  for (int i = 0; i < (int)party_ids.size(); i++) {
+    mpz_clear(lambda_abs[i]);
+  }
+  free(lambda_abs);
+  mpz_clear(inv_four_delta_square);
+}
+
+void ShareCombineContext::combine(mpz_t rop, mpz_t *shares,
+                                  mpz_t scratch) const {
+  mpz_set_ui(rop, 1);
+  for (int i = 0; i < (int)party_ids.size(); i++) {
+    mpz_powm(scratch, shares[i], lambda_abs[i], pub_key->n[pub_key->s]);
+    if (lambda_negative[i]) {
+      mpz_invert(scratch, scratch, pub_key->n[pub_key->s]);
+    }
+    mpz_mul(rop, rop, scratch);
+    mpz_mod(rop, rop, pub_key->n[pub_key->s]);
+  }
+  finish(rop, rop);
+}
+
+void ShareCombineContext::getter_coefficient(mpz_t rop, int index) const {
+  mpz_set(rop, lambda_abs[index]);
+  if (lambda_negative[index]) {
+    mpz_neg(rop, rop);
+  }
+}
+
+void ShareCombineContext::finish(mpz_t rop, const mpz_t product) const {
+  // L(u) = (u - 1) / n
+  mpz_sub_ui(rop, product, 1);
+  mpz_divexact(rop, rop, pub_key->n[0]);
+  mpz_mul(rop, rop, inv_four_delta_square);
+  mpz_mod(rop, rop, pub_key->n[0]);
+}
@@ -0,0 +1,598 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//
+// Created by root on 10/18/26.
+//
+
+#include <falcon/operator/phe/djcs_t_aux.h>
+#include <falcon/party/collectives.h>
+#include <falcon/party/encoded_number_stream.h>
+#include <falcon/utils/logger/logger.h>
+
+#include <algorithm>
+#include <future>
+#include <memory>
+
+void broadcast_message(const Party &party, int root, std::string &message,
+                       const MessageTag &tag) {
+  if (party.party_id == root) {
+    std::vector<std::future<void>> sent;
+    for (int id = 0; id < party.party_num; id++) {
+      if (id != party.party_id) {
+        sent.push_back(party.async_send(id, tag, message));
+      }
+    }
+    for (auto &f : sent) {
+      f.get();
+    }
+  } else {
+    message = party.async_recv(root, tag).get();
+  }
+}
+
+std::vector<std::string> gather_messages(const Party &party, int root,
+                                         const std::string &message,
+                                         const MessageTag &tag) {
+  std::vector<std::string> messages;
+  if (party.party_id == root) {
+    // post all the receives before waiting for any of them
+    std::vector<std::future<std::string>> received(party.party_num);
+    for (int id = 0; id < party.party_num; id++) {
+      if (id != party.party_id) {
+        received[id] = party.async_recv(id, tag);
+      }
+    }
+    messages.resize(party.party_num);
+    for (int id = 0; id < party.party_num; id++) {
+      messages[id] = (id == party.party_id) ? message : received[id].get();
+    }
+  } else {
+    party.async_send(root, tag, message).get();
+  }
+  return messages;
+}
+
+std::string scatter_messages(const Party &party, int root,
+                             const std::vector<std::string> &messages,
+                             const MessageTag &tag) {
+  if (party.party_id != root) {
+    return party.async_recv(root, tag).get();
+  }
+  std::vector<std::future<void>> sent;
+  for (int id = 0; id < party.party_num; id++) {
+    if (id != party.party_id) {
+      sent.push_back(party.async_send(id, tag, messages[id]));
+    }
+  }
+  for (auto &f : sent) {
+    f.get();
+  }
+  return messages[party.party_id];
+}
+
+std::vector<std::string> all_gather_messages(const Party &party,
+                                             const std::string &message,
+                                             const MessageTag &tag) {
+  std::vector<std::future<std::string>> received(party.party_num);
+  std::vector<std::future<void>> sent;
+  for (int id = 0; id < party.party_num; id++) {
+    if (id != party.party_id) {
+      received[id] = party.async_recv(id, tag);
+      sent.push_back(party.async_send(id, tag, message));
+    }
+  }
+  std::vector<std::string> messages(party.party_num);
+  for (int id = 0; id < party.party_num; id++) {
+    messages[id] = (id == party.party_id) ? message : received[id].get();
+  }
+  for (auto &f : sent) {
+    f.get();
+  }
+  return messages;
+}
+
+/**
+ * gather the arrays of all the parties at root chunk by chunk, call
+ * on_chunk at root on each gathered chunk, and stream result from root to
+ * the other parties if to_all
+ *
+ * @param party: the participating party
+ * @param root: the party that gathers the arrays
+ * @param numbers: the array of this party
+ * @param gathered: at root, the destination arrays indexed by party id
+ * @param result: the array streamed from root if to_all
+ * @param size: the size of the arrays
+ * @param produce: if given, called on each chunk of numbers before it is
+ *   sent
+ * @param on_chunk: if given, called at root on each gathered chunk
+ * @param to_all: whether to stream result to the other parties
+ */
+static void stream_gather(const Party &party, int root, EncodedNumber *numbers,
+                          EncodedNumber **gathered, EncodedNumber *result,
+                          int size, const ChunkFunction &produce,
+                          const ChunkFunction &on_chunk, bool to_all) {
+  if (party.party_id != root) {
+    send_encoded_number_stream(party, root, numbers, size, produce);
+    if (to_all) {
+      recv_encoded_number_stream(party, root, result, size);
+    }
+    return;
+  }
+
+  // receive the arrays of all the peers in the background
+  std::vector<std::unique_ptr<EncodedNumberStreamReader>> readers(
+      party.party_num);
+  std::vector<std::unique_ptr<EncodedNumberStreamWriter>> writers(
+      party.party_num);
+  for (int id = 0; id < party.party_num; id++) {
+    if (id != party.party_id) {
+      readers[id].reset(
+          new EncodedNumberStreamReader(party, id, gathered[id], size));
+      if (to_all) {
+        writers[id].reset(new EncodedNumberStreamWriter(party, id, size));
+      }
+    }
+  }
+  for (int begin = 0; begin < size; begin += PHE_STREAM_CHUNK_SIZE) {
+    int end = std::min(begin + PHE_STREAM_CHUNK_SIZE, size);
+    if (produce) {
+      produce(begin, end);
+    }
+    for (int id = 0; id < party.party_num; id++) {
+      if (readers[id]) {
+        readers[id]->wait(end);
+      }
+    }
+    if (on_chunk) {
+      on_chunk(begin, end);
+    }
+    for (int id = 0; id < party.party_num; id++) {
+      if (writers[id]) {
+        writers[id]->write(result, end);
+      }
+    }
+  }
+  for (int id = 0; id < party.party_num; id++) {
+    if (writers[id]) {
+      writers[id]->write(result, size);
+      writers[id]->finish();
+    }
+    if (readers[id]) {
+      readers[id]->finish();
+    }
+  }
+}
+
+void broadcast_encoded_numbers(const Party &party, int root,
+                               EncodedNumber *numbers, int size,
+                               const ChunkFunction &produce) {
+  if (party.party_id != root) {
+    recv_encoded_number_stream(party, root, numbers, size);
+    return;
+  }
+  std::vector<std::unique_ptr<EncodedNumberStreamWriter>> writers(
+      party.party_num);
+  for (int id = 0; id < party.party_num; id++) {
+    if (id != party.party_id) {
+      writers[id].reset(new EncodedNumberStreamWriter(party, id, size));
+    }
+  }
+  for (int begin = 0; begin < size; begin += PHE_STREAM_CHUNK_SIZE) {
+    int end = std::min(begin + PHE_STREAM_CHUNK_SIZE, size);
+    if (produce) {
+      produce(begin, end);
+    }
+    for (int id = 0; id < party.party_num; id++) {
+      if (writers[id]) {
+        writers[id]->write(numbers, end);
+      }
+    }
+  }
+  for (int id = 0; id < party.party_num; id++) {
+    if (writers[id]) {
+      writers[id]->write(numbers, size);
+      writers[id]->finish();
+    }
+  }
+}
+
+void gather_encoded_numbers(const Party &party, int root,
+                            EncodedNumber *numbers, EncodedNumber **gathered,
+                            int size, const ChunkFunction &produce,
+                            const ChunkFunction &consume) {
+  stream_gather(
+      party, root, numbers, gathered, nullptr, size, produce,
+      [&](int begin, int end) {
+        if (gathered[party.party_id] != numbers) {
+          std::copy(numbers + begin, numbers + end,
+                    gathered[party.party_id] + begin);
+        }
+        if (consume) {
+          consume(begin, end);
+        }
+      },
+      false);
+}
+
+void combine_encoded_numbers(const Party &party, int root,
+                             EncodedNumber *numbers, EncodedNumber *result,
+                             int size, const CombineFunction &combine,
+                             bool to_all, const ChunkFunction &produce) {
+  EncodedNumber **gathered = nullptr;
+  if (party.party_id == root) {
+    gathered = new EncodedNumber *[party.party_num];
+    for (int id = 0; id < party.party_num; id++) {
+      gathered[id] = (id == party.party_id) ? numbers : new EncodedNumber[size];
+    }
+  }
+  stream_gather(
+      party, root, numbers, gathered, result, size, produce,
+      [&](int begin, int end) { combine(gathered, begin, end); }, to_all);
+  if (party.party_id == root) {
+    for (int id = 0; id < party.party_num; id++) {
+      if (id != party.party_id) {
+        delete[] gathered[id];
+      }
+    }
+    delete[] gathered;
+  }
+}
+
+/**
+ * call fn on the chunks of [begin, end)
+ */
+static void for_each_chunk(int begin, int end, const ChunkFunction &fn) {
+  for (int b = begin; b < end; b += PHE_STREAM_CHUNK_SIZE) {
+    fn(b, std::min(b + PHE_STREAM_CHUNK_SIZE, end));
+  }
+}
+
+void shard_combine_encoded_numbers(const Party &party, EncodedNumber *numbers,
+                                   EncodedNumber *result, int size,
+                                   const BatchCombineFunction &combine,
+                                   const ChunkFunction &produce) {
+  int party_num = party.party_num;
+  int id = party.party_id;
+  // shard k of the arrays is [offset(k), offset(k + 1))
+  auto offset = [&](int k) { return (int)((long)size * k / party_num); };
+  int own_begin = offset(id);
+  int own_size = offset(id + 1) - own_begin;
+
+  // receive the own shard of each peer in the background, and send each
+  // peer its shard as it is produced, starting from the next party so that
+  // the peers are not all served in the same order
+  std::vector<EncodedNumber *> gathered(party_num);
+  std::vector<std::unique_ptr<EncodedNumberStreamReader>> readers(party_num);
+  for (int k = 0; k < party_num; k++) {
+    if (k == id) {
+      gathered[k] = numbers + own_begin;
+    } else {
+      gathered[k] = new EncodedNumber[own_size];
+      readers[k].reset(
+          new EncodedNumberStreamReader(party, k, gathered[k], own_size));
+    }
+  }
+  for (int s = 1; s <= party_num; s++) {
+    int k = (id + s) % party_num;
+    int begin = offset(k);
+    int shard_size = offset(k + 1) - begin;
+    if (k == id) {
+      if (produce) {
+        for_each_chunk(begin, begin + shard_size, produce);
+      }
+      continue;
+    }
+    EncodedNumberStreamWriter writer(party, k, shard_size);
+    for_each_chunk(0, shard_size, [&](int chunk_begin, int chunk_end) {
+      if (produce) {
+        produce(begin + chunk_begin, begin + chunk_end);
+      }
+      writer.write(numbers + begin, chunk_end);
+    });
+    writer.finish();
+  }
+
+  // combine the own shard chunk by chunk and stream it to every peer as it
+  // is combined
+  std::vector<std::unique_ptr<EncodedNumberStreamWriter>> writers(party_num);
+  for (int k = 0; k < party_num; k++) {
+    if (k != id) {
+      writers[k].reset(new EncodedNumberStreamWriter(party, k, own_size));
+    }
+  }
+  std::vector<EncodedNumber *> chunks(party_num);
+  for_each_chunk(0, own_size, [&](int begin, int end) {
+    for (int k = 0; k < party_num; k++) {
+      if (readers[k]) {
+        readers[k]->wait(end);
+      }
+      chunks[k] = gathered[k] + begin;
+    }
+    combine(chunks.data(), result + own_begin + begin, end - begin);
+    for (int k = 0; k < party_num; k++) {
+      if (writers[k]) {
+        writers[k]->write(result + own_begin, end);
+      }
+    }
+  });
+
+  // all-gather the combined shards of the peers
+  for (int k = 0; k < party_num; k++) {
+    if (readers[k]) {
+      readers[k]->finish();
+      readers[k].reset(new EncodedNumberStreamReader(
+          party, k, result + offset(k), offset(k + 1) - offset(k)));
+    }
+  }
+  for (int k = 0; k < party_num; k++) {
+    if (writers[k]) {
+      writers[k]->write(result + own_begin, own_size);
+      writers[k]->finish();
+    }
+    if (readers[k]) {
+      readers[k]->finish();
+    }
+    if (k != id) {
+      delete[] gathered[k];
+    }
+  }
+}
+
+static falcon::ReduceTopology current_reduce_topology = falcon::STAR_TOPOLOGY;
+
+void reduce_topology_init(falcon::ReduceTopology topology) {
+  current_reduce_topology = topology;
+}
+
+falcon::ReduceTopology reduce_topology() { return current_reduce_topology; }
+
+falcon::ReduceTopology parse_reduce_topology(const std::string &name) {
+  if (name == "star") {
+    return falcon::STAR_TOPOLOGY;
+  }
+  if (name == "tree") {
+    return falcon::TREE_TOPOLOGY;
+  }
+  if (name == "ring") {
+    return falcon::RING_TOPOLOGY;
+  }
+  log_error("Unknown reduce topology " + name + ".");
+  exit(EXIT_FAILURE);
+}
+
+static void star_reduce(const Party &party, int root, EncodedNumber *ciphers,
+                        EncodedNumber *result, int size, bool to_all,
+                        const ChunkFunction &produce) {
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
+  combine_encoded_numbers(
+      party, root, ciphers, result, size,
+      [&](EncodedNumber **gathered, int begin, int end) {
+        for (int i = begin; i < end; i++) {
+          result[i] = gathered[party.party_id][i];
+          for (int id = 0; id < party.party_num; id++) {
+            if (id != party.party_id) {
+              djcs_t_aux_ee_add(phe_pub_key, result[i], result[i],
+                                gathered[id][i]);
+            }
+          }
+        }
+      },
+      to_all, produce);
+}
+
+static void tree_reduce(const Party &party, int root, EncodedNumber *ciphers,
+                        EncodedNumber *result, int size, bool to_all,
+                        const ChunkFunction &produce) {
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
+  // the ranks in the binary tree are relative to root
+  int party_num = party.party_num;
+  int rank = (party.party_id - root + party_num) % party_num;
+  int parent = (rank == 0) ? -1 : ((rank - 1) / 2 + root) % party_num;
+  std::vector<int> children;
+  for (int child_rank = 2 * rank + 1;
+       child_rank <= 2 * rank + 2 && child_rank < party_num; child_rank++) {
+    children.push_back((child_rank + root) % party_num);
+  }
+
+  // add the partial sums of the children to the own ciphers, chunk by
+  // chunk, and send the chunks to the parent as they are added
+  EncodedNumber *sum = (parent < 0) ? result : new EncodedNumber[size];
+  std::vector<EncodedNumber *> child_sums;
+  std::vector<std::unique_ptr<EncodedNumberStreamReader>> readers;
+  for (int child : children) {
+    child_sums.push_back(new EncodedNumber[size]);
+    readers.emplace_back(
+        new EncodedNumberStreamReader(party, child, child_sums.back(), size));
+  }
+  std::unique_ptr<EncodedNumberStreamWriter> to_parent;
+  if (parent >= 0) {
+    to_parent.reset(new EncodedNumberStreamWriter(party, parent, size));
+  }
+  std::vector<std::unique_ptr<EncodedNumberStreamWriter>> to_children;
+  if (parent < 0 && to_all) {
+    for (int child : children) {
+      to_children.emplace_back(
+          new EncodedNumberStreamWriter(party, child, size));
+    }
+  }
+  for_each_chunk(0, size, [&](int begin, int end) {
+    if (produce) {
+      produce(begin, end);
+    }
+    for (int i = begin; i < end; i++) {
+      sum[i] = ciphers[i];
+    }
+    for (size_t c = 0; c < children.size(); c++) {
+      readers[c]->wait(end);
+      for (int i = begin; i < end; i++) {
+        djcs_t_aux_ee_add(phe_pub_key, sum[i], sum[i], child_sums[c][i]);
+      }
+    }
+    if (to_parent) {
+      to_parent->write(sum, end);
+    }
+    for (auto &writer : to_children) {
+      writer->write(sum, end);
+    }
+  });
+  for (size_t c = 0; c < children.size(); c++) {
+    readers[c]->finish();
+    delete[] child_sums[c];
+  }
+  if (to_parent) {
+    to_parent->write(sum, size);
+    to_parent->finish();
+    delete[] sum;
+  }
+
+  // send the sum down the tree, each party forwards the chunks received
+  // from its parent to its children
+  if (to_all) {
+    std::unique_ptr<EncodedNumberStreamReader> from_parent;
+    if (parent >= 0) {
+      from_parent.reset(
+          new EncodedNumberStreamReader(party, parent, result, size));
+      for (int child : children) {
+        to_children.emplace_back(
+            new EncodedNumberStreamWriter(party, child, size));
+      }
+      for_each_chunk(0, size, [&](int begin, int end) {
+        from_parent->wait(end);
+        for (auto &writer : to_children) {
+          writer->write(result, end);
+        }
+      });
+      from_parent->finish();
+    }
+    for (auto &writer : to_children) {
+      writer->write(result, size);
+      writer->finish();
+    }
+  }
+}
+
+static void ring_reduce(const Party &party, int root, EncodedNumber *ciphers,
+                        EncodedNumber *result, int size, bool to_all,
+                        const ChunkFunction &produce) {
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
+  int party_num = party.party_num;
+  int id = party.party_id;
+  int next = (id + 1) % party_num;
+  int prev = (id - 1 + party_num) % party_num;
+  // segment k of the arrays is [offset(k), offset(k + 1))
+  auto offset = [&](int k) { return (int)((long)size * k / party_num); };
+  auto produce_segment = [&](int k) {
+    if (produce) {
+      for_each_chunk(offset(k), offset(k + 1), produce);
+    }
+  };
+
+  // reduce-scatter: at step s, send the partial sum of segment id - s to
+  // next, and add the own ciphers to the partial sum of segment id - s - 1
+  // received from prev, after party_num - 1 steps, this party has the sum of
+  // segment id + 1
+  auto *sum = new EncodedNumber[size];
+  auto *received = new EncodedNumber[size];
+  produce_segment(id);
+  std::copy(ciphers + offset(id), ciphers + offset(id + 1), sum + offset(id));
+  for (int s = 0; s < party_num - 1; s++) {
+    int send_seg = (id - s + party_num) % party_num;
+    int recv_seg = (id - s - 1 + party_num) % party_num;
+    int send_begin = offset(send_seg);
+    int send_size = offset(send_seg + 1) - send_begin;
+    int recv_begin = offset(recv_seg);
+    int recv_size = offset(recv_seg + 1) - recv_begin;
+    EncodedNumberStreamWriter writer(party, next, send_size);
+    writer.write(sum + send_begin, send_size);
+    EncodedNumberStreamReader reader(party, prev, received + recv_begin,
+                                     recv_size);
+    produce_segment(recv_seg);
+    for_each_chunk(0, recv_size, [&](int begin, int end) {
+      reader.wait(end);
+      for (int i = recv_begin + begin; i < recv_begin + end; i++) {
+        djcs_t_aux_ee_add(phe_pub_key, sum[i], ciphers[i], received[i]);
+      }
+    });
+    reader.finish();
+    writer.finish();
+  }
+  delete[] received;
+
+  // all-gather: at step s, pass the sum of segment id + 1 - s to next, and
+  // receive the sum of segment id - s from prev, or send the own segment to
+  // root
+  int own_seg = (id + 1) % party_num;
+  if (!to_all && id != root) {
+    send_encoded_number_stream(party, root, sum + offset(own_seg),
+                               offset(own_seg + 1) - offset(own_seg));
+    delete[] sum;
+    return;
+  }
+  std::copy(sum + offset(own_seg), sum + offset(own_seg + 1),
+            result + offset(own_seg));
+  delete[] sum;
+  if (to_all) {
+    for (int s = 0; s < party_num - 1; s++) {
+      int send_seg = (id + 1 - s + party_num) % party_num;
+      int recv_seg = (id - s + party_num) % party_num;
+      int send_begin = offset(send_seg);
+      int send_size = offset(send_seg + 1) - send_begin;
+      EncodedNumberStreamWriter writer(party, next, send_size);
+      writer.write(result + send_begin, send_size);
+      recv_encoded_number_stream(party, prev, result + offset(recv_seg),
+                                 offset(recv_seg + 1) - offset(recv_seg));
+      writer.finish();
+    }
+  } else {
+    std::vector<std::unique_ptr<EncodedNumberStreamReader>> readers;
+    for (int other = 0; other < party_num; other++) {
+      if (other != id) {
+        int seg = (other + 1) % party_num;
+        readers.emplace_back(new EncodedNumberStreamReader(
+            party, other, result + offset(seg), offset(seg + 1) - offset(seg)));
+      }
+    }
+    for (auto &reader : readers) {
+      reader->finish();
+    }
+  }
+}
+
+void reduce_encoded_numbers(const Party &party, int root,
+                            EncodedNumber *ciphers, EncodedNumber *result,
+                            int size, bool to_all,
+                            const ChunkFunction &produce) {
+  if (party.party_num == 1 ||
+      current_reduce_topology == falcon::STAR_TOPOLOGY) {
+    star_reduce(party, root, ciphers, result, size, to_all, produce);
+  } else if (current_reduce_topology == falcon::TREE_TOPOLOGY) {
+    tree_reduce(party, root, ciphers, result, size, to_all, produce);
+  } else {
+    ring_reduce(party, root, ciphers, result, size, to_all, produce);
+  }
+}
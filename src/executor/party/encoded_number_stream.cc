@@ -0,0 +1,185 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//
+// Created by root on 10/18/26.
+//
+
+#include <falcon/party/encoded_number_stream.h>
+#include <falcon/utils/logger/logger.h>
+#include <falcon/utils/pb_converter/common_converter.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+EncodedNumberStreamWriter::EncodedNumberStreamWriter(const Party &party,
+                                                     int dest_party_id,
+                                                     int size, int chunk_size)
+    : party(party), dest_party_id(dest_party_id), size(size),
+      chunk_size(chunk_size), written(0), closed(false) {
+  if (size < 0 || chunk_size <= 0) {
+    log_error("The encoded number stream size or chunk size is invalid.");
+    exit(EXIT_FAILURE);
+  }
+  std::string header_str;
+  serialize_int_array(std::vector<int>{size, chunk_size}, header_str);
+  queue.push_back(std::move(header_str));
+  sender = std::thread(&EncodedNumberStreamWriter::send_loop, this);
+}
+
+EncodedNumberStreamWriter::~EncodedNumberStreamWriter() {
+  if (sender.joinable()) {
+    finish();
+  }
+}
+
+void EncodedNumberStreamWriter::write(EncodedNumber *numbers, int end) {
+  if (end < written || end > size) {
+    log_error("The encoded number stream is written out of order.");
+    exit(EXIT_FAILURE);
+  }
+  // send the complete chunks, and the last one when the array is complete
+  while (end - written >= chunk_size || (end == size && written < size)) {
+    int chunk_end = std::min(written + chunk_size, size);
+    std::string chunk_str;
+    serialize_encoded_number_array(numbers + written, chunk_end - written,
+                                   chunk_str, true);
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    queue_cv.wait(lock,
+                  [this] { return queue.size() < PHE_STREAM_QUEUE_CHUNKS; });
+    queue.push_back(std::move(chunk_str));
+    written = chunk_end;
+    queue_cv.notify_all();
+  }
+}
+
+void EncodedNumberStreamWriter::finish() {
+  if (written != size) {
+    log_error("The encoded number stream is finished before all the "
+              "elements are written.");
+    exit(EXIT_FAILURE);
+  }
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    closed = true;
+  }
+  queue_cv.notify_all();
+  sender.join();
+}
+
+void EncodedNumberStreamWriter::send_loop() {
+  while (true) {
+    std::string message;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex);
+      queue_cv.wait(lock, [this] { return closed || !queue.empty(); });
+      if (queue.empty()) {
+        return;
+      }
+      message = std::move(queue.front());
+      queue.pop_front();
+    }
+    // the writer may be blocked on a full queue
+    queue_cv.notify_all();
+    party.send_long_message(dest_party_id, std::move(message));
+  }
+}
+
+EncodedNumberStreamReader::EncodedNumberStreamReader(const Party &party,
+                                                     int src_party_id,
+                                                     EncodedNumber *numbers,
+                                                     int size)
+    : party(party), src_party_id(src_party_id), numbers(numbers), size(size),
+      key_context(party.phe_key_context), received(0) {
+  receiver = std::thread(&EncodedNumberStreamReader::recv_loop, this);
+}
+
+EncodedNumberStreamReader::~EncodedNumberStreamReader() {
+  if (receiver.joinable()) {
+    finish();
+  }
+}
+
+void EncodedNumberStreamReader::wait(int end) {
+  std::unique_lock<std::mutex> lock(received_mutex);
+  received_cv.wait(lock, [this, end] { return received >= end; });
+}
+
+void EncodedNumberStreamReader::finish() { receiver.join(); }
+
+void EncodedNumberStreamReader::recv_loop() {
+  std::string header_str;
+  party.recv_long_message(src_party_id, header_str);
+  std::vector<int> header;
+  deserialize_int_array(header, header_str);
+  if (header.size() != 2 || header[0] != size || header[1] <= 0) {
+    log_error("The received encoded number stream size is not expected.");
+    exit(EXIT_FAILURE);
+  }
+  int chunk_size = header[1];
+  for (int begin = 0; begin < size; begin += chunk_size) {
+    int end = std::min(begin + chunk_size, size);
+    std::string chunk_str;
+    party.recv_long_message(src_party_id, chunk_str);
+    deserialize_encoded_number_array(numbers + begin, end - begin, chunk_str,
+                                     key_context->getter_n());
+    {
+      std::lock_guard<std::mutex> lock(received_mutex);
+      received = end;
+    }
+    received_cv.notify_all();
+  }
+}
+
+void send_encoded_number_stream(const Party &party, int dest_party_id,
+                                EncodedNumber *numbers, int size,
+                                const std::function<void(int, int)> &produce,
+                                int chunk_size) {
+  EncodedNumberStreamWriter writer(party, dest_party_id, size, chunk_size);
+  for (int begin = 0; begin < size; begin += chunk_size) {
+    int end = std::min(begin + chunk_size, size);
+    if (produce) {
+      produce(begin, end);
+    }
+    writer.write(numbers, end);
+  }
+  writer.write(numbers, size);
+  writer.finish();
+}
+
+void recv_encoded_number_stream(const Party &party, int src_party_id,
+                                EncodedNumber *numbers, int size,
+                                const std::function<void(int, int)> &consume,
+                                int chunk_size) {
+  EncodedNumberStreamReader reader(party, src_party_id, numbers, size);
+  for (int begin = 0; begin < size; begin += chunk_size) {
+    int end = std::min(begin + chunk_size, size);
+    reader.wait(end);
+    if (consume) {
+      consume(begin, end);
+    }
+  }
+  reader.finish();
+}
@@ -26,6 +26,7 @@ SOFTWARE.
 // Created by root on 4/23/22.
 //
 
+#include <falcon/party/collectives.h>
 #include <falcon/party/info_exchange.h>
 #include <falcon/utils/pb_converter/common_converter.h>
 
@@ -91,108 +92,73 @@ void recv_encoded_number_matrix(const Party &party, EncodedNumber **mat,
 
 void broadcast_int_array(const Party &party, std::vector<int> &arr,
                          int req_party_id) {
+  // serialize the array to be broadcast, and deserialize it at the receivers
+  std::string arr_str;
   if (party.party_id == req_party_id) {
-    // serialize the array to be broadcast
-    std::string arr_str;
     serialize_int_array(arr, arr_str);
-    for (int id = 0; id < party.party_num; id++) {
-      if (id != party.party_id) {
-        party.send_long_message(id, arr_str);
-      }
-    }
-  } else {
-    // receive and deserialize the array
-    std::string recv_arr_str;
-    party.recv_long_message(req_party_id, recv_arr_str);
-    deserialize_int_array(arr, recv_arr_str);
+  }
+  broadcast_message(party, req_party_id, arr_str);
+  if (party.party_id != req_party_id) {
+    deserialize_int_array(arr, arr_str);
   }
 }
 
 void broadcast_double_array(const Party &party, std::vector<double> &arr,
                             int req_party_id) {
+  // serialize the array to be broadcast, and deserialize it at the receivers
+  std::string arr_str;
   if (party.party_id == req_party_id) {
-    // serialize the array to be broadcast
-    std::string arr_str;
     serialize_double_array(arr, arr_str);
-    for (int id = 0; id < party.party_num; id++) {
-      if (id != party.party_id) {
-        party.send_long_message(id, arr_str);
-      }
-    }
-  } else {
-    // receive and deserialize the array
-    std::string recv_arr_str;
-    party.recv_long_message(req_party_id, recv_arr_str);
-    deserialize_double_array(arr, recv_arr_str);
+  }
+  broadcast_message(party, req_party_id, arr_str);
+  if (party.party_id != req_party_id) {
+    deserialize_double_array(arr, arr_str);
   }
 }
 
 void broadcast_encoded_number_array(const Party &party, EncodedNumber *arr,
                                     int size, int req_party_id) {
+  // serialize the encoded number vector and send to other parties
+  std::string arr_str;
   if (party.party_id == req_party_id) {
-    // serialize the encoded number vector and send to other parties
-    std::string arr_str;
     serialize_encoded_number_array(arr, size, arr_str);
-    for (int id = 0; id < party.party_num; id++) {
-      if (id != party.party_id) {
-        party.send_long_message(id, arr_str);
-      }
-    }
-  } else {
-    // receive the message from req_party_id and set to vec
-    std::string recv_arr_str;
-    party.recv_long_message(req_party_id, recv_arr_str);
-    deserialize_encoded_number_array(arr, size, recv_arr_str);
+  }
+  broadcast_message(party, req_party_id, arr_str);
+  if (party.party_id != req_party_id) {
+    deserialize_encoded_number_array(arr, size, arr_str);
   }
 }
 
 void broadcast_encoded_number_matrix(const Party &party, EncodedNumber **mat,
                                      int row_size, int column_size,
                                      int req_party_id) {
+  // serialize the encoded number matrix and send to other parties
+  std::string mat_str;
   if (party.party_id == req_party_id) {
-    // serialize the encoded number matrix and send to other parties
-    std::string mat_str;
     serialize_encoded_number_matrix(mat, row_size, column_size, mat_str);
-    for (int id = 0; id < party.party_num; id++) {
-      if (id != party.party_id) {
-        party.send_long_message(id, mat_str);
-      }
-    }
-  } else {
-    // receive the message from req_party_id and set to vec
-    std::string recv_mat_str;
-    party.recv_long_message(req_party_id, recv_mat_str);
-    deserialize_encoded_number_matrix(mat, row_size, column_size, recv_mat_str);
+  }
+  broadcast_message(party, req_party_id, mat_str);
+  if (party.party_id != req_party_id) {
+    deserialize_encoded_number_matrix(mat, row_size, column_size, mat_str);
   }
 }
 
 std::vector<int> sync_up_int_arr(const Party &party, int v) {
+  // the active party gathers the values of all the parties, in party id
+  // order, and broadcasts the array
+  std::vector<std::string> values =
+      gather_messages(party, ACTIVE_PARTY_ID, std::to_string(v));
   std::vector<int> sync_arr;
+  std::string sync_arr_str;
   if (party.party_type == falcon::ACTIVE_PARTY) {
-    // first set its own weight size and receive other parties' weight sizes
-    sync_arr.push_back(v);
-    for (int i = 0; i < party.party_num; i++) {
-      if (i != party.party_id) {
-        std::string recv_weight_size;
-        party.recv_long_message(i, recv_weight_size);
-        sync_arr.push_back(std::stoi(recv_weight_size));
-      }
-    }
-    // then broadcast the vector
-    std::string party_weight_sizes_str;
-    serialize_int_array(sync_arr, party_weight_sizes_str);
-    for (int i = 0; i < party.party_num; i++) {
-      if (i != party.party_id) {
-        party.send_long_message(i, party_weight_sizes_str);
-      }
+    for (const std::string &value : values) {
+      sync_arr.push_back(std::stoi(value));
     }
-  } else {
-    // first send the weight size to active party
-    party.send_long_message(ACTIVE_PARTY_ID, std::to_string(v));
-    // then receive and deserialize the party_weight_sizes array
-    std::string recv_party_weight_sizes_str;
-    party.recv_long_message(ACTIVE_PARTY_ID, recv_party_weight_sizes_str);
-    deserialize_int_array(sync_arr, recv_party_weight_sizes_str);
+    serialize_int_array(sync_arr, sync_arr_str);
+  }
+  broadcast_message(party, ACTIVE_PARTY_ID, sync_arr_str);
+  if (party.party_type != falcon::ACTIVE_PARTY) {
+    deserialize_int_array(sync_arr, sync_arr_str);
   }
   return sync_arr;
 }
@@ -201,35 +167,27 @@ std::vector<int> sync_up_int_arrs(const Party &party,
                                   const std::vector<int> &arr) {
   // first sync up each party's local arr size
   std::vector<int> arr_size = sync_up_int_arr(party, (int)arr.size());
-  // then, sync up the int arr
+  // then, the active party gathers the int arrs, flattens them in party id
+  // order, and broadcasts the flattened arr
+  std::string arr_str;
+  serialize_int_array(arr, arr_str);
+  std::vector<std::string> arr_strs =
+      gather_messages(party, ACTIVE_PARTY_ID, arr_str);
   std::vector<int> flattened_arr;
+  std::string flattened_arr_str;
   if (party.party_type == falcon::ACTIVE_PARTY) {
-    // copy self arr
-    for (int v : arr) {
-      flattened_arr.push_back(v);
-    }
-    // receive arr from other parties and append
-    for (int id = 0; id < party.party_num; id++) {
-      if (id != party.party_id) {
-        std::vector<int> recv_arr_id = recv_int_array(party, id);
-        for (int v : recv_arr_id) {
-          flattened_arr.push_back(v);
-        }
-      }
-    }
-    // serialize and broadcast
-    for (int id = 0; id < party.party_num; id++) {
-      if (id != party.party_id) {
-        send_int_array(party, flattened_arr, id);
-      }
+    for (const std::string &recv_arr_str : arr_strs) {
+      std::vector<int> recv_arr;
+      deserialize_int_array(recv_arr, recv_arr_str);
+      flattened_arr.insert(flattened_arr.end(), recv_arr.begin(),
+                           recv_arr.end());
     }
-  } else {
-    // first send the int arr to active party
-    send_int_array(party, arr, ACTIVE_PARTY_ID);
-    // then receive and deserialize the flattened int array
-    flattened_arr = recv_int_array(party, ACTIVE_PARTY_ID);
+    serialize_int_array(flattened_arr, flattened_arr_str);
+  }
+  broadcast_message(party, ACTIVE_PARTY_ID, flattened_arr_str);
+  if (party.party_type != falcon::ACTIVE_PARTY) {
+    deserialize_int_array(flattened_arr, flattened_arr_str);
   }
-
   return flattened_arr;
 }
 
@@ -237,34 +195,26 @@ std::vector<double> sync_up_double_arrs(const Party &party,
                                         const std::vector<double> &arr) {
   // first sync up each party's local arr size
   std::vector<int> arr_size = sync_up_int_arr(party, (int)arr.size());
-  // then, sync up the double arr
+  // then, the active party gathers the double arrs, flattens them in party
+  // id order, and broadcasts the flattened arr
+  std::string arr_str;
+  serialize_double_array(arr, arr_str);
+  std::vector<std::string> arr_strs =
+      gather_messages(party, ACTIVE_PARTY_ID, arr_str);
   std::vector<double> flattened_arr;
+  std::string flattened_arr_str;
   if (party.party_type == falcon::ACTIVE_PARTY) {
-    // copy self arr
-    for (double v : arr) {
-      flattened_arr.push_back(v);
-    }
-    // receive arr from other parties and append
-    for (int id = 0; id < party.party_num; id++) {
-      if (id != party.party_id) {
-        std::vector<double> recv_arr_id = recv_double_array(party, id);
-        for (double v : recv_arr_id) {
-          flattened_arr.push_back(v);
-        }
-      }
-    }
-    // serialize and broadcast
-    for (int id = 0; id < party.party_num; id++) {
-      if (id != party.party_id) {
-        send_double_array(party, flattened_arr, id);
-      }
+    for (const std::string &recv_arr_str : arr_strs) {
+      std::vector<double> recv_arr;
+      deserialize_double_array(recv_arr, recv_arr_str);
+      flattened_arr.insert(flattened_arr.end(), recv_arr.begin(),
+                           recv_arr.end());
     }
-  } else {
-    // first send the double arr to active party
-    send_double_array(party, arr, ACTIVE_PARTY_ID);
-    // then receive and deserialize the flattened double array
-    flattened_arr = recv_double_array(party, ACTIVE_PARTY_ID);
+    serialize_double_array(flattened_arr, flattened_arr_str);
+  }
+  broadcast_message(party, ACTIVE_PARTY_ID, flattened_arr_str);
+  if (party.party_type != falcon::ACTIVE_PARTY) {
+    deserialize_double_array(flattened_arr, flattened_arr_str);
   }
-
   return flattened_arr;
-}
\ No newline at end of file
+}
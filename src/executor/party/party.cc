@@ -31,6 +31,7 @@ SOFTWARE.
 #include <ctime>
 #include <falcon/common.h>
 #include <falcon/network/ConfigFile.hpp>
+#include <falcon/operator/mpc/spdz_session.h>
 #include <falcon/operator/phe/djcs_t_aux.h>
 #include <falcon/party/party.h>
 #include <falcon/utils/base64.h>
@@ -39,6 +40,7 @@ SOFTWARE.
 #include <falcon/utils/pb_converter/common_converter.h>
 #include <falcon/utils/pb_converter/network_converter.h>
 #include <falcon/utils/pb_converter/phe_keys_converter.h>
+#include <cstring>
 #include <fstream>
 #include <glog/logging.h>
 #include <iostream>
@@ -47,7 +49,19 @@ SOFTWARE.
 #include <stack>
 #include <string>
 
-Party::Party() {}
+Party::Party() {
+  // an empty party, which is set up by the caller, e.g., on a loopback
+  // network in the tests
+  party_id = 0;
+  party_num = 0;
+  party_type = falcon::ACTIVE_PARTY;
+  fl_setting = falcon::VERTICAL_FL;
+  sample_num = 0;
+  feature_num = 0;
+  phe_random = hcs_init_random();
+  phe_pub_key = djcs_t_init_public_key();
+  phe_auth_server = djcs_t_init_auth_server();
+}
 
 Party::Party(int m_party_id, int m_party_num, falcon::PartyType m_party_type,
              falcon::FLSetting m_fl_setting, const std::string &m_data_file) {
@@ -84,8 +98,14 @@ Party::Party(const Party &party) {
   party_type = party.party_type;
   fl_setting = party.fl_setting;
   channels = party.channels;
+  async_channels = party.async_channels;
   host_names = party.host_names;
   executor_mpc_ports = party.executor_mpc_ports;
+  spdz_session = party.spdz_session;
+  phe_random_pool = party.phe_random_pool;
+  phe_constant_factory = party.phe_constant_factory;
+  phe_share_combiner = party.phe_share_combiner;
+  phe_key_context = party.phe_key_context;
 
   // copy private variables
   feature_num = party.getter_feature_num();
@@ -116,8 +136,14 @@ Party &Party::operator=(const Party &party) {
   party_type = party.party_type;
   fl_setting = party.fl_setting;
   channels = party.channels;
+  async_channels = party.async_channels;
   host_names = party.host_names;
   executor_mpc_ports = party.executor_mpc_ports;
+  spdz_session = party.spdz_session;
+  phe_random_pool = party.phe_random_pool;
+  phe_constant_factory = party.phe_constant_factory;
+  phe_share_combiner = party.phe_share_combiner;
+  phe_key_context = party.phe_key_context;
 
   // copy private variables
   feature_num = party.getter_feature_num();
@@ -232,6 +258,21 @@ void Party::init_network_channels(const std::string &m_network_file) {
       channels.push_back(std::move(channel));
     }
   }
+
+  // from now on, the messages go through the asynchronous channels
+  for (int i = 0; i < party_num; ++i) {
+    if (i != party_id) {
+      async_channels.push_back(std::make_shared<AsyncChannel>(
+          channels[i], PARTY_CHANNEL_MAX_PENDING_BYTES));
+    } else {
+      async_channels.push_back(nullptr);
+    }
+  }
+
+  // the connections to the spdz parties are opened by the first computation
+  spdz_session = std::make_shared<SpdzSession>(
+      party_num, party_id, executor_mpc_ports, host_names,
+      spdz_session_persistent());
 }
 
 void Party::init_phe_keys(bool m_use_existing_key,
@@ -254,6 +295,9 @@ void Party::init_phe_keys(bool m_use_existing_key,
     write_key_to_file(phe_keys_str, m_key_file);
     log_info("Write phe keys finished");
   }
+  init_phe_key_context();
+  init_phe_random_pool();
+  init_phe_share_combiner();
 }
 
 void Party::init_with_new_phe_keys(int epsilon, int phe_key_size,
@@ -332,31 +376,85 @@ void Party::load_phe_key_string(const std::string &phe_keys_str) {
   phe_pub_key = djcs_t_init_public_key();
   phe_auth_server = djcs_t_init_auth_server();
   deserialize_phe_keys(phe_pub_key, phe_auth_server, phe_keys_str);
+  init_phe_key_context();
+  init_phe_random_pool();
+  init_phe_share_combiner();
+}
+
+void Party::init_phe_key_context() {
+  phe_key_context = std::make_shared<PheKeyContext>(phe_pub_key,
+                                                    phe_auth_server);
+}
+
+void Party::init_phe_share_combiner() {
+  std::vector<int> party_ids;
+  for (int id = 0; id < party_num; id++) {
+    party_ids.push_back(id);
+  }
+  phe_share_combiner =
+      std::make_shared<ShareCombineContext>(phe_key_context, party_ids);
+}
+
+void Party::init_phe_random_pool(int capacity, int watermark,
+                                 int thread_num) {
+  // release the old pool first, so that its threads stop before refilling
+  phe_constant_factory = nullptr;
+  phe_random_pool = nullptr;
+  phe_random_pool = std::make_shared<PheRandomPool>(phe_key_context, capacity,
+                                                    watermark, thread_num);
+  phe_constant_factory = std::make_shared<PheConstantFactory>(phe_random_pool);
+}
+
+/**
+ * wait until a message is written, the blocking sends exit on a failed write
+ * as the peer would wait for the message forever
+ *
+ * @param written: the future of the queued message
+ * @param id: the receiving party id
+ */
+static void wait_message_written(std::future<void> written, int id) {
+  try {
+    written.get();
+  } catch (const std::exception &e) {
+    log_error("Send message to party " + std::to_string(id) +
+              " failed: " + e.what());
+    exit(EXIT_FAILURE);
+  }
 }
 
 void Party::send_message(int id, std::string message) const {
-  channels[id]->write((const byte *)message.c_str(), message.size());
+  // the untagged messages are sent with the default tag, in order
+  wait_message_written(async_send(id, MessageTag(), std::move(message)), id);
 }
 
 void Party::send_long_message(int id, string message) const {
-  channels[id]->writeWithSize(message);
+  wait_message_written(async_send(id, MessageTag(), std::move(message)), id);
 }
 
 void Party::recv_message(int id, std::string message, byte *buffer,
                          int expected_size) const {
-  channels[id]->read(buffer, expected_size);
+  std::string recv_message = async_recv(id, MessageTag()).get();
+  if ((int)recv_message.size() != expected_size) {
+    log_error("The received message size is not expected.");
+    exit(EXIT_FAILURE);
+  }
+  memcpy(buffer, recv_message.data(), expected_size);
   // the size of all strings is 2. Parse the message to get the original strings
-  auto s = string(reinterpret_cast<char const *>(buffer), expected_size);
-  message = s;
+  message = recv_message;
 }
 
 void Party::recv_long_message(int id, std::string &message) const {
-  vector<byte> recv_message;
-  channels[id]->readWithSizeIntoVector(recv_message);
-  const byte *uc = &(recv_message[0]);
-  string recv_message_str(reinterpret_cast<char const *>(uc),
-                          recv_message.size());
-  message = recv_message_str;
+  message = async_recv(id, MessageTag()).get();
+}
+
+std::future<void> Party::async_send(int id, const MessageTag &tag,
+                                    std::string message) const {
+  return async_channels[id]->send(tag, std::move(message));
+}
+
+std::future<std::string> Party::async_recv(int id,
+                                           const MessageTag &tag) const {
+  return async_channels[id]->recv(tag);
 }
 
 void Party::split_train_test_data(
@@ -442,9 +540,11 @@ Party::~Party() {
   // if does not reset channels[i] to nullptr,
   // there will be a heap-use-after-free crash
   io_service.stop();
-  for (int i = 0; i < party_num; i++) {
-    channels[i] = nullptr;
+  for (auto &channel : channels) {
+    channel = nullptr;
   }
+  // the last copy of the party flushes the queued messages
+  async_channels.clear();
   hcs_free_random(phe_random);
   djcs_t_free_public_key(phe_pub_key);
   djcs_t_free_auth_server(phe_auth_server);
@@ -101,8 +101,8 @@ double lime_reg_tree_root_impurity(
   auto *dec_label_sum = new EncodedNumber[2];
 
   // retrieve phe pub key
-  djcs_t_public_key *phe_pub_key = djcs_t_init_public_key();
-  party.getter_phe_pub_key(phe_pub_key);
+  const djcs_t_public_key *phe_pub_key =
+      party.phe_key_context->getter_pub_key();
 
   if (party.party_type == falcon::ACTIVE_PARTY) {
     int enc_label_prec =
@@ -113,10 +113,10 @@ double lime_reg_tree_root_impurity(
 
     enc_label_sum[0].set_double(phe_pub_key->n[0], 0.0, enc_label_prec);
     enc_label_sum[1].set_double(phe_pub_key->n[0], 0.0, enc_label_prec);
-    djcs_t_aux_encrypt(phe_pub_key, party.phe_random, enc_label_sum[0],
-                       enc_label_sum[0]);
-    djcs_t_aux_encrypt(phe_pub_key, party.phe_random, enc_label_sum[1],
-                       enc_label_sum[1]);
+    djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                       enc_label_sum[0], enc_label_sum[0]);
+    djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
+                       enc_label_sum[1], enc_label_sum[1]);
 
     // compute encrypted sum
     for (int i = 0; i < size; i++) {
@@ -154,7 +154,7 @@ double lime_reg_tree_root_impurity(
     // encrypt the root impurity
     encrypted_root_impurity[0].set_double(phe_pub_key->n[0], root_impurity,
                                           PHE_FIXED_POINT_PRECISION);
-    djcs_t_aux_encrypt(phe_pub_key, party.phe_random,
+    djcs_t_aux_encrypt(phe_pub_key, party.phe_random_pool.get(),
                        encrypted_root_impurity[0], encrypted_root_impurity[0]);
     for (int i = 0; i < party.party_num; i++) {
       if (i != party.party_id) {
@@ -173,7 +173,6 @@ double lime_reg_tree_root_impurity(
                                  ACTIVE_PARTY_ID);
   enc_root_impurity = encrypted_root_impurity[0];
 
-  djcs_t_free_public_key(phe_pub_key);
   delete[] enc_label_sum;
   delete[] dec_label_sum;
   delete[] encrypted_root_impurity;
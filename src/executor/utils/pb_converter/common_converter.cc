@@ -32,6 +32,8 @@ SOFTWARE.
 #include <falcon/utils/logger/logger.h>
 #include <google/protobuf/io/coded_stream.h>
 
+#include <algorithm>
+
 void serialize_int_array(std::vector<int> vec, std::string &output_message) {
   com::nus::dbsytem::falcon::v0::IntArray int_array;
   for (int i = 0; i < vec.size(); i++) {
@@ -158,38 +160,247 @@ void deserialize_encoded_number(EncodedNumber &number,
   mpz_clear(s_value);
 }
 
+// the version of BinaryEncodedNumberArray written by the serializers
+static const int BINARY_ENCODED_NUMBER_VERSION = 1;
+
+/**
+ * export the absolute value of a number as little-endian bytes
+ *
+ * @param bytes: the exported bytes
+ * @param v: the number
+ */
+static void export_mpz_bytes(std::string &bytes, mpz_srcptr v) {
+  bytes.assign((mpz_sizeinbase(v, 2) + 7) / 8, '\0');
+  if (mpz_sgn(v) != 0) {
+    mpz_export(&bytes[0], nullptr, -1, 1, 0, 0, v);
+  }
+}
+
+/**
+ * serialize the elements in the binary format
+ *
+ * @param elements: the elements, flattened by rows for a matrix
+ * @param size: the number of elements
+ * @param row_size: the number of rows of a matrix, 0 for an array
+ * @param omit_n: whether to omit n when the elements share it
+ * @param output_message: serialized string
+ */
+static void serialize_binary(const std::vector<EncodedNumber *> &elements,
+                             int size, int row_size, bool omit_n,
+                             std::string &output_message) {
+  com::nus::dbsytem::falcon::v0::BinaryEncodedNumberArray message;
+  message.set_version(BINARY_ENCODED_NUMBER_VERSION);
+  message.set_size(size);
+  message.set_row_size(row_size);
+  if (size == 0) {
+    message.SerializeToString(&output_message);
+    return;
+  }
+
+  // the exponent, type and n are stored once if they are uniform
+  mpz_t n0, t;
+  mpz_init(n0);
+  mpz_init(t);
+  elements[0]->getter_n(n0);
+  bool uniform_n = true, uniform_meta = true;
+  int value_bytes = 0;
+  for (int i = 0; i < size; i++) {
+    const EncodedNumber &number = *elements[i];
+    if (number.getter_exponent() != elements[0]->getter_exponent() ||
+        number.getter_type() != elements[0]->getter_type()) {
+      uniform_meta = false;
+    }
+    number.getter_n(t);
+    if (mpz_cmp(t, n0) != 0) {
+      uniform_n = false;
+    }
+    number.getter_value(t);
+    value_bytes = std::max(value_bytes, (int)(mpz_sizeinbase(t, 2) + 7) / 8);
+  }
+  if (uniform_meta) {
+    message.set_exponent(elements[0]->getter_exponent());
+    message.set_type(elements[0]->getter_type());
+  }
+  if (uniform_n && !omit_n) {
+    export_mpz_bytes(*message.mutable_n(), n0);
+  }
+
+  // the values at a fixed width, zero padded
+  message.set_value_bytes(value_bytes);
+  std::string *values = message.mutable_values();
+  values->assign((size_t)value_bytes * size, '\0');
+  for (int i = 0; i < size; i++) {
+    const EncodedNumber &number = *elements[i];
+    number.getter_value(t);
+    if (mpz_sgn(t) < 0) {
+      message.add_negative_indexes(i);
+    }
+    if (mpz_sgn(t) != 0) {
+      mpz_export(&(*values)[(size_t)value_bytes * i], nullptr, -1, 1, 0, 0,
+                 t);
+    }
+    if (!uniform_meta) {
+      message.add_element_exponent(number.getter_exponent());
+      message.add_element_type(number.getter_type());
+    }
+    if (!uniform_n) {
+      number.getter_n(t);
+      export_mpz_bytes(*message.add_element_n(), t);
+    }
+  }
+  mpz_clear(n0);
+  mpz_clear(t);
+  message.SerializeToString(&output_message);
+}
+
+/**
+ * deserialize the elements from the binary format
+ *
+ * @param elements: the elements, flattened by rows for a matrix
+ * @param size: the expected number of elements
+ * @param row_size: the expected number of rows of a matrix, 0 for an array
+ * @param input_message: serialized string
+ * @param n: the n of the elements if omitted by the sender
+ */
+static void deserialize_binary(const std::vector<EncodedNumber *> &elements,
+                               int size, int row_size,
+                               const std::string &input_message,
+                               mpz_srcptr n) {
+  com::nus::dbsytem::falcon::v0::BinaryEncodedNumberArray message;
+  if (!message.ParseFromString(input_message)) {
+    log_error("Deserialize binary encoded number array message failed.");
+    exit(EXIT_FAILURE);
+  }
+  if (message.version() != BINARY_ENCODED_NUMBER_VERSION) {
+    log_error("Unsupported binary encoded number array version " +
+              std::to_string(message.version()) + ".");
+    exit(EXIT_FAILURE);
+  }
+  if (message.size() != size || message.row_size() != row_size) {
+    log_error("Deserialized encoded number size is not expected.");
+    exit(EXIT_FAILURE);
+  }
+  if (size == 0) {
+    return;
+  }
+  bool uniform_meta = message.element_exponent_size() == 0;
+  bool uniform_n = message.element_n_size() == 0;
+  int value_bytes = message.value_bytes();
+  if ((size_t)value_bytes * size != message.values().size() ||
+      (!uniform_meta && (message.element_exponent_size() != size ||
+                         message.element_type_size() != size)) ||
+      (!uniform_n && message.element_n_size() != size)) {
+    log_error("The binary encoded number array message is malformed.");
+    exit(EXIT_FAILURE);
+  }
+  // the negative indexes are written in ascending order, so any index out
+  // of [0, size) or repeated would corrupt the elements
+  int prev_index = -1;
+  for (int i = 0; i < message.negative_indexes_size(); i++) {
+    int index = message.negative_indexes(i);
+    if (index <= prev_index || index >= size) {
+      log_error("The binary encoded number array message has an invalid "
+                "negative index " + std::to_string(index) + ".");
+      exit(EXIT_FAILURE);
+    }
+    prev_index = index;
+  }
+
+  mpz_t t;
+  mpz_init(t);
+  if (uniform_n) {
+    if (!message.n().empty()) {
+      mpz_import(t, message.n().size(), -1, 1, 0, 0, message.n().data());
+    } else if (n != nullptr) {
+      mpz_set(t, n);
+    } else {
+      log_error("The n of the encoded numbers is omitted and not given.");
+      exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < size; i++) {
+      elements[i]->setter_n(t);
+    }
+  }
+  const char *values = message.values().data();
+  for (int i = 0; i < size; i++) {
+    EncodedNumber &number = *elements[i];
+    mpz_import(t, value_bytes, -1, 1, 0, 0, values + (size_t)value_bytes * i);
+    number.setter_value(t);
+    if (uniform_meta) {
+      number.setter_exponent(message.exponent());
+      number.setter_type(static_cast<EncodedNumberType>(message.type()));
+    } else {
+      number.setter_exponent(message.element_exponent(i));
+      number.setter_type(
+          static_cast<EncodedNumberType>(message.element_type(i)));
+    }
+    if (!uniform_n) {
+      const std::string &element_n = message.element_n(i);
+      mpz_import(t, element_n.size(), -1, 1, 0, 0, element_n.data());
+      number.setter_n(t);
+    }
+  }
+  for (int i = 0; i < message.negative_indexes_size(); i++) {
+    EncodedNumber &number = *elements[message.negative_indexes(i)];
+    number.getter_value(t);
+    mpz_neg(t, t);
+    number.setter_value(t);
+  }
+  mpz_clear(t);
+}
+
+/**
+ * check whether a message is a legacy EncodedNumberArray or
+ * EncodedNumberMatrix, whose field 1 is a nested message (tag 0x0a), while
+ * the field 1 of BinaryEncodedNumberArray is the version varint (tag 0x08)
+ */
+static bool is_legacy_encoded_message(const std::string &input_message) {
+  return input_message.empty() || input_message[0] == 0x0a;
+}
+
+/**
+ * deserialize a legacy FixedPointEncodedNumber, with base-10 strings
+ */
+static void
+legacy_deserialize(EncodedNumber &number,
+                   const com::nus::dbsytem::falcon::v0::FixedPointEncodedNumber
+                       &encoded_number) {
+  mpz_t s_n, s_value;
+  mpz_init(s_n);
+  mpz_init(s_value);
+  mpz_set_str(s_n, encoded_number.n().c_str(), PHE_STR_BASE);
+  mpz_set_str(s_value, encoded_number.value().c_str(), PHE_STR_BASE);
+
+  number.setter_n(s_n);
+  number.setter_value(s_value);
+  number.setter_exponent(encoded_number.exponent());
+  number.setter_type(static_cast<EncodedNumberType>(encoded_number.type()));
+
+  mpz_clear(s_n);
+  mpz_clear(s_value);
+}
+
 void serialize_encoded_number_array(EncodedNumber *number_array, int size,
-                                    std::string &output_message) {
-  com::nus::dbsytem::falcon::v0::EncodedNumberArray encoded_number_array;
+                                    std::string &output_message,
+                                    bool omit_n) {
+  std::vector<EncodedNumber *> elements(size);
   for (int i = 0; i < size; i++) {
-    com::nus::dbsytem::falcon::v0::FixedPointEncodedNumber *encoded_number =
-        encoded_number_array.add_encoded_number();
-    mpz_t g_n, g_value;
-    mpz_init(g_n);
-    mpz_init(g_value);
-    number_array[i].getter_n(g_n);
-    number_array[i].getter_value(g_value);
-    char *n_str_c, *value_str_c;
-    n_str_c = mpz_get_str(NULL, PHE_STR_BASE, g_n);
-    value_str_c = mpz_get_str(NULL, PHE_STR_BASE, g_value);
-    std::string n_str(n_str_c), value_str(value_str_c);
-
-    encoded_number->set_n(n_str);
-    encoded_number->set_value(value_str);
-    encoded_number->set_exponent(number_array[i].getter_exponent());
-    encoded_number->set_type(number_array[i].getter_type());
-
-    mpz_clear(g_n);
-    mpz_clear(g_value);
-    free(n_str_c);
-    free(value_str_c);
-  }
-  encoded_number_array.SerializeToString(&output_message);
-  encoded_number_array.Clear();
+    elements[i] = &number_array[i];
+  }
+  serialize_binary(elements, size, 0, omit_n, output_message);
 }
 
 void deserialize_encoded_number_array(EncodedNumber *number_array, int size,
-                                      const std::string &input_message) {
+                                      const std::string &input_message,
+                                      mpz_srcptr n) {
+  if (!is_legacy_encoded_message(input_message)) {
+    std::vector<EncodedNumber *> elements(size);
+    for (int i = 0; i < size; i++) {
+      elements[i] = &number_array[i];
+    }
+    deserialize_binary(elements, size, 0, input_message, n);
+    return;
+  }
   com::nus::dbsytem::falcon::v0::EncodedNumberArray
       deserialized_encoded_number_array;
   google::protobuf::io::CodedInputStream inputStream(
@@ -204,66 +415,41 @@ void deserialize_encoded_number_array(EncodedNumber *number_array, int size,
     log_error("Deserialized encoded number size is not expected.");
     exit(EXIT_FAILURE);
   }
-  // number_array = new EncodedNumber[size];
   for (int i = 0; i < size; i++) {
-    const com::nus::dbsytem::falcon::v0::FixedPointEncodedNumber
-        &encoded_number = deserialized_encoded_number_array.encoded_number(i);
-    mpz_t s_n, s_value;
-    mpz_init(s_n);
-    mpz_init(s_value);
-    mpz_set_str(s_n, encoded_number.n().c_str(), PHE_STR_BASE);
-    mpz_set_str(s_value, encoded_number.value().c_str(), PHE_STR_BASE);
-
-    number_array[i].setter_n(s_n);
-    number_array[i].setter_value(s_value);
-    number_array[i].setter_exponent(encoded_number.exponent());
-    number_array[i].setter_type(
-        static_cast<EncodedNumberType>(encoded_number.type()));
-
-    mpz_clear(s_n);
-    mpz_clear(s_value);
+    legacy_deserialize(number_array[i],
+                       deserialized_encoded_number_array.encoded_number(i));
   }
 }
 
 void serialize_encoded_number_matrix(EncodedNumber **number_matrix,
                                      int row_size, int column_size,
-                                     std::string &output_message) {
-  com::nus::dbsytem::falcon::v0::EncodedNumberMatrix encoded_number_matrix;
+                                     std::string &output_message,
+                                     bool omit_n) {
+  std::vector<EncodedNumber *> elements(row_size * column_size);
   for (int i = 0; i < row_size; i++) {
-    com::nus::dbsytem::falcon::v0::EncodedNumberArray *encoded_number_array =
-        encoded_number_matrix.add_encoded_array();
     for (int j = 0; j < column_size; j++) {
-      com::nus::dbsytem::falcon::v0::FixedPointEncodedNumber *encoded_number =
-          encoded_number_array->add_encoded_number();
-      mpz_t g_n, g_value;
-      mpz_init(g_n);
-      mpz_init(g_value);
-      number_matrix[i][j].getter_n(g_n);
-      number_matrix[i][j].getter_value(g_value);
-      char *n_str_c, *value_str_c;
-      n_str_c = mpz_get_str(NULL, PHE_STR_BASE, g_n);
-      value_str_c = mpz_get_str(NULL, PHE_STR_BASE, g_value);
-      std::string n_str(n_str_c), value_str(value_str_c);
-
-      encoded_number->set_n(n_str);
-      encoded_number->set_value(value_str);
-      encoded_number->set_exponent(number_matrix[i][j].getter_exponent());
-      encoded_number->set_type(number_matrix[i][j].getter_type());
-
-      mpz_clear(g_n);
-      mpz_clear(g_value);
-      free(n_str_c);
-      free(value_str_c);
+      elements[i * column_size + j] = &number_matrix[i][j];
     }
   }
-
-  encoded_number_matrix.SerializeToString(&output_message);
-  encoded_number_matrix.Clear();
+  serialize_binary(elements, row_size * column_size, row_size, omit_n,
+                   output_message);
 }
 
 void deserialize_encoded_number_matrix(EncodedNumber **number_matrix,
                                        int row_size, int column_size,
-                                       const std::string &input_message) {
+                                       const std::string &input_message,
+                                       mpz_srcptr n) {
+  if (!is_legacy_encoded_message(input_message)) {
+    std::vector<EncodedNumber *> elements(row_size * column_size);
+    for (int i = 0; i < row_size; i++) {
+      for (int j = 0; j < column_size; j++) {
+        elements[i * column_size + j] = &number_matrix[i][j];
+      }
+    }
+    deserialize_binary(elements, row_size * column_size, row_size,
+                       input_message, n);
+    return;
+  }
   com::nus::dbsytem::falcon::v0::EncodedNumberMatrix
       deserialized_encoded_number_matrix;
   google::protobuf::io::CodedInputStream inputStream(
@@ -286,22 +472,8 @@ void deserialize_encoded_number_matrix(EncodedNumber **number_matrix,
         &encoded_number_array =
             deserialized_encoded_number_matrix.encoded_array(i);
     for (int j = 0; j < column_size; j++) {
-      const com::nus::dbsytem::falcon::v0::FixedPointEncodedNumber
-          &encoded_number = encoded_number_array.encoded_number(j);
-      mpz_t s_n, s_value;
-      mpz_init(s_n);
-      mpz_init(s_value);
-      mpz_set_str(s_n, encoded_number.n().c_str(), PHE_STR_BASE);
-      mpz_set_str(s_value, encoded_number.value().c_str(), PHE_STR_BASE);
-
-      number_matrix[i][j].setter_n(s_n);
-      number_matrix[i][j].setter_value(s_value);
-      number_matrix[i][j].setter_exponent(encoded_number.exponent());
-      number_matrix[i][j].setter_type(
-          static_cast<EncodedNumberType>(encoded_number.type()));
-
-      mpz_clear(s_n);
-      mpz_clear(s_value);
+      legacy_deserialize(number_matrix[i][j],
+                         encoded_number_array.encoded_number(j));
     }
   }
 }
@@ -0,0 +1,274 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+//
+// Created by root on 10/18/26.
+//
+
+#include <falcon/utils/logger/logger.h>
+#include <falcon/utils/thread_pool.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sched.h>
+#include <string>
+
+// how long a waiting caller sleeps before it looks for chunks of new loops
+static const std::chrono::microseconds WAIT_INTERVAL(200);
+
+// the number of chunks on the stack of the thread
+static thread_local int chunk_depth = 0;
+
+/** count a chunk on the stack of the thread while it runs */
+struct ChunkDepthGuard {
+  ChunkDepthGuard() { chunk_depth++; }
+  ~ChunkDepthGuard() { chunk_depth--; }
+};
+
+CryptoThreadPool::CryptoThreadPool(int thread_num) : stopped(false) {
+  for (int i = 1; i < thread_num; i++) {
+    workers.emplace_back(&CryptoThreadPool::work, this);
+  }
+}
+
+CryptoThreadPool::~CryptoThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(loops_mutex);
+    stopped = true;
+  }
+  loops_cv.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+bool CryptoThreadPool::claim(Loop *loop, int &chunk_begin, int &chunk_end) {
+  chunk_begin = loop->next.fetch_add(loop->grain);
+  if (chunk_begin >= loop->end) {
+    return false;
+  }
+  chunk_end = std::min(chunk_begin + loop->grain, loop->end);
+  return true;
+}
+
+void CryptoThreadPool::run(Loop *loop, int chunk_begin, int chunk_end) {
+  {
+    ChunkDepthGuard guard;
+    (*loop->body)(chunk_begin, chunk_end);
+  }
+  // notify under the mutex, the loop is released once pending reaches 0
+  std::lock_guard<std::mutex> lock(loop->done_mutex);
+  if (--loop->pending == 0) {
+    loop->done_cv.notify_all();
+  }
+}
+
+bool CryptoThreadPool::help() {
+  Loop *loop = nullptr;
+  int chunk_begin = 0, chunk_end = 0;
+  {
+    std::lock_guard<std::mutex> lock(loops_mutex);
+    for (auto *posted : loops) {
+      if (claim(posted, chunk_begin, chunk_end)) {
+        loop = posted;
+        break;
+      }
+    }
+  }
+  if (loop == nullptr) {
+    return false;
+  }
+  run(loop, chunk_begin, chunk_end);
+  return true;
+}
+
+void CryptoThreadPool::work() {
+  while (true) {
+    if (help()) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(loops_mutex);
+    // sleep until a loop with unclaimed chunks is posted
+    loops_cv.wait(lock, [this] {
+      if (stopped) {
+        return true;
+      }
+      for (auto *posted : loops) {
+        if (posted->next.load() < posted->end) {
+          return true;
+        }
+      }
+      return false;
+    });
+    if (stopped) {
+      return;
+    }
+  }
+}
+
+void CryptoThreadPool::parallel_for(int begin, int end, int grain,
+                                    const std::function<void(int, int)> &body) {
+  if (begin >= end) {
+    return;
+  }
+  int size = end - begin;
+  int thread_num = getter_thread_num();
+  if (grain <= 0) {
+    grain = std::max(1, size / (4 * thread_num));
+  }
+  int chunk_num = (size + grain - 1) / grain;
+  if (thread_num == 1 || chunk_num == 1) {
+    // the same chunks as in parallel, callers may depend on the boundaries
+    for (int chunk_begin = begin; chunk_begin < end; chunk_begin += grain) {
+      ChunkDepthGuard guard;
+      body(chunk_begin, std::min(chunk_begin + grain, end));
+    }
+    return;
+  }
+
+  Loop loop;
+  loop.body = &body;
+  loop.begin = begin;
+  loop.end = end;
+  loop.grain = grain;
+  loop.next.store(begin);
+  loop.pending = chunk_num;
+  {
+    std::lock_guard<std::mutex> lock(loops_mutex);
+    loops.push_back(&loop);
+  }
+  loops_cv.notify_all();
+
+  // run the chunks of this loop first
+  int chunk_begin = 0, chunk_end = 0;
+  while (true) {
+    bool claimed;
+    {
+      std::lock_guard<std::mutex> lock(loops_mutex);
+      claimed = claim(&loop, chunk_begin, chunk_end);
+      if (!claimed) {
+        loops.erase(std::find(loops.begin(), loops.end(), &loop));
+      }
+    }
+    if (!claimed) {
+      break;
+    }
+    run(&loop, chunk_begin, chunk_end);
+  }
+
+  // the rest are claimed by other threads, help the other loops meanwhile
+  // instead of blocking, the claimed chunks may wait for them (nesting)
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(loop.done_mutex);
+      if (loop.pending == 0) {
+        return;
+      }
+    }
+    if (!help()) {
+      std::unique_lock<std::mutex> lock(loop.done_mutex);
+      loop.done_cv.wait_for(lock, WAIT_INTERVAL,
+                            [&loop] { return loop.pending == 0; });
+    }
+  }
+}
+
+int crypto_parallel_depth() { return chunk_depth; }
+
+/**
+ * read the cgroup cpu quota of the process
+ *
+ * @return the quota in cpus rounded up, or 0 if there is no quota
+ */
+static int cgroup_cpu_quota() {
+  long long quota = -1, period = 0;
+  // cgroup v2: "<quota|max> <period>"
+  std::ifstream cpu_max("/sys/fs/cgroup/cpu.max");
+  if (cpu_max.is_open()) {
+    std::string quota_str;
+    cpu_max >> quota_str >> period;
+    if (!quota_str.empty() && quota_str != "max") {
+      quota = std::stoll(quota_str);
+    }
+  } else {
+    // cgroup v1
+    std::ifstream quota_file("/sys/fs/cgroup/cpu/cpu.cfs_quota_us");
+    std::ifstream period_file("/sys/fs/cgroup/cpu/cpu.cfs_period_us");
+    if (quota_file.is_open() && period_file.is_open()) {
+      quota_file >> quota;
+      period_file >> period;
+    }
+  }
+  if (quota <= 0 || period <= 0) {
+    return 0;
+  }
+  return (int)((quota + period - 1) / period);
+}
+
+int available_cpu_num() {
+  int cpu_num = (int)std::thread::hardware_concurrency();
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0) {
+    cpu_num = CPU_COUNT(&cpu_set);
+  }
+  int quota = cgroup_cpu_quota();
+  if (quota > 0 && (cpu_num <= 0 || quota < cpu_num)) {
+    cpu_num = quota;
+  }
+  return std::max(1, cpu_num);
+}
+
+static std::mutex pool_mutex;
+static std::unique_ptr<CryptoThreadPool> crypto_pool;
+// the number of live uses of the pool, which must not be replaced meanwhile
+static int pool_use_num = 0;
+
+void crypto_thread_pool_init(int thread_num) {
+  if (thread_num <= 0) {
+    thread_num = available_cpu_num();
+  }
+  std::lock_guard<std::mutex> lock(pool_mutex);
+  if (pool_use_num > 0) {
+    log_error("[crypto_thread_pool_init] The crypto thread pool is in use.");
+    exit(EXIT_FAILURE);
+  }
+  crypto_pool.reset(new CryptoThreadPool(thread_num));
+}
+
+CryptoThreadPoolUse::CryptoThreadPoolUse() {
+  std::lock_guard<std::mutex> lock(pool_mutex);
+  if (crypto_pool == nullptr) {
+    crypto_pool.reset(new CryptoThreadPool(available_cpu_num()));
+  }
+  pool_use_num++;
+  pool = crypto_pool.get();
+}
+
+CryptoThreadPoolUse::~CryptoThreadPoolUse() {
+  std::lock_guard<std::mutex> lock(pool_mutex);
+  pool_use_num--;
+}
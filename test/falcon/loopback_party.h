@@ -0,0 +1,191 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//
+// Created by root on 10/18/26.
+//
+
+#ifndef FALCON_TEST_FALCON_LOOPBACK_PARTY_H_
+#define FALCON_TEST_FALCON_LOOPBACK_PARTY_H_
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "falcon/network/Comm.hpp"
+#include "falcon/network/async_channel.h"
+#include "falcon/operator/phe/djcs_t_aux.h"
+#include "falcon/operator/phe/phe_key_context.h"
+#include "falcon/operator/phe/share_combine.h"
+#include "falcon/party/party.h"
+
+// one direction of an in-memory connection
+struct BytePipe {
+  std::mutex m;
+  std::condition_variable cv;
+  std::deque<byte> bytes;
+  // set when either end shuts the connection down
+  bool closed = false;
+};
+
+// a CommParty over two in-memory pipes, in place of a tcp connection
+class PipeCommParty : public CommParty {
+public:
+  PipeCommParty(std::shared_ptr<BytePipe> in, std::shared_ptr<BytePipe> out)
+      : in(std::move(in)), out(std::move(out)) {}
+
+  int join(int sleep_between_attempts, int timeout, bool first) override {
+    return 0;
+  }
+
+  size_t write(const byte *data, int size, int peer, int protocol) override {
+    std::lock_guard<std::mutex> lock(out->m);
+    if (out->closed) {
+      throw std::runtime_error("The pipe is closed.");
+    }
+    out->bytes.insert(out->bytes.end(), data, data + size);
+    out->cv.notify_all();
+    return size;
+  }
+
+  size_t read(byte *buffer, int size, int peer, int protocol) override {
+    std::unique_lock<std::mutex> lock(in->m);
+    in->cv.wait(lock, [this, size] {
+      return in->closed || (int)in->bytes.size() >= size;
+    });
+    if ((int)in->bytes.size() < size) {
+      throw std::runtime_error("The pipe is closed.");
+    }
+    std::copy(in->bytes.begin(), in->bytes.begin() + size, buffer);
+    in->bytes.erase(in->bytes.begin(), in->bytes.begin() + size);
+    return size;
+  }
+
+  void shutdown() override {
+    for (BytePipe *pipe : {in.get(), out.get()}) {
+      std::lock_guard<std::mutex> lock(pipe->m);
+      pipe->closed = true;
+      pipe->cv.notify_all();
+    }
+  }
+
+private:
+  std::shared_ptr<BytePipe> in;
+  std::shared_ptr<BytePipe> out;
+};
+
+/**
+ * the parties of a loopback network, fully connected by in-memory pipes and
+ * sharing a threshold phe key, party 0 is the active party
+ */
+class LoopbackParties {
+public:
+  /**
+   * generate the phe key and connect the parties
+   *
+   * @param party_num: the number of parties
+   * @param key_size: the phe key size
+   */
+  explicit LoopbackParties(int party_num, int key_size = 512)
+      : parties(party_num) {
+    hcs_random *hr = hcs_init_random();
+    pub_key = djcs_t_init_public_key();
+    djcs_t_private_key *vk = djcs_t_init_private_key();
+    djcs_t_generate_key_pair(pub_key, vk, hr, 1, key_size, party_num,
+                             party_num);
+    mpz_t *coeff = djcs_t_init_polynomial(vk, hr);
+    std::vector<int> party_ids;
+    for (int i = 0; i < party_num; i++) {
+      party_ids.push_back(i);
+    }
+    // pipes[i][j] carries the bytes from party i to party j
+    std::vector<std::vector<std::shared_ptr<BytePipe>>> pipes(party_num);
+    for (int i = 0; i < party_num; i++) {
+      for (int j = 0; j < party_num; j++) {
+        pipes[i].push_back(std::make_shared<BytePipe>());
+      }
+    }
+    for (int i = 0; i < party_num; i++) {
+      Party &party = parties[i];
+      party.party_id = i;
+      party.party_num = party_num;
+      party.party_type =
+          (i == 0) ? falcon::ACTIVE_PARTY : falcon::PASSIVE_PARTY;
+      mpz_t si;
+      mpz_init(si);
+      djcs_t_compute_polynomial(vk, coeff, si, i);
+      djcs_t_auth_server *au = djcs_t_init_auth_server();
+      djcs_t_set_auth_server(au, si, i);
+      party.phe_key_context = std::make_shared<PheKeyContext>(pub_key, au);
+      party.phe_share_combiner = std::make_shared<ShareCombineContext>(
+          party.phe_key_context, party_ids);
+      djcs_t_free_auth_server(au);
+      mpz_clear(si);
+      party.async_channels.resize(party_num);
+      for (int j = 0; j < party_num; j++) {
+        if (j != i) {
+          party.async_channels[j] = std::make_shared<AsyncChannel>(
+              std::make_shared<PipeCommParty>(pipes[j][i], pipes[i][j]),
+              1 << 20);
+        }
+      }
+    }
+    djcs_t_free_polynomial(vk, coeff);
+    djcs_t_free_private_key(vk);
+    hcs_free_random(hr);
+  }
+
+  ~LoopbackParties() { djcs_t_free_public_key(pub_key); }
+
+  LoopbackParties(const LoopbackParties &) = delete;
+  LoopbackParties &operator=(const LoopbackParties &) = delete;
+
+  /**
+   * run the same protocol on all the parties, each in its own thread
+   *
+   * @param protocol: the protocol of a party
+   */
+  void run(const std::function<void(const Party &)> &protocol) {
+    std::vector<std::thread> threads;
+    for (const Party &party : parties) {
+      threads.emplace_back([&protocol, &party] { protocol(party); });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+
+  std::vector<Party> parties;
+  // the shared public key, e.g., to encrypt the inputs
+  djcs_t_public_key *pub_key;
+};
+
+#endif // FALCON_TEST_FALCON_LOOPBACK_PARTY_H_
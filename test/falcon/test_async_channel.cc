@@ -0,0 +1,104 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//
+// Created by root on 10/18/26.
+//
+
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "falcon/network/async_channel.h"
+#include "loopback_party.h"
+#include <gtest/gtest.h>
+
+using namespace std;
+
+TEST(AsyncChannel, TaggedMessages) {
+  auto a_to_b = make_shared<BytePipe>();
+  auto b_to_a = make_shared<BytePipe>();
+  AsyncChannel a(make_shared<PipeCommParty>(b_to_a, a_to_b), 1 << 10);
+  AsyncChannel b(make_shared<PipeCommParty>(a_to_b, b_to_a), 1 << 10);
+
+  // the messages of a tag keep their order, the tags are received in any
+  // order, and the queue limit does not block the messages larger than it
+  MessageTag tag_x(1, 0, 0), tag_y(1, 0, 1);
+  a.send(tag_x, "x0");
+  a.send(tag_y, "y0");
+  a.send(tag_x, string(4096, 'x'));
+  future<void> written = a.send(MessageTag(), "");
+  future<string> y0 = b.recv(tag_y);
+  EXPECT_EQ(y0.get(), "y0");
+  EXPECT_EQ(b.recv(tag_x).get(), "x0");
+  EXPECT_EQ(b.recv(tag_x).get(), string(4096, 'x'));
+  EXPECT_EQ(b.recv(MessageTag()).get(), "");
+  written.get();
+
+  // both directions at once
+  future<string> from_b = a.recv(tag_x);
+  b.send(tag_x, "from b");
+  EXPECT_EQ(from_b.get(), "from b");
+}
+
+// a CommParty whose writes fail, as a broken connection
+class FailingCommParty : public PipeCommParty {
+public:
+  using PipeCommParty::PipeCommParty;
+
+  size_t write(const byte *data, int size, int peer, int protocol) override {
+    throw runtime_error("broken pipe");
+  }
+};
+
+TEST(AsyncChannel, FailedWrite) {
+  auto a_to_b = make_shared<BytePipe>();
+  auto b_to_a = make_shared<BytePipe>();
+  AsyncChannel a(make_shared<FailingCommParty>(b_to_a, a_to_b), 1 << 10);
+
+  // the failure is reported by the future of the message, and the later
+  // messages are still attempted
+  future<void> first = a.send(MessageTag(), string(4096, 'x'));
+  future<void> second = a.send(MessageTag(), "y");
+  EXPECT_THROW(first.get(), runtime_error);
+  EXPECT_THROW(second.get(), runtime_error);
+}
+
+TEST(AsyncChannel, ShutdownOnDestruction) {
+  auto a_to_b = make_shared<BytePipe>();
+  auto b_to_a = make_shared<BytePipe>();
+  AsyncChannel b(make_shared<PipeCommParty>(a_to_b, b_to_a), 1 << 10);
+
+  // the destroyed channel flushes its messages and joins its receiving
+  // thread, and its peer fails the receives that can no longer arrive
+  future<string> never_sent;
+  {
+    AsyncChannel a(make_shared<PipeCommParty>(b_to_a, a_to_b), 1 << 10);
+    a.send(MessageTag(), "last");
+    never_sent = b.recv(MessageTag(1, 0, 0));
+  }
+  EXPECT_EQ(b.recv(MessageTag()).get(), "last");
+  EXPECT_THROW(never_sent.get(), runtime_error);
+}
@@ -158,3 +158,131 @@ TEST(PHE, DJCS_BENCH) {
     free(au);
   }
 }
+
+double bench_elapsed(const struct timespec &start,
+                     const struct timespec &finish) {
+  auto consumed_time = (double)(finish.tv_sec - start.tv_sec);
+  consumed_time += (double)(finish.tv_nsec - start.tv_nsec) / 1000000000.0;
+  return consumed_time;
+}
+
+TEST(PHE, DJCS_SIGNED_BENCH) {
+  // benchmark the lr gradient computation, i.e., the inner products between
+  // the encrypted batch losses and the plaintext { -lr_batch * x_ij } of each
+  // feature, with the plaintexts encoded mod n or as negative integers
+  int key_size = 1024;
+  int batch_size = 128;
+  int feature_num = 4;
+  int client_num = 3;
+  double lr_batch = 0.1 / batch_size;
+  std::default_random_engine re(0);
+  std::uniform_real_distribution<double> unif(-1.0, 1.0);
+
+  hcs_random *hr = hcs_init_random();
+  djcs_t_public_key *pk = djcs_t_init_public_key();
+  djcs_t_private_key *vk = djcs_t_init_private_key();
+  auto **au =
+      (djcs_t_auth_server **)malloc(client_num * sizeof(djcs_t_auth_server *));
+  auto *si = (mpz_t *)malloc(client_num * sizeof(mpz_t));
+  djcs_t_generate_key_pair(pk, vk, hr, 1, key_size, client_num, client_num);
+  mpz_t *coeff = djcs_t_init_polynomial(vk, hr);
+  for (int i = 0; i < client_num; i++) {
+    mpz_init(si[i]);
+    djcs_t_compute_polynomial(vk, coeff, si[i], i);
+    au[i] = djcs_t_init_auth_server();
+    djcs_t_set_auth_server(au[i], si[i], i);
+  }
+
+  auto *encrypted_losses = new EncodedNumber[batch_size];
+  auto **features = new EncodedNumber *[feature_num];
+  auto **mod_n_features = new EncodedNumber *[feature_num];
+  std::vector<double> losses, expected(feature_num, 0.0);
+  for (int i = 0; i < batch_size; i++) {
+    losses.push_back(unif(re));
+    EncodedNumber plain;
+    plain.set_double(pk->n[0], losses[i], PHE_FIXED_POINT_PRECISION);
+    djcs_t_aux_encrypt(pk, hr, encrypted_losses[i], plain);
+  }
+  mpz_t v;
+  mpz_init(v);
+  for (int j = 0; j < feature_num; j++) {
+    features[j] = new EncodedNumber[batch_size];
+    mod_n_features[j] = new EncodedNumber[batch_size];
+    for (int i = 0; i < batch_size; i++) {
+      double x = unif(re);
+      expected[j] += losses[i] * (0 - lr_batch * x);
+      features[j][i].set_double(pk->n[0], 0 - lr_batch * x,
+                                PHE_FIXED_POINT_PRECISION);
+      mod_n_features[j][i] = features[j][i];
+      features[j][i].getter_value(v);
+      mpz_mod(v, v, pk->n[0]);
+      mod_n_features[j][i].setter_value(v);
+    }
+  }
+  mpz_clear(v);
+
+  // run each variant and decrypt the gradients, the first two are the
+  // per-term ep_mul loops, the last two are the multi-exponentiation
+  std::vector<std::string> names{"ep_mul loop (mod n plains)",
+                                 "ep_mul loop (negative plains)",
+                                 "inner_product (negative plains)",
+                                 "signed_inner_product (mod n plains)"};
+  auto *gradients = new EncodedNumber[feature_num];
+  auto *partial_decryption = new EncodedNumber[client_num];
+  for (int variant = 0; variant < 4; variant++) {
+    struct timespec start_time {}, finish_time {};
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    for (int j = 0; j < feature_num; j++) {
+      if (variant < 2) {
+        EncodedNumber *plains =
+            (variant == 0) ? mod_n_features[j] : features[j];
+        djcs_t_aux_ep_mul(pk, gradients[j], encrypted_losses[0], plains[0]);
+        for (int i = 1; i < batch_size; i++) {
+          EncodedNumber term;
+          djcs_t_aux_ep_mul(pk, term, encrypted_losses[i], plains[i]);
+          djcs_t_aux_ee_add(pk, gradients[j], gradients[j], term);
+        }
+      } else if (variant == 2) {
+        djcs_t_aux_inner_product(pk, hr, gradients[j], encrypted_losses,
+                                 features[j], batch_size);
+      } else {
+        djcs_t_aux_signed_inner_product(pk, gradients[j], encrypted_losses,
+                                        mod_n_features[j], batch_size);
+      }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &finish_time);
+    std::cout << "The lr gradient time of " << names[variant] << " is "
+              << bench_elapsed(start_time, finish_time) << std::endl;
+    for (int j = 0; j < feature_num; j++) {
+      EncodedNumber decrypted;
+      for (int k = 0; k < client_num; k++) {
+        djcs_t_aux_partial_decrypt(pk, au[k], partial_decryption[k],
+                                   gradients[j]);
+      }
+      djcs_t_aux_share_combine(pk, decrypted, partial_decryption, client_num);
+      double decoded;
+      decrypted.decode(decoded);
+      EXPECT_NEAR(expected[j], decoded, 1e-3);
+    }
+  }
+
+  delete[] gradients;
+  delete[] partial_decryption;
+  delete[] encrypted_losses;
+  for (int j = 0; j < feature_num; j++) {
+    delete[] features[j];
+    delete[] mod_n_features[j];
+  }
+  delete[] features;
+  delete[] mod_n_features;
+  hcs_free_random(hr);
+  djcs_t_free_public_key(pk);
+  djcs_t_free_private_key(vk);
+  for (int i = 0; i < client_num; i++) {
+    mpz_clear(si[i]);
+    djcs_t_free_auth_server(au[i]);
+  }
+  djcs_t_free_polynomial(vk, coeff);
+  free(si);
+  free(au);
+}
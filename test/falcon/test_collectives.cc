@@ -0,0 +1,412 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//
+// Created by root on 10/18/26.
+//
+
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "falcon/operator/conversion/op_conv.h"
+#include "falcon/party/collectives.h"
+#include "falcon/party/encoded_number_stream.h"
+#include "loopback_party.h"
+#include <gtest/gtest.h>
+
+using namespace std;
+
+// compare the value, n, exponent and type of two encoded numbers
+static void expect_same_number(const EncodedNumber &expected,
+                               const EncodedNumber &actual) {
+  mpz_t a, b;
+  mpz_init(a);
+  mpz_init(b);
+  expected.getter_value(a);
+  actual.getter_value(b);
+  EXPECT_EQ(0, mpz_cmp(a, b));
+  expected.getter_n(a);
+  actual.getter_n(b);
+  EXPECT_EQ(0, mpz_cmp(a, b));
+  EXPECT_EQ(expected.getter_exponent(), actual.getter_exponent());
+  EXPECT_EQ(expected.getter_type(), actual.getter_type());
+  mpz_clear(a);
+  mpz_clear(b);
+}
+
+// encrypt value(i) into numbers[begin, end)
+static void encrypt_numbers(const djcs_t_public_key *pub_key,
+                            EncodedNumber *numbers, int begin, int end,
+                            const function<double(int)> &value) {
+  hcs_random *hr = hcs_init_random();
+  for (int i = begin; i < end; i++) {
+    EncodedNumber plain;
+    plain.set_double(pub_key->n[0], value(i));
+    djcs_t_aux_encrypt(pub_key, hr, numbers[i], plain);
+  }
+  hcs_free_random(hr);
+}
+
+// the homomorphic sum of the arrays of all the parties
+static vector<EncodedNumber>
+sum_numbers(const djcs_t_public_key *pub_key,
+            vector<vector<EncodedNumber>> &arrays) {
+  vector<EncodedNumber> sum = arrays[0];
+  for (int id = 1; id < (int)arrays.size(); id++) {
+    for (int i = 0; i < (int)sum.size(); i++) {
+      djcs_t_aux_ee_add(pub_key, sum[i], sum[i], arrays[id][i]);
+    }
+  }
+  return sum;
+}
+
+TEST(Collectives, EncodedNumberStream) {
+  // each party streams ciphertexts to the next party while receiving from
+  // the previous one, the chunks are encrypted as they are sent and the
+  // receiver consumes them in chunks of another size
+  int party_num = 3, size = 1000, send_chunk = 64, recv_chunk = 100;
+  LoopbackParties loopback(party_num);
+  vector<vector<EncodedNumber>> sent(party_num, vector<EncodedNumber>(size));
+  vector<vector<EncodedNumber>> received(party_num,
+                                         vector<EncodedNumber>(size));
+  vector<vector<pair<int, int>>> consumed(party_num);
+  loopback.run([&](const Party &party) {
+    int next = (party.party_id + 1) % party_num;
+    int prev = (party.party_id + party_num - 1) % party_num;
+    vector<EncodedNumber> &numbers = sent[party.party_id];
+    thread sender([&] {
+      hcs_random *hr = hcs_init_random();
+      send_encoded_number_stream(
+          party, next, numbers.data(), size,
+          [&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+              EncodedNumber plain;
+              plain.set_double(loopback.pub_key->n[0],
+                               (i - size / 2) * 0.25 + party.party_id);
+              djcs_t_aux_encrypt(loopback.pub_key, hr, numbers[i], plain);
+            }
+          },
+          send_chunk);
+      hcs_free_random(hr);
+    });
+    recv_encoded_number_stream(
+        party, prev, received[party.party_id].data(), size,
+        [&](int begin, int end) {
+          consumed[party.party_id].emplace_back(begin, end);
+        },
+        recv_chunk);
+    sender.join();
+  });
+  for (int id = 0; id < party_num; id++) {
+    int prev = (id + party_num - 1) % party_num;
+    for (int i = 0; i < size; i++) {
+      expect_same_number(sent[prev][i], received[id][i]);
+    }
+    // the consumed chunks cover the array in order
+    ASSERT_EQ((int)consumed[id].size(), size / recv_chunk);
+    for (int c = 0; c < (int)consumed[id].size(); c++) {
+      EXPECT_EQ(consumed[id][c].first, c * recv_chunk);
+      EXPECT_EQ(consumed[id][c].second, (c + 1) * recv_chunk);
+    }
+  }
+}
+
+TEST(Collectives, EncodedNumberStreamIncrementalWrites) {
+  // negative plaintexts written at ends that are not chunk boundaries, and
+  // an empty stream
+  int size = 300, chunk_size = 64;
+  LoopbackParties loopback(2);
+  vector<EncodedNumber> sent(size), received(size);
+  for (int i = 0; i < size; i++) {
+    sent[i].set_integer(loopback.pub_key->n[0], i % 7 == 0 ? -i : i);
+  }
+  loopback.run([&](const Party &party) {
+    if (party.party_id == 0) {
+      EncodedNumberStreamWriter writer(party, 1, size, chunk_size);
+      for (int end : {10, 70, 200, 200, size}) {
+        writer.write(sent.data(), end);
+      }
+      writer.finish();
+      EncodedNumberStreamWriter empty_writer(party, 1, 0, chunk_size);
+      empty_writer.finish();
+    } else {
+      EncodedNumberStreamReader reader(party, 0, received.data(), size);
+      reader.wait(chunk_size);
+      for (int i = 0; i < chunk_size; i++) {
+        expect_same_number(sent[i], received[i]);
+      }
+      reader.finish();
+      EncodedNumberStreamReader empty_reader(party, 0, nullptr, 0);
+      empty_reader.finish();
+    }
+  });
+  for (int i = 0; i < size; i++) {
+    expect_same_number(sent[i], received[i]);
+  }
+}
+
+TEST(Collectives, Messages) {
+  for (int party_num : {2, 3, 5}) {
+    LoopbackParties loopback(party_num);
+    int root = party_num - 1;
+    string large(1 << 16, 'l');
+    loopback.run([&](const Party &party) {
+      int id = party.party_id;
+      string message = (id == root) ? large : "";
+      broadcast_message(party, root, message);
+      EXPECT_EQ(message, large);
+
+      vector<string> gathered =
+          gather_messages(party, root, "from " + to_string(id));
+      if (id == root) {
+        ASSERT_EQ((int)gathered.size(), party_num);
+        for (int k = 0; k < party_num; k++) {
+          EXPECT_EQ(gathered[k], "from " + to_string(k));
+        }
+      }
+
+      vector<string> scattered;
+      if (id == root) {
+        for (int k = 0; k < party_num; k++) {
+          scattered.push_back("to " + to_string(k));
+        }
+      }
+      EXPECT_EQ(scatter_messages(party, root, scattered),
+                "to " + to_string(id));
+
+      // two all-gathers of different tags at once, started in opposite
+      // orders by the even and the odd parties
+      MessageTag tag_x(1, 0, 0), tag_y(1, 0, 1);
+      vector<string> all_x, all_y;
+      function<void()> gather_x = [&] {
+        all_x = all_gather_messages(party, "x" + to_string(id), tag_x);
+      };
+      function<void()> gather_y = [&] {
+        all_y = all_gather_messages(party, "y" + to_string(id), tag_y);
+      };
+      thread other(id % 2 == 0 ? gather_y : gather_x);
+      if (id % 2 == 0) {
+        gather_x();
+      } else {
+        gather_y();
+      }
+      other.join();
+      ASSERT_EQ((int)all_x.size(), party_num);
+      ASSERT_EQ((int)all_y.size(), party_num);
+      for (int k = 0; k < party_num; k++) {
+        EXPECT_EQ(all_x[k], "x" + to_string(k));
+        EXPECT_EQ(all_y[k], "y" + to_string(k));
+      }
+    });
+  }
+}
+
+TEST(Collectives, EncodedNumbers) {
+  // the arrays span several chunks, with a partial last one
+  int size = 2 * PHE_STREAM_CHUNK_SIZE + 17;
+  for (int party_num : {2, 3, 5}) {
+    LoopbackParties loopback(party_num);
+    const djcs_t_public_key *pub_key = loopback.pub_key;
+    int root = 1;
+    vector<vector<EncodedNumber>> local(party_num,
+                                        vector<EncodedNumber>(size));
+    vector<vector<EncodedNumber>> broadcast(party_num,
+                                            vector<EncodedNumber>(size));
+    vector<vector<EncodedNumber>> gathered(party_num,
+                                           vector<EncodedNumber>(size));
+    vector<vector<EncodedNumber>> combined(party_num,
+                                           vector<EncodedNumber>(size));
+    loopback.run([&](const Party &party) {
+      int id = party.party_id;
+      // the root encrypts the broadcast array chunk by chunk
+      broadcast_encoded_numbers(party, root, broadcast[id].data(), size,
+                                [&](int begin, int end) {
+                                  encrypt_numbers(pub_key,
+                                                  broadcast[id].data(), begin,
+                                                  end, [](int i) { return i; });
+                                });
+
+      // each party encrypts its array as it is gathered
+      vector<EncodedNumber *> gathered_arrays(party_num);
+      for (int k = 0; k < party_num; k++) {
+        gathered_arrays[k] = gathered[k].data();
+      }
+      gather_encoded_numbers(
+          party, root, local[id].data(), gathered_arrays.data(), size,
+          [&](int begin, int end) {
+            encrypt_numbers(pub_key, local[id].data(), begin, end,
+                            [id](int i) { return i * 0.5 - id; });
+          });
+
+      // the root adds the arrays and sends the sum to all the parties
+      combine_encoded_numbers(
+          party, root, local[id].data(), combined[id].data(), size,
+          [&](EncodedNumber **arrays, int begin, int end) {
+            for (int i = begin; i < end; i++) {
+              combined[id][i] = arrays[0][i];
+              for (int k = 1; k < party_num; k++) {
+                djcs_t_aux_ee_add(pub_key, combined[id][i], combined[id][i],
+                                  arrays[k][i]);
+              }
+            }
+          },
+          true);
+    });
+    vector<EncodedNumber> sum = sum_numbers(pub_key, local);
+    for (int id = 0; id < party_num; id++) {
+      for (int i = 0; i < size; i++) {
+        expect_same_number(broadcast[root][i], broadcast[id][i]);
+        expect_same_number(local[id][i], gathered[id][i]);
+        expect_same_number(sum[i], combined[id][i]);
+      }
+    }
+  }
+}
+
+TEST(Collectives, ReduceTopologies) {
+  int size = 2 * PHE_STREAM_CHUNK_SIZE + 17;
+  for (auto topology : {falcon::STAR_TOPOLOGY, falcon::TREE_TOPOLOGY,
+                        falcon::RING_TOPOLOGY}) {
+    reduce_topology_init(topology);
+    for (int party_num : {2, 3, 5}) {
+      LoopbackParties loopback(party_num);
+      const djcs_t_public_key *pub_key = loopback.pub_key;
+      vector<vector<EncodedNumber>> ciphers(party_num,
+                                            vector<EncodedNumber>(size));
+      for (int id = 0; id < party_num; id++) {
+        encrypt_numbers(pub_key, ciphers[id].data(), 0, size,
+                        [id](int i) { return i + id; });
+      }
+      vector<EncodedNumber> sum = sum_numbers(pub_key, ciphers);
+      for (bool to_all : {false, true}) {
+        int root = to_all ? 0 : party_num - 1;
+        vector<vector<EncodedNumber>> result(party_num,
+                                             vector<EncodedNumber>(size));
+        loopback.run([&](const Party &party) {
+          int id = party.party_id;
+          reduce_encoded_numbers(party, root, ciphers[id].data(),
+                                 result[id].data(), size, to_all);
+        });
+        for (int id = 0; id < party_num; id++) {
+          if (to_all || id == root) {
+            for (int i = 0; i < size; i++) {
+              expect_same_number(sum[i], result[id][i]);
+            }
+          }
+        }
+      }
+    }
+  }
+  reduce_topology_init(falcon::STAR_TOPOLOGY);
+}
+
+TEST(Collectives, ShardedCombine) {
+  // the sharded combination gives the same arrays as the star one, also
+  // with empty shards when size < party_num
+  for (int party_num : {2, 3, 5}) {
+    LoopbackParties loopback(party_num);
+    const djcs_t_public_key *pub_key = loopback.pub_key;
+    for (int size : {3, 2 * PHE_STREAM_CHUNK_SIZE + 17}) {
+      vector<vector<EncodedNumber>> ciphers(party_num,
+                                            vector<EncodedNumber>(size));
+      for (int id = 0; id < party_num; id++) {
+        encrypt_numbers(pub_key, ciphers[id].data(), 0, size,
+                        [id](int i) { return i * 0.25 - id; });
+      }
+      vector<vector<EncodedNumber>> star(party_num,
+                                         vector<EncodedNumber>(size));
+      vector<vector<EncodedNumber>> sharded(party_num,
+                                            vector<EncodedNumber>(size));
+      loopback.run([&](const Party &party) {
+        int id = party.party_id;
+        combine_encoded_numbers(
+            party, 0, ciphers[id].data(), star[id].data(), size,
+            [&](EncodedNumber **arrays, int begin, int end) {
+              for (int i = begin; i < end; i++) {
+                star[id][i] = arrays[0][i];
+                for (int k = 1; k < party_num; k++) {
+                  djcs_t_aux_ee_add(pub_key, star[id][i], star[id][i],
+                                    arrays[k][i]);
+                }
+              }
+            },
+            true);
+        shard_combine_encoded_numbers(
+            party, ciphers[id].data(), sharded[id].data(), size,
+            [&](EncodedNumber **arrays, EncodedNumber *dest, int n) {
+              for (int i = 0; i < n; i++) {
+                dest[i] = arrays[0][i];
+                for (int k = 1; k < party_num; k++) {
+                  djcs_t_aux_ee_add(pub_key, dest[i], dest[i], arrays[k][i]);
+                }
+              }
+            });
+      });
+      for (int id = 0; id < party_num; id++) {
+        for (int i = 0; i < size; i++) {
+          expect_same_number(star[0][i], star[id][i]);
+          expect_same_number(star[0][i], sharded[id][i]);
+        }
+      }
+    }
+  }
+}
+
+TEST(Collectives, ShardedDecrypt) {
+  // --sharded-decrypt decrypts to the same plaintexts as the star
+  // combination at the request party
+  int size = PHE_STREAM_CHUNK_SIZE + 17;
+  for (int party_num : {2, 3, 5}) {
+    LoopbackParties loopback(party_num);
+    vector<EncodedNumber> ciphers(size);
+    encrypt_numbers(loopback.pub_key, ciphers.data(), 0, size,
+                    [](int i) { return i * 0.5 - 100; });
+    vector<vector<EncodedNumber>> star(party_num,
+                                       vector<EncodedNumber>(size));
+    vector<vector<EncodedNumber>> sharded(party_num,
+                                          vector<EncodedNumber>(size));
+    for (bool sharded_mode : {false, true}) {
+      sharded_decrypt_init(sharded_mode);
+      auto &plains = sharded_mode ? sharded : star;
+      loopback.run([&](const Party &party) {
+        // each party decrypts its own copy of the ciphers
+        vector<EncodedNumber> local = ciphers;
+        collaborative_decrypt(party, local.data(),
+                              plains[party.party_id].data(), size, 0);
+      });
+    }
+    sharded_decrypt_init(false);
+    for (int id = 0; id < party_num; id++) {
+      for (int i = 0; i < size; i++) {
+        expect_same_number(star[0][i], sharded[id][i]);
+        double value;
+        sharded[id][i].decode(value);
+        EXPECT_NEAR(value, i * 0.5 - 100, 1e-6);
+      }
+    }
+  }
+}
@@ -30,6 +30,9 @@ SOFTWARE.
 #include <string>
 
 #include "falcon/operator/phe/djcs_t_aux.h"
+#include "falcon/operator/phe/gmp_arena.h"
+#include "falcon/operator/phe/mont_kernel.h"
+#include "falcon/operator/phe/multi_exp.h"
 #include <gtest/gtest.h>
 
 using namespace std;
@@ -896,4 +899,922 @@ TEST(PHE, ThresholdPaillierScheme) {
 
   free(si);
   free(au);
-}
\ No newline at end of file
+}
+TEST(PHE, MaskedSelect) {
+  // init djcs_t parameters
+  int client_num = 3;
+  hcs_random *hr = hcs_init_random();
+  djcs_t_public_key *pk = djcs_t_init_public_key();
+  djcs_t_private_key *vk = djcs_t_init_private_key();
+  auto **au =
+      (djcs_t_auth_server **)malloc(client_num * sizeof(djcs_t_auth_server *));
+  auto *si = (mpz_t *)malloc(client_num * sizeof(mpz_t));
+  djcs_t_generate_key_pair(pk, vk, hr, 1, 1024, client_num, client_num);
+  mpz_t *coeff = djcs_t_init_polynomial(vk, hr);
+  for (int i = 0; i < client_num; i++) {
+    mpz_init(si[i]);
+    djcs_t_compute_polynomial(vk, coeff, si[i], i);
+    au[i] = djcs_t_init_auth_server();
+    djcs_t_set_auth_server(au[i], si[i], i);
+  }
+  PheRandomPool pool(std::make_shared<PheKeyContext>(pk, au[0]), 8, 4, 1);
+
+  // select the left child by the bits, the right child is parent - left
+  int size = 6;
+  std::vector<double> values{1.0, 0.5, -2.25, 3.0, 1.0, -0.75};
+  std::vector<int> bits{1, 0, 1, 1, 0, 0};
+  auto *parent = new EncodedNumber[size];
+  auto *left = new EncodedNumber[size];
+  auto *right = new EncodedNumber[size];
+  auto *trivial_left = new EncodedNumber[size];
+  for (int i = 0; i < size; i++) {
+    EncodedNumber plain;
+    plain.set_double(pk->n[0], values[i]);
+    djcs_t_aux_encrypt(pk, hr, parent[i], plain);
+  }
+  djcs_t_aux_masked_select(pk, &pool, left, parent, bits, size);
+  djcs_t_aux_vec_ele_wise_ee_sub(pk, right, parent, left, size);
+  djcs_t_aux_masked_select(pk, nullptr, trivial_left, parent, bits, size,
+                           false);
+
+  auto *partial_decryption = new EncodedNumber[client_num];
+  mpz_t v1, v2;
+  mpz_init(v1);
+  mpz_init(v2);
+  for (int i = 0; i < size; i++) {
+    EncodedNumber *ciphers[3] = {&left[i], &right[i], &trivial_left[i]};
+    double expected[3] = {bits[i] * values[i], (1 - bits[i]) * values[i],
+                          bits[i] * values[i]};
+    for (int k = 0; k < 3; k++) {
+      EXPECT_EQ(ciphers[k]->getter_exponent(), parent[i].getter_exponent());
+      EncodedNumber decrypted;
+      for (int j = 0; j < client_num; j++) {
+        djcs_t_aux_partial_decrypt(pk, au[j], partial_decryption[j],
+                                   *ciphers[k]);
+      }
+      djcs_t_aux_share_combine(pk, decrypted, partial_decryption, client_num);
+      double decoded;
+      decrypted.decode(decoded);
+      EXPECT_NEAR(expected[k], decoded, 1e-3);
+    }
+    // re-randomized outputs differ from the parent, trivial ones do not
+    parent[i].getter_value(v1);
+    left[i].getter_value(v2);
+    EXPECT_NE(mpz_cmp(v1, v2), 0);
+    right[i].getter_value(v2);
+    EXPECT_NE(mpz_cmp(v1, v2), 0);
+    trivial_left[i].getter_value(v2);
+    if (bits[i] == 1) {
+      EXPECT_EQ(mpz_cmp(v1, v2), 0);
+    } else {
+      EXPECT_EQ(mpz_cmp_ui(v2, 1), 0);
+    }
+  }
+  mpz_clear(v1);
+  mpz_clear(v2);
+
+  delete[] parent;
+  delete[] left;
+  delete[] right;
+  delete[] trivial_left;
+  delete[] partial_decryption;
+  for (int i = 0; i < client_num; i++) {
+    djcs_t_free_auth_server(au[i]);
+    mpz_clear(si[i]);
+  }
+  djcs_t_free_polynomial(vk, coeff);
+  free(si);
+  free(au);
+  djcs_t_free_private_key(vk);
+  djcs_t_free_public_key(pk);
+  hcs_free_random(hr);
+}
+
+TEST(PHE, Rerandomize) {
+  // init djcs_t parameters
+  int client_num = 3;
+  hcs_random *hr = hcs_init_random();
+  djcs_t_public_key *pk = djcs_t_init_public_key();
+  djcs_t_private_key *vk = djcs_t_init_private_key();
+  auto **au =
+      (djcs_t_auth_server **)malloc(client_num * sizeof(djcs_t_auth_server *));
+  auto *si = (mpz_t *)malloc(client_num * sizeof(mpz_t));
+  djcs_t_generate_key_pair(pk, vk, hr, 1, 1024, client_num, client_num);
+  mpz_t *coeff = djcs_t_init_polynomial(vk, hr);
+  for (int i = 0; i < client_num; i++) {
+    mpz_init(si[i]);
+    djcs_t_compute_polynomial(vk, coeff, si[i], i);
+    au[i] = djcs_t_init_auth_server();
+    djcs_t_set_auth_server(au[i], si[i], i);
+  }
+  PheRandomPool pool(std::make_shared<PheKeyContext>(pk, au[0]), 8, 4, 1);
+
+  // the inner product is deterministic in its operands until re-randomized
+  int size = 4;
+  std::vector<double> weights{0.5, -1.25, 2.0, 0.75};
+  std::vector<double> features{1.0, 2.0, -0.5, 4.0};
+  auto *ciphers = new EncodedNumber[size];
+  auto *plains = new EncodedNumber[size];
+  double expected = 0.0;
+  for (int i = 0; i < size; i++) {
+    EncodedNumber plain;
+    plain.set_double(pk->n[0], weights[i]);
+    djcs_t_aux_encrypt(pk, hr, ciphers[i], plain);
+    plains[i].set_double(pk->n[0], features[i]);
+    expected += weights[i] * features[i];
+  }
+  EncodedNumber products[2], rerandomized[2];
+  for (int k = 0; k < 2; k++) {
+    djcs_t_aux_inner_product(pk, hr, products[k], ciphers, plains, size);
+  }
+  djcs_t_aux_vec_rerandomize(pk, &pool, rerandomized, products, 2);
+
+  mpz_t v1, v2;
+  mpz_init(v1);
+  mpz_init(v2);
+  products[0].getter_value(v1);
+  products[1].getter_value(v2);
+  EXPECT_EQ(mpz_cmp(v1, v2), 0);
+  rerandomized[0].getter_value(v1);
+  rerandomized[1].getter_value(v2);
+  EXPECT_NE(mpz_cmp(v1, v2), 0);
+  products[0].getter_value(v2);
+  EXPECT_NE(mpz_cmp(v1, v2), 0);
+  mpz_clear(v1);
+  mpz_clear(v2);
+
+  auto *partial_decryption = new EncodedNumber[client_num];
+  for (int k = 0; k < 2; k++) {
+    EXPECT_EQ(rerandomized[k].getter_exponent(), products[k].getter_exponent());
+    EncodedNumber decrypted;
+    for (int j = 0; j < client_num; j++) {
+      djcs_t_aux_partial_decrypt(pk, au[j], partial_decryption[j],
+                                 rerandomized[k]);
+    }
+    djcs_t_aux_share_combine(pk, decrypted, partial_decryption, client_num);
+    double decoded;
+    decrypted.decode(decoded);
+    EXPECT_NEAR(expected, decoded, 1e-3);
+  }
+
+  delete[] ciphers;
+  delete[] plains;
+  delete[] partial_decryption;
+  for (int i = 0; i < client_num; i++) {
+    djcs_t_free_auth_server(au[i]);
+    mpz_clear(si[i]);
+  }
+  djcs_t_free_polynomial(vk, coeff);
+  free(si);
+  free(au);
+  djcs_t_free_private_key(vk);
+  djcs_t_free_public_key(pk);
+  hcs_free_random(hr);
+}
+
+TEST(PHE, MultiExponentiation) {
+  // compare the bucket multi-exponentiation with the per-base modexp
+  int size = 37;
+  gmp_randstate_t state;
+  gmp_randinit_default(state);
+  mpz_t modulus, expected, result, t;
+  mpz_init(modulus);
+  mpz_init(expected);
+  mpz_init(result);
+  mpz_init(t);
+  mpz_urandomb(modulus, state, 512);
+  mpz_setbit(modulus, 511);
+  mpz_setbit(modulus, 0);
+  auto *bases = (mpz_t *)malloc(size * sizeof(mpz_t));
+  auto *exponents = (mpz_t *)malloc(size * sizeof(mpz_t));
+  mpz_set_ui(expected, 1);
+  for (int i = 0; i < size; i++) {
+    mpz_init(bases[i]);
+    mpz_init(exponents[i]);
+    mpz_urandomm(bases[i], state, modulus);
+    // exponents of different lengths, including zero
+    mpz_urandomb(exponents[i], state, (i * 7) % 80);
+    mpz_powm(t, bases[i], exponents[i], modulus);
+    mpz_mul(expected, expected, t);
+    mpz_mod(expected, expected, modulus);
+  }
+  for (int window = 0; window <= 6; window++) {
+    multi_exp(result, bases, exponents, size, modulus, window);
+    EXPECT_EQ(mpz_cmp(result, expected), 0);
+  }
+  // empty product
+  multi_exp(result, bases, exponents, 0, modulus);
+  EXPECT_EQ(mpz_cmp_ui(result, 1), 0);
+
+  for (int i = 0; i < size; i++) {
+    mpz_clear(bases[i]);
+    mpz_clear(exponents[i]);
+  }
+  free(bases);
+  free(exponents);
+  mpz_clear(modulus);
+  mpz_clear(expected);
+  mpz_clear(result);
+  mpz_clear(t);
+  gmp_randclear(state);
+}
+
+TEST(PHE, EncryptedWeightTable) {
+  // init djcs_t parameters
+  int client_num = 3;
+  hcs_random *hr = hcs_init_random();
+  djcs_t_public_key *pk = djcs_t_init_public_key();
+  djcs_t_private_key *vk = djcs_t_init_private_key();
+  auto **au =
+      (djcs_t_auth_server **)malloc(client_num * sizeof(djcs_t_auth_server *));
+  auto *si = (mpz_t *)malloc(client_num * sizeof(mpz_t));
+  djcs_t_generate_key_pair(pk, vk, hr, 1, 1024, client_num, client_num);
+  mpz_t *coeff = djcs_t_init_polynomial(vk, hr);
+  for (int i = 0; i < client_num; i++) {
+    mpz_init(si[i]);
+    djcs_t_compute_polynomial(vk, coeff, si[i], i);
+    au[i] = djcs_t_init_auth_server();
+    djcs_t_set_auth_server(au[i], si[i], i);
+  }
+
+  // enough rows to use the fixed-base tables in vec_mat and mat_mat
+  int row_size = PHE_FIXED_BASE_THRESHOLD + 3, column_size = 5;
+  auto *weights = new EncodedNumber[column_size];
+  auto **weight_mat = new EncodedNumber *[column_size];
+  for (int j = 0; j < column_size; j++) {
+    EncodedNumber plain;
+    plain.set_double(pk->n[0], 0.5 * j - 1.0);
+    djcs_t_aux_encrypt(pk, hr, weights[j], plain);
+    weight_mat[j] = new EncodedNumber[1];
+    weight_mat[j][0] = weights[j];
+  }
+  auto **samples = new EncodedNumber *[row_size];
+  auto **mat_res = new EncodedNumber *[row_size];
+  for (int i = 0; i < row_size; i++) {
+    samples[i] = new EncodedNumber[column_size];
+    mat_res[i] = new EncodedNumber[1];
+    for (int j = 0; j < column_size; j++) {
+      samples[i][j].set_double(pk->n[0], (i % 7 - 3) * 0.25 + j * 0.125);
+    }
+  }
+  // the last sample is encoded mod n, and longer than the others
+  mpz_t v;
+  mpz_init(v);
+  samples[row_size - 1][0].getter_value(v);
+  mpz_mod(v, v, pk->n[0]);
+  samples[row_size - 1][0].setter_value(v);
+  samples[row_size - 1][1].set_double(pk->n[0], 1234.5);
+
+  auto *vec_res = new EncodedNumber[row_size];
+  djcs_t_aux_vec_mat_ep_mult(pk, hr, vec_res, weights, samples, row_size,
+                             column_size);
+  djcs_t_aux_mat_mat_ep_mult(pk, hr, mat_res, weight_mat, samples, column_size,
+                             1, row_size, column_size);
+  mpz_t v1, v2;
+  mpz_init(v1);
+  mpz_init(v2);
+  for (int i = 0; i < row_size; i++) {
+    EncodedNumber expected;
+    djcs_t_aux_signed_inner_product(pk, expected, weights, samples[i],
+                                    column_size);
+    expected.getter_value(v);
+    vec_res[i].getter_value(v1);
+    mat_res[i][0].getter_value(v2);
+    EXPECT_EQ(mpz_cmp(v, v1), 0);
+    EXPECT_EQ(mpz_cmp(v, v2), 0);
+    EXPECT_EQ(vec_res[i].getter_exponent(), expected.getter_exponent());
+  }
+
+  // decrypt the last row
+  auto *partial_decryption = new EncodedNumber[client_num];
+  EncodedNumber decrypted;
+  for (int j = 0; j < client_num; j++) {
+    djcs_t_aux_partial_decrypt(pk, au[j], partial_decryption[j],
+                               vec_res[row_size - 1]);
+  }
+  djcs_t_aux_share_combine(pk, decrypted, partial_decryption, client_num);
+  double decoded, expected_value = 0.0;
+  for (int j = 0; j < column_size; j++) {
+    double sample;
+    samples[row_size - 1][j].decode(sample);
+    expected_value += (0.5 * j - 1.0) * sample;
+  }
+  decrypted.decode(decoded);
+  EXPECT_NEAR(expected_value, decoded, 1e-3);
+  mpz_clear(v);
+  mpz_clear(v1);
+  mpz_clear(v2);
+
+  for (int i = 0; i < row_size; i++) {
+    delete[] samples[i];
+    delete[] mat_res[i];
+  }
+  for (int j = 0; j < column_size; j++) {
+    delete[] weight_mat[j];
+  }
+  delete[] samples;
+  delete[] mat_res;
+  delete[] weight_mat;
+  delete[] weights;
+  delete[] vec_res;
+  delete[] partial_decryption;
+  for (int i = 0; i < client_num; i++) {
+    djcs_t_free_auth_server(au[i]);
+    mpz_clear(si[i]);
+  }
+  djcs_t_free_polynomial(vk, coeff);
+  free(si);
+  free(au);
+  djcs_t_free_private_key(vk);
+  djcs_t_free_public_key(pk);
+  hcs_free_random(hr);
+}
+
+TEST(PHE, BatchedDecryption) {
+  // 2-out-of-3 threshold keys, so that a subset of the parties can decrypt
+  int client_num = 3, threshold = 2;
+  hcs_random *hr = hcs_init_random();
+  djcs_t_public_key *pk = djcs_t_init_public_key();
+  djcs_t_private_key *vk = djcs_t_init_private_key();
+  auto **au =
+      (djcs_t_auth_server **)malloc(client_num * sizeof(djcs_t_auth_server *));
+  auto *si = (mpz_t *)malloc(client_num * sizeof(mpz_t));
+  djcs_t_generate_key_pair(pk, vk, hr, 1, 1024, threshold, client_num);
+  mpz_t *coeff = djcs_t_init_polynomial(vk, hr);
+  for (int i = 0; i < client_num; i++) {
+    mpz_init(si[i]);
+    djcs_t_compute_polynomial(vk, coeff, si[i], i);
+    au[i] = djcs_t_init_auth_server();
+    djcs_t_set_auth_server(au[i], si[i], i);
+  }
+
+  int size = 20;
+  auto *ciphers = new EncodedNumber[size];
+  for (int i = 0; i < size; i++) {
+    EncodedNumber plain;
+    plain.set_double(pk->n[0], (i - 10) * 0.375, PHE_FIXED_POINT_PRECISION);
+    djcs_t_aux_encrypt(pk, hr, ciphers[i], plain);
+  }
+  // partially decrypt by each party, and compare with the per element one
+  auto **partial_decryption = new EncodedNumber *[client_num];
+  mpz_t v1, v2;
+  mpz_init(v1);
+  mpz_init(v2);
+  for (int j = 0; j < client_num; j++) {
+    partial_decryption[j] = new EncodedNumber[size];
+    djcs_t_aux_partial_decrypt_batch(pk, au[j], partial_decryption[j],
+                                     ciphers, size);
+    for (int i = 0; i < size; i++) {
+      EncodedNumber expected;
+      djcs_t_aux_partial_decrypt(pk, au[j], expected, ciphers[i]);
+      expected.getter_value(v1);
+      partial_decryption[j][i].getter_value(v2);
+      EXPECT_EQ(mpz_cmp(v1, v2), 0);
+      EXPECT_EQ(partial_decryption[j][i].getter_type(), Plaintext);
+    }
+  }
+
+  // combine by all the parties and by the subset {0, 2}
+  std::vector<std::vector<int>> party_sets{{0, 1, 2}, {0, 2}};
+  for (const auto &party_ids : party_sets) {
+    ShareCombineContext ctx(std::make_shared<PheKeyContext>(pk, au[0]),
+                            party_ids);
+    EXPECT_EQ(ctx.getter_party_num(), (int)party_ids.size());
+    auto **shares = new EncodedNumber *[size];
+    for (int i = 0; i < size; i++) {
+      shares[i] = new EncodedNumber[party_ids.size()];
+      for (int j = 0; j < (int)party_ids.size(); j++) {
+        shares[i][j] = partial_decryption[party_ids[j]][i];
+      }
+    }
+    auto *decrypted = new EncodedNumber[size];
+    djcs_t_aux_share_combine_batch(ctx, decrypted, shares, size);
+    for (int i = 0; i < size; i++) {
+      double decoded;
+      decrypted[i].decode(decoded);
+      EXPECT_NEAR((i - 10) * 0.375, decoded, 1e-3);
+      EXPECT_EQ(decrypted[i].getter_exponent(), 0 - PHE_FIXED_POINT_PRECISION);
+      delete[] shares[i];
+    }
+    delete[] shares;
+    delete[] decrypted;
+  }
+  mpz_clear(v1);
+  mpz_clear(v2);
+
+  for (int j = 0; j < client_num; j++) {
+    delete[] partial_decryption[j];
+  }
+  delete[] partial_decryption;
+  delete[] ciphers;
+  for (int i = 0; i < client_num; i++) {
+    djcs_t_free_auth_server(au[i]);
+    mpz_clear(si[i]);
+  }
+  djcs_t_free_polynomial(vk, coeff);
+  free(si);
+  free(au);
+  djcs_t_free_private_key(vk);
+  djcs_t_free_public_key(pk);
+  hcs_free_random(hr);
+}
+
+TEST(PHE, CipherVector) {
+  // init djcs_t parameters
+  int client_num = 3;
+  hcs_random *hr = hcs_init_random();
+  djcs_t_public_key *pk = djcs_t_init_public_key();
+  djcs_t_private_key *vk = djcs_t_init_private_key();
+  auto **au =
+      (djcs_t_auth_server **)malloc(client_num * sizeof(djcs_t_auth_server *));
+  auto *si = (mpz_t *)malloc(client_num * sizeof(mpz_t));
+  djcs_t_generate_key_pair(pk, vk, hr, 1, 1024, client_num, client_num);
+  mpz_t *coeff = djcs_t_init_polynomial(vk, hr);
+  for (int i = 0; i < client_num; i++) {
+    mpz_init(si[i]);
+    djcs_t_compute_polynomial(vk, coeff, si[i], i);
+    au[i] = djcs_t_init_auth_server();
+    djcs_t_set_auth_server(au[i], si[i], i);
+  }
+  auto decrypt = [&](const EncodedNumber &cipher) {
+    EncodedNumber partial_decryption[3], decrypted;
+    for (int j = 0; j < client_num; j++) {
+      djcs_t_aux_partial_decrypt(pk, au[j], partial_decryption[j], cipher);
+    }
+    djcs_t_aux_share_combine(pk, decrypted, partial_decryption, client_num);
+    double decoded;
+    decrypted.decode(decoded);
+    return decoded;
+  };
+
+  // a 2 * 10 matrix of ciphertexts, and its rows as vectors
+  int row_size = 2, column_size = 10, size = row_size * column_size;
+  auto *ciphers = new EncodedNumber[size];
+  for (int i = 0; i < size; i++) {
+    EncodedNumber plain;
+    plain.set_double(pk->n[0], (i - 10) * 0.5, PHE_FIXED_POINT_PRECISION);
+    djcs_t_aux_encrypt(pk, hr, ciphers[i], plain);
+  }
+  auto modulus = std::make_shared<const CipherModulus>(pk);
+  CipherMatrix matrix(modulus, ciphers, row_size, column_size);
+  EXPECT_EQ(matrix.getter_row_size(), row_size);
+  EXPECT_EQ(matrix.getter_exponent(), 0 - PHE_FIXED_POINT_PRECISION);
+  auto *converted = new EncodedNumber[size];
+  matrix.to_encoded_numbers(converted);
+  mpz_t v1, v2;
+  mpz_init(v1);
+  mpz_init(v2);
+  for (int i = 0; i < size; i++) {
+    ciphers[i].getter_value(v1);
+    converted[i].getter_value(v2);
+    EXPECT_EQ(mpz_cmp(v1, v2), 0);
+    EXPECT_EQ(converted[i].getter_type(), Ciphertext);
+    EXPECT_EQ(converted[i].getter_exponent(), 0 - PHE_FIXED_POINT_PRECISION);
+  }
+  CipherVector row0, row1;
+  matrix.getter_row(0, row0);
+  matrix.getter_row(1, row1);
+  EXPECT_EQ(row0.getter_modulus().get(), modulus.get());
+
+  // the moved-from vector is empty
+  CipherVector moved(std::move(row1));
+  EXPECT_EQ(moved.getter_size(), column_size);
+  EXPECT_EQ(row1.getter_size(), 0);
+
+  // element-wise addition, aggregation, inner product and masked select
+  CipherVector sum;
+  djcs_t_aux_vec_ele_wise_ee_add(pk, sum, row0, moved);
+  auto *plains = new EncodedNumber[column_size];
+  std::vector<int> bits;
+  double expected_product = 0.0, expected_select = 0.0;
+  for (int j = 0; j < column_size; j++) {
+    plains[j].set_integer(pk->n[0], j - 4);
+    bits.push_back(j % 3 == 0 ? 1 : 0);
+    double value = (j - 10) * 0.5 + (j + column_size - 10) * 0.5;
+    EncodedNumber cipher;
+    sum.getter_encoded_number(j, cipher);
+    EXPECT_NEAR(value, decrypt(cipher), 1e-3);
+    expected_product += (j - 4) * (j - 10) * 0.5;
+    expected_select += bits[j] * value;
+  }
+  EncodedNumber aggregation, product, selected_sum;
+  djcs_t_aux_vec_aggregate(pk, aggregation, row0);
+  EXPECT_NEAR(-27.5, decrypt(aggregation), 1e-3);
+  djcs_t_aux_signed_inner_product(pk, product, row0, plains);
+  EXPECT_NEAR(expected_product, decrypt(product), 1e-3);
+  auto pool = std::make_shared<PheRandomPool>(
+      std::make_shared<PheKeyContext>(pk, au[0]), 8, 4, 1);
+  djcs_t_aux_masked_select(pk, pool.get(), sum, sum, bits);
+  djcs_t_aux_vec_aggregate(pk, selected_sum, sum);
+  EXPECT_NEAR(expected_select, decrypt(selected_sum), 1e-3);
+
+  mpz_clear(v1);
+  mpz_clear(v2);
+  delete[] ciphers;
+  delete[] converted;
+  delete[] plains;
+  for (int i = 0; i < client_num; i++) {
+    djcs_t_free_auth_server(au[i]);
+    mpz_clear(si[i]);
+  }
+  djcs_t_free_polynomial(vk, coeff);
+  free(si);
+  free(au);
+  djcs_t_free_private_key(vk);
+  djcs_t_free_public_key(pk);
+  hcs_free_random(hr);
+}
+
+TEST(PHE, GmpArena) {
+  gmp_arena_install();
+  hcs_random *hr = hcs_init_random();
+  djcs_t_public_key *pk = djcs_t_init_public_key();
+  djcs_t_private_key *vk = djcs_t_init_private_key();
+  djcs_t_generate_key_pair(pk, vk, hr, 1, 1024, 1, 1);
+  djcs_t_auth_server *au = djcs_t_init_auth_server();
+  mpz_t *coeff = djcs_t_init_polynomial(vk, hr);
+  mpz_t si;
+  mpz_init(si);
+  djcs_t_compute_polynomial(vk, coeff, si, 0);
+  djcs_t_set_auth_server(au, si, 0);
+
+  // the operators reuse the blocks freed by the previous ones
+  int size = 16;
+  std::vector<EncodedNumber> ciphers(size);
+  EncodedNumber sum;
+  for (int i = 0; i < size; i++) {
+    EncodedNumber plain;
+    plain.set_double(pk->n[0], i * 0.5, PHE_FIXED_POINT_PRECISION);
+    djcs_t_aux_encrypt(pk, hr, ciphers[i], plain);
+    if (i == 0) {
+      sum = ciphers[i];
+    } else {
+      djcs_t_aux_ee_add(pk, sum, sum, ciphers[i]);
+    }
+  }
+  EXPECT_GT(gmp_arena_cached_bytes(), 0);
+  EncodedNumber share, decrypted;
+  djcs_t_aux_partial_decrypt(pk, au, share, sum);
+  djcs_t_aux_share_combine(pk, decrypted, &share, 1);
+  double decoded;
+  decrypted.decode(decoded);
+  EXPECT_NEAR(60.0, decoded, 1e-3);
+
+  // a reset releases the cached blocks of the thread
+  gmp_arena_reset();
+  EXPECT_EQ(gmp_arena_cached_bytes(), 0);
+
+  mpz_clear(si);
+  djcs_t_free_polynomial(vk, coeff);
+  djcs_t_free_auth_server(au);
+  hcs_free_random(hr);
+  djcs_t_free_public_key(pk);
+  djcs_t_free_private_key(vk);
+}
+
+TEST(PHE, LazyPrecisionAlignment) {
+  // init djcs_t parameters
+  int client_num = 3;
+  hcs_random *hr = hcs_init_random();
+  djcs_t_public_key *pk = djcs_t_init_public_key();
+  djcs_t_private_key *vk = djcs_t_init_private_key();
+  auto **au =
+      (djcs_t_auth_server **)malloc(client_num * sizeof(djcs_t_auth_server *));
+  auto *si = (mpz_t *)malloc(client_num * sizeof(mpz_t));
+  djcs_t_generate_key_pair(pk, vk, hr, 1, 1024, client_num, client_num);
+  mpz_t *coeff = djcs_t_init_polynomial(vk, hr);
+  for (int i = 0; i < client_num; i++) {
+    mpz_init(si[i]);
+    djcs_t_compute_polynomial(vk, coeff, si[i], i);
+    au[i] = djcs_t_init_auth_server();
+    djcs_t_set_auth_server(au[i], si[i], i);
+  }
+  auto decrypt = [&](const EncodedNumber &cipher) {
+    EncodedNumber partial_decryption[3], decrypted;
+    for (int j = 0; j < client_num; j++) {
+      djcs_t_aux_partial_decrypt(pk, au[j], partial_decryption[j], cipher);
+    }
+    djcs_t_aux_share_combine(pk, decrypted, partial_decryption, client_num);
+    double decoded;
+    decrypted.decode(decoded);
+    return decoded;
+  };
+
+  // the addition of two precisions aligns on the fly, the inputs are kept
+  int size = 4;
+  auto *low = new EncodedNumber[size];
+  auto *high = new EncodedNumber[size];
+  auto *sum = new EncodedNumber[size];
+  for (int i = 0; i < size; i++) {
+    EncodedNumber plain;
+    plain.set_double(pk->n[0], i - 1.5, PHE_FIXED_POINT_PRECISION);
+    djcs_t_aux_encrypt(pk, hr, low[i], plain);
+    plain.set_double(pk->n[0], 0.25 * i, 2 * PHE_FIXED_POINT_PRECISION);
+    djcs_t_aux_encrypt(pk, hr, high[i], plain);
+  }
+  djcs_t_aux_vec_ele_wise_ee_add_ext(pk, sum, low, high, size);
+  for (int i = 0; i < size; i++) {
+    EXPECT_EQ(low[i].getter_exponent(), 0 - PHE_FIXED_POINT_PRECISION);
+    EXPECT_EQ(sum[i].getter_exponent(), 0 - 2 * PHE_FIXED_POINT_PRECISION);
+    EXPECT_NEAR(i - 1.5 + 0.25 * i, decrypt(sum[i]), 1e-3);
+  }
+
+  // a trivial zero accumulator takes the precision of the first term
+  EncodedNumber acc;
+  mpz_t one;
+  mpz_init_set_ui(one, 1);
+  acc.setter_n(pk->n[0]);
+  acc.setter_value(one);
+  acc.setter_exponent(0 - PHE_FIXED_POINT_PRECISION);
+  acc.setter_type(Ciphertext);
+  djcs_t_aux_ee_add_ext(pk, acc, acc, high[3]);
+  EXPECT_EQ(acc.getter_exponent(), 0 - 2 * PHE_FIXED_POINT_PRECISION);
+  EXPECT_NEAR(0.75, decrypt(acc), 1e-3);
+  mpz_clear(one);
+
+  // the scaling of the product is folded into the plaintext
+  EncodedNumber plain, product, aligned;
+  plain.set_double(pk->n[0], -0.5, PHE_FIXED_POINT_PRECISION);
+  djcs_t_aux_ep_mul_ext(pk, product, low[0], plain,
+                        3 * PHE_FIXED_POINT_PRECISION);
+  EXPECT_EQ(product.getter_exponent(), 0 - 3 * PHE_FIXED_POINT_PRECISION);
+  EXPECT_NEAR(0.75, decrypt(product), 1e-3);
+  djcs_t_aux_ep_mul_ext(pk, product, low[0], plain, 0);
+  EXPECT_EQ(product.getter_exponent(), 0 - 2 * PHE_FIXED_POINT_PRECISION);
+  djcs_t_aux_increase_prec(pk, aligned, 3 * PHE_FIXED_POINT_PRECISION,
+                           product);
+  EXPECT_EQ(aligned.getter_exponent(), 0 - 3 * PHE_FIXED_POINT_PRECISION);
+  EXPECT_NEAR(0.75, decrypt(aligned), 1e-3);
+
+  delete[] low;
+  delete[] high;
+  delete[] sum;
+  for (int i = 0; i < client_num; i++) {
+    djcs_t_free_auth_server(au[i]);
+    mpz_clear(si[i]);
+  }
+  djcs_t_free_polynomial(vk, coeff);
+  free(si);
+  free(au);
+  djcs_t_free_private_key(vk);
+  djcs_t_free_public_key(pk);
+  hcs_free_random(hr);
+}
+
+TEST(PHE, PlaintextPacking) {
+  // init djcs_t parameters
+  int client_num = 3;
+  hcs_random *hr = hcs_init_random();
+  djcs_t_public_key *pk = djcs_t_init_public_key();
+  djcs_t_private_key *vk = djcs_t_init_private_key();
+  auto **au =
+      (djcs_t_auth_server **)malloc(client_num * sizeof(djcs_t_auth_server *));
+  auto *si = (mpz_t *)malloc(client_num * sizeof(mpz_t));
+  djcs_t_generate_key_pair(pk, vk, hr, 1, 1024, client_num, client_num);
+  mpz_t *coeff = djcs_t_init_polynomial(vk, hr);
+  for (int i = 0; i < client_num; i++) {
+    mpz_init(si[i]);
+    djcs_t_compute_polynomial(vk, coeff, si[i], i);
+    au[i] = djcs_t_init_auth_server();
+    djcs_t_set_auth_server(au[i], si[i], i);
+  }
+  auto decrypt = [&](EncodedNumber &decrypted, const EncodedNumber &cipher) {
+    EncodedNumber partial_decryption[3];
+    for (int j = 0; j < client_num; j++) {
+      djcs_t_aux_partial_decrypt(pk, au[j], partial_decryption[j], cipher);
+    }
+    djcs_t_aux_share_combine(pk, decrypted, partial_decryption, client_num);
+  };
+
+  // 1024-bit n, slots of 40 + 4 + 1 bits, 22 slots per plaintext
+  PackedEncoder encoder(pk->n[0], 40, 4);
+  EXPECT_EQ(encoder.getter_slot_bits(), 45);
+  EXPECT_EQ(encoder.getter_slot_num(), 22);
+  int size = 30;
+  int packed_size = encoder.packed_size(size);
+  EXPECT_EQ(packed_size, 2);
+  auto *plains = new EncodedNumber[size];
+  auto *ciphers = new EncodedNumber[size];
+  auto *unpacked = new EncodedNumber[size];
+  auto *packed_plains = new EncodedNumber[packed_size];
+  auto *packed_ciphers = new EncodedNumber[packed_size];
+  std::vector<double> values;
+  for (int i = 0; i < size; i++) {
+    values.push_back((i % 2 == 0) ? i * 1.25 : -i * 1.25);
+    plains[i].set_double(pk->n[0], values[i], PHE_FIXED_POINT_PRECISION);
+    djcs_t_aux_encrypt(pk, hr, ciphers[i], plains[i]);
+  }
+
+  // pack the plaintexts, then add and multiply by a scalar on the slots
+  EncodedNumber scalar;
+  scalar.set_integer(pk->n[0], -3);
+  encoder.pack(packed_plains, plains, size);
+  for (int p = 0; p < packed_size; p++) {
+    djcs_t_aux_encrypt(pk, hr, packed_ciphers[p], packed_plains[p]);
+    djcs_t_aux_ee_add(pk, packed_ciphers[p], packed_ciphers[p],
+                      packed_ciphers[p]);
+    djcs_t_aux_ep_mul(pk, packed_ciphers[p], packed_ciphers[p], scalar);
+    decrypt(packed_plains[p], packed_ciphers[p]);
+  }
+  encoder.unpack(unpacked, packed_plains, size);
+  for (int i = 0; i < size; i++) {
+    double decoded;
+    unpacked[i].decode(decoded);
+    EXPECT_NEAR(-6 * values[i], decoded, 1e-3);
+  }
+
+  // pack the ciphertexts homomorphically
+  djcs_t_aux_pack_ciphers(pk, encoder, packed_ciphers, ciphers, size);
+  for (int p = 0; p < packed_size; p++) {
+    EXPECT_EQ(packed_ciphers[p].getter_exponent(),
+              0 - PHE_FIXED_POINT_PRECISION);
+    decrypt(packed_plains[p], packed_ciphers[p]);
+  }
+  encoder.unpack(unpacked, packed_plains, size);
+  for (int i = 0; i < size; i++) {
+    double decoded;
+    unpacked[i].decode(decoded);
+    EXPECT_NEAR(values[i], decoded, 1e-3);
+  }
+
+  delete[] plains;
+  delete[] ciphers;
+  delete[] unpacked;
+  delete[] packed_plains;
+  delete[] packed_ciphers;
+  for (int i = 0; i < client_num; i++) {
+    djcs_t_free_auth_server(au[i]);
+    mpz_clear(si[i]);
+  }
+  djcs_t_free_polynomial(vk, coeff);
+  free(si);
+  free(au);
+  djcs_t_free_private_key(vk);
+  djcs_t_free_public_key(pk);
+  hcs_free_random(hr);
+}
+
+TEST(PHE, MontKernel) {
+  hcs_random *hr = hcs_init_random();
+  djcs_t_public_key *pk = djcs_t_init_public_key();
+  djcs_t_private_key *vk = djcs_t_init_private_key();
+  djcs_t_generate_key_pair(pk, vk, hr, 1, 1024, 3, 3);
+
+  // a group of 8 lanes, a group of 3 padded lanes and a tail left to gmp,
+  // with zero, small, full size and negative exponents
+  int size = 2 * PHE_MONT_KERNEL_LANES + 1;
+  auto *bases = (mpz_t *)malloc(size * sizeof(mpz_t));
+  auto *exps = (mpz_t *)malloc(size * sizeof(mpz_t));
+  auto *results = (mpz_t *)malloc(size * sizeof(mpz_t));
+  mpz_t expected;
+  mpz_init(expected);
+  for (int i = 0; i < size; i++) {
+    mpz_init(bases[i]);
+    mpz_init(exps[i]);
+    mpz_init(results[i]);
+    mpz_urandomm(bases[i], hr->rstate, pk->n[1]);
+    if (i % 4 == 0) {
+      mpz_set_ui(exps[i], i);
+    } else {
+      mpz_urandomm(exps[i], hr->rstate, pk->n[1]);
+    }
+    if (i == 5) {
+      mpz_neg(exps[i], exps[i]);
+    }
+  }
+  mont_powm_batch(results, bases, exps, size, pk->n[1]);
+  for (int i = 0; i < size; i++) {
+    mpz_powm(expected, bases[i], exps[i], pk->n[1]);
+    EXPECT_EQ(mpz_cmp(results[i], expected), 0);
+  }
+
+  // the same exponent, as the partial decryption, and in place
+  mont_powm_batch_fixed_exp(results, bases, exps[1], size, pk->n[1]);
+  for (int i = 0; i < size; i++) {
+    mpz_powm(expected, bases[i], exps[1], pk->n[1]);
+    EXPECT_EQ(mpz_cmp(results[i], expected), 0);
+  }
+  mont_powm_batch_fixed_exp(bases, bases, exps[1], size, pk->n[1]);
+  for (int i = 0; i < size; i++) {
+    EXPECT_EQ(mpz_cmp(results[i], bases[i]), 0);
+  }
+
+  for (int i = 0; i < size; i++) {
+    mpz_clear(bases[i]);
+    mpz_clear(exps[i]);
+    mpz_clear(results[i]);
+  }
+  free(bases);
+  free(exps);
+  free(results);
+  mpz_clear(expected);
+  hcs_free_random(hr);
+  djcs_t_free_public_key(pk);
+  djcs_t_free_private_key(vk);
+}
+
+TEST(PHE, KeyContext) {
+  // init djcs_t parameters
+  int client_num = 3;
+  hcs_random *hr = hcs_init_random();
+  djcs_t_public_key *pk = djcs_t_init_public_key();
+  djcs_t_private_key *vk = djcs_t_init_private_key();
+  auto **au =
+      (djcs_t_auth_server **)malloc(client_num * sizeof(djcs_t_auth_server *));
+  auto *si = (mpz_t *)malloc(client_num * sizeof(mpz_t));
+  djcs_t_generate_key_pair(pk, vk, hr, 1, 1024, client_num, client_num);
+  mpz_t *coeff = djcs_t_init_polynomial(vk, hr);
+  for (int i = 0; i < client_num; i++) {
+    mpz_init(si[i]);
+    djcs_t_compute_polynomial(vk, coeff, si[i], i);
+    au[i] = djcs_t_init_auth_server();
+    djcs_t_set_auth_server(au[i], si[i], i);
+  }
+
+  // the contexts own copies of the keys, shared by reference
+  std::vector<std::shared_ptr<const PheKeyContext>> contexts;
+  for (int i = 0; i < client_num; i++) {
+    contexts.push_back(std::make_shared<PheKeyContext>(pk, au[i]));
+  }
+  auto borrowed = contexts[0];
+  EXPECT_EQ(mpz_cmp(borrowed->getter_n(), pk->n[0]), 0);
+  EXPECT_EQ(mpz_cmp(borrowed->getter_cipher_modulus(), pk->n[1]), 0);
+  EXPECT_EQ(borrowed->getter_auth_server()->i, au[0]->i);
+
+  // the partial decryptions with the precomputed constants match
+  int size = 10;
+  auto *ciphers = new EncodedNumber[size];
+  auto *expected = new EncodedNumber[size];
+  auto **shares = new EncodedNumber *[size];
+  for (int i = 0; i < size; i++) {
+    EncodedNumber plain;
+    plain.set_double(pk->n[0], 1.5 * i - 4, PHE_FIXED_POINT_PRECISION);
+    djcs_t_aux_encrypt(borrowed->getter_pub_key(), hr, ciphers[i], plain);
+    shares[i] = new EncodedNumber[client_num];
+  }
+  mpz_t v1, v2;
+  mpz_init(v1);
+  mpz_init(v2);
+  for (int j = 0; j < client_num; j++) {
+    auto *partial = new EncodedNumber[size];
+    djcs_t_aux_partial_decrypt_batch(*contexts[j], partial, ciphers, size);
+    djcs_t_aux_partial_decrypt_batch(pk, au[j], expected, ciphers, size);
+    for (int i = 0; i < size; i++) {
+      partial[i].getter_value(v1);
+      expected[i].getter_value(v2);
+      EXPECT_EQ(mpz_cmp(v1, v2), 0);
+      shares[i][j] = partial[i];
+    }
+    delete[] partial;
+  }
+  for (int i = 0; i < size; i++) {
+    EncodedNumber decrypted;
+    djcs_t_aux_share_combine(pk, decrypted, shares[i], client_num);
+    double decoded;
+    decrypted.decode(decoded);
+    EXPECT_NEAR(1.5 * i - 4, decoded, 1e-3);
+    delete[] shares[i];
+  }
+
+  // the weighted shares are multiplied in any order, e.g., along a tree
+  ShareCombineContext combiner(borrowed, {0, 1, 2});
+  auto *products = new EncodedNumber[size];
+  for (int j = client_num - 1; j >= 0; j--) {
+    auto *weighted = new EncodedNumber[size];
+    djcs_t_aux_weighted_partial_decrypt_batch(*contexts[j], combiner, j,
+                                              weighted, ciphers, size);
+    for (int i = 0; i < size; i++) {
+      EXPECT_EQ(weighted[i].getter_type(), Ciphertext);
+      if (j == client_num - 1) {
+        products[i] = weighted[i];
+      } else {
+        djcs_t_aux_ee_add(pk, products[i], products[i], weighted[i]);
+      }
+    }
+    delete[] weighted;
+  }
+  djcs_t_aux_weighted_share_combine_batch(combiner, products, products, size);
+  for (int i = 0; i < size; i++) {
+    double decoded;
+    products[i].decode(decoded);
+    EXPECT_NEAR(1.5 * i - 4, decoded, 1e-3);
+  }
+  delete[] products;
+  mpz_clear(v1);
+  mpz_clear(v2);
+
+  delete[] ciphers;
+  delete[] expected;
+  delete[] shares;
+  contexts.clear();
+  for (int i = 0; i < client_num; i++) {
+    djcs_t_free_auth_server(au[i]);
+    mpz_clear(si[i]);
+  }
+  djcs_t_free_polynomial(vk, coeff);
+  free(si);
+  free(au);
+  djcs_t_free_private_key(vk);
+  djcs_t_free_public_key(pk);
+  hcs_free_random(hr);
+}
@@ -389,4 +389,34 @@ TEST(FixedPoint, DecodeTruncationCase4) {
   //  std::endl;
   EXPECT_NEAR(x_decoded, x_decoded_truncation, 1e-3);
   mpz_clear(v_n);
-}
\ No newline at end of file
+}
+
+TEST(FixedPoint, MoveCopy) {
+  mpz_t v_n;
+  mpz_init(v_n);
+  mpz_set_str(v_n, "100000000000000000000000000000000", PHE_STR_BASE);
+  EncodedNumber number;
+  number.set_double(v_n, -1.25, 16);
+
+  // copy keeps the source, move takes it over
+  EncodedNumber copied(number);
+  EncodedNumber moved(std::move(number));
+  EXPECT_TRUE(copied.same_n(moved));
+  EncodedNumber assigned;
+  assigned = std::move(moved);
+  double x_copied, x_assigned;
+  copied.decode(x_copied);
+  assigned.decode(x_assigned);
+  EXPECT_NEAR(-1.25, x_copied, 1e-6);
+  EXPECT_NEAR(-1.25, x_assigned, 1e-6);
+  EXPECT_EQ(assigned.getter_exponent(), -16);
+  EXPECT_EQ(assigned.getter_type(), Plaintext);
+
+  // chained copy assignment
+  EncodedNumber a, b;
+  a = b = copied;
+  double x_a;
+  a.decode(x_a);
+  EXPECT_NEAR(-1.25, x_a, 1e-6);
+  mpz_clear(v_n);
+}
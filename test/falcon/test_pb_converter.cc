@@ -28,7 +28,9 @@ SOFTWARE.
 
 #include <iostream>
 #include <string>
+#include <vector>
 
+#include "../../src/executor/include/message/common.pb.h"
 #include <falcon/utils/base64.h>
 #include <falcon/utils/pb_converter/alg_params_converter.h>
 #include <falcon/utils/pb_converter/common_converter.h>
@@ -348,6 +350,94 @@ TEST(PB_Converter, EncodedNumberMatrix) {
   delete[] deserialized_number_matrix;
 }
 
+TEST(PB_Converter, BinaryEncodedNumberArray) {
+  // mixed signs, exponents and types, and a zero
+  int size = 5;
+  auto *encoded_number_array = new EncodedNumber[size];
+  mpz_t v_n, v_value;
+  mpz_init(v_n);
+  mpz_init(v_value);
+  mpz_set_str(v_n, "340282366920938463463374607431768211507", PHE_STR_BASE);
+  std::vector<std::string> values = {"123456789012345678901234567890", "-42",
+                                     "0", "-98765432109876543210", "7"};
+  for (int i = 0; i < size; i++) {
+    mpz_set_str(v_value, values[i].c_str(), PHE_STR_BASE);
+    encoded_number_array[i].setter_n(v_n);
+    encoded_number_array[i].setter_value(v_value);
+    encoded_number_array[i].setter_exponent(i == 3 ? -16 : -8);
+    encoded_number_array[i].setter_type(i == 4 ? Plaintext : Ciphertext);
+  }
+  auto check = [&](EncodedNumber *deserialized) {
+    mpz_t t;
+    mpz_init(t);
+    for (int i = 0; i < size; i++) {
+      deserialized[i].getter_n(t);
+      EXPECT_EQ(0, mpz_cmp(v_n, t));
+      deserialized[i].getter_value(t);
+      mpz_set_str(v_value, values[i].c_str(), PHE_STR_BASE);
+      EXPECT_EQ(0, mpz_cmp(v_value, t));
+      EXPECT_EQ(encoded_number_array[i].getter_exponent(),
+                deserialized[i].getter_exponent());
+      EXPECT_EQ(encoded_number_array[i].getter_type(),
+                deserialized[i].getter_type());
+    }
+    mpz_clear(t);
+  };
+
+  std::string out_message, omitted_message;
+  serialize_encoded_number_array(encoded_number_array, size, out_message);
+  auto *deserialized_number_array = new EncodedNumber[size];
+  deserialize_encoded_number_array(deserialized_number_array, size,
+                                   out_message);
+  check(deserialized_number_array);
+
+  // n omitted by the sender and given by the receiver
+  serialize_encoded_number_array(encoded_number_array, size, omitted_message,
+                                 true);
+  EXPECT_LT(omitted_message.size(), out_message.size());
+  auto *omitted_number_array = new EncodedNumber[size];
+  deserialize_encoded_number_array(omitted_number_array, size,
+                                   omitted_message, v_n);
+  check(omitted_number_array);
+
+  // the legacy messages are still accepted
+  com::nus::dbsytem::falcon::v0::EncodedNumberArray legacy_array;
+  for (int i = 0; i < size; i++) {
+    auto *legacy_number = legacy_array.add_encoded_number();
+    legacy_number->set_n(mpz_get_str(nullptr, PHE_STR_BASE, v_n));
+    legacy_number->set_value(values[i]);
+    legacy_number->set_exponent(encoded_number_array[i].getter_exponent());
+    legacy_number->set_type(encoded_number_array[i].getter_type());
+  }
+  std::string legacy_message;
+  legacy_array.SerializeToString(&legacy_message);
+  EXPECT_LT(out_message.size(), legacy_message.size());
+  auto *legacy_number_array = new EncodedNumber[size];
+  deserialize_encoded_number_array(legacy_number_array, size, legacy_message);
+  check(legacy_number_array);
+
+  // a negative index out of range or repeated is rejected
+  for (int bad_index : {size, -1, 1}) {
+    com::nus::dbsytem::falcon::v0::BinaryEncodedNumberArray bad_array;
+    bad_array.ParseFromString(out_message);
+    bad_array.add_negative_indexes(bad_index);
+    std::string bad_message;
+    bad_array.SerializeToString(&bad_message);
+    auto *bad_number_array = new EncodedNumber[size];
+    EXPECT_EXIT(deserialize_encoded_number_array(bad_number_array, size,
+                                                 bad_message),
+                ::testing::ExitedWithCode(EXIT_FAILURE), "");
+    delete[] bad_number_array;
+  }
+
+  mpz_clear(v_n);
+  mpz_clear(v_value);
+  delete[] encoded_number_array;
+  delete[] deserialized_number_array;
+  delete[] omitted_number_array;
+  delete[] legacy_number_array;
+}
+
 TEST(PB_Converter, LogisticRegressionParams) {
   LogisticRegressionParams lr_params;
   lr_params.batch_size = 32;
@@ -0,0 +1,375 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//
+// Created by root on 10/18/26.
+//
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "falcon/operator/phe/djcs_t_aux.h"
+#include "falcon/operator/phe/phe_constant_factory.h"
+#include "falcon/operator/phe/phe_random_pool.h"
+#include "falcon/operator/phe/phe_random_stream.h"
+#include "falcon/utils/thread_pool.h"
+#include <gtest/gtest.h>
+
+using namespace std;
+
+TEST(PHE, RandomPoolEncryption) {
+  // init djcs_t parameters
+  int client_num = 3;
+  hcs_random *hr = hcs_init_random();
+  djcs_t_public_key *pk = djcs_t_init_public_key();
+  djcs_t_private_key *vk = djcs_t_init_private_key();
+  auto **au =
+      (djcs_t_auth_server **)malloc(client_num * sizeof(djcs_t_auth_server *));
+  auto *si = (mpz_t *)malloc(client_num * sizeof(mpz_t));
+  djcs_t_generate_key_pair(pk, vk, hr, 1, 1024, client_num, client_num);
+  mpz_t *coeff = djcs_t_init_polynomial(vk, hr);
+  for (int i = 0; i < client_num; i++) {
+    mpz_init(si[i]);
+    djcs_t_compute_polynomial(vk, coeff, si[i], i);
+    au[i] = djcs_t_init_auth_server();
+    djcs_t_set_auth_server(au[i], si[i], i);
+  }
+
+  // a small pool so that both hits and misses happen
+  int capacity = 8, watermark = 4, test_size = 64;
+  auto key_context = std::make_shared<PheKeyContext>(pk, au[0]);
+  auto *pool = new PheRandomPool(key_context, capacity, watermark, 1);
+  EXPECT_EQ(pool->getter_capacity(), capacity);
+  EXPECT_EQ(pool->getter_watermark(), watermark);
+
+  std::vector<double> values;
+  auto *encrypted = new EncodedNumber[test_size];
+  for (int i = 0; i < test_size; i++) {
+    values.push_back((i % 2 == 0) ? i * 0.25 : -i * 0.75);
+    EncodedNumber plain;
+    plain.set_double(pk->n[0], values[i], PHE_FIXED_POINT_PRECISION);
+    djcs_t_aux_encrypt(pk, pool, encrypted[i], plain);
+    EXPECT_EQ(encrypted[i].getter_type(), Ciphertext);
+    EXPECT_EQ(encrypted[i].getter_exponent(), 0 - PHE_FIXED_POINT_PRECISION);
+  }
+  EXPECT_EQ(pool->getter_hits() + pool->getter_misses(), test_size);
+  EXPECT_LE(pool->getter_size(), capacity);
+
+  // decrypt and check the values
+  auto *partial_decryption = new EncodedNumber[client_num];
+  for (int i = 0; i < test_size; i++) {
+    EncodedNumber decrypted;
+    for (int j = 0; j < client_num; j++) {
+      djcs_t_aux_partial_decrypt(pk, au[j], partial_decryption[j],
+                                 encrypted[i]);
+    }
+    djcs_t_aux_share_combine(pk, decrypted, partial_decryption, client_num);
+    double decoded;
+    decrypted.decode(decoded);
+    EXPECT_NEAR(values[i], decoded, 1e-3);
+  }
+
+  // the same plaintext should be encrypted with different randomness
+  EncodedNumber plain, cipher1, cipher2;
+  plain.set_integer(pk->n[0], 1);
+  djcs_t_aux_encrypt(pk, pool, cipher1, plain);
+  djcs_t_aux_encrypt(pk, pool, cipher2, plain);
+  mpz_t v1, v2;
+  mpz_init(v1);
+  mpz_init(v2);
+  cipher1.getter_value(v1);
+  cipher2.getter_value(v2);
+  EXPECT_NE(mpz_cmp(v1, v2), 0);
+  mpz_clear(v1);
+  mpz_clear(v2);
+
+  delete pool;
+  delete[] encrypted;
+  delete[] partial_decryption;
+  for (int i = 0; i < client_num; i++) {
+    djcs_t_free_auth_server(au[i]);
+    mpz_clear(si[i]);
+  }
+  djcs_t_free_polynomial(vk, coeff);
+  free(si);
+  free(au);
+  djcs_t_free_private_key(vk);
+  djcs_t_free_public_key(pk);
+  hcs_free_random(hr);
+}
+
+TEST(PHE, ConstantFactory) {
+  // init djcs_t parameters
+  int client_num = 3;
+  hcs_random *hr = hcs_init_random();
+  djcs_t_public_key *pk = djcs_t_init_public_key();
+  djcs_t_private_key *vk = djcs_t_init_private_key();
+  auto **au =
+      (djcs_t_auth_server **)malloc(client_num * sizeof(djcs_t_auth_server *));
+  auto *si = (mpz_t *)malloc(client_num * sizeof(mpz_t));
+  djcs_t_generate_key_pair(pk, vk, hr, 1, 1024, client_num, client_num);
+  mpz_t *coeff = djcs_t_init_polynomial(vk, hr);
+  for (int i = 0; i < client_num; i++) {
+    mpz_init(si[i]);
+    djcs_t_compute_polynomial(vk, coeff, si[i], i);
+    au[i] = djcs_t_init_auth_server();
+    djcs_t_set_auth_server(au[i], si[i], i);
+  }
+
+  auto pool = std::make_shared<PheRandomPool>(
+      std::make_shared<PheKeyContext>(pk, au[0]), 8, 4, 1);
+  PheConstantFactory factory(pool);
+
+  // fresh and trivial zeros, constants, and a sum of them
+  int precision = 2 * PHE_FIXED_POINT_PRECISION;
+  EncodedNumber zeros[2], constants[2], plain_constant;
+  factory.encrypt_zeros(zeros, 1, precision);
+  factory.encrypt_zero(zeros[1], precision, true);
+  plain_constant.set_double(pk->n[0], -2.5, precision);
+  factory.encrypt_constant(constants[0], plain_constant);
+  factory.encrypt_constant(constants[1], plain_constant, true);
+  EncodedNumber sum = zeros[1];
+  djcs_t_aux_ee_add(pk, sum, sum, constants[0]);
+  djcs_t_aux_ee_add(pk, sum, sum, zeros[0]);
+  std::vector<double> expected = {0.0, 0.0, -2.5, -2.5, -2.5};
+  EncodedNumber ciphers[5] = {zeros[0], zeros[1], constants[0], constants[1],
+                              sum};
+
+  auto *partial_decryption = new EncodedNumber[client_num];
+  for (int i = 0; i < 5; i++) {
+    EXPECT_EQ(ciphers[i].getter_type(), Ciphertext);
+    EXPECT_EQ(ciphers[i].getter_exponent(), 0 - precision);
+    EncodedNumber decrypted;
+    for (int j = 0; j < client_num; j++) {
+      djcs_t_aux_partial_decrypt(pk, au[j], partial_decryption[j], ciphers[i]);
+    }
+    djcs_t_aux_share_combine(pk, decrypted, partial_decryption, client_num);
+    double decoded;
+    decrypted.decode(decoded);
+    EXPECT_NEAR(expected[i], decoded, 1e-3);
+  }
+
+  // the trivial zero is deterministic, the fresh zero is not
+  mpz_t v;
+  mpz_init(v);
+  zeros[1].getter_value(v);
+  EXPECT_EQ(mpz_cmp_ui(v, 1), 0);
+  zeros[0].getter_value(v);
+  EXPECT_NE(mpz_cmp_ui(v, 1), 0);
+  mpz_clear(v);
+
+  delete[] partial_decryption;
+  for (int i = 0; i < client_num; i++) {
+    djcs_t_free_auth_server(au[i]);
+    mpz_clear(si[i]);
+  }
+  djcs_t_free_polynomial(vk, coeff);
+  free(si);
+  free(au);
+  djcs_t_free_private_key(vk);
+  djcs_t_free_public_key(pk);
+  hcs_free_random(hr);
+}
+
+TEST(PHE, RandomStream) {
+  // init djcs_t parameters
+  int client_num = 3;
+  hcs_random *hr = hcs_init_random();
+  djcs_t_public_key *pk = djcs_t_init_public_key();
+  djcs_t_private_key *vk = djcs_t_init_private_key();
+  auto **au =
+      (djcs_t_auth_server **)malloc(client_num * sizeof(djcs_t_auth_server *));
+  auto *si = (mpz_t *)malloc(client_num * sizeof(mpz_t));
+  djcs_t_generate_key_pair(pk, vk, hr, 1, 1024, client_num, client_num);
+  mpz_t *coeff = djcs_t_init_polynomial(vk, hr);
+  for (int i = 0; i < client_num; i++) {
+    mpz_init(si[i]);
+    djcs_t_compute_polynomial(vk, coeff, si[i], i);
+    au[i] = djcs_t_init_auth_server();
+    djcs_t_set_auth_server(au[i], si[i], i);
+  }
+
+  // more elements than a chunk, so that several streams are used
+  int row_size = 5, column_size = 9;
+  std::vector<std::vector<double>> mat(row_size,
+                                       std::vector<double>(column_size));
+  for (int i = 0; i < row_size; i++) {
+    for (int j = 0; j < column_size; j++) {
+      mat[i][j] = (i - j) * 0.5;
+    }
+  }
+  auto encrypt = [&](int thread_num, unsigned long seed, bool deterministic) {
+    crypto_thread_pool_init(thread_num);
+    phe_random_stream_init(seed, deterministic);
+    auto **res = new EncodedNumber *[row_size];
+    for (int i = 0; i < row_size; i++) {
+      res[i] = new EncodedNumber[column_size];
+    }
+    djcs_t_aux_double_mat_encryption(pk, hr, res, row_size, column_size, mat,
+                                     PHE_FIXED_POINT_PRECISION);
+    std::vector<std::string> values;
+    mpz_t v;
+    mpz_init(v);
+    for (int i = 0; i < row_size; i++) {
+      for (int j = 0; j < column_size; j++) {
+        res[i][j].getter_value(v);
+        values.push_back(mpz_get_str(nullptr, PHE_STR_BASE, v));
+      }
+    }
+    mpz_clear(v);
+    return std::make_pair(res, values);
+  };
+  auto free_mat = [&](EncodedNumber **res) {
+    for (int i = 0; i < row_size; i++) {
+      delete[] res[i];
+    }
+    delete[] res;
+  };
+
+  // the deterministic mode does not depend on the number of threads
+  auto single = encrypt(1, 42, true);
+  auto multiple = encrypt(3, 42, true);
+  auto other_seed = encrypt(3, 43, true);
+  auto random = encrypt(3, 0, false);
+  EXPECT_EQ(single.second, multiple.second);
+  EXPECT_NE(single.second, other_seed.second);
+  EXPECT_NE(single.second, random.second);
+  std::set<std::string> distinct(random.second.begin(), random.second.end());
+  EXPECT_EQ((int)distinct.size(), row_size * column_size);
+
+  // decrypt and check the values
+  auto *partial_decryption = new EncodedNumber[client_num];
+  for (auto *res : {single.first, random.first}) {
+    for (int i = 0; i < row_size; i++) {
+      for (int j = 0; j < column_size; j++) {
+        EncodedNumber decrypted;
+        for (int k = 0; k < client_num; k++) {
+          djcs_t_aux_partial_decrypt(pk, au[k], partial_decryption[k],
+                                     res[i][j]);
+        }
+        djcs_t_aux_share_combine(pk, decrypted, partial_decryption,
+                                 client_num);
+        double decoded;
+        decrypted.decode(decoded);
+        EXPECT_NEAR(mat[i][j], decoded, 1e-3);
+      }
+    }
+  }
+  crypto_thread_pool_init(0);
+  phe_random_stream_init(0, false);
+
+  free_mat(single.first);
+  free_mat(multiple.first);
+  free_mat(other_seed.first);
+  free_mat(random.first);
+  delete[] partial_decryption;
+  for (int i = 0; i < client_num; i++) {
+    djcs_t_free_auth_server(au[i]);
+    mpz_clear(si[i]);
+  }
+  djcs_t_free_polynomial(vk, coeff);
+  free(si);
+  free(au);
+  djcs_t_free_private_key(vk);
+  djcs_t_free_public_key(pk);
+  hcs_free_random(hr);
+}
+
+TEST(PHE, RandomStreamNestedLoop) {
+  // a chunk keeps drawing from its stream across a nested loop, while the
+  // waiting thread runs chunks of other loops that draw from their streams
+  crypto_thread_pool_init(4);
+  phe_random_stream_init(7, true);
+  int size = 8 * PHE_RANDOM_STREAM_GRAIN;
+  std::atomic<bool> stopped(false);
+  std::thread other([&] {
+    while (!stopped.load()) {
+      unsigned long other_loop = phe_random_stream_next_loop();
+      crypto_parallel_for_chunks(0, size, [&](int begin, int end) {
+        hcs_random *hr = phe_random_stream(other_loop, begin);
+        for (int i = begin; i < end; i++) {
+          gmp_urandomb_ui(hr->rstate, 32);
+        }
+      }, PHE_RANDOM_STREAM_GRAIN);
+    }
+  });
+
+  unsigned long loop = phe_random_stream_next_loop();
+  std::vector<unsigned long> first(size), second(size);
+  crypto_parallel_for_chunks(0, size, [&](int begin, int end) {
+    hcs_random *hr = phe_random_stream(loop, begin);
+    for (int i = begin; i < end; i++) {
+      first[i] = gmp_urandomb_ui(hr->rstate, 32);
+    }
+    crypto_parallel_for(0, 16, [](int) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }, 1);
+    for (int i = begin; i < end; i++) {
+      second[i] = gmp_urandomb_ui(hr->rstate, 32);
+    }
+  }, PHE_RANDOM_STREAM_GRAIN);
+  stopped.store(true);
+  other.join();
+
+  // the draws only depend on the seed, the loop and the chunk
+  for (int begin = 0; begin < size; begin += PHE_RANDOM_STREAM_GRAIN) {
+    hcs_random *hr = phe_random_stream(loop, begin);
+    int end = begin + PHE_RANDOM_STREAM_GRAIN;
+    for (int i = begin; i < end; i++) {
+      EXPECT_EQ(first[i], gmp_urandomb_ui(hr->rstate, 32));
+    }
+    for (int i = begin; i < end; i++) {
+      EXPECT_EQ(second[i], gmp_urandomb_ui(hr->rstate, 32));
+    }
+  }
+  crypto_thread_pool_init(0);
+  phe_random_stream_init(0, false);
+}
+
+TEST(PHE, SecretRandomStream) {
+  // the deterministic streams repeat for the same seed, the secret ones and
+  // the default streams do not
+  auto draw = [](unsigned long seed, bool deterministic, bool secret) {
+    phe_random_stream_init(seed, deterministic);
+    hcs_random *hr = secret
+        ? phe_secret_random_stream()
+        : phe_random_stream(phe_random_stream_next_loop(), 0);
+    return gmp_urandomb_ui(hr->rstate, 32);
+  };
+  EXPECT_EQ(draw(42, true, false), draw(42, true, false));
+  std::set<unsigned long> secrets, defaults;
+  for (int i = 0; i < 8; i++) {
+    secrets.insert(draw(42, true, true));
+    defaults.insert(draw(42, false, false));
+  }
+  EXPECT_GT((int)secrets.size(), 1);
+  EXPECT_EQ((int)defaults.size(), 8);
+  phe_random_stream_init(0, false);
+}
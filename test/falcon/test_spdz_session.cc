@@ -0,0 +1,195 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//
+// Created by root on 10/18/26.
+//
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "falcon/operator/mpc/spdz_session.h"
+#include <gtest/gtest.h>
+
+using namespace std;
+
+/**
+ * a spdz engine on a local socket that serves the computations of a client
+ * on its connection, each computation sends an int and receives it plus
+ * one, until the client closes the connection
+ *
+ * @param socket: the connection to the client
+ * @param served: incremented for each served computation
+ */
+static void loopback_spdz_engine(int socket, atomic<int> *served) {
+  int value;
+  while (recv(socket, &value, sizeof(int), MSG_WAITALL) == sizeof(int)) {
+    value++;
+    if (send(socket, &value, sizeof(int), MSG_NOSIGNAL) != sizeof(int)) {
+      break;
+    }
+    (*served)++;
+  }
+  close(socket);
+}
+
+// a session whose connections are local sockets to loopback engines
+class LoopbackSpdzSession : public SpdzSession {
+public:
+  explicit LoopbackSpdzSession(bool persistent)
+      : SpdzSession(1, 0, vector<int>{0}, vector<string>{"127.0.0.1"},
+                    persistent),
+        client_socket(-1), connections(0), served(0) {}
+
+  ~LoopbackSpdzSession() override { close(); }
+
+  // the client side of the current connection
+  int client_socket;
+  // the number of opened connections
+  int connections;
+  // the number of served computations over all the connections
+  atomic<int> served;
+
+protected:
+  void connect() override {
+    int pair[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+    client_socket = pair[0];
+    engine = thread(loopback_spdz_engine, pair[1], &served);
+    connections++;
+  }
+
+  void disconnect() override {
+    shutdown(client_socket, SHUT_RDWR);
+    engine.join();
+    ::close(client_socket);
+    client_socket = -1;
+  }
+
+private:
+  thread engine;
+};
+
+/**
+ * a spdz computation on a loopback session
+ *
+ * @param session: the loopback session
+ * @param value: the value to send
+ * @param fail: whether the computation throws after sending its value
+ * @param result: the value received from the engine
+ */
+static void loopback_computation(shared_ptr<SpdzSession> session, int value,
+                                 bool fail, promise<vector<double>> *result) {
+  SpdzComputation computation(*session);
+  auto &loopback = static_cast<LoopbackSpdzSession &>(*session);
+  ASSERT_EQ(send(loopback.client_socket, &value, sizeof(int), 0),
+            (ssize_t)sizeof(int));
+  if (fail) {
+    // the reply is left on the socket
+    throw runtime_error("the computation failed");
+  }
+  int reply;
+  ASSERT_EQ(recv(loopback.client_socket, &reply, sizeof(int), MSG_WAITALL),
+            (ssize_t)sizeof(int));
+  result->set_value(vector<double>(1, reply));
+}
+
+TEST(SpdzSession, PersistentComputations) {
+  // two computations on one connection
+  auto session = make_shared<LoopbackSpdzSession>(true);
+  auto first = spdz_computation_async(loopback_computation, session, 1, false);
+  auto second =
+      spdz_computation_async(loopback_computation, session, 10, false);
+  EXPECT_EQ(first.get()[0], 2);
+  EXPECT_EQ(second.get()[0], 11);
+  EXPECT_EQ(session->connections, 1);
+  EXPECT_EQ(session->served, 2);
+}
+
+TEST(SpdzSession, NonPersistentComputations) {
+  // one connection per computation
+  auto session = make_shared<LoopbackSpdzSession>(false);
+  auto first = spdz_computation_async(loopback_computation, session, 1, false);
+  auto second =
+      spdz_computation_async(loopback_computation, session, 10, false);
+  EXPECT_EQ(first.get()[0], 2);
+  EXPECT_EQ(second.get()[0], 11);
+  EXPECT_EQ(session->connections, 2);
+}
+
+TEST(SpdzSession, FailedComputationReconnects) {
+  // the next computation does not read the reply left by the failed one
+  auto session = make_shared<LoopbackSpdzSession>(true);
+  auto failed = spdz_computation_async(loopback_computation, session, 1, true);
+  auto next = spdz_computation_async(loopback_computation, session, 10, false);
+  EXPECT_THROW(failed.get(), runtime_error);
+  EXPECT_EQ(next.get()[0], 11);
+  EXPECT_EQ(session->connections, 2);
+}
+
+/**
+ * a computation that does not use the session, it takes a different time
+ * for each id and records the order in which the computations run
+ *
+ * @param session: the session the computation is serialized on
+ * @param id: the id of the computation
+ * @param order: the ids of the computations in the order they ran
+ * @param result: the id of the computation
+ */
+static void ordered_computation(shared_ptr<SpdzSession> session, int id,
+                                vector<int> *order,
+                                promise<vector<double>> *result) {
+  this_thread::sleep_for(chrono::milliseconds((id * 7919) % 13));
+  order->push_back(id);
+  result->set_value(vector<double>(1, id));
+}
+
+TEST(SpdzSession, AsyncComputationOrder) {
+  // the computations run one at a time in the order they are started
+  auto session = make_shared<LoopbackSpdzSession>(true);
+  int computation_num = 30;
+  vector<int> order;
+  vector<future<vector<double>>> results;
+  for (int i = 0; i < computation_num; i++) {
+    results.push_back(
+        spdz_computation_async(ordered_computation, session, i, &order));
+  }
+  for (int i = 0; i < computation_num; i++) {
+    EXPECT_EQ(results[i].get()[0], i);
+  }
+  ASSERT_EQ(order.size(), (size_t)computation_num);
+  for (int i = 0; i < computation_num; i++) {
+    EXPECT_EQ(order[i], i);
+  }
+  EXPECT_EQ(session->connections, 0);
+}
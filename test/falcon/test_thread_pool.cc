@@ -0,0 +1,120 @@
+/**
+MIT License
+
+Copyright (c) 2020 lemonviv
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//
+// Created by root on 10/18/26.
+//
+
+#include <atomic>
+#include <vector>
+
+#include "falcon/utils/thread_pool.h"
+#include <gtest/gtest.h>
+
+using namespace std;
+
+TEST(ThreadPool, ParallelFor) {
+  // more threads than cpus, so that the chunks interleave
+  CryptoThreadPool pool(4);
+  EXPECT_EQ(pool.getter_thread_num(), 4);
+
+  // each index is visited exactly once, for any grain
+  int size = 1000;
+  for (int grain : {0, 1, 7, 1000, 5000}) {
+    vector<atomic<int>> visits(size);
+    for (auto &v : visits) {
+      v.store(0);
+    }
+    pool.parallel_for(0, size, grain, [&](int begin, int end) {
+      for (int i = begin; i < end; i++) {
+        visits[i]++;
+      }
+    });
+    for (int i = 0; i < size; i++) {
+      EXPECT_EQ(visits[i].load(), 1);
+    }
+  }
+
+  // an empty range does not call the body
+  bool called = false;
+  pool.parallel_for(5, 5, 0, [&](int begin, int end) { called = true; });
+  EXPECT_FALSE(called);
+
+  // nested loops share the threads without deadlock
+  int outer = 16, inner = 64;
+  vector<atomic<int>> sums(outer);
+  for (auto &s : sums) {
+    s.store(0);
+  }
+  pool.parallel_for(0, outer, 1, [&](int begin, int end) {
+    for (int i = begin; i < end; i++) {
+      pool.parallel_for(0, inner, 3, [&](int b, int e) {
+        for (int j = b; j < e; j++) {
+          sums[i] += j;
+        }
+      });
+    }
+  });
+  for (int i = 0; i < outer; i++) {
+    EXPECT_EQ(sums[i].load(), inner * (inner - 1) / 2);
+  }
+}
+
+TEST(ThreadPool, CryptoPool) {
+  EXPECT_GE(available_cpu_num(), 1);
+  crypto_thread_pool_init(3);
+  EXPECT_EQ(CryptoThreadPoolUse()->getter_thread_num(), 3);
+
+  int size = 257;
+  vector<int> squares(size, 0);
+  crypto_parallel_for(0, size, [&](int i) { squares[i] = i * i; });
+  for (int i = 0; i < size; i++) {
+    EXPECT_EQ(squares[i], i * i);
+  }
+
+  // the chunks count their nesting depth, also on a single thread
+  EXPECT_EQ(crypto_parallel_depth(), 0);
+  std::atomic<int> wrong_depth(0);
+  crypto_parallel_for(0, 8, [&](int i) {
+    if (crypto_parallel_depth() != 1) {
+      wrong_depth++;
+    }
+    crypto_parallel_for(0, 8, [&](int j) {
+      if (crypto_parallel_depth() != 2) {
+        wrong_depth++;
+      }
+    }, 1);
+  }, 1);
+  EXPECT_EQ(wrong_depth.load(), 0);
+  EXPECT_EQ(crypto_parallel_depth(), 0);
+
+  // 0 selects the cpu quota of the process
+  crypto_thread_pool_init(0);
+  EXPECT_EQ(CryptoThreadPoolUse()->getter_thread_num(), available_cpu_num());
+
+  // the pool is not replaced while a loop runs on it
+  EXPECT_EXIT(crypto_parallel_for(0, 1, [](int i) {
+    crypto_thread_pool_init(2);
+  }), ::testing::ExitedWithCode(EXIT_FAILURE), "");
+}
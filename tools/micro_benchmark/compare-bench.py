@@ -0,0 +1,82 @@
+"""
+Compare a falcon_bench JSON output against a stored baseline.
+
+Usage:
+    falcon_bench --benchmark_out=current.json --benchmark_out_format=json
+    python3 compare-bench.py baseline.json current.json --threshold 0.10
+
+Exits with 1 if any benchmark is slower than the baseline by more than the
+threshold, so that it can gate an operator optimization.
+"""
+
+import argparse
+import json
+import sys
+
+# time units of google benchmark in nanoseconds
+TIME_UNITS = {'ns': 1.0, 'us': 1e3, 'ms': 1e6, 's': 1e9}
+
+
+def load_times(path):
+    """
+    Load the real time in nanoseconds of each benchmark, the median is used
+    when the benchmarks were repeated.
+    """
+    with open(path) as f:
+        benchmarks = json.load(f)['benchmarks']
+    times = {}
+    repeated = any(b.get('run_type') == 'aggregate' for b in benchmarks)
+    for b in benchmarks:
+        if repeated:
+            if b.get('aggregate_name') != 'median':
+                continue
+            name = b['run_name']
+        else:
+            name = b['name']
+        times[name] = b['real_time'] * TIME_UNITS[b.get('time_unit', 'ns')]
+    return times
+
+
+def compare(baseline, current, threshold):
+    regressions = []
+    print('{:<60} {:>12} {:>12} {:>8}'.format(
+        'benchmark', 'baseline', 'current', 'change'))
+    for name in sorted(current):
+        if name not in baseline:
+            print('{:<60} {:>12} {:>12.3f} {:>8}'.format(
+                name, '-', current[name] / 1e6, 'new'))
+            continue
+        change = current[name] / baseline[name] - 1.0
+        flag = ''
+        if change > threshold:
+            regressions.append(name)
+            flag = ' REGRESSION'
+        print('{:<60} {:>12.3f} {:>12.3f} {:>+7.1f}%{}'.format(
+            name, baseline[name] / 1e6, current[name] / 1e6, change * 100,
+            flag))
+    for name in sorted(set(baseline) - set(current)):
+        print('{:<60} {:>12.3f} {:>12} {:>8}'.format(
+            name, baseline[name] / 1e6, '-', 'missing'))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[1])
+    parser.add_argument('baseline', help='baseline falcon_bench json')
+    parser.add_argument('current', help='current falcon_bench json')
+    parser.add_argument('--threshold', type=float, default=0.10,
+                        help='allowed relative slowdown, default 0.10')
+    args = parser.parse_args()
+
+    print('times in ms')
+    regressions = compare(load_times(args.baseline), load_times(args.current),
+                          args.threshold)
+    if regressions:
+        print('{} benchmark(s) slower than the baseline by more than {:.0f}%'
+              .format(len(regressions), args.threshold * 100))
+        sys.exit(1)
+    print('no regression beyond {:.0f}%'.format(args.threshold * 100))
+
+
+if __name__ == '__main__':
+    main()